@@ -1,4 +1,7 @@
 #include <Asset.h>
+#include <GltfImport.h>
+#include <MeshProcessing.h>
+#include <TextureProcessing.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <ThirdParty/stb/stb_image.h>
@@ -12,7 +15,6 @@
 #endif
 
 // #define _CRT_SECURE_NO_WARNINGS
-#define CGLTF_IMPLEMENTATION
 #include <ThirdParty/cgltf/cgltf.h>
 
 #include <AssetTable.cpp>
@@ -22,6 +24,54 @@ static UniquePtr<AssetManager> s_asset_manager{ nullptr };
 
 namespace
 {
+    constexpr u32 k_max_atlas_entry_size = 256;    // Larger textures are grouped into arrays instead
+    constexpr u32 k_max_texture_array_slices = 64;
+    constexpr u64 k_max_texture_array_size = Megabytes(64);  // Half the renderer's texture upload heap, an array is uploaded in one go
+
+    void cook_texture_asset(TextureAsset* asset, u32 max_mip_levels = 0)
+    {
+        MipGenerationSettings mip_settings = get_default_mip_settings(*asset);
+        mip_settings.m_max_mip_levels = max_mip_levels;
+
+        generate_mip_chain(asset, mip_settings);
+        compress_texture(asset, get_default_texture_compression(*asset));
+
+        // Compression already writes the upload layout, this only touches uncompressed textures
+        convert_to_upload_layout(asset);
+    }
+
+    bool can_share_atlas(const TextureAsset& a, const TextureAsset& b)
+    {
+        return a.m_num_channels == b.m_num_channels && a.m_format == b.m_format && a.m_usage == b.m_usage;
+    }
+
+    bool can_share_array(const TextureAsset& a, const TextureAsset& b)
+    {
+        return a.m_width == b.m_width && a.m_height == b.m_height && a.m_num_channels == b.m_num_channels &&
+               a.m_format == b.m_format && a.m_usage == b.m_usage && a.m_compression == b.m_compression &&
+               a.m_mip_levels == b.m_mip_levels;
+    }
+
+    TextureAsset make_texture_view(const TextureAsset& texture, const AssetId& parent_id, u32 array_slice, const Vector4& uv_transform)
+    {
+        TextureAsset view{ texture.m_id };
+        view.m_width = texture.m_width;
+        view.m_height = texture.m_height;
+        view.m_num_channels = texture.m_num_channels;
+        view.m_dimension = texture.m_dimension;
+        view.m_format = texture.m_format;
+        view.m_usage = texture.m_usage;
+        view.m_parent_id = parent_id;
+        view.m_array_slice = array_slice;
+        view.m_uv_transform = uv_transform;
+        return view;
+    }
+
+    AssetId make_texture_group_id(const AssetId& model_id, const char* kind, u32 index)
+    {
+        return AssetId(ZV::format("{}/{}_{}", model_id.name().c_str(), kind, index).c_str());
+    }
+
     SubmeshHandle cgltf_append_submesh(
         ModelAsset* asset,
         const MeshGeometryData& geom,
@@ -41,14 +91,16 @@ namespace
         {
             memcpy(data.m_data.m_indices.data(), geom.m_indices.data(), sizeof(u16) * geom.m_indices.size());
         }
+        data.m_data.m_bounds = geom.m_bounds;
+        data.m_data.m_bounding_sphere = geom.m_bounding_sphere;
 
         data.m_local_transform = local;
-        data.m_world_transform = world;
         data.m_material_info = material_info;
         data.m_parent = parent;
 
         const SubmeshHandle handle = (SubmeshHandle)(s32)asset->m_submeshes.size();
         asset->m_submeshes.push_back(data);
+        set_submesh_world_transform(asset, handle, world);
 
         if ((s32)parent != (s32)SubmeshHandle::Invalid)
         {
@@ -58,7 +110,11 @@ namespace
         return handle;
     }
     
-    void cgltf_read_material_info(const cgltf_primitive* prim, const char* model_id, MaterialInfo* out_material_info)
+    void cgltf_read_material_info(
+        const cgltf_primitive* prim,
+        const char* model_id,
+        MaterialInfo* out_material_info,
+        HashMap<AssetId, PackedTextureLoadInfo>* out_packed_textures)
     {
         if (prim->material)
         {
@@ -117,9 +173,7 @@ namespace
                     metallic_roughness_texture_name.assign(model_id);
                     metallic_roughness_texture_name.append("/");
                     metallic_roughness_texture_name.append(metallic_roughness_texture->image->uri);
-                    out_material_info->m_metallic_roughness_texture_id.set(metallic_roughness_texture_name.c_str());
-
-                    auto asset_id = out_material_info->m_metallic_roughness_texture_id;
+                    out_material_info->m_orms_texture_id.set(metallic_roughness_texture_name.c_str());
 
                     // TODO: This is not true all the time!!!
                     out_material_info->m_channel_packing = ChannelPacking::Metalness | ChannelPacking::Roughness;
@@ -131,7 +185,30 @@ namespace
                     ao_texture_name.assign(model_id);
                     ao_texture_name.append("/");
                     ao_texture_name.append(ao_texture->image->uri);
-                    out_material_info->m_ao_texture_id.set(ao_texture_name.c_str());
+                    const AssetId ao_texture_id(ao_texture_name.c_str());
+
+                    if (!out_material_info->m_orms_texture_id.is_valid() || ao_texture->image == metallic_roughness_texture->image)
+                    {
+                        // Occlusion only, or glTF ORM texture with occlusion already in the red channel
+                        out_material_info->m_orms_texture_id = ao_texture_id;
+                    }
+                    else
+                    {
+                        // Separate occlusion map, cook it into the red channel of a combined texture
+                        PackedTextureLoadInfo packed_info{};
+                        packed_info.m_occlusion = PackedTextureChannel{ ao_texture_id, 0 };
+                        packed_info.m_roughness = PackedTextureChannel{ out_material_info->m_orms_texture_id, 1 };
+                        packed_info.m_metalness = PackedTextureChannel{ out_material_info->m_orms_texture_id, 2 };
+
+                        FixedSizeString<128> orms_texture_name = out_material_info->m_orms_texture_id.name();
+                        orms_texture_name.append("+");
+                        orms_texture_name.append(ao_texture->image->uri);
+                        out_material_info->m_orms_texture_id.set(orms_texture_name);
+
+                        out_packed_textures->emplace(out_material_info->m_orms_texture_id, packed_info);
+                    }
+
+                    out_material_info->m_channel_packing.set(ChannelPacking::Occlusion);
                 }
                 cgltf_texture* emissive_texture = material->emissive_texture.texture;
                 if (emissive_texture && emissive_texture->image)
@@ -156,136 +233,6 @@ namespace
         }
     }
 
-    inline const cgltf_accessor* cgltf_find_attr_accessor(const cgltf_primitive* prim, cgltf_attribute_type type, s32 index)
-    {
-        for (cgltf_size i = 0; i < prim->attributes_count; ++i)
-        {
-            const cgltf_attribute* a = &prim->attributes[i];
-            if (a->type == type && a->index == (cgltf_int)index)
-            {
-                return a->data;
-            }
-        }
-        return nullptr;
-    }
-
-    inline void cgltf_read_indices(const cgltf_accessor* acc, DynamicArray<u16>& out_indices, bool is_cw_winding_order = true)
-    {
-        cgltf_size num_indices = cgltf_accessor_unpack_indices(acc, nullptr, 0, 0);
-        out_indices.resize((size_t)num_indices);
-        cgltf_accessor_unpack_indices(acc, out_indices.data(), sizeof(u16), num_indices);
-
-        if (is_cw_winding_order)
-        {
-            for (s32 i = 0; i + 2 < (s32)out_indices.size(); i += 3)
-            {
-                const u16 t = out_indices[i + 1];
-                out_indices[i + 1]   = out_indices[i + 2];
-                out_indices[i + 2]   = t;
-            }
-        }
-    }
-
-    void cgltf_read_vertices(const cgltf_primitive* prim, DynamicArray<MeshVertex>& out_vertices, bool is_left_handed_coordinate_system = true)
-    {
-        const cgltf_accessor* pos_acc  = cgltf_find_attr_accessor(prim, cgltf_attribute_type_position, 0);
-        // Position is mandatory for us; if missing, produce zero verts.
-        if (!pos_acc)
-        {
-            out_vertices.resize(0);
-            return;
-        }
-    
-        const cgltf_size vcount = pos_acc->count;
-        out_vertices.resize((size_t)vcount);
-        MeshVertex* vtx = out_vertices.data();
-    
-        const cgltf_accessor* uv_acc   = cgltf_find_attr_accessor(prim, cgltf_attribute_type_texcoord, 0);
-        const cgltf_accessor* nrm_acc  = cgltf_find_attr_accessor(prim, cgltf_attribute_type_normal,   0);
-        const cgltf_accessor* tan_acc  = cgltf_find_attr_accessor(prim, cgltf_attribute_type_tangent,  0);
-    
-        f32 tmp[4];
-    
-        for (cgltf_size i = 0; i < vcount; ++i)
-        {
-            // position
-            tmp[0]=tmp[1]=tmp[2]=0.0f; tmp[3]=1.0f;
-            cgltf_accessor_read_float(pos_acc, i, tmp, 3);
-            vtx[i].position.x = tmp[0];
-            vtx[i].position.y = tmp[1];
-            vtx[i].position.z = tmp[2];
-            if (is_left_handed_coordinate_system)
-            {
-                vtx[i].position = basis_flip_y(vtx[i].position);
-            }
-    
-            // uv
-            if (uv_acc)
-            {
-                tmp[0]=tmp[1]=0.0f;
-                cgltf_accessor_read_float(uv_acc, i, tmp, 2);
-                vtx[i].uv.x = tmp[0];
-                vtx[i].uv.y = tmp[1];
-            }
-            else
-            {
-                vtx[i].uv.x = 0.0f; vtx[i].uv.y = 0.0f;
-            }
-    
-            // normal
-            if (nrm_acc)
-            {
-                tmp[0]=tmp[1]=tmp[2]=0.0f;
-                cgltf_accessor_read_float(nrm_acc, i, tmp, 3);
-                vtx[i].normal.x = tmp[0];
-                vtx[i].normal.y = tmp[1];
-                vtx[i].normal.z = tmp[2];
-                if (is_left_handed_coordinate_system)
-                {
-                    vtx[i].normal = basis_flip_y(vtx[i].normal);
-                }
-            }
-            else
-            {
-                vtx[i].normal.x = 0.0f; vtx[i].normal.y = 0.0f; vtx[i].normal.z = 1.0f;
-            }
-    
-            // tangent (xyz from accessor, ignore handedness w)
-            if (tan_acc)
-            {
-                tmp[0]=tmp[1]=tmp[2]=0.0f; tmp[3]=1.0f;
-                cgltf_accessor_read_float(tan_acc, i, tmp, 4);
-                vtx[i].tangent.x = tmp[0];
-                vtx[i].tangent.y = tmp[1];
-                vtx[i].tangent.z = tmp[2];
-                vtx[i].tangent.w = tmp[3];
-                if (is_left_handed_coordinate_system)
-                {
-                    vtx[i].tangent = basis_flip_y(vtx[i].tangent);
-                }
-            }
-            else
-            {
-                vtx[i].tangent.x = 1.0f; vtx[i].tangent.y = 0.0f; vtx[i].tangent.z = 0.0f;
-                vtx[i].tangent.w = 1.0f;
-            }
-        }
-    }
-
-    void cgltf_read_geometry_data(const cgltf_primitive* prim, MeshGeometryData* out_geom)
-    {
-        cgltf_read_vertices(prim, out_geom->m_vertices);
-    
-        if (prim->indices && prim->type == cgltf_primitive_type_triangles)
-        {
-            cgltf_read_indices(prim->indices, out_geom->m_indices);
-        }
-        else
-        {
-            zv_error("No index accessor found for primitive");
-        }
-    }
-
     inline Matrix cgltf_get_local_transform(const cgltf_node* node, bool is_row_major = true)
     {
         f32 cm[16]; // column-major from cgltf/glTF
@@ -330,7 +277,12 @@ namespace
         return basis_flip_y(Matrix{ rm });
     }
 
-    void cgltf_parse_node(const ModelLoadInfo& load_info, const cgltf_node* node, ModelAsset* asset, SubmeshHandle parent_handle)
+    void cgltf_parse_node(
+        const ModelLoadInfo& load_info,
+        const cgltf_node* node,
+        ModelAsset* asset,
+        SubmeshHandle parent_handle,
+        HashMap<AssetId, PackedTextureLoadInfo>* out_packed_textures)
     {
         if (node->mesh)
         {
@@ -342,9 +294,9 @@ namespace
                 const cgltf_primitive* prim = &node->mesh->primitives[p];
     
                 MeshGeometryData geom{};
-                cgltf_read_geometry_data(prim, &geom);
+                read_gltf_geometry(prim, &geom);
                 MaterialInfo material_info{};
-                cgltf_read_material_info(prim, asset->m_id.name().c_str(), &material_info);
+                cgltf_read_material_info(prim, asset->m_id.name().c_str(), &material_info, out_packed_textures);
     
                 cgltf_append_submesh(asset, geom, material_info, local, world, parent_handle);
             }
@@ -352,11 +304,38 @@ namespace
     
         for (cgltf_size i = 0; i < node->children_count; ++i)
         {
-            cgltf_parse_node(load_info, node->children[i], asset, parent_handle);
+            cgltf_parse_node(load_info, node->children[i], asset, parent_handle, out_packed_textures);
         }
     }
 
-    void cgltf_parse_model_data(const ModelLoadInfo& load_info, cgltf_scene* scene, ModelAsset* out_asset)
+    struct OptimizeSubmeshesContext
+    {
+        SubmeshData* m_submeshes = nullptr;
+        DynamicArray<MeshRepairStats> m_repair_stats;
+        DynamicArray<MeshOptimizationStats> m_stats;
+        DynamicArray<MeshletStats> m_meshlet_stats;
+    };
+
+    PARALLEL_FOR_CALLBACK(optimize_submeshes_job)
+    {
+        OptimizeSubmeshesContext& context = *static_cast<OptimizeSubmeshesContext*>(data);
+
+        for (u32 i = begin; i < end; i++)
+        {
+            repair_mesh(&context.m_submeshes[i].m_data, &context.m_repair_stats[i]);
+            optimize_mesh(&context.m_submeshes[i].m_data, &context.m_stats[i]);
+            generate_mesh_lods(&context.m_submeshes[i].m_data);
+            build_meshlets(context.m_submeshes[i].m_data, &context.m_submeshes[i].m_meshlets);
+            context.m_meshlet_stats[i] = analyze_meshlets(context.m_submeshes[i].m_meshlets);
+            pack_mesh_geometry(&context.m_submeshes[i].m_data);
+        }
+    }
+
+    void cgltf_parse_model_data(
+        const ModelLoadInfo& load_info,
+        cgltf_scene* scene,
+        ModelAsset* out_asset,
+        HashMap<AssetId, PackedTextureLoadInfo>* out_packed_textures)
     {
         zv_assert_msg(scene != nullptr, "Invalid cgltf_scene passed to cgltf_parse_model_data");
         zv_assert_msg(out_asset != nullptr, "Invalid out_asset passed to cgltf_parse_model_data");
@@ -366,7 +345,88 @@ namespace
 
         for (cgltf_size i = 0; i < scene->nodes_count; ++i)
         {
-            cgltf_parse_node(load_info, scene->nodes[i], out_asset, SubmeshHandle::Invalid);
+            cgltf_parse_node(load_info, scene->nodes[i], out_asset, SubmeshHandle::Invalid, out_packed_textures);
+        }
+
+        // Exporters leave duplicate vertices and degenerate triangles behind and rarely care about index order. Every submesh is
+        // repaired first, then reordered for the post-transform cache and linear vertex fetches.
+        // LODs and meshlets are built afterwards since they index into the reordered vertices. The vertices are not split into
+        // streams, the renderer splits its own upload copy. Triangle BVHs wait until the model is added to a scene BVH.
+        OptimizeSubmeshesContext context{};
+        context.m_submeshes = out_asset->m_submeshes.data();
+        context.m_repair_stats.resize(out_asset->m_submeshes.size());
+        context.m_stats.resize(out_asset->m_submeshes.size());
+        context.m_meshlet_stats.resize(out_asset->m_submeshes.size());
+        Platform::parallel_for(static_cast<u32>(out_asset->m_submeshes.size()), 1, &optimize_submeshes_job, &context);
+
+        MeshRepairStats total_repair_stats{};
+        for (const MeshRepairStats& stats : context.m_repair_stats)
+        {
+            total_repair_stats.add(stats);
+        }
+
+        zv_info("Repaired {}: {} duplicate vertices welded, {} unreferenced removed, {} with NaN attributes fixed, "
+                "{} triangles dropped ({} invalid, {} degenerate, {} zero area)",
+                load_info.m_path, total_repair_stats.m_num_welded_vertices, total_repair_stats.m_num_removed_vertices,
+                total_repair_stats.m_num_fixed_vertices, total_repair_stats.get_num_dropped_triangles(),
+                total_repair_stats.m_num_invalid_triangles, total_repair_stats.m_num_degenerate_triangles,
+                total_repair_stats.m_num_zero_area_triangles);
+
+        MeshOptimizationStats total_stats{};
+        for (const MeshOptimizationStats& stats : context.m_stats)
+        {
+            total_stats.add(stats);
+        }
+
+        MeshletStats total_meshlet_stats{};
+        for (const MeshletStats& stats : context.m_meshlet_stats)
+        {
+            total_meshlet_stats.add(stats);
+        }
+
+        zv_info("Optimized {} submeshes of {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} unused vertices removed",
+                out_asset->m_submeshes.size(), load_info.m_path,
+                total_stats.m_before.get_acmr(), total_stats.m_after.get_acmr(),
+                total_stats.m_before.get_atvr(), total_stats.m_after.get_atvr(),
+                total_stats.m_num_removed_vertices);
+
+        size_t num_triangles = 0;
+        size_t num_coarsest_triangles = 0;
+        u32 num_lods = 0;
+        for (const SubmeshData& submesh : out_asset->m_submeshes)
+        {
+            const MeshGeometryData& geometry = submesh.m_data;
+            num_triangles += geometry.m_indices.size() / 3;
+            num_coarsest_triangles += (geometry.m_lods.empty() ? geometry.m_indices.size() : geometry.m_lods.back().m_indices.size()) / 3;
+            num_lods += static_cast<u32>(geometry.m_lods.size());
+        }
+
+        zv_info("Generated {} LODs for {}: {} -> {} triangles at the coarsest levels",
+                num_lods, load_info.m_path, num_triangles, num_coarsest_triangles);
+
+        zv_info("Built {} meshlets for {}: triangle fill {:.2f}, vertex fill {:.2f}, {} with cullable cones of {:.1f} degrees on average",
+                total_meshlet_stats.m_num_meshlets, load_info.m_path,
+                total_meshlet_stats.get_triangle_fill(), total_meshlet_stats.get_vertex_fill(),
+                total_meshlet_stats.m_num_cullable, total_meshlet_stats.get_average_cone_angle());
+    }
+
+    struct BuildSubmeshBvhsContext
+    {
+        SubmeshData* m_submeshes = nullptr;
+        DynamicArray<BvhStats> m_stats;
+    };
+
+    PARALLEL_FOR_CALLBACK(build_submesh_bvhs_job)
+    {
+        BuildSubmeshBvhsContext& context = *static_cast<BuildSubmeshBvhsContext*>(data);
+
+        for (u32 i = begin; i < end; i++)
+        {
+            if (context.m_submeshes[i].m_bvh.is_empty())
+            {
+                build_mesh_bvh(context.m_submeshes[i].m_data, &context.m_submeshes[i].m_bvh);
+                context.m_stats[i] = analyze_bvh(context.m_submeshes[i].m_bvh);
+            }
         }
     }
 
@@ -383,6 +443,7 @@ namespace
 
         Mutex m_tex_mutex;
         HashSet<AssetId> m_tex_inflight;
+        HashMap<AssetId, PackedTextureLoadInfo> m_packed_texture_load_infos;  // Asset table entries plus the ones found in models
 
         // For async model loading
         Mutex m_model_mutex;
@@ -400,12 +461,20 @@ namespace
             AssetManager* manager;
             AssetId id;
         };
+
+        struct ModelTextureDecodeContext
+        {
+            AssetManager* m_manager = nullptr;
+            TextureAsset* m_textures = nullptr;
+            u8* m_is_decoded = nullptr;
+        };
     
         static void load_texture_asset_job(JobQueue* queue, void* data);
         static void load_model_asset_job(JobQueue* queue, void* data);
+        static void decode_model_textures_job(u32 begin, u32 end, void* data);
 
     public:
-        AssetManager() : BaseType(this) {}
+        AssetManager() : BaseType(this), m_packed_texture_load_infos(s_packed_texture_load_infos) {}
 
         // void load_texture_asset_async(const AssetId& id, bool flip_vertically);
 
@@ -419,6 +488,13 @@ namespace
     private:
         TextureLoadInfo get_texture_load_info(const AssetId& id) const;
         ModelLoadInfo get_model_load_info(const AssetId& id) const;
+        bool get_packed_texture_load_info(const AssetId& id, PackedTextureLoadInfo* out_info);
+
+        bool decode_texture_asset(const AssetId& id, TextureAsset* out_asset);
+        bool decode_texture(const AssetId& id, TextureAsset* out_asset) const;
+        bool cook_packed_texture(const PackedTextureLoadInfo& packed_info, TextureAsset* out_asset) const;
+
+        void group_model_textures(const ModelAsset& model);
     };
 
     void AssetManager::load_texture_asset_job(JobQueue*, void* data)
@@ -427,47 +503,21 @@ namespace
         AssetManager* manager = job->manager;
         const AssetId id   = job->id;
 
-        // Gather info (safe; pure read)
-        TextureLoadInfo load_info = manager->get_texture_load_info(id);
-
         stbi_set_flip_vertically_on_load_thread(job->flip_vertically ? 1 : 0);
 
-        s32 width = 0, height = 0, original_channels = 0;
-        u8* pixels = stbi_load(load_info.m_path, &width, &height,
-                                        &original_channels, load_info.m_request_channels);
-        if (!pixels)
+        // Build the asset off-thread, no locks held
+        TextureAsset asset{ id };
+        // asset.m_state         = AssetState::Loaded;
+
+        if (!manager->decode_texture_asset(id, &asset))
         {
-            zv_error("Failed to load texture file: {}", load_info.m_path);
             // Clear inflight so a future call can retry
             ScopedLock lock(manager->m_tex_mutex);
             manager->m_tex_inflight.erase(id);
             return;
         }
 
-        const u32 total_size = static_cast<u32>(width) *
-                               static_cast<u32>(height) *
-                               static_cast<u32>(load_info.m_request_channels);
-
-        if (original_channels != load_info.m_request_channels)
-        {
-            // TODO
-            // zv_warning("Original channels ({}) != request channels ({}) for texture {}",
-            //         original_channels, load_info.m_request_channels, load_info.m_path);
-        }
-
-        // Build the asset off-thread, no locks held
-        TextureAsset asset{};
-        // asset.m_state         = AssetState::Loaded;
-        asset.m_id            = id;
-        asset.m_width         = width;
-        asset.m_height        = height;
-        asset.m_num_channels  = load_info.m_request_channels;
-        asset.m_data          = make_unique_ptr<u8[]>(total_size);
-        asset.m_dimension     = TextureDimension::Texture2D;
-        asset.m_format        = load_info.m_format;
-
-        memcpy(asset.m_data.get(), pixels, total_size);
-        stbi_image_free(pixels);
+        cook_texture_asset(&asset);
 
         // Publish under the mutex
         {
@@ -619,9 +669,22 @@ namespace
 
         // Build the asset off-thread, no locks held
         ModelAsset asset{ id };
-        cgltf_parse_model_data(load_info, &cgltfData->scenes[0], &asset);
+        HashMap<AssetId, PackedTextureLoadInfo> packed_textures;
+        cgltf_parse_model_data(load_info, &cgltfData->scenes[0], &asset, &packed_textures);
         cgltf_free(cgltfData);
 
+        // Register the combined textures before the model is visible, so the renderer can request them right away
+        if (!packed_textures.empty())
+        {
+            ScopedLock lock(manager->m_tex_mutex);
+            manager->m_packed_texture_load_infos.insert(packed_textures.begin(), packed_textures.end());
+        }
+
+        if (load_info.m_group_textures)
+        {
+            manager->group_model_textures(asset);
+        }
+
         // Publish under the mutex
         {
             ScopedLock lock(manager->m_model_mutex);
@@ -689,6 +752,374 @@ namespace
         zv_assert_msg(s_model_load_infos.find(id) != s_model_load_infos.end(), "Model load info not found for asset id: {}", id.name().c_str());
         return s_model_load_infos[id];
     }
+
+    bool AssetManager::get_packed_texture_load_info(const AssetId& id, PackedTextureLoadInfo* out_info)
+    {
+        ScopedLock lock(m_tex_mutex);
+
+        auto it = m_packed_texture_load_infos.find(id);
+        if (it == m_packed_texture_load_infos.end())
+        {
+            return false;
+        }
+
+        *out_info = it->second;
+        return true;
+    }
+
+    bool AssetManager::decode_texture_asset(const AssetId& id, TextureAsset* out_asset)
+    {
+        out_asset->m_dimension = TextureDimension::Texture2D;
+
+        PackedTextureLoadInfo packed_info{};
+        const bool is_packed = get_packed_texture_load_info(id, &packed_info);
+
+        if (!(is_packed ? cook_packed_texture(packed_info, out_asset) : decode_texture(id, out_asset)))
+        {
+            return false;
+        }
+
+        if (out_asset->m_usage == TextureUsage::Auto)
+        {
+            out_asset->m_usage = out_asset->m_format == TextureFormat::SRGB ? TextureUsage::Color : TextureUsage::Data;
+        }
+
+        return true;
+    }
+
+    bool AssetManager::decode_texture(const AssetId& id, TextureAsset* out_asset) const
+    {
+        TextureLoadInfo load_info = get_texture_load_info(id);
+
+        s32 width = 0, height = 0, original_channels = 0;
+        u8* pixels = stbi_load(load_info.m_path, &width, &height,
+                                        &original_channels, load_info.m_request_channels);
+        if (!pixels)
+        {
+            zv_error("Failed to load texture file: {}", load_info.m_path);
+            return false;
+        }
+
+        const u32 total_size = static_cast<u32>(width) *
+                               static_cast<u32>(height) *
+                               static_cast<u32>(load_info.m_request_channels);
+
+        if (original_channels != load_info.m_request_channels)
+        {
+            // TODO
+            // zv_warning("Original channels ({}) != request channels ({}) for texture {}",
+            //         original_channels, load_info.m_request_channels, load_info.m_path);
+        }
+
+        out_asset->m_width         = width;
+        out_asset->m_height        = height;
+        out_asset->m_num_channels  = load_info.m_request_channels;
+        out_asset->m_data          = make_unique_ptr<u8[]>(total_size);
+        out_asset->m_format        = load_info.m_format;
+        out_asset->m_usage         = load_info.m_usage;
+
+        memcpy(out_asset->m_data.get(), pixels, total_size);
+        stbi_image_free(pixels);
+
+        return true;
+    }
+
+    bool AssetManager::cook_packed_texture(const PackedTextureLoadInfo& packed_info, TextureAsset* out_asset) const
+    {
+        const PackedTextureChannel* channels[k_orms_channel_count] = { &packed_info.m_occlusion, &packed_info.m_roughness, &packed_info.m_metalness, &packed_info.m_specular };
+
+        struct DecodedSource
+        {
+            AssetId m_id{};
+            u8* m_pixels = nullptr;
+            s32 m_width = 0;
+            s32 m_height = 0;
+            s32 m_num_channels = 0;
+        };
+
+        // Channels that share a source file (e.g. metalness and roughness) only decode it once
+        StaticArray<DecodedSource, k_orms_channel_count> sources = {};
+        StaticArray<TextureChannelSource, k_orms_channel_count> channel_sources = {};
+        u32 num_sources = 0;
+        bool is_valid = true;
+
+        for (u32 channel = 0; channel < k_orms_channel_count && is_valid; channel++)
+        {
+            const PackedTextureChannel& packed_channel = *channels[channel];
+            if (!packed_channel.m_source_id.is_valid())
+            {
+                continue;
+            }
+
+            DecodedSource* source = nullptr;
+            for (u32 i = 0; i < num_sources; i++)
+            {
+                if (sources[i].m_id == packed_channel.m_source_id)
+                {
+                    source = &sources[i];
+                }
+            }
+
+            if (!source)
+            {
+                const TextureLoadInfo load_info = get_texture_load_info(packed_channel.m_source_id);
+
+                source = &sources[num_sources++];
+                source->m_id = packed_channel.m_source_id;
+                source->m_num_channels = load_info.m_request_channels;
+
+                s32 original_channels = 0;
+                source->m_pixels = stbi_load(load_info.m_path, &source->m_width, &source->m_height, &original_channels, load_info.m_request_channels);
+                if (!source->m_pixels)
+                {
+                    zv_error("Failed to load texture file: {}", load_info.m_path);
+                    is_valid = false;
+                    break;
+                }
+
+                if (num_sources > 1 && (source->m_width != sources[0].m_width || source->m_height != sources[0].m_height))
+                {
+                    zv_warning("Packed texture source {} is {}x{}, resampling to {}x{}", load_info.m_path,
+                        source->m_width, source->m_height, sources[0].m_width, sources[0].m_height);
+                }
+            }
+
+            TextureChannelSource& channel_source = channel_sources[channel];
+            channel_source.m_data = source->m_pixels;
+            channel_source.m_width = static_cast<u32>(source->m_width);
+            channel_source.m_height = static_cast<u32>(source->m_height);
+            channel_source.m_num_channels = static_cast<u32>(source->m_num_channels);
+            channel_source.m_channel = packed_channel.m_source_channel;
+        }
+
+        if (is_valid && !cook_orms_texture(channel_sources.data(), out_asset))
+        {
+            zv_error("Packed texture {} has no source channels", out_asset->m_id.name().c_str());
+            is_valid = false;
+        }
+
+        for (u32 i = 0; i < num_sources; i++)
+        {
+            if (sources[i].m_pixels)
+            {
+                stbi_image_free(sources[i].m_pixels);
+            }
+        }
+
+        return is_valid;
+    }
+
+    void AssetManager::decode_model_textures_job(u32 begin, u32 end, void* data)
+    {
+        const ModelTextureDecodeContext& context = *static_cast<const ModelTextureDecodeContext*>(data);
+
+        // glTF images are stored top row first, whatever the last job on this thread asked for
+        stbi_set_flip_vertically_on_load_thread(0);
+
+        for (u32 i = begin; i < end; i++)
+        {
+            TextureAsset* texture = &context.m_textures[i];
+            if (!context.m_manager->decode_texture_asset(texture->m_id, texture))
+            {
+                continue;
+            }
+
+            // Cook right away, keeping every decoded image around would need gigabytes for larger scenes
+            if (ZV::max(texture->m_width, texture->m_height) > k_max_atlas_entry_size)
+            {
+                cook_texture_asset(texture);
+            }
+            context.m_is_decoded[i] = 1;
+        }
+    }
+
+    void AssetManager::group_model_textures(const ModelAsset& model)
+    {
+        DynamicArray<AssetId> texture_ids;
+        for (const SubmeshData& submesh : model.m_submeshes)
+        {
+            const MaterialInfo& info = submesh.m_material_info;
+            for (const AssetId& id : { info.m_albedo_texture_id, info.m_normal_texture_id, info.m_orms_texture_id, info.m_emissive_texture_id, info.m_overlay_texture_id })
+            {
+                if (id.is_valid() && std::find(texture_ids.begin(), texture_ids.end(), id) == texture_ids.end())
+                {
+                    texture_ids.push_back(id);
+                }
+            }
+        }
+
+        // Only group the textures nobody else has loaded or queued yet
+        {
+            ScopedLock lock(m_tex_mutex);
+
+            texture_ids.erase(std::remove_if(texture_ids.begin(), texture_ids.end(), [this](const AssetId& id)
+            {
+                return m_texture_assets.find(id) != m_texture_assets.end() || !m_tex_inflight.insert(id).second;
+            }), texture_ids.end());
+        }
+
+        // Textures are decoded in parallel, one per batch
+        DynamicArray<TextureAsset> decoded;
+        decoded.reserve(texture_ids.size());
+        for (const AssetId& id : texture_ids)
+        {
+            decoded.emplace_back(id);
+        }
+        DynamicArray<u8> is_decoded(texture_ids.size(), 0);
+
+        ModelTextureDecodeContext decode_context{};
+        decode_context.m_manager = this;
+        decode_context.m_textures = decoded.data();
+        decode_context.m_is_decoded = is_decoded.data();
+        Platform::parallel_for(static_cast<u32>(decoded.size()), 1, &decode_model_textures_job, &decode_context);
+
+        DynamicArray<TextureAsset> small_textures;
+        DynamicArray<TextureAsset> textures;
+        DynamicArray<TextureAsset> published;
+
+        for (size_t i = 0; i < decoded.size(); i++)
+        {
+            if (!is_decoded[i])
+            {
+                continue;
+            }
+
+            if (ZV::max(decoded[i].m_width, decoded[i].m_height) <= k_max_atlas_entry_size)
+            {
+                small_textures.emplace_back(move_ptr(decoded[i]));
+            }
+            else
+            {
+                textures.emplace_back(move_ptr(decoded[i]));
+            }
+        }
+
+        // Small textures of the same format go into atlases
+        u32 num_atlases = 0;
+        DynamicArray<bool> is_grouped(small_textures.size(), false);
+
+        for (size_t first = 0; first < small_textures.size(); first++)
+        {
+            if (is_grouped[first])
+            {
+                continue;
+            }
+
+            DynamicArray<size_t> members;
+            DynamicArray<const TextureAsset*> sources;
+            for (size_t i = first; i < small_textures.size(); i++)
+            {
+                if (!is_grouped[i] && can_share_atlas(small_textures[first], small_textures[i]))
+                {
+                    members.push_back(i);
+                    sources.push_back(&small_textures[i]);
+                }
+            }
+
+            if (members.size() < 2)
+            {
+                continue;
+            }
+
+            TextureAsset atlas{ make_texture_group_id(model.m_id, "atlas", num_atlases) };
+            DynamicArray<Vector4> uv_transforms(members.size());
+            MipGenerationSettings mip_settings = get_default_mip_settings(*sources[0]);
+            mip_settings.m_max_mip_levels = k_atlas_max_mip_levels;
+            if (!build_texture_atlas(sources.data(), static_cast<u32>(sources.size()), mip_settings, &atlas, uv_transforms.data()))
+            {
+                zv_warning("Textures of model {} do not fit into a {}x{} atlas", model.m_id.name().c_str(), k_atlas_max_size, k_atlas_max_size);
+                continue;
+            }
+
+            cook_texture_asset(&atlas, k_atlas_max_mip_levels);
+
+            for (size_t i = 0; i < members.size(); i++)
+            {
+                TextureAsset view = make_texture_view(small_textures[members[i]], atlas.m_id, 0, uv_transforms[i]);
+                view.m_compression = atlas.m_compression;
+                view.m_mip_levels = atlas.m_mip_levels;
+                published.emplace_back(move_ptr(view));
+                is_grouped[members[i]] = true;
+            }
+
+            published.emplace_back(move_ptr(atlas));
+            num_atlases++;
+        }
+
+        for (size_t i = 0; i < small_textures.size(); i++)
+        {
+            if (!is_grouped[i])
+            {
+                cook_texture_asset(&small_textures[i]);
+                textures.emplace_back(move_ptr(small_textures[i]));
+            }
+        }
+
+        // Everything else with a matching layout goes into texture arrays
+        u32 num_arrays = 0;
+        is_grouped.assign(textures.size(), false);
+
+        for (size_t first = 0; first < textures.size(); first++)
+        {
+            if (is_grouped[first])
+            {
+                continue;
+            }
+
+            DynamicArray<size_t> members;
+            DynamicArray<const TextureAsset*> sources;
+            u64 array_size = 0;
+            for (size_t i = first; i < textures.size() && members.size() < k_max_texture_array_slices; i++)
+            {
+                const u64 slice_size = textures[i].get_data_size();
+                if (!is_grouped[i] && can_share_array(textures[first], textures[i]) && array_size + slice_size <= k_max_texture_array_size)
+                {
+                    members.push_back(i);
+                    sources.push_back(&textures[i]);
+                    array_size += slice_size;
+                }
+            }
+
+            if (members.size() < 2)
+            {
+                is_grouped[first] = true;
+                published.emplace_back(move_ptr(textures[first]));
+                continue;
+            }
+
+            TextureAsset array{ make_texture_group_id(model.m_id, "array", num_arrays) };
+            build_texture_array(sources.data(), static_cast<u32>(sources.size()), &array);
+
+            for (size_t i = 0; i < members.size(); i++)
+            {
+                TextureAsset view = make_texture_view(textures[members[i]], array.m_id, static_cast<u32>(i), Vector4(1.0f, 1.0f, 0.0f, 0.0f));
+                view.m_compression = array.m_compression;
+                view.m_mip_levels = array.m_mip_levels;
+                published.emplace_back(move_ptr(view));
+                is_grouped[members[i]] = true;
+            }
+
+            published.emplace_back(move_ptr(array));
+            num_arrays++;
+        }
+
+        // Publish arrays, atlases and their members together, so a member never exists without its parent
+        ScopedLock lock(m_tex_mutex);
+
+        for (TextureAsset& texture : published)
+        {
+            const AssetId id = texture.m_id;
+            if (m_texture_assets.find(id) == m_texture_assets.end())
+            {
+                m_texture_assets.emplace(id, move_ptr(texture));
+            }
+        }
+
+        for (const AssetId& id : texture_ids)
+        {
+            m_tex_inflight.erase(id);
+        }
+    }
 }
 
 void Assets::initialize()
@@ -743,3 +1174,48 @@ ModelAsset* Assets::get_model_asset(const AssetId& id)
     zv_assert_msg(s_asset_manager != nullptr, "Asset manager not initialized!");
     return s_asset_manager->get_model_asset(id);
 }
+
+void set_submesh_world_transform(ModelAsset* model, SubmeshHandle handle, const Matrix& world_transform)
+{
+    zv_assert_msg(handle != SubmeshHandle::Invalid && (s32)handle < (s32)model->m_submeshes.size(), "Invalid submesh handle");
+
+    SubmeshData& submesh = model->m_submeshes[(s32)handle];
+    submesh.m_world_transform = world_transform;
+    submesh.m_world_bounds = transform_aabb(submesh.m_data.m_bounds, world_transform);
+    submesh.m_world_bounding_sphere = transform_bounding_sphere(submesh.m_data.m_bounding_sphere, world_transform);
+
+    for (const SubmeshHandle child : submesh.m_children)
+    {
+        // Row vectors, the local transform is applied first
+        set_submesh_world_transform(model, child, model->m_submeshes[(s32)child].m_local_transform * world_transform);
+    }
+}
+
+u32 add_model_to_scene_bvh(ModelAsset* model, SceneBvh* scene)
+{
+    // Only models that take part in raycasts pay for their triangle BVHs
+    BuildSubmeshBvhsContext context{};
+    context.m_submeshes = model->m_submeshes.data();
+    context.m_stats.resize(model->m_submeshes.size());
+    Platform::parallel_for(static_cast<u32>(model->m_submeshes.size()), 1, &build_submesh_bvhs_job, &context);
+
+    BvhStats total_stats{};
+    for (const BvhStats& stats : context.m_stats)
+    {
+        total_stats.add(stats);
+    }
+
+    if (total_stats.m_num_trees > 0)
+    {
+        zv_info("Built {} BVHs for {}: {} nodes, {:.2f} triangles per leaf, max depth {}, average SAH cost {:.1f}",
+                total_stats.m_num_trees, model->m_id.name().c_str(), total_stats.m_num_nodes,
+                total_stats.get_average_leaf_size(), total_stats.m_max_depth, total_stats.get_average_sah_cost());
+    }
+
+    const u32 first = static_cast<u32>(scene->m_instances.size());
+    for (const SubmeshData& submesh : model->m_submeshes)
+    {
+        add_scene_bvh_instance(scene, &submesh.m_bvh, &submesh.m_data, submesh.m_world_transform);
+    }
+    return first;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Geometry.h>
+#include <Bvh.h>
 #include <CoreDefs.h>
 #include <Utility.h>
 #include <MathLib.h>
@@ -108,6 +109,38 @@ enum class TextureFormat : u8
     Linear = 1,
 };
 
+enum class TextureUsage : u8
+{
+    Auto = 0,    // Color for SRGB textures, Data for linear ones
+    Color = 1,
+    Normal = 2,  // Tangent space normal, xyz stored as n * 0.5 + 0.5
+    Data = 3,    // Roughness, metalness, AO, specular, ...
+};
+
+enum class TextureCompression : u8
+{
+    None = 0,
+    BC1 = 1,  // RGB, 8 bytes per block
+    BC4 = 2,  // R, 8 bytes per block
+    BC5 = 3,  // RG, 16 bytes per block
+    BC7 = 4,  // RGBA, 16 bytes per block
+};
+
+constexpr u32 k_texture_row_pitch_alignment = 256;  // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+constexpr u32 k_texture_placement_alignment = 512;  // D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+
+// Placement of one subresource in upload-ready texture data, mirrors D3D12_PLACED_SUBRESOURCE_FOOTPRINT
+struct TextureFootprint
+{
+    u64 m_offset = 0;
+    u32 m_width = 0;      // Rounded up to whole 4x4 blocks for compressed textures
+    u32 m_height = 0;
+    u32 m_depth = 1;
+    u32 m_row_pitch = 0;
+    u32 m_num_rows = 0;   // Rows of texels, or rows of 4x4 blocks for compressed textures
+    u32 m_row_size = 0;   // Bytes of one row without the pitch padding
+};
+
 struct TextureAsset : public Asset
 {
     // struct Desc
@@ -120,13 +153,70 @@ struct TextureAsset : public Asset
     u32 m_width;
     u32 m_height;
     u32 m_num_channels;
-    UniquePtr<u8[]> m_data;
+    UniquePtr<u8[]> m_data;  // Tightly packed mip chain per array slice, mip 0 first, until converted to the upload layout
     TextureDimension m_dimension;
     TextureFormat m_format = TextureFormat::SRGB;
+    TextureUsage m_usage = TextureUsage::Color;
+    TextureCompression m_compression = TextureCompression::None;
     u16 m_mip_levels = 1;
     u16 m_depth = 1;       // Should be 1 for 1D or 2D textures
     u16 m_array_size = 1;  // For cubemap, this is a multiple of 6
 
+    // Set for textures that were grouped into a texture array or atlas at import, m_data is empty for those
+    AssetId m_parent_id{};
+    u32 m_array_slice = 0;
+    Vector4 m_uv_transform = {1.0f, 1.0f, 0.0f, 0.0f};  // xy scale, zw offset of the atlas region
+
+    // Set once m_data is laid out the way the GPU copies it, one footprint per subresource
+    DynamicArray<TextureFootprint> m_footprints;
+    u64 m_upload_size = 0;
+
+    bool is_view() const { return m_parent_id.is_valid(); }
+    bool has_upload_layout() const { return !m_footprints.empty(); }
+
+    bool is_block_compressed() const { return m_compression != TextureCompression::None; }
+    u32 get_bytes_per_block() const
+    {
+        switch (m_compression)
+        {
+            case TextureCompression::BC1:
+            case TextureCompression::BC4:
+                return 8;
+            case TextureCompression::BC5:
+            case TextureCompression::BC7:
+                return 16;
+            default:
+                return m_num_channels;
+        }
+    }
+    // There is no 3 channel 8 bit GPU format, RGB data is uploaded as RGBA
+    u32 get_upload_bytes_per_block() const { return !is_block_compressed() && m_num_channels == 3 ? 4 : get_bytes_per_block(); }
+    u32 get_subresource_count() const { return m_dimension == TextureDimension::Texture3D ? m_mip_levels : m_mip_levels * m_array_size; }
+
+    u32 get_mip_width(u32 mip) const { return ZV::max(m_width >> mip, 1u); }
+    u32 get_mip_height(u32 mip) const { return ZV::max(m_height >> mip, 1u); }
+    // Offsets and pitches below describe the tightly packed layout
+    // Rows of texels, or rows of 4x4 blocks for compressed textures
+    u32 get_mip_row_count(u32 mip) const { return is_block_compressed() ? (get_mip_height(mip) + 3) / 4 : get_mip_height(mip); }
+    size_t get_mip_pitch(u32 mip) const
+    {
+        const u32 width = is_block_compressed() ? (get_mip_width(mip) + 3) / 4 : get_mip_width(mip);
+        return static_cast<size_t>(width) * get_bytes_per_block();
+    }
+    size_t get_mip_size(u32 mip) const { return get_mip_pitch(mip) * get_mip_row_count(mip); }
+    size_t get_mip_offset(u32 mip) const
+    {
+        size_t offset = 0;
+        for (u32 i = 0; i < mip; i++)
+        {
+            offset += get_mip_size(i);
+        }
+        return offset;
+    }
+    size_t get_slice_size() const { return get_mip_offset(m_mip_levels); }
+    size_t get_subresource_offset(u32 slice, u32 mip) const { return get_slice_size() * slice + get_mip_offset(mip); }
+    size_t get_data_size() const { return has_upload_layout() ? static_cast<size_t>(m_upload_size) : get_slice_size() * m_array_size; }
+
     // TODO: Remove?
     DX12TextureData* m_texture_data = nullptr;
 
@@ -148,12 +238,10 @@ enum class MaterialTextureType : u32
 {
   Albedo = 0,
   Normal = 1,
-  MetallicRoughness = 2,
-  AO = 3,
-  Emissive = 4,
-  Specular = 5,
-  Overlay = 6,
-  NumTextureTypes = 7,
+  ORMS = 2,  // Occlusion, roughness, metalness and specular packed into one texture
+  Emissive = 3,
+  Overlay = 4,
+  NumTextureTypes = 5,
 };
 
 static constexpr u32 k_num_material_textures = static_cast<u32>(MaterialTextureType::NumTextureTypes);
@@ -163,6 +251,8 @@ enum class ChannelPacking : u8
   None = 0,
   Metalness = 1 << 0,  // Blue channel
   Roughness = 1 << 1,  // Green channel
+  Occlusion = 1 << 2,  // Red channel
+  Specular = 1 << 3,   // Alpha channel
 };
 using ChannelPackingFlags = BitFlags<ChannelPacking>;
 DEFINE_BITMASK_OPERATORS(ChannelPacking);
@@ -177,13 +267,11 @@ struct MaterialInfo
 {
     AssetId m_albedo_texture_id{};
     AssetId m_normal_texture_id{};
-    AssetId m_metallic_roughness_texture_id{};
-    AssetId m_ao_texture_id{};
+    AssetId m_orms_texture_id{};
     AssetId m_emissive_texture_id{};
-    AssetId m_specular_texture_id{};
     AssetId m_overlay_texture_id{};
 
-    // TODO: We should probably do this for each texture type; Create an array of texture infos???
+    // Which channels of the ORMS texture hold data, the others fall back to the constants below
     ChannelPackingFlags m_channel_packing{ ChannelPacking::None };
 
     Vector3 m_albedo_color = {1.0f, 1.0f, 1.0f};
@@ -197,10 +285,16 @@ struct MaterialInfo
 struct SubmeshData
 {
     MeshGeometryData m_data{};
+    MeshletData m_meshlets{};  // Clusters of m_data's LOD 0 for finer grained culling
+    Bvh m_bvh{};               // Triangles of m_data's LOD 0 for raycasts, built when the model joins a scene BVH
     Matrix m_local_transform{};
     Matrix m_world_transform{};
     MaterialInfo m_material_info{};
 
+    // m_data's bounds in world space, kept in sync by set_submesh_world_transform
+    AABB m_world_bounds{};
+    BoundingSphere m_world_bounding_sphere{};
+
     SubmeshHandle m_parent = SubmeshHandle::Invalid;
     DynamicArray<SubmeshHandle> m_children = {};
 };
@@ -213,6 +307,14 @@ struct ModelAsset : public Asset
     ModelAsset(const AssetId& id) : Asset(id, AssetType::Model) {}
 };
 
+// Updates the world transform and world bounds of a submesh, its children follow through their local transforms
+void set_submesh_world_transform(ModelAsset* model, SubmeshHandle handle, const Matrix& world_transform);
+
+// Adds an instance for every submesh at its world transform, submesh i becomes instance first + i. Returns first.
+// Builds the submesh BVHs that are still missing, so it must not run for the same model on two threads at once.
+// The model must outlive the scene BVH, which keeps pointing at the submeshes' BVHs and geometry.
+u32 add_model_to_scene_bvh(ModelAsset* model, SceneBvh* scene);
+
 // struct MeshAsset : public Asset
 // {
 //     // TODO: Check Frank Luna's implementation
@@ -0,0 +1,842 @@
+#include <Bvh.h>
+
+#include <Platform/Platform.h>
+#include <Platform/Jobs.h>
+
+#include <algorithm>
+
+namespace
+{
+    constexpr u32 k_bvh_subtree_size = 1024;    // Ranges at or below this are built by a single job
+    constexpr u32 k_bvh_bounds_batch_size = 4096;
+    constexpr u32 k_bvh_binning_batch_size = 16384;
+    constexpr f32 k_bvh_traversal_cost = 1.0f;  // Relative to testing one primitive
+
+    inline f32 get_axis(const Vector3& v, u32 axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    struct BvhBuildRange
+    {
+        u32 m_node = 0;
+        u32 m_begin = 0;
+        u32 m_end = 0;
+        u32 m_depth = 0;
+        AABB m_bounds{};
+        AABB m_centroid_bounds{};
+    };
+
+    struct BvhBin
+    {
+        AABB m_bounds{};
+        u32 m_count = 0;
+    };
+
+    // One row of bins per axis
+    using BvhBins = StaticArray<StaticArray<BvhBin, k_bvh_num_bins>, 3>;
+
+    // Partitioned by value rather than through indices, so every level streams through memory
+    struct BvhBuildPrimitive
+    {
+        AABB m_bounds{};
+        Vector3 m_centroid{};
+        u32 m_index = 0;
+    };
+
+    struct BvhBuildContext
+    {
+        const AABB* m_bounds = nullptr;
+        DynamicArray<BvhBuildPrimitive> m_primitives{};
+
+        DynamicArray<BvhBuildRange> m_subtrees{};
+        DynamicArray<DynamicArray<BvhNode>> m_subtree_nodes{};
+
+        // Binning of the range currently split by the serial upper levels, one set of bins per batch
+        const BvhBuildRange* m_binned_range = nullptr;
+        StaticArray<f32, 3> m_bin_scales{};
+        DynamicArray<BvhBins> m_batch_bins{};
+    };
+
+    inline u32 get_bin(f32 centroid, f32 min_centroid, f32 scale, u32 num_bins)
+    {
+        return ZV::min(static_cast<u32>((centroid - min_centroid) * scale), num_bins - 1);
+    }
+
+    void bin_primitives(const BvhBuildContext& context, u32 begin, u32 end, const Vector3& min_centroid, const StaticArray<f32, 3>& scales, u32 num_bins, BvhBins* bins)
+    {
+        for (u32 i = begin; i < end; i++)
+        {
+            const Vector3& centroid = context.m_primitives[i].m_centroid;
+            const AABB& bounds = context.m_primitives[i].m_bounds;
+            for (u32 axis = 0; axis < 3; axis++)
+            {
+                BvhBin& bin = (*bins)[axis][get_bin(get_axis(centroid, axis), get_axis(min_centroid, axis), scales[axis], num_bins)];
+                bin.m_bounds.add(bounds);
+                bin.m_count++;
+            }
+        }
+    }
+
+    PARALLEL_FOR_CALLBACK(bin_primitives_job)
+    {
+        BvhBuildContext& context = *static_cast<BvhBuildContext*>(data);
+        const BvhBuildRange& range = *context.m_binned_range;
+
+        BvhBins& bins = context.m_batch_bins[begin / k_bvh_binning_batch_size];
+        bins = {};
+        bin_primitives(context, range.m_begin + begin, range.m_begin + end, range.m_centroid_bounds.m_min, context.m_bin_scales, k_bvh_num_bins, &bins);
+    }
+
+    void bound_primitives(const BvhBuildContext& context, u32 begin, u32 end, BvhBuildRange* out_range)
+    {
+        out_range->m_bounds = {};
+        out_range->m_centroid_bounds = {};
+        for (u32 i = begin; i < end; i++)
+        {
+            out_range->m_bounds.add(context.m_primitives[i].m_bounds);
+            out_range->m_centroid_bounds.add(context.m_primitives[i].m_centroid);
+        }
+    }
+
+    // Picks the cheapest of the binned SAH splits and partitions the primitives around it. The children's bounds come
+    // out of the bins and the partition pass, so every level reads each primitive twice. With parallel set, large ranges
+    // are binned in batches through the context's batch bins, only the serial upper levels may do that.
+    // Returns false if the range is cheaper as a leaf.
+    bool split_range(BvhBuildContext* context, const BvhBuildRange& range, bool parallel, BvhBuildRange* out_left, BvhBuildRange* out_right)
+    {
+        const u32 count = range.m_end - range.m_begin;
+        if (count <= 1 || range.m_depth + 1 >= k_bvh_max_depth)
+        {
+            return false;
+        }
+
+        out_left->m_begin = range.m_begin;
+        out_left->m_depth = range.m_depth + 1;
+        out_right->m_end = range.m_end;
+        out_right->m_depth = range.m_depth + 1;
+
+        // Small ranges get a bin per primitive at most, most nodes are near the leaves and the sweeps would dominate
+        const u32 num_bins = ZV::min(k_bvh_num_bins, count);
+
+        StaticArray<f32, 3> scales{};
+        bool has_extent = false;
+        for (u32 axis = 0; axis < 3; axis++)
+        {
+            const f32 extent = get_axis(range.m_centroid_bounds.m_max, axis) - get_axis(range.m_centroid_bounds.m_min, axis);
+            scales[axis] = extent > 0.0f ? static_cast<f32>(num_bins) / extent : 0.0f;  // A flat axis puts everything in bin 0
+            has_extent |= extent > 0.0f;
+        }
+
+        if (!has_extent)
+        {
+            // All centroids coincide, no plane separates them. Halve the range so leaves stay small.
+            if (count <= k_bvh_max_leaf_size)
+            {
+                return false;
+            }
+            const u32 middle = range.m_begin + count / 2;
+            bound_primitives(*context, range.m_begin, middle, out_left);
+            bound_primitives(*context, middle, range.m_end, out_right);
+            out_left->m_end = middle;
+            out_right->m_begin = middle;
+            return true;
+        }
+
+        BvhBins bins{};
+        if (parallel && count > 2 * k_bvh_binning_batch_size)
+        {
+            context->m_binned_range = &range;
+            context->m_bin_scales = scales;
+            context->m_batch_bins.resize((count + k_bvh_binning_batch_size - 1) / k_bvh_binning_batch_size);
+            Platform::parallel_for(count, k_bvh_binning_batch_size, &bin_primitives_job, context);
+
+            for (const BvhBins& batch_bins : context->m_batch_bins)
+            {
+                for (u32 axis = 0; axis < 3; axis++)
+                {
+                    for (u32 bin = 0; bin < k_bvh_num_bins; bin++)
+                    {
+                        bins[axis][bin].m_bounds.add(batch_bins[axis][bin].m_bounds);
+                        bins[axis][bin].m_count += batch_bins[axis][bin].m_count;
+                    }
+                }
+            }
+        }
+        else
+        {
+            bin_primitives(*context, range.m_begin, range.m_end, range.m_centroid_bounds.m_min, scales, num_bins, &bins);
+        }
+
+        f32 best_cost = FLT_MAX;
+        u32 best_axis = 0;
+        u32 best_bin = 0;
+
+        for (u32 axis = 0; axis < 3; axis++)
+        {
+            if (scales[axis] == 0.0f)
+            {
+                continue;
+            }
+
+            // Sweep from the right to get the cost of every right side, then from the left to finish each candidate
+            StaticArray<f32, k_bvh_num_bins> right_costs{};
+            AABB right_bounds{};
+            u32 right_count = 0;
+            for (u32 bin = num_bins - 1; bin > 0; bin--)
+            {
+                right_bounds.add(bins[axis][bin].m_bounds);
+                right_count += bins[axis][bin].m_count;
+                right_costs[bin] = right_count ? right_bounds.get_half_area() * right_count : FLT_MAX;
+            }
+
+            AABB left_bounds{};
+            u32 left_count = 0;
+            for (u32 bin = 1; bin < num_bins; bin++)
+            {
+                left_bounds.add(bins[axis][bin - 1].m_bounds);
+                left_count += bins[axis][bin - 1].m_count;
+                if (left_count == 0 || right_costs[bin] == FLT_MAX)
+                {
+                    continue;
+                }
+
+                const f32 cost = left_bounds.get_half_area() * left_count + right_costs[bin];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_bin = bin;
+                }
+            }
+        }
+
+        // Costs relative to the parent's area, a leaf tests every primitive once
+        const f32 parent_area = range.m_bounds.get_half_area();
+        const f32 split_cost = k_bvh_traversal_cost * parent_area + best_cost;
+        const f32 leaf_cost = parent_area * count;
+        if (count <= k_bvh_max_leaf_size && split_cost >= leaf_cost)
+        {
+            return false;
+        }
+
+        out_left->m_bounds = {};
+        out_right->m_bounds = {};
+        for (u32 bin = 0; bin < num_bins; bin++)
+        {
+            (bin < best_bin ? out_left : out_right)->m_bounds.add(bins[best_axis][bin].m_bounds);
+        }
+
+        // Hoare partition that also bounds the centroids of both sides
+        const f32 min_centroid = get_axis(range.m_centroid_bounds.m_min, best_axis);
+        const f32 scale = scales[best_axis];
+        out_left->m_centroid_bounds = {};
+        out_right->m_centroid_bounds = {};
+
+        u32 left = range.m_begin;
+        u32 right = range.m_end;
+        while (left < right)
+        {
+            const Vector3& centroid = context->m_primitives[left].m_centroid;
+            if (get_bin(get_axis(centroid, best_axis), min_centroid, scale, num_bins) < best_bin)
+            {
+                out_left->m_centroid_bounds.add(centroid);
+                left++;
+            }
+            else
+            {
+                out_right->m_centroid_bounds.add(centroid);
+                std::swap(context->m_primitives[left], context->m_primitives[--right]);
+            }
+        }
+
+        out_left->m_end = left;
+        out_right->m_begin = left;
+        return true;
+    }
+
+    // Builds the subtree of the range depth first, the range's node must already exist
+    void build_subtree(BvhBuildContext* context, const BvhBuildRange& root, DynamicArray<BvhNode>* nodes)
+    {
+        DynamicArray<BvhBuildRange> stack{};
+        stack.push_back(root);
+
+        while (!stack.empty())
+        {
+            const BvhBuildRange range = stack.back();
+            stack.pop_back();
+
+            BvhBuildRange left{};
+            BvhBuildRange right{};
+            if (!split_range(context, range, false, &left, &right))
+            {
+                (*nodes)[range.m_node] = BvhNode{ range.m_bounds, range.m_begin, range.m_end - range.m_begin };
+                continue;
+            }
+
+            left.m_node = static_cast<u32>(nodes->size());
+            right.m_node = left.m_node + 1;
+            nodes->resize(nodes->size() + 2);
+            (*nodes)[range.m_node] = BvhNode{ range.m_bounds, left.m_node, 0 };
+
+            stack.push_back(right);
+            stack.push_back(left);
+        }
+    }
+
+    PARALLEL_FOR_CALLBACK(build_primitives_job)
+    {
+        BvhBuildContext& context = *static_cast<BvhBuildContext*>(data);
+
+        for (u32 i = begin; i < end; i++)
+        {
+            context.m_primitives[i] = BvhBuildPrimitive{ context.m_bounds[i], context.m_bounds[i].get_center(), i };
+        }
+    }
+
+    PARALLEL_FOR_CALLBACK(build_subtrees_job)
+    {
+        BvhBuildContext& context = *static_cast<BvhBuildContext*>(data);
+
+        for (u32 i = begin; i < end; i++)
+        {
+            // Built into a local array with the subtree root at 0, the stitching moves it to the reserved node
+            DynamicArray<BvhNode>& nodes = context.m_subtree_nodes[i];
+            nodes.resize(1);
+
+            BvhBuildRange root = context.m_subtrees[i];
+            root.m_node = 0;
+            build_subtree(&context, root, &nodes);
+        }
+    }
+
+    // Positions of LOD 0, tight when the streams are split
+    struct MeshPositions
+    {
+        const u8* m_first = nullptr;
+        size_t m_stride = 0;
+
+        const Vector3& operator[](size_t i) const { return *reinterpret_cast<const Vector3*>(m_first + i * m_stride); }
+    };
+
+    MeshPositions get_mesh_positions(const MeshGeometryData& geometry)
+    {
+        if (geometry.has_split_streams())
+        {
+            return { reinterpret_cast<const u8*>(geometry.m_positions.data()), sizeof(Vector3) };
+        }
+        return { reinterpret_cast<const u8*>(&geometry.m_vertices[0].position), sizeof(MeshVertex) };
+    }
+
+    AABB get_triangle_bounds(const MeshPositions& positions, const u16* indices)
+    {
+        AABB bounds{};
+        bounds.add(positions[indices[0]]);
+        bounds.add(positions[indices[1]]);
+        bounds.add(positions[indices[2]]);
+        return bounds;
+    }
+
+    struct TriangleBoundsContext
+    {
+        MeshPositions m_positions{};
+        const u16* m_indices = nullptr;
+        AABB* m_bounds = nullptr;
+    };
+
+    PARALLEL_FOR_CALLBACK(triangle_bounds_job)
+    {
+        TriangleBoundsContext& context = *static_cast<TriangleBoundsContext*>(data);
+
+        for (u32 i = begin; i < end; i++)
+        {
+            context.m_bounds[i] = get_triangle_bounds(context.m_positions, context.m_indices + 3 * i);
+        }
+    }
+
+    // Every subtree owns a contiguous range of m_primitives, its outermost leaves bound it
+    void get_subtree_primitives(const Bvh& bvh, u32 node_index, u32* out_begin, u32* out_end)
+    {
+        u32 first = node_index;
+        while (!bvh.m_nodes[first].is_leaf())
+        {
+            first = bvh.m_nodes[first].m_first;
+        }
+
+        u32 last = node_index;
+        while (!bvh.m_nodes[last].is_leaf())
+        {
+            last = bvh.m_nodes[last].m_first + 1;
+        }
+
+        *out_begin = bvh.m_nodes[first].m_first;
+        *out_end = bvh.m_nodes[last].m_first + bvh.m_nodes[last].m_count;
+    }
+
+    // Calls on_primitive for every primitive of a leaf whose bounds pass overlaps
+    template<typename Overlaps, typename OnPrimitive>
+    void query_bvh(const Bvh& bvh, const Overlaps& overlaps, const OnPrimitive& on_primitive)
+    {
+        if (bvh.is_empty())
+        {
+            return;
+        }
+
+        StaticArray<u32, k_bvh_max_depth + 1> stack{};
+        u32 stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const BvhNode& node = bvh.m_nodes[stack[--stack_size]];
+            if (!overlaps(node.m_bounds))
+            {
+                continue;
+            }
+
+            if (node.is_leaf())
+            {
+                for (u32 i = node.m_first; i < node.m_first + node.m_count; i++)
+                {
+                    on_primitive(bvh.m_primitives[i]);
+                }
+                continue;
+            }
+
+            stack[stack_size++] = node.m_first + 1;
+            stack[stack_size++] = node.m_first;
+        }
+    }
+
+    // Like query_bvh, subtrees fully inside the frustum hand out all their primitives without further tests
+    template<typename OnPrimitive>
+    void query_bvh_frustum(const Bvh& bvh, const Frustum& frustum, const OnPrimitive& on_primitive)
+    {
+        if (bvh.is_empty())
+        {
+            return;
+        }
+
+        StaticArray<u32, k_bvh_max_depth + 1> stack{};
+        u32 stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0)
+        {
+            const u32 node_index = stack[--stack_size];
+            const BvhNode& node = bvh.m_nodes[node_index];
+
+            const Containment containment = test_frustum_aabb(frustum, node.m_bounds);
+            if (containment == Containment::Outside)
+            {
+                continue;
+            }
+
+            if (containment == Containment::Inside || node.is_leaf())
+            {
+                u32 primitives_begin = 0;
+                u32 primitives_end = 0;
+                get_subtree_primitives(bvh, node_index, &primitives_begin, &primitives_end);
+                for (u32 i = primitives_begin; i < primitives_end; i++)
+                {
+                    on_primitive(bvh.m_primitives[i], containment == Containment::Inside);
+                }
+                continue;
+            }
+
+            stack[stack_size++] = node.m_first + 1;
+            stack[stack_size++] = node.m_first;
+        }
+    }
+
+    // Front to back traversal that visits the nearer child first. intersect_primitive tests a primitive and returns the
+    // closest distance so far, which shrinks the ray for the remaining nodes.
+    template<typename IntersectPrimitive>
+    void raycast_bvh(const Bvh& bvh, const Ray& ray, const IntersectPrimitive& intersect_primitive)
+    {
+        if (bvh.is_empty())
+        {
+            return;
+        }
+
+        Ray clipped_ray = ray;
+        const Vector3 inverse_direction(1.0f / ray.m_direction.x, 1.0f / ray.m_direction.y, 1.0f / ray.m_direction.z);
+
+        f32 distance = 0.0f;
+        if (!intersect_ray_aabb(clipped_ray, inverse_direction, bvh.m_nodes[0].m_bounds, &distance))
+        {
+            return;
+        }
+
+        StaticArray<u32, k_bvh_max_depth> stack{};
+        u32 stack_size = 0;
+        u32 node_index = 0;
+
+        for (;;)
+        {
+            const BvhNode& node = bvh.m_nodes[node_index];
+
+            if (node.is_leaf())
+            {
+                for (u32 i = node.m_first; i < node.m_first + node.m_count; i++)
+                {
+                    clipped_ray.m_max_distance = intersect_primitive(clipped_ray, bvh.m_primitives[i]);
+                }
+            }
+            else
+            {
+                f32 left_distance = 0.0f;
+                f32 right_distance = 0.0f;
+                const bool hit_left = intersect_ray_aabb(clipped_ray, inverse_direction, bvh.m_nodes[node.m_first].m_bounds, &left_distance);
+                const bool hit_right = intersect_ray_aabb(clipped_ray, inverse_direction, bvh.m_nodes[node.m_first + 1].m_bounds, &right_distance);
+
+                if (hit_left && hit_right)
+                {
+                    const bool left_first = left_distance <= right_distance;
+                    stack[stack_size++] = left_first ? node.m_first + 1 : node.m_first;
+                    node_index = left_first ? node.m_first : node.m_first + 1;
+                    continue;
+                }
+                if (hit_left || hit_right)
+                {
+                    node_index = hit_left ? node.m_first : node.m_first + 1;
+                    continue;
+                }
+            }
+
+            if (stack_size == 0)
+            {
+                break;
+            }
+            node_index = stack[--stack_size];
+        }
+    }
+}
+
+void build_bvh(const AABB* primitive_bounds, u32 num_primitives, Bvh* out_bvh)
+{
+    out_bvh->m_nodes.clear();
+    out_bvh->m_primitives.resize(num_primitives);
+    if (num_primitives == 0)
+    {
+        return;
+    }
+
+    BvhBuildContext context{};
+    context.m_bounds = primitive_bounds;
+    context.m_primitives.resize(num_primitives);
+    Platform::parallel_for(num_primitives, k_bvh_bounds_batch_size, &build_primitives_job, &context);
+
+    // Split the upper levels until every range is small enough for one job. Only a handful of levels are done this way
+    // and their binning runs in parallel batches.
+    DynamicArray<BvhNode>& nodes = out_bvh->m_nodes;
+    nodes.reserve(2 * num_primitives / k_bvh_max_leaf_size + 1);
+    nodes.resize(1);
+
+    BvhBuildRange root{ 0, 0, num_primitives, 0 };
+    bound_primitives(context, 0, num_primitives, &root);
+
+    DynamicArray<BvhBuildRange> pending{};
+    pending.push_back(root);
+    while (!pending.empty())
+    {
+        const BvhBuildRange range = pending.back();
+        pending.pop_back();
+
+        if (range.m_end - range.m_begin <= k_bvh_subtree_size)
+        {
+            context.m_subtrees.push_back(range);
+            continue;
+        }
+
+        BvhBuildRange left{};
+        BvhBuildRange right{};
+        if (!split_range(&context, range, true, &left, &right))
+        {
+            nodes[range.m_node] = BvhNode{ range.m_bounds, range.m_begin, range.m_end - range.m_begin };
+            continue;
+        }
+
+        left.m_node = static_cast<u32>(nodes.size());
+        right.m_node = left.m_node + 1;
+        nodes.resize(nodes.size() + 2);
+        nodes[range.m_node] = BvhNode{ range.m_bounds, left.m_node, 0 };
+
+        pending.push_back(right);
+        pending.push_back(left);
+    }
+
+    // The subtrees own disjoint primitive ranges, so they partition in place without synchronization
+    context.m_subtree_nodes.resize(context.m_subtrees.size());
+    Platform::parallel_for(static_cast<u32>(context.m_subtrees.size()), 1, &build_subtrees_job, &context);
+
+    // Stitch in subtree order: the local root replaces the reserved node, everything below it is appended
+    for (size_t i = 0; i < context.m_subtrees.size(); i++)
+    {
+        const DynamicArray<BvhNode>& subtree_nodes = context.m_subtree_nodes[i];
+        const u32 offset = static_cast<u32>(nodes.size()) - 1;  // Local node 1 lands at nodes.size()
+
+        for (size_t local = 0; local < subtree_nodes.size(); local++)
+        {
+            BvhNode node = subtree_nodes[local];
+            if (!node.is_leaf())
+            {
+                node.m_first += offset;
+            }
+
+            if (local == 0)
+            {
+                nodes[context.m_subtrees[i].m_node] = node;
+            }
+            else
+            {
+                nodes.push_back(node);
+            }
+        }
+    }
+
+    for (u32 i = 0; i < num_primitives; i++)
+    {
+        out_bvh->m_primitives[i] = context.m_primitives[i].m_index;
+    }
+}
+
+void refit_bvh(Bvh* bvh, const AABB* primitive_bounds)
+{
+    // Children are stored after their parent, walking backwards refits them first
+    for (size_t i = bvh->m_nodes.size(); i-- > 0;)
+    {
+        BvhNode& node = bvh->m_nodes[i];
+        AABB bounds{};
+        if (node.is_leaf())
+        {
+            for (u32 j = node.m_first; j < node.m_first + node.m_count; j++)
+            {
+                bounds.add(primitive_bounds[bvh->m_primitives[j]]);
+            }
+        }
+        else
+        {
+            bounds.add(bvh->m_nodes[node.m_first].m_bounds);
+            bounds.add(bvh->m_nodes[node.m_first + 1].m_bounds);
+        }
+        node.m_bounds = bounds;
+    }
+}
+
+BvhStats analyze_bvh(const Bvh& bvh)
+{
+    BvhStats stats{};
+    if (bvh.is_empty())
+    {
+        return stats;
+    }
+
+    stats.m_num_trees = 1;
+    stats.m_num_nodes = static_cast<u32>(bvh.m_nodes.size());
+    stats.m_num_primitives = static_cast<u32>(bvh.m_primitives.size());
+
+    // Depths follow from the parents, which always come first
+    DynamicArray<u32> depths(bvh.m_nodes.size(), 0);
+    const f32 root_area = bvh.m_nodes[0].m_bounds.get_half_area();
+    for (size_t i = 0; i < bvh.m_nodes.size(); i++)
+    {
+        const BvhNode& node = bvh.m_nodes[i];
+        const f64 area_ratio = root_area > 0.0f ? node.m_bounds.get_half_area() / root_area : 1.0;
+        stats.m_max_depth = ZV::max(stats.m_max_depth, depths[i]);
+
+        if (node.is_leaf())
+        {
+            stats.m_num_leaves++;
+            stats.m_sah_cost_sum += area_ratio * node.m_count;
+        }
+        else
+        {
+            stats.m_sah_cost_sum += area_ratio * k_bvh_traversal_cost;
+            depths[node.m_first] = depths[i] + 1;
+            depths[node.m_first + 1] = depths[i] + 1;
+        }
+    }
+    return stats;
+}
+
+void build_mesh_bvh(const MeshGeometryData& geometry, Bvh* out_bvh)
+{
+    const u32 num_triangles = static_cast<u32>(geometry.m_indices.size() / 3);
+    if (num_triangles == 0 || geometry.m_vertices.empty())
+    {
+        out_bvh->m_nodes.clear();
+        out_bvh->m_primitives.clear();
+        return;
+    }
+
+    DynamicArray<AABB> triangle_bounds(num_triangles);
+
+    TriangleBoundsContext context{};
+    context.m_positions = get_mesh_positions(geometry);
+    context.m_indices = geometry.m_indices.data();
+    context.m_bounds = triangle_bounds.data();
+    Platform::parallel_for(num_triangles, k_bvh_bounds_batch_size, &triangle_bounds_job, &context);
+
+    build_bvh(triangle_bounds.data(), num_triangles, out_bvh);
+}
+
+bool raycast_mesh_bvh(const Bvh& bvh, const MeshGeometryData& geometry, const Ray& ray, RayHit* in_out_hit)
+{
+    if (bvh.is_empty())
+    {
+        return false;
+    }
+
+    const MeshPositions positions = get_mesh_positions(geometry);
+    const u16* indices = geometry.m_indices.data();
+
+    Ray clipped_ray = ray;
+    clipped_ray.m_max_distance = ZV::min(ray.m_max_distance, in_out_hit->m_distance);
+
+    bool hit = false;
+    raycast_bvh(bvh, clipped_ray, [&](const Ray& current_ray, u32 triangle)
+    {
+        const u16* triangle_indices = indices + 3 * triangle;
+        f32 distance = 0.0f;
+        f32 u = 0.0f;
+        f32 v = 0.0f;
+        if (intersect_ray_triangle(current_ray, positions[triangle_indices[0]], positions[triangle_indices[1]], positions[triangle_indices[2]], &distance, &u, &v) &&
+            distance < in_out_hit->m_distance)
+        {
+            in_out_hit->m_distance = distance;
+            in_out_hit->m_triangle = triangle;
+            in_out_hit->m_u = u;
+            in_out_hit->m_v = v;
+            hit = true;
+            return distance;
+        }
+        return current_ray.m_max_distance;
+    });
+    return hit;
+}
+
+void query_mesh_bvh(const Bvh& bvh, const MeshGeometryData& geometry, const AABB& aabb, DynamicArray<u32>* out_triangles)
+{
+    if (bvh.is_empty())
+    {
+        return;
+    }
+
+    const MeshPositions positions = get_mesh_positions(geometry);
+    const u16* indices = geometry.m_indices.data();
+
+    query_bvh(bvh,
+        [&](const AABB& bounds) { return bounds.intersects(aabb); },
+        [&](u32 triangle)
+        {
+            if (get_triangle_bounds(positions, indices + 3 * triangle).intersects(aabb))
+            {
+                out_triangles->push_back(triangle);
+            }
+        });
+}
+
+void query_mesh_bvh(const Bvh& bvh, const MeshGeometryData& geometry, const Frustum& frustum, DynamicArray<u32>* out_triangles)
+{
+    if (bvh.is_empty())
+    {
+        return;
+    }
+
+    const MeshPositions positions = get_mesh_positions(geometry);
+    const u16* indices = geometry.m_indices.data();
+
+    query_bvh_frustum(bvh, frustum, [&](u32 triangle, bool inside)
+    {
+        if (inside || test_frustum_aabb(frustum, get_triangle_bounds(positions, indices + 3 * triangle)) != Containment::Outside)
+        {
+            out_triangles->push_back(triangle);
+        }
+    });
+}
+
+u32 add_scene_bvh_instance(SceneBvh* scene, const Bvh* mesh_bvh, const MeshGeometryData* geometry, const Matrix& world_transform)
+{
+    zv_assert_msg(mesh_bvh != nullptr && geometry != nullptr, "Scene BVH instances need a mesh BVH and its geometry");
+
+    const u32 instance = static_cast<u32>(scene->m_instances.size());
+    scene->m_instances.push_back(SceneBvhInstance{ mesh_bvh, geometry });
+    scene->m_world_bounds.emplace_back();
+    set_scene_bvh_instance_transform(scene, instance, world_transform);
+    return instance;
+}
+
+void set_scene_bvh_instance_transform(SceneBvh* scene, u32 instance, const Matrix& world_transform)
+{
+    zv_assert_msg(instance < scene->m_instances.size(), "Invalid scene BVH instance {}", instance);
+
+    SceneBvhInstance& scene_instance = scene->m_instances[instance];
+    scene_instance.m_world_transform = world_transform;
+    scene_instance.m_inverse_world_transform = world_transform.Invert();
+
+    // The root bounds what the mesh queries can hit, an empty mesh keeps invalid bounds and is never found
+    const Bvh& mesh_bvh = *scene_instance.m_mesh_bvh;
+    scene->m_world_bounds[instance] = mesh_bvh.is_empty() ? AABB{} : transform_aabb(mesh_bvh.m_nodes[0].m_bounds, world_transform);
+}
+
+void build_scene_bvh(SceneBvh* scene)
+{
+    build_bvh(scene->m_world_bounds.data(), static_cast<u32>(scene->m_world_bounds.size()), &scene->m_bvh);
+}
+
+void refit_scene_bvh(SceneBvh* scene)
+{
+    refit_bvh(&scene->m_bvh, scene->m_world_bounds.data());
+}
+
+bool raycast_scene_bvh(const SceneBvh& scene, const Ray& ray, RayHit* in_out_hit)
+{
+    Ray clipped_ray = ray;
+    clipped_ray.m_max_distance = ZV::min(ray.m_max_distance, in_out_hit->m_distance);
+
+    bool hit = false;
+    raycast_bvh(scene.m_bvh, clipped_ray, [&](const Ray& current_ray, u32 instance)
+    {
+        const SceneBvhInstance& scene_instance = scene.m_instances[instance];
+
+        // An affine transform keeps the ray's parametrization, distances in mesh space are world space distances
+        Ray mesh_ray{};
+        mesh_ray.m_origin = Vector3::Transform(current_ray.m_origin, scene_instance.m_inverse_world_transform);
+        mesh_ray.m_direction = Vector3::TransformNormal(current_ray.m_direction, scene_instance.m_inverse_world_transform);
+        mesh_ray.m_max_distance = current_ray.m_max_distance;
+
+        if (raycast_mesh_bvh(*scene_instance.m_mesh_bvh, *scene_instance.m_geometry, mesh_ray, in_out_hit))
+        {
+            in_out_hit->m_instance = instance;
+            hit = true;
+            return in_out_hit->m_distance;
+        }
+        return current_ray.m_max_distance;
+    });
+    return hit;
+}
+
+void query_scene_bvh(const SceneBvh& scene, const AABB& aabb, DynamicArray<u32>* out_instances)
+{
+    query_bvh(scene.m_bvh,
+        [&](const AABB& bounds) { return bounds.intersects(aabb); },
+        [&](u32 instance)
+        {
+            if (scene.m_world_bounds[instance].intersects(aabb))
+            {
+                out_instances->push_back(instance);
+            }
+        });
+}
+
+void query_scene_bvh(const SceneBvh& scene, const Frustum& frustum, DynamicArray<u32>* out_instances)
+{
+    query_bvh_frustum(scene.m_bvh, frustum, [&](u32 instance, bool inside)
+    {
+        if (inside || test_frustum_aabb(frustum, scene.m_world_bounds[instance]) != Containment::Outside)
+        {
+            out_instances->push_back(instance);
+        }
+    });
+}
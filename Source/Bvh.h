@@ -0,0 +1,116 @@
+#pragma once
+
+#include <CoreDefs.h>
+#include <Geometry.h>
+
+constexpr u32 k_bvh_max_leaf_size = 4;   // Leaves hold at most this many primitives unless k_bvh_max_depth forces a bigger one
+constexpr u32 k_bvh_num_bins = 16;       // Split candidates per axis of the binned SAH build
+constexpr u32 k_bvh_max_depth = 64;      // Bounds the traversal stacks
+constexpr u32 k_bvh_invalid_index = ~0u;
+
+// Inner nodes (m_count == 0) have their children at m_first and m_first + 1, leaves own the m_count primitives starting at
+// m_first in Bvh::m_primitives. Children are always stored after their parent.
+struct BvhNode
+{
+    AABB m_bounds{};
+    u32 m_first = 0;
+    u32 m_count = 0;
+
+    bool is_leaf() const { return m_count > 0; }
+};
+
+struct Bvh
+{
+    DynamicArray<BvhNode> m_nodes{};   // Root first
+    DynamicArray<u32> m_primitives{};  // Primitive indices in leaf order, every subtree owns a contiguous range
+
+    bool is_empty() const { return m_nodes.empty(); }
+};
+
+struct BvhStats
+{
+    u32 m_num_trees = 0;
+    u32 m_num_nodes = 0;
+    u32 m_num_leaves = 0;
+    u32 m_num_primitives = 0;
+    u32 m_max_depth = 0;
+    f64 m_sah_cost_sum = 0.0;  // Expected primitive and node tests of a random ray through the root, summed over the trees
+
+    f32 get_average_sah_cost() const { return m_num_trees ? static_cast<f32>(m_sah_cost_sum / m_num_trees) : 0.0f; }
+    f32 get_average_leaf_size() const { return m_num_leaves ? static_cast<f32>(m_num_primitives) / m_num_leaves : 0.0f; }
+
+    void add(const BvhStats& other)
+    {
+        m_num_trees += other.m_num_trees;
+        m_num_nodes += other.m_num_nodes;
+        m_num_leaves += other.m_num_leaves;
+        m_num_primitives += other.m_num_primitives;
+        m_max_depth = ZV::max(m_max_depth, other.m_max_depth);
+        m_sah_cost_sum += other.m_sah_cost_sum;
+    }
+};
+
+struct RayHit
+{
+    f32 m_distance = FLT_MAX;                 // Along the ray's direction, hits further away are not reported
+    u32 m_triangle = k_bvh_invalid_index;     // The triangle's indices start at 3 * m_triangle
+    u32 m_instance = k_bvh_invalid_index;     // Scene queries only
+    f32 m_u = 0.0f;                           // Barycentrics of the triangle's second and third vertex
+    f32 m_v = 0.0f;
+
+    bool is_valid() const { return m_triangle != k_bvh_invalid_index; }
+};
+
+// Binned SAH build (Wald, "On fast Construction of SAH-based Bounding Volume Hierarchies") over arbitrary primitive bounds.
+// The upper levels are split serially until the ranges are small enough, the remaining subtrees are built in parallel and
+// stitched together in a fixed order, so the result does not depend on the thread count.
+void build_bvh(const AABB* primitive_bounds, u32 num_primitives, Bvh* out_bvh);
+
+// Recomputes the node bounds bottom up after primitives moved, the topology stays. Much cheaper than a rebuild but the
+// tree degrades when primitives move far from where they were built.
+void refit_bvh(Bvh* bvh, const AABB* primitive_bounds);
+
+BvhStats analyze_bvh(const Bvh& bvh);
+
+// Triangle BVH over LOD 0, reads m_positions when the streams are split
+void build_mesh_bvh(const MeshGeometryData& geometry, Bvh* out_bvh);
+
+// Closest hit nearer than in_out_hit->m_distance, ray in mesh space. Returns true if in_out_hit was updated.
+bool raycast_mesh_bvh(const Bvh& bvh, const MeshGeometryData& geometry, const Ray& ray, RayHit* in_out_hit);
+
+// Append the triangles whose bounds overlap the box or are not outside the frustum, so both are conservative
+void query_mesh_bvh(const Bvh& bvh, const MeshGeometryData& geometry, const AABB& aabb, DynamicArray<u32>* out_triangles);
+void query_mesh_bvh(const Bvh& bvh, const MeshGeometryData& geometry, const Frustum& frustum, DynamicArray<u32>* out_triangles);
+
+struct SceneBvhInstance
+{
+    const Bvh* m_mesh_bvh = nullptr;
+    const MeshGeometryData* m_geometry = nullptr;
+    Matrix m_world_transform{};
+    Matrix m_inverse_world_transform{};
+};
+
+// Top level BVH over mesh instances, which keep pointing at their mesh's BVH and geometry. Moving an instance only updates
+// its world bounds, refit_scene_bvh or build_scene_bvh bring the tree up to date. Instances added since the last build are
+// not found by queries.
+struct SceneBvh
+{
+    DynamicArray<SceneBvhInstance> m_instances{};
+    DynamicArray<AABB> m_world_bounds{};  // Per instance, separate so builds and refits read them tightly
+    Bvh m_bvh{};
+};
+
+// Returns the instance index that queries report
+u32 add_scene_bvh_instance(SceneBvh* scene, const Bvh* mesh_bvh, const MeshGeometryData* geometry, const Matrix& world_transform);
+void set_scene_bvh_instance_transform(SceneBvh* scene, u32 instance, const Matrix& world_transform);
+
+void build_scene_bvh(SceneBvh* scene);
+void refit_scene_bvh(SceneBvh* scene);
+
+// Closest hit nearer than in_out_hit->m_distance, world space ray. Instances are tested with the ray moved into mesh space,
+// which keeps its parametrization, so distances are always along the world space ray.
+bool raycast_scene_bvh(const SceneBvh& scene, const Ray& ray, RayHit* in_out_hit);
+
+// Append the instances whose world bounds overlap the box or are not outside the frustum
+void query_scene_bvh(const SceneBvh& scene, const AABB& aabb, DynamicArray<u32>* out_instances);
+void query_scene_bvh(const SceneBvh& scene, const Frustum& frustum, DynamicArray<u32>* out_instances);
@@ -0,0 +1,69 @@
+#include <ConstantTable.h>
+
+#include <Log.h>
+#include <MathLib.h>
+
+ConstantTableEntries::ConstantTableEntries(u32 entry_size, u32 capacity)
+    : m_entry_size(entry_size)
+    , m_capacity(ZV::max(capacity, 1u))
+{
+    m_counted_frames.resize(m_capacity, 0);
+}
+
+u32 ConstantTableEntries::acquire_entry()
+{
+    if (!m_free_entries.empty())
+    {
+        const u32 entry = m_free_entries.back();
+        m_free_entries.pop_back();
+        m_counted_frames[entry] = 0;
+        return entry;
+    }
+
+    if (m_num_entries == m_capacity)
+    {
+        m_capacity *= 2;
+        m_counted_frames.resize(m_capacity, 0);
+    }
+
+    return m_num_entries++;
+}
+
+void ConstantTableEntries::release_entry(u32 entry)
+{
+    zv_assert_msg(entry < m_num_entries, "Constant table entry {} out of range {}", entry, m_num_entries);
+    m_free_entries.push_back(entry);
+}
+
+void ConstantTableEntries::begin_frame()
+{
+    m_stats_frame++;
+}
+
+bool ConstantTableEntries::update(u32 entry, u32 frame_index, u8* dirty_frames, ConstantUploadStats* stats)
+{
+    zv_assert_msg(entry < m_num_entries, "Constant table entry {} out of range {}", entry, m_num_entries);
+
+    const u8 frame_bit = static_cast<u8>(1 << frame_index);
+    const bool is_uploaded = (*dirty_frames & frame_bit) != 0;
+    *dirty_frames &= ~frame_bit;
+
+    // Materials are updated once per object drawing them, only the first update of a frame says whether the entry was written
+    if (stats && m_counted_frames[entry] != m_stats_frame)
+    {
+        m_counted_frames[entry] = m_stats_frame;
+
+        if (is_uploaded)
+        {
+            stats->m_num_uploaded++;
+            stats->m_uploaded_bytes += m_entry_size;
+        }
+        else
+        {
+            stats->m_num_skipped++;
+            stats->m_skipped_bytes += m_entry_size;
+        }
+    }
+
+    return is_uploaded;
+}
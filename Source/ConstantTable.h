@@ -0,0 +1,44 @@
+#pragma once
+
+#include <CoreDefs.h>
+
+struct ConstantUploadStats
+{
+    u32 m_num_uploaded = 0;
+    u32 m_num_skipped = 0;
+    u64 m_uploaded_bytes = 0;
+    u64 m_skipped_bytes = 0;
+};
+
+// Entry bookkeeping of a constant table: which entries are in use, and whether an update has to write the current
+// frame's copy of an entry. Every frame in flight keeps its own copy, the owner tracks which copies are stale in a
+// dirty frame mask per entry, bit i for frame index i. Only the entries live here, the owner maps them to memory, so the
+// logic doesn't need a device.
+class ConstantTableEntries
+{
+public:
+    ConstantTableEntries(u32 entry_size, u32 capacity);
+
+    // Doubles the capacity when every entry is taken, the owner has to grow its memory to match
+    u32 acquire_entry();
+    void release_entry(u32 entry);
+
+    // Starts counting the entries' stats anew, call once per frame before the updates
+    void begin_frame();
+
+    // True when frame_index's bit is set in dirty_frames, the bit is cleared and the caller has to write the entry.
+    // stats is optional, an entry updated several times in a frame is only counted the first time.
+    bool update(u32 entry, u32 frame_index, u8* dirty_frames, ConstantUploadStats* stats = nullptr);
+
+    u32 get_entry_size() const { return m_entry_size; }
+    u32 get_capacity() const { return m_capacity; }
+    u32 get_num_entries() const { return m_num_entries; }
+
+private:
+    u32 m_entry_size = 0;
+    u32 m_capacity = 0;
+    u32 m_num_entries = 0;
+    DynamicArray<u32> m_free_entries{};
+    u32 m_stats_frame = 1;
+    DynamicArray<u32> m_counted_frames{};  // Per entry, the m_stats_frame it was last counted in
+};
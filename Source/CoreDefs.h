@@ -77,6 +77,9 @@ using UniquePtr = std::unique_ptr<T, Deleter>;
 template <typename T>
 using SharedPtr = std::shared_ptr<T>;
 
+template <typename T>
+using WeakPtr = std::weak_ptr<T>;
+
 template <typename T, typename... Args>
 UniquePtr<T> make_unique_ptr(Args &&...args)
 {
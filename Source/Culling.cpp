@@ -0,0 +1,179 @@
+#include <Culling.h>
+
+#include <Platform/Platform.h>
+#include <Platform/Jobs.h>
+
+#include <cfloat>
+
+#if ZV_ARCH_X64
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // Half extents of padding and invalid boxes, any plane sees them at -inf
+    constexpr f32 k_culling_invisible_extent = -FLT_MAX;
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Float4 helpers, one box per lane
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+#if ZV_ARCH_X64
+    using Float4 = __m128;
+
+    inline Float4 f4_splat(f32 value) { return _mm_set1_ps(value); }
+    inline Float4 f4_load(const f32* src) { return _mm_loadu_ps(src); }
+    inline Float4 f4_add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 f4_mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    // One bit per lane, set where a < 0
+    inline u32 f4_negative_mask(Float4 a) { return static_cast<u32>(_mm_movemask_ps(_mm_cmplt_ps(a, _mm_setzero_ps()))); }
+#else
+    struct Float4 { f32 v[4]; };
+
+    inline Float4 f4_splat(f32 value) { return Float4{ { value, value, value, value } }; }
+    inline Float4 f4_load(const f32* src) { return Float4{ { src[0], src[1], src[2], src[3] } }; }
+    inline Float4 f4_add(Float4 a, Float4 b) { return Float4{ { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+    inline Float4 f4_mul(Float4 a, Float4 b) { return Float4{ { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+    inline u32 f4_negative_mask(Float4 a)
+    {
+        return (a.v[0] < 0.0f ? 1u : 0u) | (a.v[1] < 0.0f ? 2u : 0u) | (a.v[2] < 0.0f ? 4u : 0u) | (a.v[3] < 0.0f ? 8u : 0u);
+    }
+#endif
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Frustum culling
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    // Plane coefficients splatted once per frame instead of once per group of boxes
+    struct CullingPlane
+    {
+        Float4 m_x, m_y, m_z, m_w;
+        Float4 m_abs_x, m_abs_y, m_abs_z;
+    };
+
+    struct CullFrustumContext
+    {
+        StaticArray<CullingPlane, Frustum::Plane::Count> m_planes{};
+        const CullingBounds* m_bounds = nullptr;
+        u32* m_visible = nullptr;           // Every batch writes from its first box on
+        DynamicArray<u32> m_batch_counts{};
+    };
+
+    PARALLEL_FOR_CALLBACK(cull_frustum_job)
+    {
+        CullFrustumContext& context = *static_cast<CullFrustumContext*>(data);
+        const CullingBounds& bounds = *context.m_bounds;
+
+        // Whole groups, the padding boxes are outside every frustum
+        const u32 padded_end = (end + k_culling_simd_width - 1) / k_culling_simd_width * k_culling_simd_width;
+        u32* visible = context.m_visible + begin;
+        u32 num_visible = 0;
+
+        for (u32 i = begin; i < padded_end; i += k_culling_simd_width)
+        {
+            const Float4 center_x = f4_load(&bounds.m_center_x[i]);
+            const Float4 center_y = f4_load(&bounds.m_center_y[i]);
+            const Float4 center_z = f4_load(&bounds.m_center_z[i]);
+            const Float4 extent_x = f4_load(&bounds.m_extent_x[i]);
+            const Float4 extent_y = f4_load(&bounds.m_extent_y[i]);
+            const Float4 extent_z = f4_load(&bounds.m_extent_z[i]);
+
+            // Outside as soon as the box is behind any plane, the same sums in the same order as test_frustum_aabb
+            u32 outside = 0;
+            for (const CullingPlane& plane : context.m_planes)
+            {
+                const Float4 distance = f4_add(f4_add(f4_add(f4_mul(plane.m_x, center_x), f4_mul(plane.m_y, center_y)), f4_mul(plane.m_z, center_z)), plane.m_w);
+                const Float4 radius = f4_add(f4_add(f4_mul(plane.m_abs_x, extent_x), f4_mul(plane.m_abs_y, extent_y)), f4_mul(plane.m_abs_z, extent_z));
+                outside |= f4_negative_mask(f4_add(distance, radius));
+            }
+
+            // Branch free compaction, every lane is written and only the visible ones are kept
+            for (u32 lane = 0; lane < k_culling_simd_width; lane++)
+            {
+                visible[num_visible] = i + lane;
+                num_visible += ((outside >> lane) & 1) ^ 1;
+            }
+        }
+
+        context.m_batch_counts[begin / k_culling_batch_size] = num_visible;
+    }
+}
+
+void CullingBounds::resize(u32 count)
+{
+    const size_t padded_count = (count + k_culling_simd_width - 1) / k_culling_simd_width * k_culling_simd_width;
+
+    m_center_x.resize(padded_count, 0.0f);
+    m_center_y.resize(padded_count, 0.0f);
+    m_center_z.resize(padded_count, 0.0f);
+    m_extent_x.resize(padded_count, k_culling_invisible_extent);
+    m_extent_y.resize(padded_count, k_culling_invisible_extent);
+    m_extent_z.resize(padded_count, k_culling_invisible_extent);
+
+    // A shrink leaves old boxes in what is now padding
+    for (size_t i = count; i < padded_count; i++)
+    {
+        m_center_x[i] = m_center_y[i] = m_center_z[i] = 0.0f;
+        m_extent_x[i] = m_extent_y[i] = m_extent_z[i] = k_culling_invisible_extent;
+    }
+
+    m_count = count;
+}
+
+void CullingBounds::set(u32 index, const AABB& aabb)
+{
+    zv_assert_msg(index < m_count, "Culling bounds index {} out of range {}", index, m_count);
+
+    if (!aabb.is_valid())
+    {
+        m_center_x[index] = m_center_y[index] = m_center_z[index] = 0.0f;
+        m_extent_x[index] = m_extent_y[index] = m_extent_z[index] = k_culling_invisible_extent;
+        return;
+    }
+
+    const Vector3 center = aabb.get_center();
+    const Vector3 extents = aabb.get_extents();
+    m_center_x[index] = center.x;
+    m_center_y[index] = center.y;
+    m_center_z[index] = center.z;
+    m_extent_x[index] = extents.x;
+    m_extent_y[index] = extents.y;
+    m_extent_z[index] = extents.z;
+}
+
+void cull_frustum(const Frustum& frustum, const CullingBounds& bounds, DynamicArray<u32>* out_visible, CullingStats* out_stats)
+{
+    static_assert(k_culling_batch_size % k_culling_simd_width == 0, "Culling jobs must start on a whole group of boxes");
+
+    CullFrustumContext context{};
+    for (u32 i = 0; i < Frustum::Plane::Count; i++)
+    {
+        const Vector4& plane = frustum.m_planes[i];
+        context.m_planes[i] = CullingPlane{
+            f4_splat(plane.x), f4_splat(plane.y), f4_splat(plane.z), f4_splat(plane.w),
+            f4_splat(ZV::abs(plane.x)), f4_splat(ZV::abs(plane.y)), f4_splat(ZV::abs(plane.z)) };
+    }
+
+    const u32 num_batches = (bounds.m_count + k_culling_batch_size - 1) / k_culling_batch_size;
+    out_visible->resize(bounds.m_center_x.size());  // The compaction writes every lane, the padding included
+    context.m_bounds = &bounds;
+    context.m_visible = out_visible->data();
+    context.m_batch_counts.resize(num_batches, 0);
+    Platform::parallel_for(bounds.m_count, k_culling_batch_size, &cull_frustum_job, &context);
+
+    // Close the gaps between the batches, the first one is already in place
+    u32 num_visible = num_batches ? context.m_batch_counts[0] : 0;
+    for (u32 batch = 1; batch < num_batches; batch++)
+    {
+        const u32* batch_visible = out_visible->data() + batch * k_culling_batch_size;
+        memmove(out_visible->data() + num_visible, batch_visible, context.m_batch_counts[batch] * sizeof(u32));
+        num_visible += context.m_batch_counts[batch];
+    }
+    out_visible->resize(num_visible);
+
+    if (out_stats)
+    {
+        out_stats->m_num_tested = bounds.m_count;
+        out_stats->m_num_visible = num_visible;
+    }
+}
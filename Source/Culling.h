@@ -0,0 +1,38 @@
+#pragma once
+
+#include <CoreDefs.h>
+#include <Geometry.h>
+
+constexpr u32 k_culling_simd_width = 4;    // Boxes tested per kernel iteration
+constexpr u32 k_culling_batch_size = 4096; // Boxes per job, a multiple of k_culling_simd_width
+
+// World space boxes as centers and half extents in separate streams, so the culling kernel loads one coordinate of four
+// boxes with a single load. The streams are padded to a multiple of k_culling_simd_width with boxes that are never visible.
+struct CullingBounds
+{
+    DynamicArray<f32> m_center_x{};
+    DynamicArray<f32> m_center_y{};
+    DynamicArray<f32> m_center_z{};
+    DynamicArray<f32> m_extent_x{};
+    DynamicArray<f32> m_extent_y{};
+    DynamicArray<f32> m_extent_z{};
+    u32 m_count = 0;
+
+    // New boxes are invisible until they are set
+    void resize(u32 count);
+    // Invalid boxes are never visible
+    void set(u32 index, const AABB& aabb);
+};
+
+struct CullingStats
+{
+    u32 m_num_tested = 0;
+    u32 m_num_visible = 0;
+
+    f32 get_visible_ratio() const { return m_num_tested ? static_cast<f32>(m_num_visible) / m_num_tested : 0.0f; }
+};
+
+// Replaces out_visible with the indices of the boxes that are not completely outside the frustum, in increasing order.
+// Same result as test_frustum_aabb. Large counts are split into k_culling_batch_size jobs and every job writes to its own
+// range of the output, so the list doesn't depend on the thread count. out_stats is optional.
+void cull_frustum(const Frustum& frustum, const CullingBounds& bounds, DynamicArray<u32>* out_visible, CullingStats* out_stats = nullptr);
@@ -0,0 +1,66 @@
+#include <DescriptorTableCache.h>
+
+#include <Log.h>
+
+namespace
+{
+    // FNV-1a over whole handles, the count goes in first so a table never hashes like its prefix
+    inline u64 hash_descriptors(const u64* descriptors, u32 num_descriptors)
+    {
+        constexpr u64 k_offset_basis = 0xcbf29ce484222325;
+        constexpr u64 k_prime = 0x100000001b3;
+
+        u64 hash = (k_offset_basis ^ num_descriptors) * k_prime;
+        for (u32 i = 0; i < num_descriptors; i++)
+        {
+            hash = (hash ^ descriptors[i]) * k_prime;
+        }
+        return hash;
+    }
+}
+
+DescriptorTableCache::DescriptorTableCache(DescriptorTableHeap* heap)
+    : m_heap(heap)
+{
+}
+
+void DescriptorTableCache::reset()
+{
+    m_table_indices.clear();
+    m_tables.clear();
+    m_sources.clear();
+    m_stats = {};
+}
+
+bool DescriptorTableCache::matches(const Table& table, const u64* source_descriptors, u32 num_descriptors) const
+{
+    return table.m_num_descriptors == num_descriptors && memcmp(&m_sources[table.m_first_source], source_descriptors, num_descriptors * sizeof(u64)) == 0;
+}
+
+u64 DescriptorTableCache::get_descriptor_table(const u64* source_descriptors, u32 num_descriptors)
+{
+    zv_assert_msg(num_descriptors > 0 && num_descriptors <= k_max_descriptor_table_size, "Descriptor table size {} out of range", num_descriptors);
+
+    const u64 hash = hash_descriptors(source_descriptors, num_descriptors);
+
+    auto it = m_table_indices.find(hash);
+    if (it != m_table_indices.end() && matches(m_tables[it->second], source_descriptors, num_descriptors))
+    {
+        m_stats.m_num_hits++;
+        m_stats.m_num_reused_descriptors += num_descriptors;
+        return m_tables[it->second].m_handle;
+    }
+
+    Table table{};
+    table.m_first_source = static_cast<u32>(m_sources.size());
+    table.m_num_descriptors = num_descriptors;
+    table.m_handle = m_heap->copy_descriptor_table(source_descriptors, num_descriptors);
+
+    m_sources.insert(m_sources.end(), source_descriptors, source_descriptors + num_descriptors);
+    m_table_indices[hash] = static_cast<u32>(m_tables.size());
+    m_tables.push_back(table);
+
+    m_stats.m_num_misses++;
+    m_stats.m_num_copied_descriptors += num_descriptors;
+    return table.m_handle;
+}
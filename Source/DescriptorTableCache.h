@@ -0,0 +1,60 @@
+#pragma once
+
+#include <CoreDefs.h>
+
+constexpr u32 k_max_descriptor_table_size = 16;
+
+struct DescriptorTableCacheStats
+{
+    u32 m_num_hits = 0;
+    u32 m_num_misses = 0;
+    u32 m_num_copied_descriptors = 0;  // Heap space taken by misses
+    u32 m_num_reused_descriptors = 0;  // Heap space hits didn't need
+
+    f32 get_hit_rate() const { return m_num_hits + m_num_misses ? static_cast<f32>(m_num_hits) / (m_num_hits + m_num_misses) : 0.0f; }
+};
+
+// Where the cache copies tables to. Descriptors are opaque handles, for DX12 the CPU handles of the staging descriptors
+// and the GPU handle of the copied table.
+class DescriptorTableHeap
+{
+public:
+    virtual ~DescriptorTableHeap() = default;
+
+    // Copies the descriptors into a new contiguous block and returns the block's handle
+    virtual u64 copy_descriptor_table(const u64* source_descriptors, u32 num_descriptors) = 0;
+};
+
+// Hands out the table copied earlier when a descriptor table with the same source descriptors in the same order is set
+// again. The copies live as long as the heap's current contents, reset the cache whenever the heap is reset.
+class DescriptorTableCache
+{
+public:
+    explicit DescriptorTableCache(DescriptorTableHeap* heap);
+
+    // Forgets every table and restarts the counters
+    void reset();
+
+    u64 get_descriptor_table(const u64* source_descriptors, u32 num_descriptors);
+
+    const DescriptorTableCacheStats& get_stats() const { return m_stats; }
+
+private:
+    struct Table
+    {
+        u32 m_first_source = 0;  // Into m_sources
+        u32 m_num_descriptors = 0;
+        u64 m_handle = 0;
+    };
+
+    bool matches(const Table& table, const u64* source_descriptors, u32 num_descriptors) const;
+
+private:
+    DescriptorTableHeap* m_heap = nullptr;
+    DescriptorTableCacheStats m_stats{};
+
+    // Tables by the hash of their sources, a colliding table replaces the one it collides with
+    HashMap<u64, u32> m_table_indices{};
+    DynamicArray<Table> m_tables{};
+    DynamicArray<u64> m_sources{};
+};
@@ -1,30 +1,15 @@
 #include <Geometry.h>
+#include <MeshProcessing.h>
+
+#include <Platform/Platform.h>
+#include <Platform/Jobs.h>
+
+#if ZV_ARCH_X64
+#include <immintrin.h>
+#endif
 
 namespace
 {
-    // Taken from: https://iquilezles.org/articles/normals/
-    void recalculate_normals(MeshVertex* vertices, size_t num_vertices, u16* indices, size_t num_indices)
-    {
-        for (u32 i = 0; i < num_vertices; ++i) vertices[i].normal = Vector3(0.0f);
-    
-        for (u32 i = 0; i < num_indices; i += 3)
-        {
-            const u16 ia = indices[i + 0];
-            const u16 ib = indices[i + 1];
-            const u16 ic = indices[i + 2];
-    
-            const Vector3 e1 = vertices[ib].position - vertices[ia].position;
-            const Vector3 e2 = vertices[ic].position - vertices[ia].position;
-            const Vector3 no = e1.Cross(e2);
-    
-            vertices[ia].normal += no;
-            vertices[ib].normal += no;
-            vertices[ic].normal += no;
-        }
-    
-        for (u32 i = 0; i < num_vertices; ++i) vertices[i].normal.Normalize();
-    }
-
     MeshVertex get_mid_point(const MeshVertex& v0, const MeshVertex& v1)
     {
         Vector3 p0 = v0.position;
@@ -57,77 +42,174 @@ namespace
         return v;
     }
 
+    // Splits every triangle into four. Midpoints are shared by both triangles of an edge through the edge cache,
+    // so a closed mesh with V vertices, E edges and F triangles ends up with V + E vertices and 4F triangles.
     void subdivide(PrimitiveMeshGeometryData& data)
     {
-        // Save a copy of the input geometry.
-        PrimitiveMeshGeometryData input_copy = data;
-
-        data.m_vertices.resize(0);
-        data.m_indices.resize(0);
-
-        //       v1
-        //       *
-        //      / \
-        //     /   \
-        //  m0*-----*m1
-        //   / \   / \
-        //  /   \ /   \
-        // *-----*-----*
-        // v0    m2     v2
-
-        u32 num_tris = static_cast<u32>(input_copy.m_indices.size() / 3);
-        for(u32 i = 0; i < num_tris; ++i)
-        {
-            MeshVertex v0 = input_copy.m_vertices[input_copy.m_indices[i * 3 + 0]];
-            MeshVertex v1 = input_copy.m_vertices[input_copy.m_indices[i * 3 + 1]];
-            MeshVertex v2 = input_copy.m_vertices[input_copy.m_indices[i * 3 + 2]];
-
-            //
-            // Generate the midpoints.
-            //
-
-            MeshVertex m0 = get_mid_point(v0, v1);
-            MeshVertex m1 = get_mid_point(v1, v2);
-            MeshVertex m2 = get_mid_point(v0, v2);
-
-            //
-            // Add new geometry.
-            //
-
-            data.m_vertices.push_back(v0); // 0
-            data.m_vertices.push_back(v1); // 1
-            data.m_vertices.push_back(v2); // 2
-            data.m_vertices.push_back(m0); // 3
-            data.m_vertices.push_back(m1); // 4
-            data.m_vertices.push_back(m2); // 5
-    
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 0));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 3));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 5));
+        DynamicArray<u16> input_indices = move_ptr(data.m_indices);
+        const u32 num_input_vertices = static_cast<u32>(data.m_vertices.size());
+        const u32 num_tris = static_cast<u32>(input_indices.size() / 3);
+
+        // Edges are keyed by their sorted vertex indices, midpoints are numbered in first use order after the input vertices
+        HashMap<u32, u16> edge_midpoints{};
+        edge_midpoints.reserve(num_tris * 3 / 2 + 1);
+
+        auto get_edge_key = [](u16 a, u16 b) { return a < b ? (static_cast<u32>(a) << 16) | b : (static_cast<u32>(b) << 16) | a; };
+
+        for (u32 i = 0; i < input_indices.size(); ++i)
+        {
+            const u16 a = input_indices[i];
+            const u16 b = input_indices[i - i % 3 + (i % 3 + 1) % 3];
+            edge_midpoints.try_emplace(get_edge_key(a, b), static_cast<u16>(num_input_vertices + edge_midpoints.size()));
+        }
+
+        const size_t num_output_vertices = num_input_vertices + edge_midpoints.size();
+        zv_assert_msg(num_output_vertices <= UINT16_MAX + 1, "Subdivision needs {} vertices, more than 16 bit indices can address", num_output_vertices);
+
+        // The input vertices keep their indices
+        data.m_vertices.resize(num_output_vertices);
+        for (const auto& [key, midpoint] : edge_midpoints)
+        {
+            data.m_vertices[midpoint] = get_mid_point(data.m_vertices[key >> 16], data.m_vertices[key & 0xffff]);
+        }
+
+        /*
+                 v1
+                 *
+                / \
+               /   \
+            m0*-----*m1
+             / \   / \
+            /   \ /   \
+           *-----*-----*
+           v0    m2     v2
+        */
+
+        data.m_indices.resize(num_tris * 12);
+        u16* out_indices = data.m_indices.data();
+
+        for (u32 i = 0; i < num_tris; ++i)
+        {
+            const u16 v0 = input_indices[i * 3 + 0];
+            const u16 v1 = input_indices[i * 3 + 1];
+            const u16 v2 = input_indices[i * 3 + 2];
+
+            const u16 m0 = edge_midpoints[get_edge_key(v0, v1)];
+            const u16 m1 = edge_midpoints[get_edge_key(v1, v2)];
+            const u16 m2 = edge_midpoints[get_edge_key(v0, v2)];
+
+            const u16 triangles[12] =
+            {
+                v0, m0, m2,
+                m0, m1, m2,
+                m2, m1, v2,
+                m0, v1, m1,
+            };
+            memcpy(out_indices + i * 12, triangles, sizeof(triangles));
+        }
+    }
+
+    // Exact vertex and index counts of each building block, so generators can size their storage once
+    struct PrimitiveSize
+    {
+        u32 m_num_vertices = 0;
+        u32 m_num_indices = 0;
+
+        PrimitiveSize operator+(const PrimitiveSize& other) const { return { m_num_vertices + other.m_num_vertices, m_num_indices + other.m_num_indices }; }
+    };
 
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 3));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 4));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 5));
+    PrimitiveSize get_cylinder_side_size(u32 radial_segments, u32 height_segments)
+    {
+        return { (height_segments + 1) * (radial_segments + 1), height_segments * radial_segments * 6 };
+    }
+
+    PrimitiveSize get_cylinder_cap_size(u32 slice_count)
+    {
+        return { slice_count + 2, slice_count * 3 };
+    }
+
+    PrimitiveSize get_capsule_cap_size(u32 slice_count, u32 stack_count)
+    {
+        return { (stack_count + 1) * (slice_count + 1), stack_count * slice_count * 6 };
+    }
+
+    // Writes into geometry that was sized up front, the builders never grow the arrays
+    struct GeometryWriter
+    {
+        MeshVertex* m_vertices = nullptr;
+        u16* m_indices = nullptr;
+        u32 m_num_vertices = 0;
+        u32 m_num_indices = 0;
+
+        void add_vertex(const MeshVertex& vertex)
+        {
+            m_vertices[m_num_vertices++] = vertex;
+        }
+
+        void add_triangle(u32 a, u32 b, u32 c)
+        {
+            m_indices[m_num_indices++] = static_cast<u16>(a);
+            m_indices[m_num_indices++] = static_cast<u16>(b);
+            m_indices[m_num_indices++] = static_cast<u16>(c);
+        }
+    };
+
+    GeometryWriter begin_geometry(PrimitiveMeshGeometryData& data, const PrimitiveSize& size)
+    {
+        zv_assert_msg(size.m_num_vertices <= UINT16_MAX + 1, "Primitive needs {} vertices, more than 16 bit indices can address", size.m_num_vertices);
+
+        data.m_vertices.resize(size.m_num_vertices);
+        data.m_indices.resize(size.m_num_indices);
+
+        GeometryWriter writer{};
+        writer.m_vertices = data.m_vertices.data();
+        writer.m_indices = data.m_indices.data();
+        return writer;
+    }
+
+    void end_geometry(const PrimitiveMeshGeometryData& data, const GeometryWriter& writer)
+    {
+        zv_assert_msg(writer.m_num_vertices == data.m_vertices.size(), "Wrote {} of {} vertices", writer.m_num_vertices, data.m_vertices.size());
+        zv_assert_msg(writer.m_num_indices == data.m_indices.size(), "Wrote {} of {} indices", writer.m_num_indices, data.m_indices.size());
+    }
+
+    // cos and sin of i * 2pi / segments for i in [0, segments], shared by every ring of a generator.
+    // The last entry repeats the first angle for the duplicated seam vertex.
+    struct RingAngles
+    {
+        DynamicArray<f32> m_values;  // cos, sin pairs
+
+        f32 get_cos(u32 i) const { return m_values[i * 2]; }
+        f32 get_sin(u32 i) const { return m_values[i * 2 + 1]; }
+    };
 
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 5));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 4));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 2));
+    RingAngles make_ring_angles(u32 segments)
+    {
+        RingAngles angles{};
+        angles.m_values.resize((segments + 1) * 2);
 
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 3));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 1));
-            data.m_indices.push_back(static_cast<u16>(i * 6 + 4));
+        const f32 step = ZV_2PI / segments;
+        for (u32 i = 0; i <= segments; ++i)
+        {
+            angles.m_values[i * 2] = ZV::cos(i * step);
+            angles.m_values[i * 2 + 1] = ZV::sin(i * step);
         }
+
+        return angles;
     }
 
     void build_cylinder_side(
         f32 bottom_radius, f32 top_radius, f32 height,
         u32 radial_segments, u32 height_segments,
-        PrimitiveMeshGeometryData& data)
+        const RingAngles& angles,
+        GeometryWriter& writer)
     {
         //
         // Build Stacks.
         // 
 
+        const u32 base_index = writer.m_num_vertices;
+
         f32 stack_height = height / height_segments;
 
         // Amount to increment radius as we move up each stack level from bottom to top.
@@ -142,13 +224,12 @@ namespace
             f32 r = bottom_radius + i * radius_step;
 
             // vertices of ring
-            f32 d_theta = 2.0f * ZV_PI / radial_segments;
             for (u32 j = 0; j <= radial_segments; ++j)
             {
                 MeshVertex vertex;
 
-                f32 c = cosf(j * d_theta);
-                f32 s = sinf(j * d_theta);
+                f32 c = angles.get_cos(j);
+                f32 s = angles.get_sin(j);
 
                 vertex.position.x = r * c;
                 vertex.position.y = y;
@@ -180,6 +261,7 @@ namespace
                 vertex.tangent.x = -s;
                 vertex.tangent.y = 0.0f;
                 vertex.tangent.z = c;
+                vertex.tangent.w = 0.0f;
 
                 f32 dr = bottom_radius - top_radius;
                 Vector3 bitangent(dr * c, -height, dr * s);
@@ -190,7 +272,7 @@ namespace
                 N.Normalize();
                 vertex.normal = N;
 
-                data.m_vertices.push_back(vertex);
+                writer.add_vertex(vertex);
             }
         }
 
@@ -203,13 +285,15 @@ namespace
         {
             for (u32 j = 0; j < radial_segments; ++j)
             {
-                data.m_indices.push_back(static_cast<u16>(i * ring_vertex_count + j));
-                data.m_indices.push_back(static_cast<u16>((i + 1) * ring_vertex_count + j));
-                data.m_indices.push_back(static_cast<u16>((i + 1) * ring_vertex_count + j + 1));
-
-                data.m_indices.push_back(static_cast<u16>(i * ring_vertex_count + j));
-                data.m_indices.push_back(static_cast<u16>((i + 1) * ring_vertex_count + j + 1));
-                data.m_indices.push_back(static_cast<u16>(i * ring_vertex_count + j + 1));
+                writer.add_triangle(
+                    base_index + i * ring_vertex_count + j,
+                    base_index + (i + 1) * ring_vertex_count + j,
+                    base_index + (i + 1) * ring_vertex_count + j + 1);
+
+                writer.add_triangle(
+                    base_index + i * ring_vertex_count + j,
+                    base_index + (i + 1) * ring_vertex_count + j + 1,
+                    base_index + i * ring_vertex_count + j + 1);
             }
         }
     }
@@ -217,138 +301,144 @@ namespace
     void build_cylinder_top_cap(
         f32 top_radius, f32 height,
         u32 slice_count,
-        PrimitiveMeshGeometryData& data)
+        const RingAngles& angles,
+        GeometryWriter& writer)
     {
-        u32 base_index = static_cast<u32>(data.m_vertices.size());
+        u32 base_index = writer.m_num_vertices;
 
         f32 y = 0.5f * height;
-        f32 d_theta = 2.0f * ZV_PI / slice_count;
 
         // Duplicate cap ring vertices because the texture coordinates and normals differ.
         for (u32 i = 0; i <= slice_count; ++i)
         {
-            f32 x = top_radius * ZV::cos(i * d_theta);
-            f32 z = top_radius * ZV::sin(i * d_theta);
+            f32 x = top_radius * angles.get_cos(i);
+            f32 z = top_radius * angles.get_sin(i);
 
             // Scale down by the height to try and make top cap texture coord area
             // proportional to base.
             f32 u = x / height + 0.5f;
             f32 v = z / height + 0.5f;
 
-            data.m_vertices.push_back({Vector3(x, y, z), Vector2(u, v), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+            writer.add_vertex({Vector3(x, y, z), Vector2(u, v), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
         }
 
         // Cap center vertex.
-        data.m_vertices.push_back({Vector3(0.0f, y, 0.0f), Vector2(0.5f, 0.5f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-
-        // Index of center vertex.
-        u32 center_index = static_cast<u32>(data.m_vertices.size() - 1);
+        u32 center_index = writer.m_num_vertices;
+        writer.add_vertex({Vector3(0.0f, y, 0.0f), Vector2(0.5f, 0.5f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
 
         for (u32 i = 0; i < slice_count; ++i)
         {
-            data.m_indices.push_back(static_cast<u16>(center_index));
-            data.m_indices.push_back(static_cast<u16>(base_index + i + 1));
-            data.m_indices.push_back(static_cast<u16>(base_index + i));
+            writer.add_triangle(center_index, base_index + i + 1, base_index + i);
         }
     }
 
     void build_cylinder_bottom_cap(
         f32 bottom_radius, f32 height,
         u32 slice_count,
-        PrimitiveMeshGeometryData& data)
+        const RingAngles& angles,
+        GeometryWriter& writer)
     {
         // 
         // Build bottom cap.
         //
 
-        u32 base_index = static_cast<u32>(data.m_vertices.size());
+        u32 base_index = writer.m_num_vertices;
         f32 y = -0.5f * height;
 
         // vertices of ring
-        f32 d_theta = 2.0f * ZV_PI / slice_count;
         for (u32 i = 0; i <= slice_count; ++i)
         {
-            f32 x = bottom_radius * ZV::cos(i * d_theta);
-            f32 z = bottom_radius * ZV::sin(i * d_theta);
+            f32 x = bottom_radius * angles.get_cos(i);
+            f32 z = bottom_radius * angles.get_sin(i);
 
             // Scale down by the height to try and make top cap texture coord area
             // proportional to base.
             f32 u = x / height + 0.5f;
             f32 v = z / height + 0.5f;
 
-            data.m_vertices.push_back({Vector3(x, y, z), Vector2(u, v), Vector3(0.0f, -1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+            writer.add_vertex({Vector3(x, y, z), Vector2(u, v), Vector3(0.0f, -1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
         }
 
         // Cap center vertex.
-        data.m_vertices.push_back({Vector3(0.0f, y, 0.0f), Vector2(0.5f, 0.5f), Vector3(0.0f, -1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-
-        // Cache the index of center vertex.
-        u32 center_index = static_cast<u32>(data.m_vertices.size() - 1);
+        u32 center_index = writer.m_num_vertices;
+        writer.add_vertex({Vector3(0.0f, y, 0.0f), Vector2(0.5f, 0.5f), Vector3(0.0f, -1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
 
         for (u32 i = 0; i < slice_count; ++i)
         {
-            data.m_indices.push_back(static_cast<u16>(center_index));
-            data.m_indices.push_back(static_cast<u16>(base_index + i));
-            data.m_indices.push_back(static_cast<u16>(base_index + i + 1));
+            writer.add_triangle(center_index, base_index + i, base_index + i + 1);
         }
     }
 
-    void build_capsule_top_cap(
-        f32 radius, f32 height,
+    // Hemisphere rings from phi_start down, phi and its sin and cos are computed once per ring
+    void build_capsule_cap_rings(
+        f32 radius, f32 y_offset, f32 phi_start,
         u32 slice_count, u32 stack_count,
-        PrimitiveMeshGeometryData& data)
+        bool is_top,
+        const RingAngles& angles,
+        GeometryWriter& writer)
     {
         f32 phi_step = 0.5f * ZV_PI / stack_count;
-        f32 theta_step = 2.0f * ZV_PI / slice_count;
-    
-        // Start from top pole (we won't use it, but we build rings starting just below)
-        f32 y_offset = 0.5f * height;
-    
-        // Build rings (excluding the top pole)
+
         for (u32 i = 0; i <= stack_count; ++i)
         {
-            f32 phi = i * phi_step;
+            const f32 phi = phi_start + i * phi_step;
+            const f32 sin_phi = ZV::sin(phi);
+            const f32 cos_phi = ZV::cos(phi);
+
             for (u32 j = 0; j <= slice_count; ++j)
             {
-                f32 theta = j * theta_step;
-    
+                const f32 cos_theta = angles.get_cos(j);
+                const f32 sin_theta = angles.get_sin(j);
+
                 MeshVertex v;
-                v.position.x = radius * ZV::sin(phi) * ZV::cos(theta);
-                v.position.y = radius * ZV::cos(phi) + y_offset;
-                v.position.z = radius * ZV::sin(phi) * ZV::sin(theta);
+                v.position.x = radius * sin_phi * cos_theta;
+                v.position.y = radius * cos_phi + y_offset;
+                v.position.z = radius * sin_phi * sin_theta;
     
                 // Partial derivative of P with respect to theta
-                v.tangent.x = -radius * ZV::sin(phi) * ZV::sin(theta);
+                v.tangent.x = -radius * sin_phi * sin_theta;
                 v.tangent.y = 0.0f;
-                v.tangent.z = +radius * ZV::sin(phi) * ZV::cos(theta);
+                v.tangent.z = +radius * sin_phi * cos_theta;
                 v.tangent.w = 1.0f;
                 v.tangent.Normalize();
 
-                Vector3 p = v.position - Vector3(0.0f, y_offset, 0.0f);
-                v.normal = p;
-                v.normal.Normalize();
+                // Unit sphere direction, the same as normalizing the offset from the cap center
+                v.normal = Vector3(sin_phi * cos_theta, cos_phi, sin_phi * sin_theta);
     
-                v.uv.x = theta / ZV_2PI;
-                v.uv.y = 1.0f - phi / ZV_PI;
+                v.uv.x = static_cast<f32>(j) / slice_count;
+                v.uv.y = is_top ? 1.0f - phi / ZV_PI : phi / ZV_PI;
     
-                data.m_vertices.push_back(v);
+                writer.add_vertex(v);
             }
         }
+    }
+
+    void build_capsule_top_cap(
+        f32 radius, f32 height,
+        u32 slice_count, u32 stack_count,
+        const RingAngles& angles,
+        GeometryWriter& writer)
+    {
+        u32 base_index = writer.m_num_vertices;
+
+        // Start from top pole (we won't use it, but we build rings starting just below)
+        build_capsule_cap_rings(radius, 0.5f * height, 0.0f, slice_count, stack_count, true, angles, writer);
     
         // Indices
         u32 ring_vertex_count = slice_count + 1;
-        u32 base_index = static_cast<u32>(data.m_vertices.size()) - (stack_count + 1) * ring_vertex_count;
         for (u32 i = 0; i < stack_count; ++i)
         {
             for (u32 j = 0; j < slice_count; ++j)
             {
-                data.m_indices.push_back(static_cast<u16>(i * ring_vertex_count + j + base_index));
-                data.m_indices.push_back(static_cast<u16>((i + 1) * ring_vertex_count + j + 1 + base_index));
-                data.m_indices.push_back(static_cast<u16>((i + 1) * ring_vertex_count + j + base_index));
+                writer.add_triangle(
+                    i * ring_vertex_count + j + base_index,
+                    (i + 1) * ring_vertex_count + j + 1 + base_index,
+                    (i + 1) * ring_vertex_count + j + base_index);
                 
-                data.m_indices.push_back(static_cast<u16>(i * ring_vertex_count + j + base_index));
-                data.m_indices.push_back(static_cast<u16>(i * ring_vertex_count + j + 1 + base_index));
-                data.m_indices.push_back(static_cast<u16>((i + 1) * ring_vertex_count + j + 1 + base_index));
+                writer.add_triangle(
+                    i * ring_vertex_count + j + base_index,
+                    i * ring_vertex_count + j + 1 + base_index,
+                    (i + 1) * ring_vertex_count + j + 1 + base_index);
             }
         }
     }
@@ -356,44 +446,12 @@ namespace
     void build_capsule_bottom_cap(
         f32 radius, f32 height,
         u32 slice_count, u32 stack_count,
-        PrimitiveMeshGeometryData& data)
+        const RingAngles& angles,
+        GeometryWriter& writer)
     {
-        f32 phi_step = 0.5f * ZV_PI / stack_count;
-        f32 theta_step = 2.0f * ZV_PI / slice_count;
-    
-        f32 y_offset = -0.5f * height;
-    
-        u32 base_index = static_cast<u32>(data.m_vertices.size());
-    
-        for (u32 i = 0; i <= stack_count; ++i)
-        {
-            f32 phi = i * phi_step + 0.5f * ZV_PI;
-            for (u32 j = 0; j <= slice_count; ++j)
-            {
-                f32 theta = j * theta_step;
-
-                MeshVertex v;
-                v.position.x = radius * ZV::sin(phi) * ZV::cos(theta);
-                v.position.y = radius * ZV::cos(phi) + y_offset;
-                v.position.z = radius * ZV::sin(phi) * ZV::sin(theta);
-    
-                // Partial derivative of P with respect to theta
-                v.tangent.x = -radius * ZV::sin(phi) * ZV::sin(theta);
-                v.tangent.y = 0.0f;
-                v.tangent.z = +radius * ZV::sin(phi) * ZV::cos(theta);
-                v.tangent.w = 1.0f;
-                v.tangent.Normalize();
+        u32 base_index = writer.m_num_vertices;
 
-                Vector3 p = v.position - Vector3(0.0f, y_offset, 0.0f);
-                v.normal = p;
-                v.normal.Normalize();
-    
-                v.uv.x = theta / ZV_2PI;
-                v.uv.y = phi / ZV_PI;
-    
-                data.m_vertices.push_back(v);
-            }
-        }
+        build_capsule_cap_rings(radius, -0.5f * height, 0.5f * ZV_PI, slice_count, stack_count, false, angles, writer);
     
         u32 ring_vertex_count = slice_count + 1;
     
@@ -407,445 +465,1482 @@ namespace
                 u32 d = base_index + i * ring_vertex_count + j + 1;
     
                 // Clockwise winding order for bottom cap (facing -Y)
-                data.m_indices.push_back(static_cast<u16>(a));
-                data.m_indices.push_back(static_cast<u16>(c));
-                data.m_indices.push_back(static_cast<u16>(b));
-    
-                data.m_indices.push_back(static_cast<u16>(a));
-                data.m_indices.push_back(static_cast<u16>(d));
-                data.m_indices.push_back(static_cast<u16>(c));
+                writer.add_triangle(a, c, b);
+                writer.add_triangle(a, d, c);
             }
         }
     }
 }
 
-SharedPtr<PrimitiveMeshGeometryData> create_triangle(Vector3 p1, Vector3 p2, Vector3 p3)
+namespace
 {
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
-    
-    data->m_type = PrimitiveMeshGeometryData::Type::Triangle;
-
-    data->m_vertices.push_back({p1, Vector2(0.0f, 1.0f), Vector3(0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-    data->m_vertices.push_back({p2, Vector2(0.5f, 0.0f), Vector3(0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-    data->m_vertices.push_back({p3, Vector2(1.0f, 1.0f), Vector3(0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-    
-    data->m_indices.push_back(0);
-    data->m_indices.push_back(1);
-    data->m_indices.push_back(2);
+    // Geometry is only shared while someone references it, expired entries are dropped on the next miss
+    struct PrimitiveGeometryCache
+    {
+        Mutex m_mutex;
+        HashMap<PrimitiveGeometryKey, WeakPtr<PrimitiveMeshGeometryData>> m_entries{};
+        u32 m_num_hits = 0;
+        u32 m_num_misses = 0;
+    };
 
-    recalculate_normals(data->m_vertices.data(), data->m_vertices.size(), data->m_indices.data(), data->m_indices.size());
+    PrimitiveGeometryCache s_primitive_geometry_cache{};
 
-    return data;
-}
+    PrimitiveGeometryKey make_primitive_geometry_key(PrimitiveMeshGeometryData::Type type, std::initializer_list<f32> params)
+    {
+        zv_assert_msg(params.size() <= std::tuple_size_v<decltype(PrimitiveGeometryKey::m_params)>, "Too many primitive parameters: {}", params.size());
 
-SharedPtr<PrimitiveMeshGeometryData> create_quad(f32 width, f32 height)
-{
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+        PrimitiveGeometryKey key{};
+        key.m_type = type;
 
-    data->m_type = PrimitiveMeshGeometryData::Type::Quad;
+        // Bits rather than values, so 0.0 and -0.0 don't share a key while hashing differently
+        u32 i = 0;
+        for (f32 param : params)
+        {
+            memcpy(&key.m_params[i++], &param, sizeof(f32));
+        }
 
-    data->m_vertices.push_back({Vector3(-width / 2.0f, -height / 2.0f, 0.0f), Vector2(0.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-    data->m_vertices.push_back({Vector3(-width / 2.0f, height / 2.0f, 0.0f), Vector2(0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-    data->m_vertices.push_back({Vector3(width / 2.0f, height / 2.0f, 0.0f), Vector2(1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
-    data->m_vertices.push_back({Vector3(width / 2.0f, -height / 2.0f, 0.0f), Vector2(1.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+        return key;
+    }
 
-    data->m_indices.push_back(0);
-    data->m_indices.push_back(1);
-    data->m_indices.push_back(2);
-    data->m_indices.push_back(0);
-    data->m_indices.push_back(2);
-    data->m_indices.push_back(3);
+    template <typename Generator>
+    SharedPtr<PrimitiveMeshGeometryData> get_or_generate_primitive(const PrimitiveGeometryKey& key, Generator generate)
+    {
+        PrimitiveGeometryCache& cache = s_primitive_geometry_cache;
+        ScopedLock lock_guard(cache.m_mutex);
 
-    return data;
-}
+        auto it = cache.m_entries.find(key);
+        if (it != cache.m_entries.end())
+        {
+            if (SharedPtr<PrimitiveMeshGeometryData> geometry = it->second.lock())
+            {
+                ++cache.m_num_hits;
+                return geometry;
+            }
+        }
 
-SharedPtr<PrimitiveMeshGeometryData> create_plane(f32 width, f32 height, u32 width_segments, u32 height_segments)
-{
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+        ++cache.m_num_misses;
 
-    data->m_type = PrimitiveMeshGeometryData::Type::Plane;
+        for (auto entry = cache.m_entries.begin(); entry != cache.m_entries.end();)
+        {
+            entry = entry->second.expired() ? cache.m_entries.erase(entry) : std::next(entry);
+        }
 
-    u32 m = width_segments * 2;
-    u32 n = height_segments * 2;
+        // Packed before anyone else can see it, shared geometry is only ever read
+        SharedPtr<PrimitiveMeshGeometryData> geometry = generate();
+        pack_mesh_geometry(geometry.get());
+        cache.m_entries[key] = geometry;
 
-	u32 vertex_count = m * n;
-	u32 face_count   = (m - 1) * (n - 1) * 2;
+        return geometry;
+    }
 
-	//
-	// Create the vertices.
-	//
+    SharedPtr<PrimitiveMeshGeometryData> generate_triangle(Vector3 p1, Vector3 p2, Vector3 p3)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
 
-	f32 half_width = 0.5f * width;
-	f32 half_height = 0.5f * height;
+        data->m_type = PrimitiveMeshGeometryData::Type::Triangle;
 
-	f32 dx = width / (n - 1);
-	f32 dz = height / (m - 1);
+        data->m_vertices.push_back({p1, Vector2(0.0f, 1.0f), Vector3(0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+        data->m_vertices.push_back({p2, Vector2(0.5f, 0.0f), Vector3(0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+        data->m_vertices.push_back({p3, Vector2(1.0f, 1.0f), Vector3(0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
 
-	f32 du = 1.0f / (n - 1);
-	f32 dv = 1.0f / (m - 1);
+        data->m_indices.push_back(0);
+        data->m_indices.push_back(1);
+        data->m_indices.push_back(2);
 
-	data->m_vertices.resize(vertex_count);
-	
-    for (u32 i = 0; i < m; ++i)
-	{
-		f32 z = half_height - i * dz;
+        recalculate_normals(data->m_vertices.data(), data->m_vertices.size(), data->m_indices.data(), data->m_indices.size());
+        compute_mesh_bounds(data.get());
 
-		for (u32 j = 0; j < n; ++j)
-		{
-			f32 x = -half_width + j * dx;
+        return data;
+    }
 
-			data->m_vertices[i * n + j].position = Vector3(x, 0.0f, z);
-			data->m_vertices[i * n + j].normal   = Vector3(0.0f, 1.0f, 0.0f);
-			data->m_vertices[i * n + j].tangent  = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
+    SharedPtr<PrimitiveMeshGeometryData> generate_quad(f32 width, f32 height)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
 
-			// Stretch texture over grid.
-			data->m_vertices[i * n + j].uv.x = j * du;
-			data->m_vertices[i * n + j].uv.y = i * dv;
-		}
-	}
- 
-    //
-	// Create the indices.
-	//
+        data->m_type = PrimitiveMeshGeometryData::Type::Quad;
 
-	data->m_indices.resize(face_count * 3); // 3 indices per face
+        data->m_vertices.push_back({Vector3(-width / 2.0f, -height / 2.0f, 0.0f), Vector2(0.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+        data->m_vertices.push_back({Vector3(-width / 2.0f, height / 2.0f, 0.0f), Vector2(0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+        data->m_vertices.push_back({Vector3(width / 2.0f, height / 2.0f, 0.0f), Vector2(1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
+        data->m_vertices.push_back({Vector3(width / 2.0f, -height / 2.0f, 0.0f), Vector2(1.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)});
 
-	// Iterate over each quad and compute indices.
-	u32 k = 0;
-	for (u32 i = 0; i < m - 1; ++i)
-	{
-		for (u32 j = 0; j < n - 1; ++j)
-		{
-			data->m_indices[k]     = static_cast<u16>(i * n + j);
-			data->m_indices[k + 1] = static_cast<u16>(i * n + j + 1);
-			data->m_indices[k + 2] = static_cast<u16>((i + 1) * n + j);
+        data->m_indices.push_back(0);
+        data->m_indices.push_back(1);
+        data->m_indices.push_back(2);
+        data->m_indices.push_back(0);
+        data->m_indices.push_back(2);
+        data->m_indices.push_back(3);
 
-			data->m_indices[k + 3] = static_cast<u16>((i + 1) * n + j);
-			data->m_indices[k + 4] = static_cast<u16>(i * n + j + 1);
-			data->m_indices[k + 5] = static_cast<u16>((i + 1) * n + j + 1);
+        compute_mesh_bounds(data.get());
 
-			k += 6; // next quad
-		}
-	}
+        return data;
+    }
 
-    recalculate_normals(data->m_vertices.data(), data->m_vertices.size(), data->m_indices.data(), data->m_indices.size());
+    SharedPtr<PrimitiveMeshGeometryData> generate_plane(f32 width, f32 height, u32 width_segments, u32 height_segments)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
 
-    return data;
-}
+        data->m_type = PrimitiveMeshGeometryData::Type::Plane;
 
-SharedPtr<PrimitiveMeshGeometryData> create_box(f32 width, f32 height, f32 depth, u32 num_subdivisions)
-{
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+        u32 m = width_segments * 2;
+        u32 n = height_segments * 2;
 
-    data->m_type = PrimitiveMeshGeometryData::Type::Box;
+    	u32 vertex_count = m * n;
+    	u32 face_count   = (m - 1) * (n - 1) * 2;
 
-	MeshVertex v[24];
+    	//
+    	// Create the vertices.
+    	//
 
-	f32 w2 = 0.5f * width;
-	f32 h2 = 0.5f * height;
-	f32 d2 = 0.5f * depth;
-    
-	// Fill in the front face vertex data.
-	v[0] = {Vector3(-w2, -h2, -d2), Vector2(0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
-	v[1] = {Vector3(-w2, +h2, -d2), Vector2(0.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
-	v[2] = {Vector3(+w2, +h2, -d2), Vector2(1.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
-	v[3] = {Vector3(+w2, -h2, -d2), Vector2(1.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	f32 half_width = 0.5f * width;
+    	f32 half_height = 0.5f * height;
 
-	// Fill in the back face vertex data.
-	v[4] = {Vector3(-w2, -h2, +d2), Vector2(0.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
-	v[5] = {Vector3(+w2, -h2, +d2), Vector2(0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
-	v[6] = {Vector3(+w2, +h2, +d2), Vector2(1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
-	v[7] = {Vector3(-w2, +h2, +d2), Vector2(1.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	f32 dx = width / (n - 1);
+    	f32 dz = height / (m - 1);
 
-	// Fill in the top face vertex data.
-	v[8]  = {Vector3(-w2, +h2, -d2), Vector2(0.0f, 1.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
-	v[9]  = {Vector3(-w2, +h2, +d2), Vector2(0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
-	v[10] = {Vector3(+w2, +h2, +d2), Vector2(1.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
-	v[11] = {Vector3(+w2, +h2, -d2), Vector2(1.0f, 1.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	f32 du = 1.0f / (n - 1);
+    	f32 dv = 1.0f / (m - 1);
 
-	// Fill in the bottom face vertex data.
-	v[12] = {Vector3(-w2, -h2, -d2), Vector2(0.0f, 1.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
-	v[13] = {Vector3(+w2, -h2, -d2), Vector2(0.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
-	v[14] = {Vector3(+w2, -h2, +d2), Vector2(1.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
-	v[15] = {Vector3(-w2, -h2, +d2), Vector2(1.0f, 1.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	data->m_vertices.resize(vertex_count);
 
-	// Fill in the left face vertex data.
-	v[16] = {Vector3(-w2, -h2, +d2), Vector2(0.0f, 1.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
-	v[17] = {Vector3(-w2, +h2, +d2), Vector2(0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
-	v[18] = {Vector3(-w2, +h2, -d2), Vector2(1.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
-	v[19] = {Vector3(-w2, -h2, -d2), Vector2(1.0f, 1.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
+        for (u32 i = 0; i < m; ++i)
+    	{
+    		f32 z = half_height - i * dz;
 
-	// Fill in the right face vertex data.
-	v[20] = {Vector3(+w2, -h2, -d2), Vector2(0.0f, 1.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
-	v[21] = {Vector3(+w2, +h2, -d2), Vector2(0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
-	v[22] = {Vector3(+w2, +h2, +d2), Vector2(1.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
-	v[23] = {Vector3(+w2, -h2, +d2), Vector2(1.0f, 1.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
+    		for (u32 j = 0; j < n; ++j)
+    		{
+    			f32 x = -half_width + j * dx;
 
-	data->m_vertices.assign(&v[0], &v[24]);
- 
-	//
-	// Create the indices.
-	//
+    			data->m_vertices[i * n + j].position = Vector3(x, 0.0f, z);
+    			data->m_vertices[i * n + j].normal   = Vector3(0.0f, 1.0f, 0.0f);
+    			data->m_vertices[i * n + j].tangent  = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
 
-	u16 indices[36];
+    			// Stretch texture over grid.
+    			data->m_vertices[i * n + j].uv.x = j * du;
+    			data->m_vertices[i * n + j].uv.y = i * dv;
+    		}
+    	}
 
-	// Fill in the front face index data
-	indices[0] = 0; indices[1] = 1; indices[2] = 2;
-	indices[3] = 0; indices[4] = 2; indices[5] = 3;
+        //
+    	// Create the indices.
+    	//
 
-	// Fill in the back face index data
-	indices[6] = 4; indices[7]  = 5; indices[8]  = 6;
-	indices[9] = 4; indices[10] = 6; indices[11] = 7;
+    	data->m_indices.resize(face_count * 3); // 3 indices per face
 
-	// Fill in the top face index data
-	indices[12] = 8; indices[13] =  9; indices[14] = 10;
-	indices[15] = 8; indices[16] = 10; indices[17] = 11;
+    	// Iterate over each quad and compute indices.
+    	u32 k = 0;
+    	for (u32 i = 0; i < m - 1; ++i)
+    	{
+    		for (u32 j = 0; j < n - 1; ++j)
+    		{
+    			data->m_indices[k]     = static_cast<u16>(i * n + j);
+    			data->m_indices[k + 1] = static_cast<u16>(i * n + j + 1);
+    			data->m_indices[k + 2] = static_cast<u16>((i + 1) * n + j);
 
-	// Fill in the bottom face index data
-	indices[18] = 12; indices[19] = 13; indices[20] = 14;
-	indices[21] = 12; indices[22] = 14; indices[23] = 15;
+    			data->m_indices[k + 3] = static_cast<u16>((i + 1) * n + j);
+    			data->m_indices[k + 4] = static_cast<u16>(i * n + j + 1);
+    			data->m_indices[k + 5] = static_cast<u16>((i + 1) * n + j + 1);
 
-	// Fill in the left face index data
-	indices[24] = 16; indices[25] = 17; indices[26] = 18;
-	indices[27] = 16; indices[28] = 18; indices[29] = 19;
+    			k += 6; // next quad
+    		}
+    	}
 
-	// Fill in the right face index data
-	indices[30] = 20; indices[31] = 21; indices[32] = 22;
-	indices[33] = 20; indices[34] = 22; indices[35] = 23;
+        recalculate_normals(data->m_vertices.data(), data->m_vertices.size(), data->m_indices.data(), data->m_indices.size());
 
-	data->m_indices.assign(&indices[0], &indices[36]);
+        optimize_mesh(data.get());
+        compute_mesh_bounds(data.get());
 
-    // Put a cap on the number of subdivisions.
-    // num_subdivisions = ZV::min(num_subdivisions, 6u);
+        return data;
+    }
 
-    for (u32 i = 0; i < num_subdivisions; ++i)
+    SharedPtr<PrimitiveMeshGeometryData> generate_box(f32 width, f32 height, f32 depth, u32 num_subdivisions)
     {
-        subdivide(*data.get());
-    }
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
 
-    return data;
-}
+        data->m_type = PrimitiveMeshGeometryData::Type::Box;
 
-SharedPtr<PrimitiveMeshGeometryData> create_sphere(f32 radius, u32 width_segments, u32 height_segments)
-{
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
-
-    data->m_type = PrimitiveMeshGeometryData::Type::Sphere;
-
-	//
-	// Compute the vertices stating at the top pole and moving down the stacks.
-	//
-
-	// Poles: note that there will be texture coordinate distortion as there is
-	// not a unique point on the texture map to assign to the pole when mapping
-	// a rectangular texture onto a sphere.
-	MeshVertex top_vertex = {Vector3(0.0f, +radius, 0.0f), Vector2(0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f)};
-	MeshVertex bottom_vertex = {Vector3(0.0f, -radius, 0.0f), Vector2(0.0f, 1.0f), Vector3(0.0f, -1.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f)};
-
-	data->m_vertices.push_back(top_vertex);
-
-    f32 phi_step   = ZV_PI / height_segments;
-    float theta_step = 2.0f * ZV_PI / width_segments;
-
-	// Compute vertices for each stack ring (do not count the poles as rings).
-	for (u32 i = 1; i <= height_segments - 1; ++i)
-	{
-		f32 phi = i * phi_step;
-
-		// Vertices of ring.
-        for(u32 j = 0; j <= width_segments; ++j)
-		{
-			f32 theta = j * theta_step;
-
-			MeshVertex v;
-
-			// spherical to cartesian
-			v.position.x = radius * ZV::sin(phi) * ZV::cos(theta);
-			v.position.y = radius * ZV::cos(phi);
-			v.position.z = radius * ZV::sin(phi) * ZV::sin(theta);
-
-			// Partial derivative of P with respect to theta
-			v.tangent.x = -radius * ZV::sin(phi) * ZV::sin(theta);
-			v.tangent.y = 0.0f;
-			v.tangent.z = +radius * ZV::sin(phi) * ZV::cos(theta);
-            v.tangent.w = 1.0f;
-			v.tangent.Normalize();
-
-            Vector3 p = v.position;
-			v.normal = p;
-			v.normal.Normalize();
-
-			v.uv.x = theta / ZV_2PI;
-			v.uv.y = phi / ZV_PI;
-
-			data->m_vertices.push_back(v);
-		}
-	}
-
-	data->m_vertices.push_back(bottom_vertex);
-
-	//
-	// Compute indices for top stack.  The top stack was written first to the vertex buffer
-	// and connects the top pole to the first ring.
-	//
-
-    for (u32 i = 1; i <= width_segments; ++i)
-	{
-		data->m_indices.push_back(static_cast<u16>(0));
-		data->m_indices.push_back(static_cast<u16>(i + 1));
-		data->m_indices.push_back(static_cast<u16>(i));
-	}
-	
-	//
-	// Compute indices for inner stacks (not connected to poles).
-	//
-
-	// Offset the indices to the index of the first vertex in the first ring.
-	// This is just skipping the top pole vertex.
-    u32 base_index = 1;
-    u32 ring_vertex_count = width_segments + 1;
-	for (u32 i = 0; i < height_segments-2; ++i)
-	{
-		for (u32 j = 0; j < width_segments; ++j)
-		{
-			data->m_indices.push_back(static_cast<u16>(base_index + i * ring_vertex_count + j));
-			data->m_indices.push_back(static_cast<u16>(base_index + i * ring_vertex_count + j + 1));
-			data->m_indices.push_back(static_cast<u16>(base_index + (i + 1) * ring_vertex_count + j));
-
-			data->m_indices.push_back(static_cast<u16>(base_index + (i + 1) * ring_vertex_count + j));
-			data->m_indices.push_back(static_cast<u16>(base_index + i * ring_vertex_count + j + 1));
-			data->m_indices.push_back(static_cast<u16>(base_index + (i + 1) * ring_vertex_count + j+1));
-		}
-	}
-
-	//
-	// Compute indices for bottom stack.  The bottom stack was written last to the vertex buffer
-	// and connects the bottom pole to the bottom ring.
-	//
-
-	// South pole vertex was added last.
-	u32 south_pole_index = static_cast<u32>(data->m_vertices.size()-1);
-
-	// Offset the indices to the index of the first vertex in the last ring.
-	base_index = south_pole_index - ring_vertex_count;
-	
-	for (u32 i = 0; i < width_segments; ++i)
-	{
-		data->m_indices.push_back(static_cast<u16>(south_pole_index));
-		data->m_indices.push_back(static_cast<u16>(base_index + i));
-		data->m_indices.push_back(static_cast<u16>(base_index + i + 1));
-	}
-
-    return data;
-}
+    	MeshVertex v[24];
 
-SharedPtr<PrimitiveMeshGeometryData> create_icosphere(f32 radius, u32 num_subdivisions)
-{
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+    	f32 w2 = 0.5f * width;
+    	f32 h2 = 0.5f * height;
+    	f32 d2 = 0.5f * depth;
 
-    data->m_type = PrimitiveMeshGeometryData::Type::Icosphere;
+    	// Fill in the front face vertex data.
+    	v[0] = {Vector3(-w2, -h2, -d2), Vector2(0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[1] = {Vector3(-w2, +h2, -d2), Vector2(0.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[2] = {Vector3(+w2, +h2, -d2), Vector2(1.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[3] = {Vector3(+w2, -h2, -d2), Vector2(1.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
 
-    // Put a cap on the number of subdivisions.
-    // num_subdivisions = ZV::min<u32>(num_subdivisions, 6u);
+    	// Fill in the back face vertex data.
+    	v[4] = {Vector3(-w2, -h2, +d2), Vector2(0.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[5] = {Vector3(+w2, -h2, +d2), Vector2(0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[6] = {Vector3(+w2, +h2, +d2), Vector2(1.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[7] = {Vector3(-w2, +h2, +d2), Vector2(1.0f, 1.0f), Vector3(0.0f, 0.0f, 1.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
 
-    // Approximate a sphere by tessellating an icosahedron.
+    	// Fill in the top face vertex data.
+    	v[8]  = {Vector3(-w2, +h2, -d2), Vector2(0.0f, 1.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[9]  = {Vector3(-w2, +h2, +d2), Vector2(0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[10] = {Vector3(+w2, +h2, +d2), Vector2(1.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[11] = {Vector3(+w2, +h2, -d2), Vector2(1.0f, 1.0f), Vector3(0.0f, 1.0f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 1.0f)};
 
-    const f32 X = 0.525731f; 
-    const f32 Z = 0.850651f;
+    	// Fill in the bottom face vertex data.
+    	v[12] = {Vector3(-w2, -h2, -d2), Vector2(0.0f, 1.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[13] = {Vector3(+w2, -h2, -d2), Vector2(0.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[14] = {Vector3(+w2, -h2, +d2), Vector2(1.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
+    	v[15] = {Vector3(-w2, -h2, +d2), Vector2(1.0f, 1.0f), Vector3(0.0f, -1.0f, 0.0f), Vector4(-1.0f, 0.0f, 0.0f, 1.0f)};
 
-    Vector3 pos[12] = 
-    {
-        Vector3(-X, 0.0f, Z),  Vector3(X, 0.0f, Z),  
-        Vector3(-X, 0.0f, -Z), Vector3(X, 0.0f, -Z),    
-        Vector3(0.0f, Z, X),   Vector3(0.0f, Z, -X), 
-        Vector3(0.0f, -Z, X),  Vector3(0.0f, -Z, -X),    
-        Vector3(Z, X, 0.0f),   Vector3(-Z, X, 0.0f), 
-        Vector3(Z, -X, 0.0f),  Vector3(-Z, -X, 0.0f)
-    };
+    	// Fill in the left face vertex data.
+    	v[16] = {Vector3(-w2, -h2, +d2), Vector2(0.0f, 1.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
+    	v[17] = {Vector3(-w2, +h2, +d2), Vector2(0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
+    	v[18] = {Vector3(-w2, +h2, -d2), Vector2(1.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
+    	v[19] = {Vector3(-w2, -h2, -d2), Vector2(1.0f, 1.0f), Vector3(-1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, -1.0f, 1.0f)};
 
-    u16 k[60] =
-    {
-        1,4,0,  4,9,0,  4,5,9,  8,5,4,  1,8,4,    
-        1,10,8, 10,3,8, 8,3,5,  3,2,5,  3,7,2,    
-        3,10,7, 10,6,7, 6,11,7, 6,0,11, 6,1,0, 
-        10,1,6, 11,0,9, 2,11,9, 5,2,9,  11,2,7 
-    };
+    	// Fill in the right face vertex data.
+    	v[20] = {Vector3(+w2, -h2, -d2), Vector2(0.0f, 1.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
+    	v[21] = {Vector3(+w2, +h2, -d2), Vector2(0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
+    	v[22] = {Vector3(+w2, +h2, +d2), Vector2(1.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
+    	v[23] = {Vector3(+w2, -h2, +d2), Vector2(1.0f, 1.0f), Vector3(1.0f, 0.0f, 0.0f), Vector4(0.0f, 0.0f, 1.0f, 1.0f)};
 
-    data->m_vertices.resize(12);
-    data->m_indices.assign(&k[0], &k[60]);
+    	data->m_vertices.assign(&v[0], &v[24]);
 
-    for (u32 i = 0; i < 12; ++i)
-    {
-        data->m_vertices[i].position = pos[i];
+    	//
+    	// Create the indices.
+    	//
+
+    	u16 indices[36];
+
+    	// Fill in the front face index data
+    	indices[0] = 0; indices[1] = 1; indices[2] = 2;
+    	indices[3] = 0; indices[4] = 2; indices[5] = 3;
+
+    	// Fill in the back face index data
+    	indices[6] = 4; indices[7]  = 5; indices[8]  = 6;
+    	indices[9] = 4; indices[10] = 6; indices[11] = 7;
+
+    	// Fill in the top face index data
+    	indices[12] = 8; indices[13] =  9; indices[14] = 10;
+    	indices[15] = 8; indices[16] = 10; indices[17] = 11;
+
+    	// Fill in the bottom face index data
+    	indices[18] = 12; indices[19] = 13; indices[20] = 14;
+    	indices[21] = 12; indices[22] = 14; indices[23] = 15;
+
+    	// Fill in the left face index data
+    	indices[24] = 16; indices[25] = 17; indices[26] = 18;
+    	indices[27] = 16; indices[28] = 18; indices[29] = 19;
+
+    	// Fill in the right face index data
+    	indices[30] = 20; indices[31] = 21; indices[32] = 22;
+    	indices[33] = 20; indices[34] = 22; indices[35] = 23;
+
+    	data->m_indices.assign(&indices[0], &indices[36]);
+
+        // Put a cap on the number of subdivisions.
+        // num_subdivisions = ZV::min(num_subdivisions, 6u);
+
+        for (u32 i = 0; i < num_subdivisions; ++i)
+        {
+            subdivide(*data.get());
+        }
+
+        optimize_mesh(data.get());
+        compute_mesh_bounds(data.get());
+
+        return data;
     }
 
-    for (u32 i = 0; i < num_subdivisions; ++i)
+    SharedPtr<PrimitiveMeshGeometryData> generate_sphere(f32 radius, u32 width_segments, u32 height_segments)
     {
-        subdivide(*data.get());
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+
+        data->m_type = PrimitiveMeshGeometryData::Type::Sphere;
+
+        // Two poles plus the inner rings, a fan of width_segments triangles at each pole and two per quad in between
+        const u32 ring_vertex_count = width_segments + 1;
+        PrimitiveSize size{};
+        size.m_num_vertices = 2 + (height_segments - 1) * ring_vertex_count;
+        size.m_num_indices = width_segments * 6 + (height_segments - 2) * width_segments * 6;
+
+        GeometryWriter writer = begin_geometry(*data.get(), size);
+
+        const RingAngles angles = make_ring_angles(width_segments);
+
+    	//
+    	// Compute the vertices stating at the top pole and moving down the stacks.
+    	//
+
+    	// Poles: note that there will be texture coordinate distortion as there is
+    	// not a unique point on the texture map to assign to the pole when mapping
+    	// a rectangular texture onto a sphere.
+    	MeshVertex top_vertex = {Vector3(0.0f, +radius, 0.0f), Vector2(0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f)};
+    	MeshVertex bottom_vertex = {Vector3(0.0f, -radius, 0.0f), Vector2(0.0f, 1.0f), Vector3(0.0f, -1.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f)};
+
+    	writer.add_vertex(top_vertex);
+
+        f32 phi_step = ZV_PI / height_segments;
+
+    	// Compute vertices for each stack ring (do not count the poles as rings).
+    	for (u32 i = 1; i <= height_segments - 1; ++i)
+    	{
+    		const f32 phi = i * phi_step;
+    		const f32 sin_phi = ZV::sin(phi);
+    		const f32 cos_phi = ZV::cos(phi);
+
+    		// Vertices of ring.
+            for (u32 j = 0; j <= width_segments; ++j)
+    		{
+    			const f32 cos_theta = angles.get_cos(j);
+    			const f32 sin_theta = angles.get_sin(j);
+
+    			MeshVertex v;
+
+    			// spherical to cartesian
+    			v.position.x = radius * sin_phi * cos_theta;
+    			v.position.y = radius * cos_phi;
+    			v.position.z = radius * sin_phi * sin_theta;
+
+    			// Partial derivative of P with respect to theta
+    			v.tangent.x = -radius * sin_phi * sin_theta;
+    			v.tangent.y = 0.0f;
+    			v.tangent.z = +radius * sin_phi * cos_theta;
+                v.tangent.w = 1.0f;
+    			v.tangent.Normalize();
+
+    			// Unit sphere direction, the same as normalizing the position
+    			v.normal = Vector3(sin_phi * cos_theta, cos_phi, sin_phi * sin_theta);
+
+    			v.uv.x = static_cast<f32>(j) / width_segments;
+    			v.uv.y = phi / ZV_PI;
+
+    			writer.add_vertex(v);
+    		}
+    	}
+
+    	writer.add_vertex(bottom_vertex);
+
+    	//
+    	// Compute indices for top stack.  The top stack was written first to the vertex buffer
+    	// and connects the top pole to the first ring.
+    	//
+
+        for (u32 i = 1; i <= width_segments; ++i)
+    	{
+    		writer.add_triangle(0, i + 1, i);
+    	}
+
+    	//
+    	// Compute indices for inner stacks (not connected to poles).
+    	//
+
+    	// Offset the indices to the index of the first vertex in the first ring.
+    	// This is just skipping the top pole vertex.
+        u32 base_index = 1;
+    	for (u32 i = 0; i < height_segments-2; ++i)
+    	{
+    		for (u32 j = 0; j < width_segments; ++j)
+    		{
+    			writer.add_triangle(
+    				base_index + i * ring_vertex_count + j,
+    				base_index + i * ring_vertex_count + j + 1,
+    				base_index + (i + 1) * ring_vertex_count + j);
+
+    			writer.add_triangle(
+    				base_index + (i + 1) * ring_vertex_count + j,
+    				base_index + i * ring_vertex_count + j + 1,
+    				base_index + (i + 1) * ring_vertex_count + j + 1);
+    		}
+    	}
+
+    	//
+    	// Compute indices for bottom stack.  The bottom stack was written last to the vertex buffer
+    	// and connects the bottom pole to the bottom ring.
+    	//
+
+    	// South pole vertex was added last.
+    	u32 south_pole_index = writer.m_num_vertices - 1;
+
+    	// Offset the indices to the index of the first vertex in the last ring.
+    	base_index = south_pole_index - ring_vertex_count;
+
+    	for (u32 i = 0; i < width_segments; ++i)
+    	{
+    		writer.add_triangle(south_pole_index, base_index + i, base_index + i + 1);
+    	}
+
+        end_geometry(*data.get(), writer);
+
+        optimize_mesh(data.get());
+        compute_mesh_bounds(data.get());
+
+        return data;
     }
 
-    // Project vertices onto sphere and scale.
-    for (u32 i = 0; i < data->m_vertices.size(); ++i)
+    SharedPtr<PrimitiveMeshGeometryData> generate_icosphere(f32 radius, u32 num_subdivisions)
     {
-        // Project onto unit sphere.
-        Vector3 n = Vector3(data->m_vertices[i].position);
-        n.Normalize();
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+
+        data->m_type = PrimitiveMeshGeometryData::Type::Icosphere;
+
+        // Seven subdivisions would need 163842 vertices, more than 16 bit indices can address
+        zv_assert_msg(num_subdivisions <= 6, "Icosphere subdivisions are limited to 6, got {}", num_subdivisions);
+        num_subdivisions = ZV::min(num_subdivisions, 6u);
+
+        // Approximate a sphere by tessellating an icosahedron.
 
-        // Project onto sphere.
-        Vector3 p = radius * n;
+        const f32 X = 0.525731f; 
+        const f32 Z = 0.850651f;
 
-        data->m_vertices[i].position = p;
-        data->m_vertices[i].normal = n;
+        Vector3 pos[12] = 
+        {
+            Vector3(-X, 0.0f, Z),  Vector3(X, 0.0f, Z),  
+            Vector3(-X, 0.0f, -Z), Vector3(X, 0.0f, -Z),    
+            Vector3(0.0f, Z, X),   Vector3(0.0f, Z, -X), 
+            Vector3(0.0f, -Z, X),  Vector3(0.0f, -Z, -X),    
+            Vector3(Z, X, 0.0f),   Vector3(-Z, X, 0.0f), 
+            Vector3(Z, -X, 0.0f),  Vector3(-Z, -X, 0.0f)
+        };
+
+        u16 k[60] =
+        {
+            1,4,0,  4,9,0,  4,5,9,  8,5,4,  1,8,4,    
+            1,10,8, 10,3,8, 8,3,5,  3,2,5,  3,7,2,    
+            3,10,7, 10,6,7, 6,11,7, 6,0,11, 6,1,0, 
+            10,1,6, 11,0,9, 2,11,9, 5,2,9,  11,2,7 
+        };
+
+        data->m_vertices.resize(12);
+        data->m_indices.assign(&k[0], &k[60]);
+
+        for (u32 i = 0; i < 12; ++i)
+        {
+            data->m_vertices[i].position = pos[i];
+        }
+
+        for (u32 i = 0; i < num_subdivisions; ++i)
+        {
+            subdivide(*data.get());
+        }
 
-        // Derive texture coordinates from spherical coordinates.
-        f32 theta = atan2f(data->m_vertices[i].position.z, data->m_vertices[i].position.x);
+        // Every subdivision of the closed icosahedron adds one vertex per edge
+        zv_assert_msg(data->m_vertices.size() == 10u * (1u << (2 * num_subdivisions)) + 2u, "Icosphere has {} vertices, expected 10 * 4^{} + 2", data->m_vertices.size(), num_subdivisions);
+        zv_assert_msg(data->m_indices.size() == 60u * (1u << (2 * num_subdivisions)), "Icosphere has {} indices, expected 60 * 4^{}", data->m_indices.size(), num_subdivisions);
 
-        // Put in [0, 2pi].
-        if (theta < 0.0f)
+        // Project vertices onto sphere and scale.
+        for (u32 i = 0; i < data->m_vertices.size(); ++i)
         {
-            theta += ZV_2PI;
+            // Project onto unit sphere.
+            Vector3 n = Vector3(data->m_vertices[i].position);
+            n.Normalize();
+
+            // Project onto sphere.
+            Vector3 p = radius * n;
+
+            data->m_vertices[i].position = p;
+            data->m_vertices[i].normal = n;
+
+            // Derive texture coordinates from spherical coordinates.
+            f32 theta = atan2f(data->m_vertices[i].position.z, data->m_vertices[i].position.x);
+
+            // Put in [0, 2pi].
+            if (theta < 0.0f)
+            {
+                theta += ZV_2PI;
+            }
+
+            f32 phi = acosf(data->m_vertices[i].position.y / radius);
+
+            data->m_vertices[i].uv.x = theta / ZV_2PI;
+            data->m_vertices[i].uv.y = phi / ZV_PI;
+
+            // Partial derivative of P with respect to theta
+            data->m_vertices[i].tangent.x = -radius*ZV::sin(phi)*ZV::sin(theta);
+            data->m_vertices[i].tangent.y = 0.0f;
+            data->m_vertices[i].tangent.z = +radius*ZV::sin(phi)*ZV::cos(theta);
+            data->m_vertices[i].tangent.w = 1.0f;
+            data->m_vertices[i].tangent.Normalize();
         }
 
-        f32 phi = acosf(data->m_vertices[i].position.y / radius);
+        optimize_mesh(data.get());
+        compute_mesh_bounds(data.get());
+
+        return data;
+    }
+
+    SharedPtr<PrimitiveMeshGeometryData> generate_cylinder(f32 bottom_radius, f32 top_radius, f32 height, u32 radial_segments, u32 height_segments)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+
+        data->m_type = PrimitiveMeshGeometryData::Type::Cylinder;
+
+        const PrimitiveSize size = get_cylinder_side_size(radial_segments, height_segments) + get_cylinder_cap_size(radial_segments) + get_cylinder_cap_size(radial_segments);
+        GeometryWriter writer = begin_geometry(*data.get(), size);
 
-        data->m_vertices[i].uv.x = theta / ZV_2PI;
-        data->m_vertices[i].uv.y = phi / ZV_PI;
+        // Side and caps share the same ring angles
+        const RingAngles angles = make_ring_angles(radial_segments);
 
-        // Partial derivative of P with respect to theta
-        data->m_vertices[i].tangent.x = -radius*ZV::sin(phi)*ZV::sin(theta);
-        data->m_vertices[i].tangent.y = 0.0f;
-        data->m_vertices[i].tangent.z = +radius*ZV::sin(phi)*ZV::cos(theta);
-        data->m_vertices[i].tangent.w = 1.0f;
-        data->m_vertices[i].tangent.Normalize();
+        build_cylinder_side(bottom_radius, top_radius, height, radial_segments, height_segments, angles, writer);
+
+    	build_cylinder_top_cap(top_radius, height, radial_segments, angles, writer);
+    	build_cylinder_bottom_cap(bottom_radius, height, radial_segments, angles, writer);
+
+        end_geometry(*data.get(), writer);
+
+        optimize_mesh(data.get());
+        compute_mesh_bounds(data.get());
+
+        return data;
     }
 
-    return data;
+    SharedPtr<PrimitiveMeshGeometryData> generate_capsule(f32 radius, f32 height, u32 radial_segments, u32 height_segments, u32 cap_segments)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+
+        data->m_type = PrimitiveMeshGeometryData::Type::Capsule;
+
+        const PrimitiveSize size = get_cylinder_side_size(radial_segments, height_segments) + get_capsule_cap_size(radial_segments, cap_segments) + get_capsule_cap_size(radial_segments, cap_segments);
+        GeometryWriter writer = begin_geometry(*data.get(), size);
+
+        const RingAngles angles = make_ring_angles(radial_segments);
+
+        build_cylinder_side(radius, radius, height, radial_segments, height_segments, angles, writer);
+
+        build_capsule_top_cap(radius, height, radial_segments, cap_segments, angles, writer);
+        build_capsule_bottom_cap(radius, height, radial_segments, cap_segments, angles, writer);
+
+        end_geometry(*data.get(), writer);
+
+        optimize_mesh(data.get());
+        compute_mesh_bounds(data.get());
+
+        return data;
+    }
 }
 
-SharedPtr<PrimitiveMeshGeometryData> create_cylinder(f32 bottom_radius, f32 top_radius, f32 height, u32 radial_segments, u32 height_segments)
+SharedPtr<PrimitiveMeshGeometryData> create_triangle(Vector3 p1, Vector3 p2, Vector3 p3)
 {
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Triangle, { p1.x, p1.y, p1.z, p2.x, p2.y, p2.z, p3.x, p3.y, p3.z });
+    return get_or_generate_primitive(key, [&]() { return generate_triangle(p1, p2, p3); });
+}
+
+SharedPtr<PrimitiveMeshGeometryData> create_quad(f32 width, f32 height)
+{
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Quad, { width, height });
+    return get_or_generate_primitive(key, [&]() { return generate_quad(width, height); });
+}
+
+SharedPtr<PrimitiveMeshGeometryData> create_plane(f32 width, f32 height, u32 width_segments, u32 height_segments)
+{
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Plane, { width, height, static_cast<f32>(width_segments), static_cast<f32>(height_segments) });
+    return get_or_generate_primitive(key, [&]() { return generate_plane(width, height, width_segments, height_segments); });
+}
 
-    data->m_type = PrimitiveMeshGeometryData::Type::Cylinder;
+SharedPtr<PrimitiveMeshGeometryData> create_box(f32 width, f32 height, f32 depth, u32 num_subdivisions)
+{
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Box, { width, height, depth, static_cast<f32>(num_subdivisions) });
+    return get_or_generate_primitive(key, [&]() { return generate_box(width, height, depth, num_subdivisions); });
+}
 
-    build_cylinder_side(bottom_radius, top_radius, height, radial_segments, height_segments, *data.get());
+SharedPtr<PrimitiveMeshGeometryData> create_sphere(f32 radius, u32 width_segments, u32 height_segments)
+{
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Sphere, { radius, static_cast<f32>(width_segments), static_cast<f32>(height_segments) });
+    return get_or_generate_primitive(key, [&]() { return generate_sphere(radius, width_segments, height_segments); });
+}
 
-	build_cylinder_top_cap(top_radius, height, radial_segments, *data.get());
-	build_cylinder_bottom_cap(bottom_radius, height, radial_segments, *data.get());
+SharedPtr<PrimitiveMeshGeometryData> create_icosphere(f32 radius, u32 num_subdivisions)
+{
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Icosphere, { radius, static_cast<f32>(num_subdivisions) });
+    return get_or_generate_primitive(key, [&]() { return generate_icosphere(radius, num_subdivisions); });
+}
 
-    return data;
+SharedPtr<PrimitiveMeshGeometryData> create_cylinder(f32 bottom_radius, f32 top_radius, f32 height, u32 radial_segments, u32 height_segments)
+{
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Cylinder, { bottom_radius, top_radius, height, static_cast<f32>(radial_segments), static_cast<f32>(height_segments) });
+    return get_or_generate_primitive(key, [&]() { return generate_cylinder(bottom_radius, top_radius, height, radial_segments, height_segments); });
 }
 
 SharedPtr<PrimitiveMeshGeometryData> create_capsule(f32 radius, f32 height, u32 radial_segments, u32 height_segments, u32 cap_segments)
 {
-    SharedPtr<PrimitiveMeshGeometryData> data = make_shared_ptr<PrimitiveMeshGeometryData>();
+    const PrimitiveGeometryKey key = make_primitive_geometry_key(PrimitiveMeshGeometryData::Type::Capsule, { radius, height, static_cast<f32>(radial_segments), static_cast<f32>(height_segments), static_cast<f32>(cap_segments) });
+    return get_or_generate_primitive(key, [&]() { return generate_capsule(radius, height, radial_segments, height_segments, cap_segments); });
+}
+
+PrimitiveGeometryCacheStats get_primitive_geometry_cache_stats()
+{
+    PrimitiveGeometryCache& cache = s_primitive_geometry_cache;
+    ScopedLock lock_guard(cache.m_mutex);
+
+    PrimitiveGeometryCacheStats stats{};
+    stats.m_num_hits = cache.m_num_hits;
+    stats.m_num_misses = cache.m_num_misses;
 
-    data->m_type = PrimitiveMeshGeometryData::Type::Capsule;
+    for (const auto& entry : cache.m_entries)
+    {
+        stats.m_num_live += entry.second.expired() ? 0 : 1;
+    }
 
-    build_cylinder_side(radius, radius, height, radial_segments, height_segments, *data.get());
+    return stats;
+}
 
-    build_capsule_top_cap(radius, height, radial_segments, cap_segments, *data.get());
-    build_capsule_bottom_cap(radius, height, radial_segments, cap_segments, *data.get());
+namespace
+{
+    constexpr u32 k_normal_batch_size = 1024;
 
-    return data;
+    // Lists the corners of each vertex, corners of vertex v are out_corners[out_offsets[v]..out_offsets[v + 1]] in index
+    // order. The counts are summed into the end of each vertex's list, filling backwards moves them to its start.
+    void build_vertex_corners(const u16* indices, size_t num_indices, size_t num_vertices, DynamicArray<u32>* out_offsets, DynamicArray<u32>* out_corners)
+    {
+        DynamicArray<u32>& offsets = *out_offsets;
+        offsets.assign(num_vertices + 1, 0);
+        for (size_t i = 0; i < num_indices; i++)
+        {
+            offsets[indices[i]]++;
+        }
+        for (size_t vertex = 1; vertex < num_vertices; vertex++)
+        {
+            offsets[vertex] += offsets[vertex - 1];
+        }
+        offsets[num_vertices] = static_cast<u32>(num_indices);
+
+        out_corners->resize(num_indices);
+        for (size_t i = num_indices; i-- > 0;)
+        {
+            (*out_corners)[--offsets[indices[i]]] = static_cast<u32>(i);
+        }
+    }
+
+#if ZV_ARCH_X64
+    using Float4 = __m128;
+
+    inline Float4 f4_set(f32 a, f32 b, f32 c, f32 d) { return _mm_setr_ps(a, b, c, d); }
+    inline Float4 f4_splat(f32 value) { return _mm_set1_ps(value); }
+    inline void f4_store(f32* dst, Float4 value) { _mm_storeu_ps(dst, value); }
+    inline Float4 f4_add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 f4_sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 f4_mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 f4_sqrt(Float4 a) { return _mm_sqrt_ps(a); }
+#else
+    struct Float4 { f32 v[4]; };
+
+    inline Float4 f4_set(f32 a, f32 b, f32 c, f32 d) { return Float4{ { a, b, c, d } }; }
+    inline Float4 f4_splat(f32 value) { return Float4{ { value, value, value, value } }; }
+    inline void f4_store(f32* dst, Float4 value) { memcpy(dst, value.v, sizeof(value.v)); }
+    inline Float4 f4_add(Float4 a, Float4 b) { return Float4{ { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+    inline Float4 f4_sub(Float4 a, Float4 b) { return Float4{ { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+    inline Float4 f4_mul(Float4 a, Float4 b) { return Float4{ { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+    inline Float4 f4_sqrt(Float4 a) { return Float4{ { sqrtf(a.v[0]), sqrtf(a.v[1]), sqrtf(a.v[2]), sqrtf(a.v[3]) } }; }
+#endif
+
+    // Four lanes of 3D vectors, one triangle per lane
+    struct Vector3x4
+    {
+        Float4 x;
+        Float4 y;
+        Float4 z;
+    };
+
+    inline Vector3x4 sub(const Vector3x4& a, const Vector3x4& b) { return { f4_sub(a.x, b.x), f4_sub(a.y, b.y), f4_sub(a.z, b.z) }; }
+    inline Float4 dot(const Vector3x4& a, const Vector3x4& b) { return f4_add(f4_add(f4_mul(a.x, b.x), f4_mul(a.y, b.y)), f4_mul(a.z, b.z)); }
+
+    inline Vector3x4 cross(const Vector3x4& a, const Vector3x4& b)
+    {
+        return {
+            f4_sub(f4_mul(a.y, b.z), f4_mul(a.z, b.y)),
+            f4_sub(f4_mul(a.z, b.x), f4_mul(a.x, b.z)),
+            f4_sub(f4_mul(a.x, b.y), f4_mul(a.y, b.x)) };
+    }
+
+    struct NormalContext
+    {
+        MeshVertex* m_vertices = nullptr;
+        const u16* m_indices = nullptr;
+        u32 m_num_vertices = 0;
+        u32 m_num_triangles = 0;
+        NormalWeighting m_weighting = NormalWeighting::Area;
+
+        // Positions gathered into separate streams, the triangle loop loads four triangles' corners from them
+        DynamicArray<f32> m_position_x;
+        DynamicArray<f32> m_position_y;
+        DynamicArray<f32> m_position_z;
+
+        // One face normal per triangle, padded to whole groups of four. Area weighted, or unit length with the corner
+        // angles next to it.
+        DynamicArray<f32> m_face_x;
+        DynamicArray<f32> m_face_y;
+        DynamicArray<f32> m_face_z;
+        StaticArray<DynamicArray<f32>, 3> m_corner_angles;
+
+        DynamicArray<u32> m_corner_offsets;  // See build_vertex_corners
+        DynamicArray<u32> m_vertex_corners;
+    };
+
+    PARALLEL_FOR_CALLBACK(gather_positions_job)
+    {
+        NormalContext& context = *static_cast<NormalContext*>(data);
+
+        for (u32 vertex = begin; vertex < end; vertex++)
+        {
+            const Vector3& position = context.m_vertices[vertex].position;
+            context.m_position_x[vertex] = position.x;
+            context.m_position_y[vertex] = position.y;
+            context.m_position_z[vertex] = position.z;
+        }
+    }
+
+    inline Vector3x4 gather_positions(const NormalContext& context, const StaticArray<u16, 4>& vertices)
+    {
+        return {
+            f4_set(context.m_position_x[vertices[0]], context.m_position_x[vertices[1]], context.m_position_x[vertices[2]], context.m_position_x[vertices[3]]),
+            f4_set(context.m_position_y[vertices[0]], context.m_position_y[vertices[1]], context.m_position_y[vertices[2]], context.m_position_y[vertices[3]]),
+            f4_set(context.m_position_z[vertices[0]], context.m_position_z[vertices[1]], context.m_position_z[vertices[2]], context.m_position_z[vertices[3]]) };
+    }
+
+    // Angle between the edges at each lane's corner, the lanes are stored to compute acos one by one
+    inline void get_corner_angles(const Vector3x4& edge1, const Vector3x4& edge2, f32* out_angles)
+    {
+        StaticArray<f32, 4> cosines{};
+        StaticArray<f32, 4> length_products{};
+        f4_store(cosines.data(), dot(edge1, edge2));
+        f4_store(length_products.data(), f4_sqrt(f4_mul(dot(edge1, edge1), dot(edge2, edge2))));
+
+        for (u32 lane = 0; lane < 4; lane++)
+        {
+            out_angles[lane] = length_products[lane] > 0.0f ? acosf(ZV::min(ZV::max(cosines[lane] / length_products[lane], -1.0f), 1.0f)) : 0.0f;
+        }
+    }
+
+    // Face normals four triangles at a time, batches start on a multiple of four. The last group repeats its final
+    // triangle in the unused lanes and writes them into the padding.
+    PARALLEL_FOR_CALLBACK(face_normals_job)
+    {
+        NormalContext& context = *static_cast<NormalContext*>(data);
+
+        for (u32 first_triangle = begin; first_triangle < end; first_triangle += 4)
+        {
+            StaticArray<StaticArray<u16, 4>, 3> corners{};
+            for (u32 lane = 0; lane < 4; lane++)
+            {
+                const u16* tri = context.m_indices + ZV::min(first_triangle + lane, context.m_num_triangles - 1) * 3;
+                corners[0][lane] = tri[0];
+                corners[1][lane] = tri[1];
+                corners[2][lane] = tri[2];
+            }
+
+            const Vector3x4 a = gather_positions(context, corners[0]);
+            const Vector3x4 b = gather_positions(context, corners[1]);
+            const Vector3x4 c = gather_positions(context, corners[2]);
+
+            const Vector3x4 ab = sub(b, a);
+            const Vector3x4 ac = sub(c, a);
+            Vector3x4 normal = cross(ab, ac);  // Length is twice the triangle's area
+
+            if (context.m_weighting == NormalWeighting::Angle)
+            {
+                get_corner_angles(ab, ac, context.m_corner_angles[0].data() + first_triangle);
+                get_corner_angles(sub(c, b), sub(a, b), context.m_corner_angles[1].data() + first_triangle);
+                get_corner_angles(sub(a, c), sub(b, c), context.m_corner_angles[2].data() + first_triangle);
+
+                // Degenerate triangles have zero angles and add nothing
+                StaticArray<f32, 4> lengths{};
+                f4_store(lengths.data(), f4_sqrt(dot(normal, normal)));
+                const Float4 scale = f4_set(
+                    lengths[0] > 0.0f ? 1.0f / lengths[0] : 0.0f, lengths[1] > 0.0f ? 1.0f / lengths[1] : 0.0f,
+                    lengths[2] > 0.0f ? 1.0f / lengths[2] : 0.0f, lengths[3] > 0.0f ? 1.0f / lengths[3] : 0.0f);
+                normal = { f4_mul(normal.x, scale), f4_mul(normal.y, scale), f4_mul(normal.z, scale) };
+            }
+
+            f4_store(context.m_face_x.data() + first_triangle, normal.x);
+            f4_store(context.m_face_y.data() + first_triangle, normal.y);
+            f4_store(context.m_face_z.data() + first_triangle, normal.z);
+        }
+    }
+
+    // Each vertex sums the faces of its corners in index order, so the result does not depend on how the vertices are
+    // split between threads
+    PARALLEL_FOR_CALLBACK(vertex_normals_job)
+    {
+        NormalContext& context = *static_cast<NormalContext*>(data);
+        const bool is_angle_weighted = context.m_weighting == NormalWeighting::Angle;
+
+        for (u32 vertex = begin; vertex < end; vertex++)
+        {
+            Vector3 sum(0.0f, 0.0f, 0.0f);
+            for (u32 i = context.m_corner_offsets[vertex]; i < context.m_corner_offsets[vertex + 1]; i++)
+            {
+                const u32 corner = context.m_vertex_corners[i];
+                const u32 triangle = corner / 3;
+                const Vector3 face(context.m_face_x[triangle], context.m_face_y[triangle], context.m_face_z[triangle]);
+                sum += is_angle_weighted ? face * context.m_corner_angles[corner % 3][triangle] : face;
+            }
+
+            const f32 length = sum.Length();
+            context.m_vertices[vertex].normal = length > 0.0f ? sum / length : sum;
+        }
+    }
+}
+
+void recalculate_normals(MeshVertex* vertices, size_t num_vertices, const u16* indices, size_t num_indices, NormalWeighting weighting)
+{
+    zv_assert_msg(num_indices % 3 == 0, "Index count must be a multiple of 3");
+
+    NormalContext context{};
+    context.m_vertices = vertices;
+    context.m_indices = indices;
+    context.m_num_vertices = static_cast<u32>(num_vertices);
+    context.m_num_triangles = static_cast<u32>(num_indices / 3);
+    context.m_weighting = weighting;
+
+    if (context.m_num_vertices == 0)
+    {
+        return;
+    }
+
+    const u32 num_padded_triangles = (context.m_num_triangles + 3) & ~3u;
+    context.m_position_x.resize(num_vertices);
+    context.m_position_y.resize(num_vertices);
+    context.m_position_z.resize(num_vertices);
+    context.m_face_x.resize(num_padded_triangles);
+    context.m_face_y.resize(num_padded_triangles);
+    context.m_face_z.resize(num_padded_triangles);
+    if (weighting == NormalWeighting::Angle)
+    {
+        for (DynamicArray<f32>& angles : context.m_corner_angles)
+        {
+            angles.resize(num_padded_triangles);
+        }
+    }
+    build_vertex_corners(indices, num_indices, num_vertices, &context.m_corner_offsets, &context.m_vertex_corners);
+
+    Platform::parallel_for(context.m_num_vertices, k_normal_batch_size, &gather_positions_job, &context);
+    Platform::parallel_for(num_padded_triangles, k_normal_batch_size, &face_normals_job, &context);
+    Platform::parallel_for(context.m_num_vertices, k_normal_batch_size, &vertex_normals_job, &context);
+}
+
+namespace
+{
+    constexpr u32 k_tangent_batch_size = 1024;
+
+    // Corner data is kept as separate float streams, the per vertex sums read them linearly
+    struct TangentContext
+    {
+        MeshVertex* m_vertices = nullptr;
+        const u16* m_indices = nullptr;
+
+        DynamicArray<f32> m_corner_x;  // Tangent scaled by the corner angle
+        DynamicArray<f32> m_corner_y;
+        DynamicArray<f32> m_corner_z;
+        DynamicArray<u8> m_corner_orientation;  // 1 if the triangle's uv area is positive
+
+        DynamicArray<u32> m_corner_offsets;  // See build_vertex_corners
+        DynamicArray<u32> m_vertex_corners;
+    };
+
+    Vector3 project_to_tangent_plane(const Vector3& v, const Vector3& normal)
+    {
+        Vector3 projected = v - normal * normal.Dot(v);
+        projected.Normalize();
+        return projected;
+    }
+
+    PARALLEL_FOR_CALLBACK(corner_tangents_job)
+    {
+        TangentContext& context = *static_cast<TangentContext*>(data);
+
+        for (u32 triangle = begin; triangle < end; triangle++)
+        {
+            const u16* tri = context.m_indices + triangle * 3;
+            const MeshVertex& v0 = context.m_vertices[tri[0]];
+            const MeshVertex& v1 = context.m_vertices[tri[1]];
+            const MeshVertex& v2 = context.m_vertices[tri[2]];
+
+            const Vector3 d1 = v1.position - v0.position;
+            const Vector3 d2 = v2.position - v0.position;
+            const Vector2 t21 = v1.uv - v0.uv;
+            const Vector2 t31 = v2.uv - v0.uv;
+
+            // Same first order tangent as MikkTSpace, the direction of increasing u once the uv area's sign is applied
+            const f32 signed_area_x2 = t21.x * t31.y - t21.y * t31.x;
+            const u8 orientation = signed_area_x2 > 0.0f ? 1 : 0;
+            const Vector3 os = (d1 * t31.y - d2 * t21.y) * (orientation ? 1.0f : -1.0f);
+
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                const MeshVertex& v = context.m_vertices[tri[corner]];
+                const MeshVertex& next = context.m_vertices[tri[(corner + 1) % 3]];
+                const MeshVertex& prev = context.m_vertices[tri[(corner + 2) % 3]];
+
+                const Vector3 tangent = project_to_tangent_plane(os, v.normal);
+                const Vector3 edge1 = project_to_tangent_plane(next.position - v.position, v.normal);
+                const Vector3 edge2 = project_to_tangent_plane(prev.position - v.position, v.normal);
+                const f32 angle = acosf(ZV::min(ZV::max(edge1.Dot(edge2), -1.0f), 1.0f));
+
+                const u32 index = triangle * 3 + corner;
+                context.m_corner_x[index] = tangent.x * angle;
+                context.m_corner_y[index] = tangent.y * angle;
+                context.m_corner_z[index] = tangent.z * angle;
+                context.m_corner_orientation[index] = orientation;
+            }
+        }
+    }
+
+    PARALLEL_FOR_CALLBACK(vertex_tangents_job)
+    {
+        TangentContext& context = *static_cast<TangentContext*>(data);
+
+        for (u32 vertex = begin; vertex < end; vertex++)
+        {
+            // [0] orientation reversing, [1] preserving
+            f32 sum_x[2] = { 0.0f, 0.0f };
+            f32 sum_y[2] = { 0.0f, 0.0f };
+            f32 sum_z[2] = { 0.0f, 0.0f };
+            u32 count[2] = { 0, 0 };
+
+            for (u32 i = context.m_corner_offsets[vertex]; i < context.m_corner_offsets[vertex + 1]; i++)
+            {
+                const u32 corner = context.m_vertex_corners[i];
+                const u8 group = context.m_corner_orientation[corner];
+
+                sum_x[group] += context.m_corner_x[corner];
+                sum_y[group] += context.m_corner_y[corner];
+                sum_z[group] += context.m_corner_z[corner];
+                count[group]++;
+            }
+
+            const u8 group = count[1] >= count[0] ? 1 : 0;
+            Vector3 tangent(sum_x[group], sum_y[group], sum_z[group]);
+
+            MeshVertex& v = context.m_vertices[vertex];
+            if (tangent.LengthSquared() <= ZV_EPSILON * ZV_EPSILON)
+            {
+                // Degenerate uvs, any direction in the tangent plane
+                const Vector3 axis = ZV::abs(v.normal.x) < 0.9f ? Vector3(1.0f, 0.0f, 0.0f) : Vector3(0.0f, 1.0f, 0.0f);
+                tangent = project_to_tangent_plane(axis, v.normal);
+            }
+            tangent.Normalize();
+
+            v.tangent = Vector4(tangent.x, tangent.y, tangent.z, group ? 1.0f : -1.0f);
+        }
+    }
+}
+
+void generate_tangents(MeshVertex* vertices, size_t num_vertices, const u16* indices, size_t num_indices)
+{
+    zv_assert_msg(num_indices % 3 == 0, "Index count must be a multiple of 3");
+
+    TangentContext context{};
+    context.m_vertices = vertices;
+    context.m_indices = indices;
+    context.m_corner_x.resize(num_indices);
+    context.m_corner_y.resize(num_indices);
+    context.m_corner_z.resize(num_indices);
+    context.m_corner_orientation.resize(num_indices);
+    build_vertex_corners(indices, num_indices, num_vertices, &context.m_corner_offsets, &context.m_vertex_corners);
+
+    Platform::parallel_for(static_cast<u32>(num_indices / 3), k_tangent_batch_size, &corner_tangents_job, &context);
+    Platform::parallel_for(static_cast<u32>(num_vertices), k_tangent_batch_size, &vertex_tangents_job, &context);
+}
+
+namespace
+{
+    // Position passes take a stride, so they run over MeshVertex and over a tight position stream alike
+    inline const Vector3& get_position(const Vector3* first_position, size_t stride, size_t i)
+    {
+        return *reinterpret_cast<const Vector3*>(reinterpret_cast<const u8*>(first_position) + i * stride);
+    }
+
+    BoundingSphere compute_bounding_sphere_strided(const Vector3* first_position, size_t stride, size_t num_positions, const Vector3& center)
+    {
+        f32 max_distance_sq = 0.0f;
+        for (size_t i = 0; i < num_positions; i++)
+        {
+            max_distance_sq = ZV::max(max_distance_sq, Vector3::DistanceSquared(center, get_position(first_position, stride, i)));
+        }
+
+        BoundingSphere sphere{};
+        sphere.m_center = center;
+        sphere.m_radius = ZV::sqrt(max_distance_sq);
+        return sphere;
+    }
+
+    VertexQuantization compute_vertex_quantization_strided(const Vector3* first_position, size_t stride, size_t num_positions)
+    {
+        VertexQuantization quantization{};
+        if (num_positions == 0)
+        {
+            return quantization;
+        }
+
+        Vector3 min_position = first_position[0];
+        Vector3 max_position = first_position[0];
+
+        for (size_t i = 1; i < num_positions; i++)
+        {
+            min_position = Vector3::Min(min_position, get_position(first_position, stride, i));
+            max_position = Vector3::Max(max_position, get_position(first_position, stride, i));
+        }
+
+        quantization.m_position_offset = min_position;
+        quantization.m_position_scale = max_position - min_position;
+
+        return quantization;
+    }
+}
+
+BoundingSphere compute_bounding_sphere(const MeshVertex* vertices, size_t num_vertices, const Vector3& center)
+{
+    return compute_bounding_sphere_strided(&vertices->position, sizeof(MeshVertex), num_vertices, center);
+}
+
+BoundingSphere compute_bounding_sphere(const Vector3* positions, size_t num_positions, const Vector3& center)
+{
+    return compute_bounding_sphere_strided(positions, sizeof(Vector3), num_positions, center);
+}
+
+void compute_mesh_bounds(MeshGeometryData* geometry)
+{
+    if (geometry->m_vertices.empty())
+    {
+        geometry->m_bounds = {};
+        geometry->m_bounding_sphere = {};
+        return;
+    }
+
+    const bool has_split_streams = geometry->has_split_streams();
+    const Vector3* first_position = has_split_streams ? geometry->m_positions.data() : &geometry->m_vertices.data()->position;
+    const size_t stride = has_split_streams ? sizeof(Vector3) : sizeof(MeshVertex);
+    const size_t num_positions = geometry->m_vertices.size();
+
+    geometry->m_bounds = {};
+    for (size_t i = 0; i < num_positions; i++)
+    {
+        geometry->m_bounds.add(get_position(first_position, stride, i));
+    }
+
+    if (!geometry->m_bounds.is_valid())
+    {
+        geometry->m_bounding_sphere = {};
+        return;
+    }
+
+    geometry->m_bounding_sphere = compute_bounding_sphere_strided(first_position, stride, num_positions, geometry->m_bounds.get_center());
+}
+
+void split_vertices(const MeshVertex* vertices, size_t num_vertices, Vector3* out_positions, MeshVertexAttributes* out_attributes)
+{
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+        out_positions[i] = vertices[i].position;
+        out_attributes[i].uv = vertices[i].uv;
+        out_attributes[i].normal = vertices[i].normal;
+        out_attributes[i].tangent = vertices[i].tangent;
+    }
+}
+
+void interleave_vertices(const Vector3* positions, const MeshVertexAttributes* attributes, size_t num_vertices, MeshVertex* out_vertices)
+{
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+        out_vertices[i].position = positions[i];
+        out_vertices[i].uv = attributes[i].uv;
+        out_vertices[i].normal = attributes[i].normal;
+        out_vertices[i].tangent = attributes[i].tangent;
+    }
+}
+
+void split_packed_vertices(const PackedMeshVertex* vertices, size_t num_vertices, PackedMeshVertexPosition* out_positions, PackedMeshVertexAttributes* out_attributes)
+{
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+        memcpy(out_positions[i].position, vertices[i].position, sizeof(vertices[i].position));
+        memcpy(out_attributes[i].uv, vertices[i].uv, sizeof(vertices[i].uv));
+        memcpy(out_attributes[i].normal, vertices[i].normal, sizeof(vertices[i].normal));
+        memcpy(out_attributes[i].tangent, vertices[i].tangent, sizeof(vertices[i].tangent));
+    }
+}
+
+void interleave_packed_vertices(const PackedMeshVertexPosition* positions, const PackedMeshVertexAttributes* attributes, size_t num_vertices, PackedMeshVertex* out_vertices)
+{
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+        memcpy(out_vertices[i].position, positions[i].position, sizeof(positions[i].position));
+        memcpy(out_vertices[i].uv, attributes[i].uv, sizeof(attributes[i].uv));
+        memcpy(out_vertices[i].normal, attributes[i].normal, sizeof(attributes[i].normal));
+        memcpy(out_vertices[i].tangent, attributes[i].tangent, sizeof(attributes[i].tangent));
+    }
+}
+
+void split_vertex_streams(MeshGeometryData* geometry)
+{
+    geometry->m_positions.resize(geometry->m_vertices.size());
+    geometry->m_attributes.resize(geometry->m_vertices.size());
+
+    split_vertices(geometry->m_vertices.data(), geometry->m_vertices.size(), geometry->m_positions.data(), geometry->m_attributes.data());
+}
+
+AABB transform_aabb(const AABB& aabb, const Matrix& m)
+{
+    if (!aabb.is_valid())
+    {
+        return aabb;
+    }
+
+    const Vector3 c = aabb.get_center();
+    const Vector3 e = aabb.get_extents();
+
+    // Row vectors, the translation is in the fourth row
+    const Vector3 center(
+        c.x * m._11 + c.y * m._21 + c.z * m._31 + m._41,
+        c.x * m._12 + c.y * m._22 + c.z * m._32 + m._42,
+        c.x * m._13 + c.y * m._23 + c.z * m._33 + m._43);
+
+    const Vector3 extents(
+        e.x * ZV::abs(m._11) + e.y * ZV::abs(m._21) + e.z * ZV::abs(m._31),
+        e.x * ZV::abs(m._12) + e.y * ZV::abs(m._22) + e.z * ZV::abs(m._32),
+        e.x * ZV::abs(m._13) + e.y * ZV::abs(m._23) + e.z * ZV::abs(m._33));
+
+    AABB result{};
+    result.m_min = center - extents;
+    result.m_max = center + extents;
+    return result;
+}
+
+BoundingSphere transform_bounding_sphere(const BoundingSphere& sphere, const Matrix& m)
+{
+    const Vector3& c = sphere.m_center;
+
+    const f32 scale_x_sq = m._11 * m._11 + m._12 * m._12 + m._13 * m._13;
+    const f32 scale_y_sq = m._21 * m._21 + m._22 * m._22 + m._23 * m._23;
+    const f32 scale_z_sq = m._31 * m._31 + m._32 * m._32 + m._33 * m._33;
+
+    BoundingSphere result{};
+    result.m_center = Vector3(
+        c.x * m._11 + c.y * m._21 + c.z * m._31 + m._41,
+        c.x * m._12 + c.y * m._22 + c.z * m._32 + m._42,
+        c.x * m._13 + c.y * m._23 + c.z * m._33 + m._43);
+    result.m_radius = sphere.m_radius * ZV::sqrt(ZV::max(ZV::max(scale_x_sq, scale_y_sq), scale_z_sq));
+    return result;
+}
+
+Frustum extract_frustum(const Matrix& m)
+{
+    // Row vectors: clip = (x, y, z, w) = v * m, so every clip coordinate is a dot product with a column of m
+    const Vector4 column_x(m._11, m._21, m._31, m._41);
+    const Vector4 column_y(m._12, m._22, m._32, m._42);
+    const Vector4 column_z(m._13, m._23, m._33, m._43);
+    const Vector4 column_w(m._14, m._24, m._34, m._44);
+
+    Frustum frustum{};
+    frustum.m_planes[Frustum::Left] = column_w + column_x;
+    frustum.m_planes[Frustum::Right] = column_w - column_x;
+    frustum.m_planes[Frustum::Bottom] = column_w + column_y;
+    frustum.m_planes[Frustum::Top] = column_w - column_y;
+    frustum.m_planes[Frustum::Near] = column_z;
+    frustum.m_planes[Frustum::Far] = column_w - column_z;
+
+    for (Vector4& plane : frustum.m_planes)
+    {
+        const f32 length = Vector3(plane.x, plane.y, plane.z).Length();
+        if (length > ZV_EPSILON)
+        {
+            plane /= length;
+        }
+    }
+    return frustum;
+}
+
+Containment test_frustum_aabb(const Frustum& frustum, const AABB& aabb)
+{
+    if (!aabb.is_valid())
+    {
+        return Containment::Outside;
+    }
+
+    const Vector3 center = aabb.get_center();
+    const Vector3 extents = aabb.get_extents();
+
+    Containment result = Containment::Inside;
+    for (const Vector4& plane : frustum.m_planes)
+    {
+        const f32 distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        const f32 radius = ZV::abs(plane.x) * extents.x + ZV::abs(plane.y) * extents.y + ZV::abs(plane.z) * extents.z;
+        if (distance + radius < 0.0f)
+        {
+            return Containment::Outside;
+        }
+        if (distance - radius < 0.0f)
+        {
+            result = Containment::Intersects;
+        }
+    }
+    return result;
+}
+
+bool intersect_ray_aabb(const Ray& ray, const Vector3& inverse_direction, const AABB& aabb, f32* out_distance)
+{
+    // The running interval is the second argument, so the NaN of an origin on a slab with a zero direction is ignored
+    f32 t_min = 0.0f;
+    f32 t_max = ray.m_max_distance;
+
+    const f32 tx1 = (aabb.m_min.x - ray.m_origin.x) * inverse_direction.x;
+    const f32 tx2 = (aabb.m_max.x - ray.m_origin.x) * inverse_direction.x;
+    t_min = ZV::max(ZV::min(tx1, tx2), t_min);
+    t_max = ZV::min(ZV::max(tx1, tx2), t_max);
+
+    const f32 ty1 = (aabb.m_min.y - ray.m_origin.y) * inverse_direction.y;
+    const f32 ty2 = (aabb.m_max.y - ray.m_origin.y) * inverse_direction.y;
+    t_min = ZV::max(ZV::min(ty1, ty2), t_min);
+    t_max = ZV::min(ZV::max(ty1, ty2), t_max);
+
+    const f32 tz1 = (aabb.m_min.z - ray.m_origin.z) * inverse_direction.z;
+    const f32 tz2 = (aabb.m_max.z - ray.m_origin.z) * inverse_direction.z;
+    t_min = ZV::max(ZV::min(tz1, tz2), t_min);
+    t_max = ZV::min(ZV::max(tz1, tz2), t_max);
+
+    *out_distance = t_min;
+    return t_min <= t_max;
+}
+
+bool intersect_ray_triangle(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, f32* out_distance, f32* out_u, f32* out_v)
+{
+    const Vector3 edge1 = b - a;
+    const Vector3 edge2 = c - a;
+    const Vector3 p = ray.m_direction.Cross(edge2);
+    const f32 determinant = edge1.Dot(p);
+    if (ZV::abs(determinant) < 1e-12f)
+    {
+        return false;  // Parallel to the triangle's plane or degenerate
+    }
+
+    const f32 inverse_determinant = 1.0f / determinant;
+    const Vector3 s = ray.m_origin - a;
+    const f32 u = s.Dot(p) * inverse_determinant;
+    if (u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+
+    const Vector3 q = s.Cross(edge1);
+    const f32 v = ray.m_direction.Dot(q) * inverse_determinant;
+    if (v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+
+    const f32 t = edge2.Dot(q) * inverse_determinant;
+    if (t < 0.0f || t > ray.m_max_distance)
+    {
+        return false;
+    }
+
+    *out_distance = t;
+    *out_u = u;
+    *out_v = v;
+    return true;
+}
+
+namespace
+{
+    f32 sign_not_zero(f32 value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    u16 quantize_unorm16(f32 value)
+    {
+        return static_cast<u16>(lroundf(ZV::max(0.0f, ZV::min(value, 1.0f)) * 65535.0f));
+    }
+
+    f32 dequantize_unorm16(u16 value)
+    {
+        return static_cast<f32>(value) / 65535.0f;
+    }
+
+    s16 quantize_snorm16(f32 value)
+    {
+        return static_cast<s16>(lroundf(ZV::max(-1.0f, ZV::min(value, 1.0f)) * 32767.0f));
+    }
+
+    f32 dequantize_snorm16(s16 value)
+    {
+        // Same as the GPU, -32768 and -32767 both map to -1
+        return ZV::max(static_cast<f32>(value) / 32767.0f, -1.0f);
+    }
+}
+
+Vector2 encode_octahedral(const Vector3& n)
+{
+    const f32 l1_norm = ZV::abs(n.x) + ZV::abs(n.y) + ZV::abs(n.z);
+    if (l1_norm < ZV_EPSILON)
+    {
+        return Vector2(0.0f, 0.0f);
+    }
+
+    f32 x = n.x / l1_norm;
+    f32 y = n.y / l1_norm;
+
+    // Fold the lower hemisphere over the diagonals
+    if (n.z < 0.0f)
+    {
+        const f32 folded_x = (1.0f - ZV::abs(y)) * sign_not_zero(x);
+        const f32 folded_y = (1.0f - ZV::abs(x)) * sign_not_zero(y);
+        x = folded_x;
+        y = folded_y;
+    }
+
+    return Vector2(x, y);
+}
+
+Vector3 decode_octahedral(const Vector2& e)
+{
+    Vector3 n(e.x, e.y, 1.0f - ZV::abs(e.x) - ZV::abs(e.y));
+
+    const f32 t = ZV::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    n.Normalize();
+
+    return n;
+}
+
+u16 float_to_half(f32 value)
+{
+    u32 bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+
+    const u32 sign = (bits >> 16) & 0x8000;
+    const u32 abs_bits = bits & 0x7FFFFFFF;
+
+    // Inf and NaN
+    if (abs_bits >= 0x7F800000)
+    {
+        return static_cast<u16>(sign | 0x7C00 | (abs_bits > 0x7F800000 ? 0x200 : 0));
+    }
+
+    // 65520 and above round to inf
+    if (abs_bits >= 0x477FF000)
+    {
+        return static_cast<u16>(sign | 0x7C00);
+    }
+
+    // Below the smallest normal half, the result is a denormal in units of 2^-24
+    if (abs_bits < 0x38800000)
+    {
+        const u32 shift = 126 - (abs_bits >> 23);
+        if (shift > 24)
+        {
+            return static_cast<u16>(sign);
+        }
+
+        const u32 mantissa = (abs_bits & 0x7FFFFF) | 0x800000;
+        const u32 remainder = mantissa & ((1u << shift) - 1);
+        const u32 halfway = 1u << (shift - 1);
+        u32 half_bits = mantissa >> shift;
+
+        if (remainder > halfway || (remainder == halfway && (half_bits & 1)))
+        {
+            half_bits++;
+        }
+
+        return static_cast<u16>(sign | half_bits);
+    }
+
+    // Rebias the exponent and round the mantissa to nearest even, a carry correctly bumps the exponent
+    u32 half_bits = (abs_bits - 0x38000000) >> 13;
+    const u32 remainder = abs_bits & 0x1FFF;
+
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half_bits & 1)))
+    {
+        half_bits++;
+    }
+
+    return static_cast<u16>(sign | half_bits);
+}
+
+f32 half_to_float(u16 value)
+{
+    const u32 sign = static_cast<u32>(value & 0x8000) << 16;
+    const u32 exponent = (value >> 10) & 0x1F;
+    const u32 mantissa = value & 0x3FF;
+
+    if (exponent == 0)
+    {
+        const f32 magnitude = static_cast<f32>(mantissa) * (1.0f / 16777216.0f);
+        return sign ? -magnitude : magnitude;
+    }
+
+    const u32 bits = exponent == 0x1F
+        ? sign | 0x7F800000 | (mantissa << 13)
+        : sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    f32 result = 0.0f;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+VertexQuantization compute_vertex_quantization(const MeshVertex* vertices, size_t num_vertices)
+{
+    return compute_vertex_quantization_strided(&vertices->position, sizeof(MeshVertex), num_vertices);
+}
+
+VertexQuantization compute_vertex_quantization(const Vector3* positions, size_t num_positions)
+{
+    return compute_vertex_quantization_strided(positions, sizeof(Vector3), num_positions);
+}
+
+PackedMeshVertex pack_mesh_vertex(const MeshVertex& vertex, const VertexQuantization& quantization)
+{
+    const f32 position[3] = { vertex.position.x, vertex.position.y, vertex.position.z };
+    const f32 offset[3] = { quantization.m_position_offset.x, quantization.m_position_offset.y, quantization.m_position_offset.z };
+    const f32 scale[3] = { quantization.m_position_scale.x, quantization.m_position_scale.y, quantization.m_position_scale.z };
+
+    PackedMeshVertex packed{};
+
+    for (u32 axis = 0; axis < 3; axis++)
+    {
+        // Flat axes keep all vertices at the offset
+        packed.position[axis] = scale[axis] > 0.0f ? quantize_unorm16((position[axis] - offset[axis]) / scale[axis]) : 0;
+    }
+    packed.position[3] = vertex.tangent.w < 0.0f ? 0 : 65535;
+
+    packed.uv[0] = float_to_half(vertex.uv.x);
+    packed.uv[1] = float_to_half(vertex.uv.y);
+
+    const Vector2 normal = encode_octahedral(vertex.normal);
+    packed.normal[0] = quantize_snorm16(normal.x);
+    packed.normal[1] = quantize_snorm16(normal.y);
+
+    const Vector2 tangent = encode_octahedral(Vector3(vertex.tangent.x, vertex.tangent.y, vertex.tangent.z));
+    packed.tangent[0] = quantize_snorm16(tangent.x);
+    packed.tangent[1] = quantize_snorm16(tangent.y);
+
+    return packed;
+}
+
+MeshVertex unpack_mesh_vertex(const PackedMeshVertex& vertex, const VertexQuantization& quantization)
+{
+    MeshVertex unpacked{};
+
+    unpacked.position.x = dequantize_unorm16(vertex.position[0]) * quantization.m_position_scale.x + quantization.m_position_offset.x;
+    unpacked.position.y = dequantize_unorm16(vertex.position[1]) * quantization.m_position_scale.y + quantization.m_position_offset.y;
+    unpacked.position.z = dequantize_unorm16(vertex.position[2]) * quantization.m_position_scale.z + quantization.m_position_offset.z;
+
+    unpacked.uv = Vector2(half_to_float(vertex.uv[0]), half_to_float(vertex.uv[1]));
+    unpacked.normal = decode_octahedral(Vector2(dequantize_snorm16(vertex.normal[0]), dequantize_snorm16(vertex.normal[1])));
+
+    const Vector3 tangent = decode_octahedral(Vector2(dequantize_snorm16(vertex.tangent[0]), dequantize_snorm16(vertex.tangent[1])));
+    unpacked.tangent = Vector4(tangent.x, tangent.y, tangent.z, vertex.position[3] >= 32768 ? 1.0f : -1.0f);
+
+    return unpacked;
+}
+
+void pack_mesh_geometry(MeshGeometryData* geometry)
+{
+    geometry->m_quantization = geometry->has_split_streams()
+        ? compute_vertex_quantization(geometry->m_positions.data(), geometry->m_positions.size())
+        : compute_vertex_quantization(geometry->m_vertices.data(), geometry->m_vertices.size());
+    geometry->m_packed_vertices.resize(geometry->m_vertices.size());
+
+    for (size_t i = 0; i < geometry->m_vertices.size(); i++)
+    {
+        geometry->m_packed_vertices[i] = pack_mesh_vertex(geometry->m_vertices[i], geometry->m_quantization);
+    }
 }
@@ -4,14 +4,160 @@
 #include <MathLib.h>
 #include <Shaders/Shared.h>
 
+#include <cfloat>
+
+
+static_assert(sizeof(PackedMeshVertex) == 20, "The packed input layout in Rendering.cpp expects 20 byte vertices");
+
+// Everything of MeshVertex but the position, the second stream of split vertex data
+struct MeshVertexAttributes
+{
+  Vector2 uv;
+  Vector3 normal;
+  Vector4 tangent;
+};
+
+// PackedMeshVertex split the same way, the position keeps the tangent sign in w
+struct PackedMeshVertexPosition
+{
+  u16 position[4];
+};
+
+struct PackedMeshVertexAttributes
+{
+  u16 uv[2];
+  s16 normal[2];
+  s16 tangent[2];
+};
+
+static_assert(sizeof(MeshVertexAttributes) == 36, "The split input layout in Rendering.cpp expects 36 byte attributes");
+static_assert(sizeof(PackedMeshVertexPosition) + sizeof(PackedMeshVertexAttributes) == sizeof(PackedMeshVertex), "Split packed streams must add up to PackedMeshVertex");
+
+struct AABB
+{
+  // Empty until the first point is added
+  Vector3 m_min = Vector3(FLT_MAX, FLT_MAX, FLT_MAX);
+  Vector3 m_max = Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+  bool is_valid() const { return m_min.x <= m_max.x && m_min.y <= m_max.y && m_min.z <= m_max.z; }
+  Vector3 get_center() const { return (m_min + m_max) * 0.5f; }
+  Vector3 get_extents() const { return (m_max - m_min) * 0.5f; }
+
+  void add(const Vector3& point) { m_min = Vector3::Min(m_min, point); m_max = Vector3::Max(m_max, point); }
+  void add(const AABB& other) { m_min = Vector3::Min(m_min, other.m_min); m_max = Vector3::Max(m_max, other.m_max); }
+
+  bool intersects(const AABB& other) const
+  {
+    return m_min.x <= other.m_max.x && m_max.x >= other.m_min.x &&
+           m_min.y <= other.m_max.y && m_max.y >= other.m_min.y &&
+           m_min.z <= other.m_max.z && m_max.z >= other.m_min.z;
+  }
+
+  // Half the surface area, all the surface area heuristic needs
+  f32 get_half_area() const
+  {
+    const Vector3 size = m_max - m_min;
+    return is_valid() ? size.x * size.y + size.y * size.z + size.z * size.x : 0.0f;
+  }
+};
+
+struct BoundingSphere
+{
+  Vector3 m_center = Vector3(0.0f, 0.0f, 0.0f);
+  f32 m_radius = 0.0f;
+};
+
+// Hits are reported as distances along m_direction, which does not have to be normalized
+struct Ray
+{
+  Vector3 m_origin = Vector3(0.0f, 0.0f, 0.0f);
+  Vector3 m_direction = Vector3(0.0f, 0.0f, 1.0f);
+  f32 m_max_distance = FLT_MAX;
+};
+
+// Planes face inwards as (normal, distance): a point p is inside when dot(normal, p) + distance >= 0 for all six
+struct Frustum
+{
+  enum Plane : u8 { Left, Right, Bottom, Top, Near, Far, Count };
+  StaticArray<Vector4, Plane::Count> m_planes{};
+};
+
+enum class Containment : u8
+{
+  Outside,
+  Intersects,
+  Inside,
+};
+
+// Maps the unorm16 positions of a packed mesh back into its bounds
+struct VertexQuantization
+{
+  Vector3 m_position_scale = Vector3(1.0f, 1.0f, 1.0f);
+  Vector3 m_position_offset = Vector3(0.0f, 0.0f, 0.0f);
+};
+
+// Reduced detail index list into the vertices of the full detail mesh
+struct MeshLod
+{
+  DynamicArray<u16> m_indices{};
+  f32 m_rms_error = 0.0f;  // Area weighted RMS distance to the surface of LOD 0, in mesh units
+};
+
+constexpr u32 k_meshlet_max_vertices = 64;
+constexpr u32 k_meshlet_max_triangles = 124;  // Keeps each meshlet's primitive list a multiple of 4 bytes
+
+// Cluster of at most k_meshlet_max_triangles triangles, ranges refer to the lists in MeshletData
+struct Meshlet
+{
+  u32 m_vertex_offset = 0;
+  u32 m_triangle_offset = 0;  // In triangles, the local indices start at m_triangle_offset * 3
+  u32 m_vertex_count = 0;
+  u32 m_triangle_count = 0;
+
+  // Bounding sphere in mesh space
+  Vector3 m_center = Vector3(0.0f, 0.0f, 0.0f);
+  f32 m_radius = 0.0f;
+
+  // All triangles face away from positions p with dot(normalize(m_cone_apex - p), m_cone_axis) >= m_cone_cutoff.
+  // A cutoff of 1 means the normals are too spread to ever cull the whole meshlet.
+  Vector3 m_cone_apex = Vector3(0.0f, 0.0f, 0.0f);
+  Vector3 m_cone_axis = Vector3(0.0f, 0.0f, 0.0f);
+  f32 m_cone_cutoff = 1.0f;
+};
+
+struct MeshletData
+{
+  DynamicArray<Meshlet> m_meshlets{};
+  DynamicArray<u16> m_vertices{};  // Indices into the mesh's vertices
+  DynamicArray<u8> m_triangles{};  // Three meshlet local vertex indices per triangle
+};
 
 struct MeshGeometryData
 {
   DynamicArray<MeshVertex> m_vertices{};
   DynamicArray<u16> m_indices{};
 
+  // Compact copy of m_vertices for rendering, filled by pack_mesh_geometry
+  DynamicArray<PackedMeshVertex> m_packed_vertices{};
+  VertexQuantization m_quantization{};
+
+  // Optional de-interleaved copy of m_vertices, filled by split_vertex_streams. Position only work reads the
+  // tight m_positions array instead of pulling uvs, normals and tangents through the cache.
+  DynamicArray<Vector3> m_positions{};
+  DynamicArray<MeshVertexAttributes> m_attributes{};
+
+  // Mesh space, filled by compute_mesh_bounds or when the mesh is imported
+  AABB m_bounds{};
+  BoundingSphere m_bounding_sphere{};
+
+  // LOD 1 and up, coarsest last. m_indices is LOD 0. Filled by generate_mesh_lods.
+  DynamicArray<MeshLod> m_lods{};
+
   size_t vertices_size() const { return m_vertices.size() * sizeof(MeshVertex); }
+  size_t packed_vertices_size() const { return m_packed_vertices.size() * sizeof(PackedMeshVertex); }
   size_t indices_size() const { return m_indices.size() * sizeof(u16); }
+  bool is_packed() const { return !m_vertices.empty() && m_packed_vertices.size() == m_vertices.size(); }
+  bool has_split_streams() const { return !m_vertices.empty() && m_positions.size() == m_vertices.size() && m_attributes.size() == m_vertices.size(); }
 };
 
 struct PrimitiveMeshGeometryData : public MeshGeometryData
@@ -30,6 +176,41 @@ struct PrimitiveMeshGeometryData : public MeshGeometryData
   Type m_type;
 };
 
+// Identifies generated primitive geometry by its type and the bits of its generation parameters
+struct PrimitiveGeometryKey
+{
+  PrimitiveMeshGeometryData::Type m_type = PrimitiveMeshGeometryData::Type::Triangle;
+  StaticArray<u32, 9> m_params = {};
+
+  bool operator==(const PrimitiveGeometryKey& other) const { return m_type == other.m_type && m_params == other.m_params; }
+};
+
+template<>
+struct std::hash<PrimitiveGeometryKey>
+{
+  [[nodiscard]] size_t operator()(const PrimitiveGeometryKey& key) const noexcept
+  {
+    // FNV-1a over the type and the parameter bits
+    u64 hash = 0xcbf29ce484222325ull ^ static_cast<u64>(key.m_type);
+    for (u32 param : key.m_params)
+    {
+      hash = (hash ^ param) * 0x100000001b3ull;
+    }
+    return static_cast<size_t>(hash);
+  }
+};
+
+struct PrimitiveGeometryCacheStats
+{
+  u32 m_num_hits = 0;
+  u32 m_num_misses = 0;
+  u32 m_num_live = 0;  // Cached geometries that are still referenced
+
+  f32 get_hit_rate() const { return m_num_hits + m_num_misses ? static_cast<f32>(m_num_hits) / (m_num_hits + m_num_misses) : 0.0f; }
+};
+
+// The create functions return cached geometry: identical parameters give the same shared geometry for as long as
+// someone holds a reference to it, so callers must not modify the result. Thread safe.
 SharedPtr<PrimitiveMeshGeometryData> create_triangle(
     Vector3 p1 = {-0.5f, -0.5f, 0.0f}, 
     Vector3 p2 = {0.0f, 0.5f, 0.0f}, 
@@ -66,3 +247,77 @@ SharedPtr<PrimitiveMeshGeometryData> create_capsule(
     u32 radial_segments = 16, 
     u32 height_segments = 1, 
     u32 cap_segments = 16);
+
+PrimitiveGeometryCacheStats get_primitive_geometry_cache_stats();
+
+enum class NormalWeighting : u8
+{
+  Area,   // Face normals weighted by the triangle's area, the plain sum of cross products (https://iquilezles.org/articles/normals/)
+  Angle,  // Weighted by the corner angle (Thurmer and Wuthrich), doesn't change with how a surface is triangulated
+};
+
+// Smooth vertex normals from the triangles. Face normals are computed four triangles at a time into one buffer, then every
+// thread sums them for its own range of vertices in triangle order, so the result doesn't depend on the thread count.
+void recalculate_normals(MeshVertex* vertices, size_t num_vertices, const u16* indices, size_t num_indices, NormalWeighting weighting = NormalWeighting::Area);
+
+// MikkTSpace compatible tangents (Mikkelsen, "Simulation of Wrinkled Surfaces Revisited"): per corner tangents projected
+// onto the vertex normal and weighted by the corner angle, w is the sign of the triangle's uv area. Triangles are
+// processed in parallel and each vertex sums its corners in index order, so the result doesn't depend on the thread count.
+// Where MikkTSpace would split a vertex shared by mirrored triangles, the larger group wins.
+void generate_tangents(MeshVertex* vertices, size_t num_vertices, const u16* indices, size_t num_indices);
+
+// Sphere around center that encloses every vertex
+BoundingSphere compute_bounding_sphere(const MeshVertex* vertices, size_t num_vertices, const Vector3& center);
+BoundingSphere compute_bounding_sphere(const Vector3* positions, size_t num_positions, const Vector3& center);
+
+// Fills m_bounds and m_bounding_sphere, the sphere is centered on the box. Uses the position stream if the mesh has one.
+void compute_mesh_bounds(MeshGeometryData* geometry);
+
+// Converts between interleaved vertices and a position stream plus an attribute stream, the round trip is exact
+void split_vertices(const MeshVertex* vertices, size_t num_vertices, Vector3* out_positions, MeshVertexAttributes* out_attributes);
+void interleave_vertices(const Vector3* positions, const MeshVertexAttributes* attributes, size_t num_vertices, MeshVertex* out_vertices);
+void split_packed_vertices(const PackedMeshVertex* vertices, size_t num_vertices, PackedMeshVertexPosition* out_positions, PackedMeshVertexAttributes* out_attributes);
+void interleave_packed_vertices(const PackedMeshVertexPosition* positions, const PackedMeshVertexAttributes* attributes, size_t num_vertices, PackedMeshVertex* out_vertices);
+
+// Fills m_positions and m_attributes from m_vertices. Anything that rewrites m_vertices drops the streams again.
+void split_vertex_streams(MeshGeometryData* geometry);
+
+// Transforms the center and sums the extents over the absolute values of the upper 3x3 (Arvo, "Transforming Axis-Aligned
+// Bounding Boxes"). Never smaller than the transformed box, exact when the rotation keeps the axes aligned.
+AABB transform_aabb(const AABB& aabb, const Matrix& transform);
+
+// Scales the radius by the largest axis scale of the transform
+BoundingSphere transform_bounding_sphere(const BoundingSphere& sphere, const Matrix& transform);
+
+// Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix", for row vectors
+// and a [0, 1] clip depth. With a view projection the planes are in world space, with a world view projection in object space.
+Frustum extract_frustum(const Matrix& view_projection);
+
+// Conservative: boxes outside a corner of the frustum can report Intersects
+Containment test_frustum_aabb(const Frustum& frustum, const AABB& aabb);
+
+// Slab test, inverse_direction is 1 / ray.m_direction per axis. Writes the entry distance, 0 if the origin is inside.
+bool intersect_ray_aabb(const Ray& ray, const Vector3& inverse_direction, const AABB& aabb, f32* out_distance);
+
+// Moller and Trumbore, "Fast, Minimum Storage Ray/Triangle Intersection". Two sided, writes the distance and the
+// barycentrics of b and c.
+bool intersect_ray_triangle(const Ray& ray, const Vector3& a, const Vector3& b, const Vector3& c, f32* out_distance, f32* out_u, f32* out_v);
+
+// Octahedral mapping of a unit vector to [-1, 1]^2
+Vector2 encode_octahedral(const Vector3& n);
+Vector3 decode_octahedral(const Vector2& e);
+
+u16 float_to_half(f32 value);
+f32 half_to_float(u16 value);
+
+// Scale and offset that map the position bounds of the vertices to [0, 1]
+VertexQuantization compute_vertex_quantization(const MeshVertex* vertices, size_t num_vertices);
+VertexQuantization compute_vertex_quantization(const Vector3* positions, size_t num_positions);
+
+// Worst case errors: position 0.5 / 65535 of the bounds per axis, uv 2^-11 relative (half float),
+// normal and tangent direction 0.04 degrees. The tangent sign is exact.
+PackedMeshVertex pack_mesh_vertex(const MeshVertex& vertex, const VertexQuantization& quantization);
+MeshVertex unpack_mesh_vertex(const PackedMeshVertex& vertex, const VertexQuantization& quantization);
+
+// Fills m_packed_vertices and m_quantization from m_vertices
+void pack_mesh_geometry(MeshGeometryData* geometry);
@@ -0,0 +1,276 @@
+#include <GltfImport.h>
+
+#include <Utility.h>
+#include <Platform/Platform.h>
+
+#include <Platform/PlatformContext.h>
+#if ZV_COMPILER_CL
+#pragma warning(disable: 4996)  // This function or variable may be unsafe
+#endif
+
+#define CGLTF_IMPLEMENTATION
+#include <ThirdParty/cgltf/cgltf.h>
+
+namespace
+{
+    inline const cgltf_accessor* cgltf_find_attr_accessor(const cgltf_primitive* prim, cgltf_attribute_type type, s32 index)
+    {
+        for (cgltf_size i = 0; i < prim->attributes_count; ++i)
+        {
+            const cgltf_attribute* a = &prim->attributes[i];
+            if (a->type == type && a->index == (cgltf_int)index)
+            {
+                return a->data;
+            }
+        }
+        return nullptr;
+    }
+
+    inline void cgltf_read_indices(const cgltf_accessor* acc, DynamicArray<u16>& out_indices, bool is_cw_winding_order = true)
+    {
+        cgltf_size num_indices = cgltf_accessor_unpack_indices(acc, nullptr, 0, 0);
+        out_indices.resize((size_t)num_indices);
+        cgltf_accessor_unpack_indices(acc, out_indices.data(), sizeof(u16), num_indices);
+
+        if (is_cw_winding_order)
+        {
+            for (s32 i = 0; i + 2 < (s32)out_indices.size(); i += 3)
+            {
+                const u16 t = out_indices[i + 1];
+                out_indices[i + 1]   = out_indices[i + 2];
+                out_indices[i + 2]   = t;
+            }
+        }
+    }
+
+    constexpr u32 k_vertex_read_batch_size = 4096;
+
+    struct ReadVerticesContext
+    {
+        const cgltf_accessor* m_position_accessor = nullptr;
+        const cgltf_accessor* m_uv_accessor = nullptr;
+        const cgltf_accessor* m_normal_accessor = nullptr;
+        const cgltf_accessor* m_tangent_accessor = nullptr;
+        bool m_is_left_handed_coordinate_system = true;
+
+        MeshVertex* m_vertices = nullptr;
+        DynamicArray<AABB> m_batch_bounds;  // Position bounds of each batch, reduced after the read
+    };
+
+    PARALLEL_FOR_CALLBACK(read_vertices_job)
+    {
+        ReadVerticesContext& context = *static_cast<ReadVerticesContext*>(data);
+
+        MeshVertex* vtx = context.m_vertices;
+        const bool is_left_handed_coordinate_system = context.m_is_left_handed_coordinate_system;
+        AABB bounds{};
+
+        f32 tmp[4];
+
+        for (u32 i = begin; i < end; ++i)
+        {
+            // position
+            tmp[0]=tmp[1]=tmp[2]=0.0f; tmp[3]=1.0f;
+            cgltf_accessor_read_float(context.m_position_accessor, i, tmp, 3);
+            vtx[i].position.x = tmp[0];
+            vtx[i].position.y = tmp[1];
+            vtx[i].position.z = tmp[2];
+            if (is_left_handed_coordinate_system)
+            {
+                vtx[i].position = basis_flip_y(vtx[i].position);
+            }
+            bounds.add(vtx[i].position);
+    
+            // uv
+            if (context.m_uv_accessor)
+            {
+                tmp[0]=tmp[1]=0.0f;
+                cgltf_accessor_read_float(context.m_uv_accessor, i, tmp, 2);
+                vtx[i].uv.x = tmp[0];
+                vtx[i].uv.y = tmp[1];
+            }
+            else
+            {
+                vtx[i].uv.x = 0.0f; vtx[i].uv.y = 0.0f;
+            }
+    
+            // normal
+            if (context.m_normal_accessor)
+            {
+                tmp[0]=tmp[1]=tmp[2]=0.0f;
+                cgltf_accessor_read_float(context.m_normal_accessor, i, tmp, 3);
+                vtx[i].normal.x = tmp[0];
+                vtx[i].normal.y = tmp[1];
+                vtx[i].normal.z = tmp[2];
+                if (is_left_handed_coordinate_system)
+                {
+                    vtx[i].normal = basis_flip_y(vtx[i].normal);
+                }
+            }
+            else
+            {
+                vtx[i].normal.x = 0.0f; vtx[i].normal.y = 0.0f; vtx[i].normal.z = 1.0f;
+            }
+    
+            // tangent (xyz from accessor, ignore handedness w)
+            if (context.m_tangent_accessor)
+            {
+                tmp[0]=tmp[1]=tmp[2]=0.0f; tmp[3]=1.0f;
+                cgltf_accessor_read_float(context.m_tangent_accessor, i, tmp, 4);
+                vtx[i].tangent.x = tmp[0];
+                vtx[i].tangent.y = tmp[1];
+                vtx[i].tangent.z = tmp[2];
+                vtx[i].tangent.w = tmp[3];
+                if (is_left_handed_coordinate_system)
+                {
+                    vtx[i].tangent = basis_flip_y(vtx[i].tangent);
+                }
+            }
+            else
+            {
+                vtx[i].tangent.x = 1.0f; vtx[i].tangent.y = 0.0f; vtx[i].tangent.z = 0.0f;
+                vtx[i].tangent.w = 1.0f;
+            }
+        }
+
+        context.m_batch_bounds[begin / k_vertex_read_batch_size] = bounds;
+    }
+
+    struct BoundingRadiusContext
+    {
+        const MeshVertex* m_vertices = nullptr;
+        Vector3 m_center{};
+        DynamicArray<f32> m_batch_radius;
+    };
+
+    PARALLEL_FOR_CALLBACK(bounding_radius_job)
+    {
+        BoundingRadiusContext& context = *static_cast<BoundingRadiusContext*>(data);
+
+        const BoundingSphere sphere = compute_bounding_sphere(context.m_vertices + begin, end - begin, context.m_center);
+        context.m_batch_radius[begin / k_vertex_read_batch_size] = sphere.m_radius;
+    }
+
+    // Vertices are read in parallel batches, which also produce the bounds
+    void cgltf_read_vertices(const cgltf_primitive* prim, MeshGeometryData* out_geom, bool is_left_handed_coordinate_system = true)
+    {
+        const cgltf_accessor* pos_acc  = cgltf_find_attr_accessor(prim, cgltf_attribute_type_position, 0);
+        // Position is mandatory for us; if missing, produce zero verts.
+        if (!pos_acc)
+        {
+            out_geom->m_vertices.resize(0);
+            out_geom->m_bounds = {};
+            out_geom->m_bounding_sphere = {};
+            return;
+        }
+    
+        const u32 vcount = static_cast<u32>(pos_acc->count);
+        const u32 num_batches = (vcount + k_vertex_read_batch_size - 1) / k_vertex_read_batch_size;
+        out_geom->m_vertices.resize(vcount);
+    
+        ReadVerticesContext context{};
+        context.m_position_accessor = pos_acc;
+        context.m_uv_accessor = cgltf_find_attr_accessor(prim, cgltf_attribute_type_texcoord, 0);
+        context.m_normal_accessor = cgltf_find_attr_accessor(prim, cgltf_attribute_type_normal, 0);
+        context.m_tangent_accessor = cgltf_find_attr_accessor(prim, cgltf_attribute_type_tangent, 0);
+        context.m_is_left_handed_coordinate_system = is_left_handed_coordinate_system;
+        context.m_vertices = out_geom->m_vertices.data();
+        context.m_batch_bounds.resize(num_batches);
+        Platform::parallel_for(vcount, k_vertex_read_batch_size, &read_vertices_job, &context);
+
+        AABB bounds{};
+        if (pos_acc->has_min && pos_acc->has_max)
+        {
+            // glTF requires position bounds, exporters already computed them
+            bounds.add(Vector3(pos_acc->min[0], pos_acc->min[1], pos_acc->min[2]));
+            bounds.add(Vector3(pos_acc->max[0], pos_acc->max[1], pos_acc->max[2]));
+            if (is_left_handed_coordinate_system)
+            {
+                bounds.m_min.y = -pos_acc->max[1];
+                bounds.m_max.y = -pos_acc->min[1];
+            }
+        }
+        else
+        {
+            for (const AABB& batch_bounds : context.m_batch_bounds)
+            {
+                bounds.add(batch_bounds);
+            }
+        }
+        out_geom->m_bounds = bounds;
+
+        if (!bounds.is_valid())
+        {
+            out_geom->m_bounding_sphere = {};
+            return;
+        }
+
+        BoundingRadiusContext radius_context{};
+        radius_context.m_vertices = out_geom->m_vertices.data();
+        radius_context.m_center = bounds.get_center();
+        radius_context.m_batch_radius.resize(num_batches, 0.0f);
+        Platform::parallel_for(vcount, k_vertex_read_batch_size, &bounding_radius_job, &radius_context);
+
+        out_geom->m_bounding_sphere.m_center = radius_context.m_center;
+        out_geom->m_bounding_sphere.m_radius = 0.0f;
+        for (const f32 radius : radius_context.m_batch_radius)
+        {
+            out_geom->m_bounding_sphere.m_radius = ZV::max(out_geom->m_bounding_sphere.m_radius, radius);
+        }
+    }
+}
+
+void read_gltf_geometry(const cgltf_primitive* prim, MeshGeometryData* out_geom)
+{
+    cgltf_read_vertices(prim, out_geom);
+
+    if (prim->indices && prim->type == cgltf_primitive_type_triangles)
+    {
+        cgltf_read_indices(prim->indices, out_geom->m_indices);
+    }
+    else
+    {
+        zv_error("No index accessor found for primitive");
+    }
+
+    // glTF expects MikkTSpace tangents when a normal mapped primitive leaves them out
+    const bool has_tangents = cgltf_find_attr_accessor(prim, cgltf_attribute_type_tangent, 0) != nullptr;
+    const bool has_uvs = cgltf_find_attr_accessor(prim, cgltf_attribute_type_texcoord, 0) != nullptr;
+    if (!has_tangents && has_uvs && !out_geom->m_indices.empty())
+    {
+        generate_tangents(out_geom->m_vertices.data(), out_geom->m_vertices.size(), out_geom->m_indices.data(), out_geom->m_indices.size());
+    }
+}
+
+bool load_gltf_mesh_geometries(const char* path, DynamicArray<MeshGeometryData>* out_geometries)
+{
+    cgltf_options options{};
+    cgltf_data* data = nullptr;
+    if (cgltf_parse_file(&options, path, &data) != cgltf_result_success)
+    {
+        zv_error("Failed to parse glTF file {}", path);
+        return false;
+    }
+
+    if (cgltf_load_buffers(&options, data, path) != cgltf_result_success)
+    {
+        zv_error("Failed to load glTF buffers of {}", path);
+        cgltf_free(data);
+        return false;
+    }
+
+    for (cgltf_size m = 0; m < data->meshes_count; ++m)
+    {
+        const cgltf_mesh& mesh = data->meshes[m];
+        for (cgltf_size p = 0; p < mesh.primitives_count; ++p)
+        {
+            if (mesh.primitives[p].type == cgltf_primitive_type_triangles)
+            {
+                read_gltf_geometry(&mesh.primitives[p], &out_geometries->emplace_back());
+            }
+        }
+    }
+
+    cgltf_free(data);
+    return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <CoreDefs.h>
+#include <Geometry.h>
+
+struct cgltf_primitive;
+
+// Reads a triangle primitive's vertices and indices into out_geom, flipping glTF's right handed basis to the engine's
+// left handed one. The bounds come from the position accessor's min and max when it has them, and from the vertices
+// otherwise. Tangents are generated when the primitive has uvs but no tangents.
+void read_gltf_geometry(const cgltf_primitive* prim, MeshGeometryData* out_geom);
+
+// Appends every triangle primitive of every mesh in the file, in file order and without node transforms, for tools and
+// tests that need imported geometry without the asset manager. False when the file or its buffers can't be loaded.
+bool load_gltf_mesh_geometries(const char* path, DynamicArray<MeshGeometryData>* out_geometries);
@@ -0,0 +1,156 @@
+#include <GraphicsStateFilter.h>
+
+#include <Log.h>
+
+GraphicsStateFilter::GraphicsStateFilter(GraphicsCommandBackend* backend)
+    : m_backend(backend)
+{
+}
+
+void GraphicsStateFilter::reset()
+{
+    invalidate();
+    m_stats = {};
+}
+
+void GraphicsStateFilter::invalidate()
+{
+    m_pipeline_state_valid = false;
+    m_root_signature_valid = false;
+    m_viewport_valid = false;
+    m_scissor_valid = false;
+    m_index_buffer_valid = false;
+    m_primitive_topology_valid = false;
+    m_vertex_buffers_valid = 0;
+    invalidate_root_arguments();
+}
+
+bool GraphicsStateFilter::filter(bool changed)
+{
+    if (changed)
+    {
+        m_stats.m_num_issued++;
+    }
+    else
+    {
+        m_stats.m_num_filtered++;
+    }
+    return changed;
+}
+
+void GraphicsStateFilter::invalidate_root_arguments()
+{
+    m_root_cbvs_valid = 0;
+    m_root_tables_valid = 0;
+}
+
+void GraphicsStateFilter::set_pipeline_state(void* pipeline_state)
+{
+    if (filter(!m_pipeline_state_valid || m_pipeline_state != pipeline_state))
+    {
+        m_pipeline_state = pipeline_state;
+        m_pipeline_state_valid = true;
+        m_backend->set_pipeline_state(pipeline_state);
+    }
+}
+
+void GraphicsStateFilter::set_root_signature(void* root_signature)
+{
+    if (filter(!m_root_signature_valid || m_root_signature != root_signature))
+    {
+        m_root_signature = root_signature;
+        m_root_signature_valid = true;
+        invalidate_root_arguments();
+        m_backend->set_root_signature(root_signature);
+    }
+}
+
+void GraphicsStateFilter::set_viewport(const FilteredViewport& viewport)
+{
+    if (filter(!m_viewport_valid || m_viewport != viewport))
+    {
+        m_viewport = viewport;
+        m_viewport_valid = true;
+        m_backend->set_viewport(viewport);
+    }
+}
+
+void GraphicsStateFilter::set_scissor(const FilteredScissor& scissor)
+{
+    if (filter(!m_scissor_valid || m_scissor != scissor))
+    {
+        m_scissor = scissor;
+        m_scissor_valid = true;
+        m_backend->set_scissor(scissor);
+    }
+}
+
+void GraphicsStateFilter::set_primitive_topology(u32 topology)
+{
+    if (filter(!m_primitive_topology_valid || m_primitive_topology != topology))
+    {
+        m_primitive_topology = topology;
+        m_primitive_topology_valid = true;
+        m_backend->set_primitive_topology(topology);
+    }
+}
+
+void GraphicsStateFilter::set_vertex_buffers(const FilteredBufferView* views, u32 num_views)
+{
+    zv_assert_msg(num_views <= k_max_filtered_vertex_buffers, "Too many vertex buffers: {}", num_views);
+
+    // Slots past num_views keep their buffers, as they do in the API
+    bool changed = false;
+    for (u32 slot = 0; slot < num_views && !changed; slot++)
+    {
+        changed = !(m_vertex_buffers_valid & (1u << slot)) || m_vertex_buffers[slot] != views[slot];
+    }
+
+    if (filter(changed))
+    {
+        for (u32 slot = 0; slot < num_views; slot++)
+        {
+            m_vertex_buffers[slot] = views[slot];
+            m_vertex_buffers_valid |= 1u << slot;
+        }
+        m_backend->set_vertex_buffers(views, num_views);
+    }
+}
+
+void GraphicsStateFilter::set_index_buffer(const FilteredBufferView& view)
+{
+    if (filter(!m_index_buffer_valid || m_index_buffer != view))
+    {
+        m_index_buffer = view;
+        m_index_buffer_valid = true;
+        m_backend->set_index_buffer(view);
+    }
+}
+
+void GraphicsStateFilter::set_root_constant_buffer_view(u32 root_index, u64 address)
+{
+    zv_assert_msg(root_index < k_max_filtered_root_parameters, "Root index {} out of range", root_index);
+
+    const u64 bit = 1ull << root_index;
+    if (filter(!(m_root_cbvs_valid & bit) || m_root_arguments[root_index] != address))
+    {
+        m_root_arguments[root_index] = address;
+        m_root_cbvs_valid |= bit;
+        m_root_tables_valid &= ~bit;
+        m_backend->set_root_constant_buffer_view(root_index, address);
+    }
+}
+
+void GraphicsStateFilter::set_root_descriptor_table(u32 root_index, u64 base_descriptor)
+{
+    zv_assert_msg(root_index < k_max_filtered_root_parameters, "Root index {} out of range", root_index);
+
+    const u64 bit = 1ull << root_index;
+    if (filter(!(m_root_tables_valid & bit) || m_root_arguments[root_index] != base_descriptor))
+    {
+        m_root_arguments[root_index] = base_descriptor;
+        m_root_tables_valid |= bit;
+        m_root_cbvs_valid &= ~bit;
+        m_backend->set_root_descriptor_table(root_index, base_descriptor);
+    }
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <CoreDefs.h>
+
+constexpr u32 k_max_filtered_vertex_buffers = 32;  // D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT
+constexpr u32 k_max_filtered_root_parameters = 64; // A root signature holds at most 64 DWORDs
+
+struct FilteredViewport
+{
+    f32 m_x = 0.0f;
+    f32 m_y = 0.0f;
+    f32 m_width = 0.0f;
+    f32 m_height = 0.0f;
+    f32 m_min_depth = 0.0f;
+    f32 m_max_depth = 1.0f;
+
+    bool operator==(const FilteredViewport& other) const
+    {
+        return m_x == other.m_x && m_y == other.m_y && m_width == other.m_width && m_height == other.m_height && m_min_depth == other.m_min_depth && m_max_depth == other.m_max_depth;
+    }
+    bool operator!=(const FilteredViewport& other) const { return !(*this == other); }
+};
+
+struct FilteredScissor
+{
+    s32 m_left = 0;
+    s32 m_top = 0;
+    s32 m_right = 0;
+    s32 m_bottom = 0;
+
+    bool operator==(const FilteredScissor& other) const
+    {
+        return m_left == other.m_left && m_top == other.m_top && m_right == other.m_right && m_bottom == other.m_bottom;
+    }
+    bool operator!=(const FilteredScissor& other) const { return !(*this == other); }
+};
+
+// Vertex and index buffer views, the format of an index buffer is the backend's own enum value
+struct FilteredBufferView
+{
+    u64 m_address = 0;
+    u32 m_size = 0;
+    u32 m_stride_or_format = 0;
+
+    bool operator==(const FilteredBufferView& other) const
+    {
+        return m_address == other.m_address && m_size == other.m_size && m_stride_or_format == other.m_stride_or_format;
+    }
+    bool operator!=(const FilteredBufferView& other) const { return !(*this == other); }
+};
+
+struct StateFilterStats
+{
+    u32 m_num_issued = 0;    // Calls passed on to the backend
+    u32 m_num_filtered = 0;  // Calls dropped because they matched the bound state
+
+    f32 get_filtered_rate() const { return m_num_issued + m_num_filtered ? static_cast<f32>(m_num_filtered) / (m_num_issued + m_num_filtered) : 0.0f; }
+};
+
+// The state setting calls of a command list. The DX12 backend forwards them to the list, GraphicsCommandRecorder keeps them.
+// Pipeline states and root signatures are opaque handles.
+class GraphicsCommandBackend
+{
+public:
+    virtual ~GraphicsCommandBackend() = default;
+
+    virtual void set_pipeline_state(void* pipeline_state) = 0;
+    virtual void set_root_signature(void* root_signature) = 0;
+    virtual void set_viewport(const FilteredViewport& viewport) = 0;
+    virtual void set_scissor(const FilteredScissor& scissor) = 0;
+    virtual void set_primitive_topology(u32 topology) = 0;
+    // Binds views to the slots starting at 0
+    virtual void set_vertex_buffers(const FilteredBufferView* views, u32 num_views) = 0;
+    virtual void set_index_buffer(const FilteredBufferView& view) = 0;
+    virtual void set_root_constant_buffer_view(u32 root_index, u64 address) = 0;
+    virtual void set_root_descriptor_table(u32 root_index, u64 base_descriptor) = 0;
+};
+
+// Keeps every call as a command, so the filtering can be checked without a device
+class GraphicsCommandRecorder final : public GraphicsCommandBackend
+{
+public:
+    enum class CommandType : u8
+    {
+        SetPipelineState,
+        SetRootSignature,
+        SetViewport,
+        SetScissor,
+        SetPrimitiveTopology,
+        SetVertexBuffers,
+        SetIndexBuffer,
+        SetRootConstantBufferView,
+        SetRootDescriptorTable,
+    };
+
+    struct Command
+    {
+        CommandType m_type = CommandType::SetPipelineState;
+        u32 m_index = 0;   // Root index, or number of vertex buffers
+        u64 m_value = 0;   // Handle, address, topology or first vertex buffer address
+    };
+
+    void set_pipeline_state(void* pipeline_state) override { m_commands.push_back({ CommandType::SetPipelineState, 0, reinterpret_cast<u64>(pipeline_state) }); }
+    void set_root_signature(void* root_signature) override { m_commands.push_back({ CommandType::SetRootSignature, 0, reinterpret_cast<u64>(root_signature) }); }
+    void set_viewport(const FilteredViewport& viewport) override { m_commands.push_back({ CommandType::SetViewport, 0, static_cast<u64>(viewport.m_width) }); }
+    void set_scissor(const FilteredScissor& scissor) override { m_commands.push_back({ CommandType::SetScissor, 0, static_cast<u64>(scissor.m_right) }); }
+    void set_primitive_topology(u32 topology) override { m_commands.push_back({ CommandType::SetPrimitiveTopology, 0, topology }); }
+    void set_vertex_buffers(const FilteredBufferView* views, u32 num_views) override { m_commands.push_back({ CommandType::SetVertexBuffers, num_views, num_views ? views[0].m_address : 0 }); }
+    void set_index_buffer(const FilteredBufferView& view) override { m_commands.push_back({ CommandType::SetIndexBuffer, 0, view.m_address }); }
+    void set_root_constant_buffer_view(u32 root_index, u64 address) override { m_commands.push_back({ CommandType::SetRootConstantBufferView, root_index, address }); }
+    void set_root_descriptor_table(u32 root_index, u64 base_descriptor) override { m_commands.push_back({ CommandType::SetRootDescriptorTable, root_index, base_descriptor }); }
+
+    DynamicArray<Command> m_commands{};
+};
+
+// Shadows the state bound on a command list and only passes calls that change it on to the backend.
+// Root arguments are forgotten when the root signature changes, as the API does.
+class GraphicsStateFilter
+{
+public:
+    explicit GraphicsStateFilter(GraphicsCommandBackend* backend);
+
+    // Forgets the bound state and restarts the counters. Call it whenever the command list is reset.
+    void reset();
+    // Forgets the bound state only, for when something else recorded into the command list
+    void invalidate();
+
+    void set_pipeline_state(void* pipeline_state);
+    void set_root_signature(void* root_signature);
+    void set_viewport(const FilteredViewport& viewport);
+    void set_scissor(const FilteredScissor& scissor);
+    void set_primitive_topology(u32 topology);
+    void set_vertex_buffers(const FilteredBufferView* views, u32 num_views);
+    void set_index_buffer(const FilteredBufferView& view);
+    void set_root_constant_buffer_view(u32 root_index, u64 address);
+    void set_root_descriptor_table(u32 root_index, u64 base_descriptor);
+
+    const StateFilterStats& get_stats() const { return m_stats; }
+
+private:
+    // Counts the call and tells whether to issue it
+    bool filter(bool changed);
+    void invalidate_root_arguments();
+
+private:
+    GraphicsCommandBackend* m_backend = nullptr;
+    StateFilterStats m_stats{};
+
+    // Nothing is bound until the matching valid flag is set, so the first call of each kind is always issued
+    void* m_pipeline_state = nullptr;
+    void* m_root_signature = nullptr;
+    FilteredViewport m_viewport{};
+    FilteredScissor m_scissor{};
+    FilteredBufferView m_index_buffer{};
+    u32 m_primitive_topology = 0;
+    bool m_pipeline_state_valid = false;
+    bool m_root_signature_valid = false;
+    bool m_viewport_valid = false;
+    bool m_scissor_valid = false;
+    bool m_index_buffer_valid = false;
+    bool m_primitive_topology_valid = false;
+
+    StaticArray<FilteredBufferView, k_max_filtered_vertex_buffers> m_vertex_buffers{};
+    u32 m_vertex_buffers_valid = 0;  // One bit per slot
+
+    // Root CBV addresses and descriptor table starts share the root index space, one kind per index
+    StaticArray<u64, k_max_filtered_root_parameters> m_root_arguments{};
+    u64 m_root_cbvs_valid = 0;    // One bit per root index
+    u64 m_root_tables_valid = 0;
+};
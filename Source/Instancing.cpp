@@ -0,0 +1,53 @@
+#include <Instancing.h>
+#include <RenderQueue.h>
+
+void InstanceBatcher::clear()
+{
+    m_draws.clear();
+    m_instance_items.clear();
+}
+
+void InstanceBatcher::add(const InstancedDrawKey& key, u32 item)
+{
+    if (m_draws.empty() || m_draws.back().m_key != key)
+    {
+        InstancedDraw draw{};
+        draw.m_key = key;
+        draw.m_first_instance = static_cast<u32>(m_instance_items.size());
+        draw.m_first_item = item;
+        m_draws.push_back(draw);
+    }
+
+    m_draws.back().m_instance_count++;
+    m_instance_items.push_back(item);
+}
+
+void InstanceBatcher::record(DrawRecorder* recorder, InstancingStats* out_stats) const
+{
+    for (const InstancedDraw& draw : m_draws)
+    {
+        recorder->record_draw(draw);
+    }
+
+    if (out_stats)
+    {
+        out_stats->m_num_instances = static_cast<u32>(m_instance_items.size());
+        out_stats->m_num_draws = static_cast<u32>(m_draws.size());
+    }
+}
+
+void batch_instanced_objects(const InstancedObject* objects, u32 num_objects, RenderQueue* queue, InstanceBatcher* batcher)
+{
+    queue->clear();
+    for (u32 i = 0; i < num_objects; i++)
+    {
+        queue->push(make_opaque_sort_key(objects[i].m_key.m_pipeline, objects[i].m_key.m_geometry, objects[i].m_depth), i);
+    }
+    queue->sort();
+
+    batcher->clear();
+    for (const RenderQueueEntry& entry : queue->m_entries)
+    {
+        batcher->add(objects[entry.m_item].m_key, objects[entry.m_item].m_item);
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <CoreDefs.h>
+
+struct RenderQueue;
+
+// What a draw binds and draws. Draws with equal keys only differ in their instance data and can be merged.
+struct InstancedDrawKey
+{
+    u32 m_pipeline = 0;
+    u32 m_geometry = 0;
+    u32 m_index_count = 0;
+    u32 m_start_index = 0;
+
+    bool operator==(const InstancedDrawKey& other) const
+    {
+        return m_pipeline == other.m_pipeline && m_geometry == other.m_geometry && m_index_count == other.m_index_count && m_start_index == other.m_start_index;
+    }
+    bool operator!=(const InstancedDrawKey& other) const { return !(*this == other); }
+};
+
+struct InstancedDraw
+{
+    InstancedDrawKey m_key{};
+    u32 m_first_instance = 0;  // Into the batcher's instance list
+    u32 m_instance_count = 0;
+    u32 m_first_item = 0;      // Item of the first instance, for state that isn't part of the key such as buffers
+};
+
+struct InstancingStats
+{
+    u32 m_num_instances = 0;
+    u32 m_num_draws = 0;
+
+    f32 get_instances_per_draw() const { return m_num_draws ? static_cast<f32>(m_num_instances) / m_num_draws : 0.0f; }
+};
+
+// Receives the draws of an InstanceBatcher. The renderer records into a command list.
+class DrawRecorder
+{
+public:
+    virtual ~DrawRecorder() = default;
+
+    virtual void record_draw(const InstancedDraw& draw) = 0;
+};
+
+// Keeps the draws in a list, so the batching can be checked without a device
+class DrawListRecorder final : public DrawRecorder
+{
+public:
+    void record_draw(const InstancedDraw& draw) override { m_draws.push_back(draw); }
+
+    DynamicArray<InstancedDraw> m_draws{};
+};
+
+// Merges runs of consecutive draws with equal keys into instanced draws. Only neighbours merge, so submit the draws
+// sorted by state, as the RenderQueue does. Instances keep their submission order.
+class InstanceBatcher
+{
+public:
+    void clear();
+    // item is caller defined, usually the index of the object drawn
+    void add(const InstancedDrawKey& key, u32 item);
+
+    void record(DrawRecorder* recorder, InstancingStats* out_stats = nullptr) const;
+
+    // The items in instance order, instance i of a draw is m_first_instance + i
+    const DynamicArray<u32>& get_instance_items() const { return m_instance_items; }
+    u32 get_num_draws() const { return static_cast<u32>(m_draws.size()); }
+
+private:
+    DynamicArray<InstancedDraw> m_draws{};
+    DynamicArray<u32> m_instance_items{};
+};
+
+// A visible object as the renderer submits it. Its constants and material are read per instance, so they are not part
+// of the key and objects with different materials still merge.
+struct InstancedObject
+{
+    InstancedDrawKey m_key{};
+    f32 m_depth = 0.0f;  // View space depth, orders the objects front to back
+    u32 m_item = 0;      // Passed on to the batcher
+};
+
+// Sorts the objects through the queue by state and depth, then merges neighbours with equal keys in the batcher.
+// Clears both first.
+void batch_instanced_objects(const InstancedObject* objects, u32 num_objects, RenderQueue* queue, InstanceBatcher* batcher);
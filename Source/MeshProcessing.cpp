@@ -0,0 +1,1388 @@
+#include <MeshProcessing.h>
+
+#include <Utility.h>
+
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // Tuning values from the paper
+    constexpr f32 k_cache_decay_power = 1.5f;
+    constexpr f32 k_last_triangle_score = 0.75f;
+    constexpr f32 k_valence_boost_scale = 2.0f;
+    constexpr f32 k_valence_boost_power = 0.5f;
+    constexpr u32 k_max_valence_score = 32;  // Vertices with more open triangles share the last valence score
+
+    constexpr u32 k_invalid_triangle = UINT32_MAX;
+    constexpr u32 k_unused_vertex = UINT32_MAX;
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Vertex cache optimization
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    struct VertexScoreTables
+    {
+        f32 m_cache[k_vertex_cache_size];
+        f32 m_valence[k_max_valence_score + 1];
+    };
+
+    VertexScoreTables make_vertex_score_tables()
+    {
+        VertexScoreTables tables{};
+
+        for (u32 i = 0; i < k_vertex_cache_size; i++)
+        {
+            // The last triangle's vertices get a fixed score, so the next triangle doesn't just pick the one sharing an edge
+            if (i < 3)
+            {
+                tables.m_cache[i] = k_last_triangle_score;
+                continue;
+            }
+
+            const f32 scaler = 1.0f / static_cast<f32>(k_vertex_cache_size - 3);
+            tables.m_cache[i] = powf(1.0f - static_cast<f32>(i - 3) * scaler, k_cache_decay_power);
+        }
+
+        tables.m_valence[0] = 0.0f;
+        for (u32 i = 1; i <= k_max_valence_score; i++)
+        {
+            // Boost vertices with few triangles left, so lone triangles don't get stranded
+            tables.m_valence[i] = k_valence_boost_scale * powf(static_cast<f32>(i), -k_valence_boost_power);
+        }
+
+        return tables;
+    }
+
+    f32 get_vertex_score(const VertexScoreTables& tables, u32 cache_position, u32 num_open_triangles)
+    {
+        if (num_open_triangles == 0)
+        {
+            return -1.0f;
+        }
+
+        const f32 cache_score = cache_position < k_vertex_cache_size ? tables.m_cache[cache_position] : 0.0f;
+        return cache_score + tables.m_valence[ZV::min(num_open_triangles, k_max_valence_score)];
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Validation and repair
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    // Twice the area over the summed squared edge lengths, roughly the sine of the corner angle. Below float precision the
+    // triangle is a line.
+    constexpr f64 k_min_triangle_sine = FLT_EPSILON;
+
+    constexpr u32 k_vertex_words = sizeof(MeshVertex) / sizeof(u32);
+    static_assert(sizeof(MeshVertex) % sizeof(u32) == 0, "MeshVertex is hashed as 32 bit words");
+
+    // Resets non finite attributes to the importer's defaults. Returns false if the position itself is unusable.
+    bool sanitize_vertex(MeshVertex* vertex, bool* out_fixed)
+    {
+        if (!std::isfinite(vertex->uv.x) || !std::isfinite(vertex->uv.y))
+        {
+            vertex->uv = Vector2(0.0f, 0.0f);
+            *out_fixed = true;
+        }
+
+        if (!std::isfinite(vertex->normal.x) || !std::isfinite(vertex->normal.y) || !std::isfinite(vertex->normal.z))
+        {
+            vertex->normal = Vector3(0.0f, 0.0f, 1.0f);
+            *out_fixed = true;
+        }
+
+        if (!std::isfinite(vertex->tangent.x) || !std::isfinite(vertex->tangent.y) || !std::isfinite(vertex->tangent.z) || !std::isfinite(vertex->tangent.w))
+        {
+            vertex->tangent = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
+            *out_fixed = true;
+        }
+
+        return std::isfinite(vertex->position.x) && std::isfinite(vertex->position.y) && std::isfinite(vertex->position.z);
+    }
+
+    // Bits rather than values, only exact duplicates are welded
+    u32 hash_vertex(const MeshVertex& vertex)
+    {
+        u32 words[k_vertex_words];
+        memcpy(words, &vertex, sizeof(MeshVertex));
+
+        u32 hash = 2166136261u;
+        for (u32 word : words)
+        {
+            hash = (hash ^ word) * 16777619u;
+        }
+        return hash ^ (hash >> 15);
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Simplification
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    constexpr f64 k_min_flip_cosine = 0.25;  // A collapse may turn a remaining triangle by up to ~75 degrees
+    constexpr f64 k_pass_cost_slack = 1.5;   // A pass takes collapses up to this factor above the cost its goal needs
+    constexpr size_t k_min_pass_share = 16;  // A pass looks at the cheapest 1/16 of the candidates and does 1/16 of the collapses needed
+
+    // Area weighted sum of squared plane distances, p^T A p + 2 b^T p + c
+    struct Quadric
+    {
+        f64 m_a00 = 0.0, m_a01 = 0.0, m_a02 = 0.0, m_a11 = 0.0, m_a12 = 0.0, m_a22 = 0.0;
+        f64 m_b0 = 0.0, m_b1 = 0.0, m_b2 = 0.0;
+        f64 m_c = 0.0;
+        f64 m_weight = 0.0;
+
+        void add(const Quadric& other)
+        {
+            m_a00 += other.m_a00; m_a01 += other.m_a01; m_a02 += other.m_a02;
+            m_a11 += other.m_a11; m_a12 += other.m_a12; m_a22 += other.m_a22;
+            m_b0 += other.m_b0; m_b1 += other.m_b1; m_b2 += other.m_b2;
+            m_c += other.m_c;
+            m_weight += other.m_weight;
+        }
+    };
+
+    struct CollapseCandidate
+    {
+        f64 m_cost = 0.0;  // Mean squared distance, the square root is in mesh units
+        u32 m_from = 0;
+        u32 m_to = 0;
+    };
+
+    // Unnormalized, the length is twice the triangle's area
+    void compute_triangle_normal(const Vector3& p0, const Vector3& p1, const Vector3& p2, f64* out_normal)
+    {
+        const f64 e1[3] = { static_cast<f64>(p1.x) - p0.x, static_cast<f64>(p1.y) - p0.y, static_cast<f64>(p1.z) - p0.z };
+        const f64 e2[3] = { static_cast<f64>(p2.x) - p0.x, static_cast<f64>(p2.y) - p0.y, static_cast<f64>(p2.z) - p0.z };
+
+        out_normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        out_normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        out_normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    }
+
+    Quadric make_triangle_quadric(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+    {
+        f64 n[3];
+        compute_triangle_normal(p0, p1, p2, n);
+
+        const f64 length = ZV::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length == 0.0)
+        {
+            return {};
+        }
+
+        n[0] /= length;
+        n[1] /= length;
+        n[2] /= length;
+
+        const f64 d = -(n[0] * p0.x + n[1] * p0.y + n[2] * p0.z);
+        const f64 w = length * 0.5;
+
+        Quadric q{};
+        q.m_a00 = w * n[0] * n[0]; q.m_a01 = w * n[0] * n[1]; q.m_a02 = w * n[0] * n[2];
+        q.m_a11 = w * n[1] * n[1]; q.m_a12 = w * n[1] * n[2]; q.m_a22 = w * n[2] * n[2];
+        q.m_b0 = w * n[0] * d; q.m_b1 = w * n[1] * d; q.m_b2 = w * n[2] * d;
+        q.m_c = w * d * d;
+        q.m_weight = w;
+        return q;
+    }
+
+    f64 evaluate_quadric(const Quadric& q, const Vector3& p)
+    {
+        if (q.m_weight <= 0.0)
+        {
+            return 0.0;
+        }
+
+        const f64 x = p.x, y = p.y, z = p.z;
+        const f64 value =
+            q.m_a00 * x * x + q.m_a11 * y * y + q.m_a22 * z * z +
+            2.0 * (q.m_a01 * x * y + q.m_a02 * x * z + q.m_a12 * y * z) +
+            2.0 * (q.m_b0 * x + q.m_b1 * y + q.m_b2 * z) +
+            q.m_c;
+
+        // Rounding can push the value of a point on all planes slightly below zero
+        return ZV::max(value, 0.0) / q.m_weight;
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Meshlets
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    constexpr f32 k_meshlet_cone_weight = 0.5f;   // Score of a triangle facing 90 degrees away from the meshlet, relative to one new vertex
+    constexpr f32 k_meshlet_distance_weight = 0.25f;  // Score of a triangle at the meshlet's estimated radius, keeps meshlets round instead of strips
+    constexpr f32 k_meshlet_min_cone_dot = 0.1f;  // Cones wider than ~84 degrees would almost never cull
+    constexpr u8 k_unused_local_vertex = 0xff;
+
+    Vector3 compute_unit_normal(const Vector3& p0, const Vector3& p1, const Vector3& p2)
+    {
+        Vector3 normal = (p1 - p0).Cross(p2 - p0);
+        const f32 length = normal.Length();
+        return length > 0.0f ? normal / length : Vector3(0.0f, 0.0f, 0.0f);
+    }
+
+    void compute_meshlet_bounds(const MeshletData& meshlets, const MeshVertex* vertices, const DynamicArray<Vector3>& triangle_normals, const u32* triangle_ids, Meshlet* meshlet)
+    {
+        const u16* meshlet_vertices = meshlets.m_vertices.data() + meshlet->m_vertex_offset;
+        const u8* meshlet_triangles = meshlets.m_triangles.data() + meshlet->m_triangle_offset * 3;
+
+        Vector3 bounds_min = vertices[meshlet_vertices[0]].position;
+        Vector3 bounds_max = bounds_min;
+        for (u32 i = 1; i < meshlet->m_vertex_count; i++)
+        {
+            bounds_min = Vector3::Min(bounds_min, vertices[meshlet_vertices[i]].position);
+            bounds_max = Vector3::Max(bounds_max, vertices[meshlet_vertices[i]].position);
+        }
+
+        meshlet->m_center = (bounds_min + bounds_max) * 0.5f;
+        meshlet->m_radius = 0.0f;
+        for (u32 i = 0; i < meshlet->m_vertex_count; i++)
+        {
+            meshlet->m_radius = ZV::max(meshlet->m_radius, Vector3::Distance(meshlet->m_center, vertices[meshlet_vertices[i]].position));
+        }
+
+        Vector3 axis(0.0f, 0.0f, 0.0f);
+        for (u32 i = 0; i < meshlet->m_triangle_count; i++)
+        {
+            axis += triangle_normals[triangle_ids[i]];
+        }
+
+        meshlet->m_cone_apex = meshlet->m_center;
+        meshlet->m_cone_axis = Vector3(0.0f, 0.0f, 0.0f);
+        meshlet->m_cone_cutoff = 1.0f;
+
+        const f32 axis_length = axis.Length();
+        if (axis_length == 0.0f)
+        {
+            return;
+        }
+        axis /= axis_length;
+        meshlet->m_cone_axis = axis;
+
+        f32 min_dot = 1.0f;
+        for (u32 i = 0; i < meshlet->m_triangle_count; i++)
+        {
+            const Vector3& normal = triangle_normals[triangle_ids[i]];
+            if (normal != Vector3(0.0f, 0.0f, 0.0f))
+            {
+                min_dot = ZV::min(min_dot, normal.Dot(axis));
+            }
+        }
+
+        if (min_dot <= k_meshlet_min_cone_dot)
+        {
+            return;
+        }
+
+        // Move the apex back along the axis until it is behind every triangle's plane, so the test is conservative for the
+        // whole meshlet and not just its center
+        f32 max_t = 0.0f;
+        for (u32 i = 0; i < meshlet->m_triangle_count; i++)
+        {
+            const Vector3& normal = triangle_normals[triangle_ids[i]];
+            const f32 normal_dot_axis = normal.Dot(axis);
+            if (normal_dot_axis <= 0.0f)
+            {
+                continue;
+            }
+
+            const Vector3& p0 = vertices[meshlet_vertices[meshlet_triangles[i * 3]]].position;
+            max_t = ZV::max(max_t, (meshlet->m_center - p0).Dot(normal) / normal_dot_axis);
+        }
+
+        meshlet->m_cone_apex = meshlet->m_center - axis * max_t;
+        // The cone of view directions that see only back faces is the normal cone rotated by 90 degrees
+        meshlet->m_cone_cutoff = ZV::sqrt(1.0f - min_dot * min_dot);
+    }
+
+    enum class SimplifyVertexKind : u8
+    {
+        Free,    // Unique position inside the mesh
+        Seam,    // One of the two copies of a position on a uv or normal seam, slides along the seam together with its twin
+        Locked,  // Open borders, seam ends and corners, and positions with more than two copies
+    };
+
+    // Border edges are directed edges without a twin. Between positions that is an open border, between vertices only it
+    // is a seam, whose twin edge uses the other copies of its positions. out_position_ids holds the lowest vertex with the
+    // same position, out_next_copies links the copies of a position in a ring.
+    void classify_simplify_vertices(
+        const u16* indices, size_t num_indices, const MeshVertex* vertices, size_t num_vertices,
+        DynamicArray<SimplifyVertexKind>& out_kinds, DynamicArray<u32>& out_position_ids, DynamicArray<u32>& out_next_copies)
+    {
+        DynamicArray<u32> order(num_vertices);
+        fill_sequential(order.begin(), order.end(), 0u);
+
+        auto position_less = [vertices](u32 a, u32 b)
+        {
+            const Vector3& pa = vertices[a].position;
+            const Vector3& pb = vertices[b].position;
+            if (pa.x != pb.x) return pa.x < pb.x;
+            if (pa.y != pb.y) return pa.y < pb.y;
+            if (pa.z != pb.z) return pa.z < pb.z;
+            return a < b;
+        };
+        sort_container(order.begin(), order.end(), position_less);
+
+        out_position_ids.resize(num_vertices);
+        out_next_copies.resize(num_vertices);
+        DynamicArray<u32> num_copies(num_vertices, 0);
+
+        for (size_t begin = 0, end = 0; begin < num_vertices; begin = end)
+        {
+            const Vector3& position = vertices[order[begin]].position;
+            for (end = begin + 1; end < num_vertices; end++)
+            {
+                const Vector3& other = vertices[order[end]].position;
+                if (other.x != position.x || other.y != position.y || other.z != position.z)
+                {
+                    break;
+                }
+            }
+
+            for (size_t i = begin; i < end; i++)
+            {
+                out_position_ids[order[i]] = order[begin];
+                out_next_copies[order[i]] = order[i + 1 < end ? i + 1 : begin];
+            }
+            num_copies[order[begin]] = static_cast<u32>(end - begin);
+        }
+
+        DynamicArray<u32> edges(num_indices);
+        DynamicArray<u32> position_edges(num_indices);
+        for (size_t i = 0; i < num_indices; i += 3)
+        {
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                const u32 a = indices[i + corner];
+                const u32 b = indices[i + (corner + 1) % 3];
+                edges[i + corner] = (a << 16) | b;
+                position_edges[i + corner] = (out_position_ids[a] << 16) | out_position_ids[b];
+            }
+        }
+        sort_container(edges.begin(), edges.end());
+        sort_container(position_edges.begin(), position_edges.end());
+
+        DynamicArray<bool> is_on_border(num_vertices, false);
+        DynamicArray<bool> is_on_open_border(num_vertices, false);
+        for (size_t i = 0; i < num_indices; i++)
+        {
+            if (!std::binary_search(edges.begin(), edges.end(), (edges[i] << 16) | (edges[i] >> 16)))
+            {
+                is_on_border[edges[i] >> 16] = true;
+                is_on_border[edges[i] & 0xffff] = true;
+            }
+            if (!std::binary_search(position_edges.begin(), position_edges.end(), (position_edges[i] << 16) | (position_edges[i] >> 16)))
+            {
+                is_on_open_border[position_edges[i] >> 16] = true;
+                is_on_open_border[position_edges[i] & 0xffff] = true;
+            }
+        }
+
+        // A seam that ends inside the mesh leaves its last vertex unique but on a border, it stays put like the seam corners
+        out_kinds.resize(num_vertices);
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            const u32 position_id = out_position_ids[i];
+            if (is_on_open_border[position_id] || num_copies[position_id] > 2 || (num_copies[position_id] == 1 && is_on_border[i]))
+            {
+                out_kinds[i] = SimplifyVertexKind::Locked;
+            }
+            else
+            {
+                out_kinds[i] = num_copies[position_id] == 2 ? SimplifyVertexKind::Seam : SimplifyVertexKind::Free;
+            }
+        }
+    }
+}
+
+VertexCacheStats analyze_vertex_cache(const u16* indices, size_t num_indices, size_t num_vertices, u32 cache_size, VertexCacheModel model)
+{
+    zv_assert_msg(num_indices % 3 == 0, "Index count must be a multiple of 3");
+    zv_assert_msg(cache_size > 0, "Cache needs at least one entry");
+
+    VertexCacheStats stats{};
+    stats.m_num_triangles = static_cast<u32>(num_indices / 3);
+
+    DynamicArray<bool> is_referenced(num_vertices, false);
+    for (size_t i = 0; i < num_indices; i++)
+    {
+        if (!is_referenced[indices[i]])
+        {
+            is_referenced[indices[i]] = true;
+            stats.m_num_vertices++;
+        }
+    }
+
+    if (model == VertexCacheModel::FIFO)
+    {
+        // A vertex is still cached while fewer than cache_size other vertices were inserted after it
+        DynamicArray<u32> insert_time(num_vertices, 0);
+        u32 time = cache_size + 1;
+
+        for (size_t i = 0; i < num_indices; i++)
+        {
+            const u16 index = indices[i];
+            if (time - insert_time[index] > cache_size)
+            {
+                insert_time[index] = time++;
+                stats.m_num_transformed++;
+            }
+        }
+    }
+    else
+    {
+        // Most recently used first
+        DynamicArray<u16> cache;
+        cache.reserve(cache_size + 1);
+
+        for (size_t i = 0; i < num_indices; i++)
+        {
+            const u16 index = indices[i];
+            auto it = std::find(cache.begin(), cache.end(), index);
+
+            if (it != cache.end())
+            {
+                cache.erase(it);
+            }
+            else
+            {
+                stats.m_num_transformed++;
+            }
+
+            cache.insert(cache.begin(), index);
+            if (cache.size() > cache_size)
+            {
+                cache.pop_back();
+            }
+        }
+    }
+
+    return stats;
+}
+
+void optimize_vertex_cache(u16* dst_indices, const u16* indices, size_t num_indices, size_t num_vertices)
+{
+    zv_assert_msg(num_indices % 3 == 0, "Index count must be a multiple of 3");
+    zv_assert_msg(dst_indices != indices, "Vertex cache optimization can't run in place");
+
+    static const VertexScoreTables s_score_tables = make_vertex_score_tables();
+
+    const u32 num_triangles = static_cast<u32>(num_indices / 3);
+    if (num_triangles == 0)
+    {
+        return;
+    }
+
+    // Triangles using each vertex, the open ones are kept at the front of each vertex's range
+    DynamicArray<u32> num_open_triangles(num_vertices, 0);
+    for (size_t i = 0; i < num_indices; i++)
+    {
+        num_open_triangles[indices[i]]++;
+    }
+
+    DynamicArray<u32> triangle_offsets(num_vertices + 1, 0);
+    for (size_t vertex = 0; vertex < num_vertices; vertex++)
+    {
+        triangle_offsets[vertex + 1] = triangle_offsets[vertex] + num_open_triangles[vertex];
+    }
+
+    DynamicArray<u32> vertex_triangles(num_indices);
+    {
+        DynamicArray<u32> fill_counts(num_vertices, 0);
+        for (size_t i = 0; i < num_indices; i++)
+        {
+            const u16 vertex = indices[i];
+            vertex_triangles[triangle_offsets[vertex] + fill_counts[vertex]++] = static_cast<u32>(i / 3);
+        }
+    }
+
+    DynamicArray<u32> cache_positions(num_vertices, k_unused_vertex);
+    DynamicArray<f32> vertex_scores(num_vertices);
+    for (size_t vertex = 0; vertex < num_vertices; vertex++)
+    {
+        vertex_scores[vertex] = get_vertex_score(s_score_tables, k_unused_vertex, num_open_triangles[vertex]);
+    }
+
+    DynamicArray<f32> triangle_scores(num_triangles);
+    DynamicArray<bool> is_emitted(num_triangles, false);
+    u32 best_triangle = 0;
+
+    for (u32 triangle = 0; triangle < num_triangles; triangle++)
+    {
+        const u16* tri = indices + triangle * 3;
+        triangle_scores[triangle] = vertex_scores[tri[0]] + vertex_scores[tri[1]] + vertex_scores[tri[2]];
+
+        if (triangle_scores[triangle] > triangle_scores[best_triangle])
+        {
+            best_triangle = triangle;
+        }
+    }
+
+    // Three extra slots for the vertices of the emitted triangle, which push the oldest ones out
+    u32 cache[k_vertex_cache_size + 3];
+    u32 cache_count = 0;
+    u32 input_cursor = 0;
+
+    for (u32 num_emitted = 0; num_emitted < num_triangles; num_emitted++)
+    {
+        if (best_triangle == k_invalid_triangle)
+        {
+            // Nothing in the cache touches an open triangle, continue with the next one in input order
+            while (is_emitted[input_cursor])
+            {
+                input_cursor++;
+            }
+            best_triangle = input_cursor;
+        }
+
+        const u16* tri = indices + best_triangle * 3;
+        memcpy(dst_indices + num_emitted * 3, tri, 3 * sizeof(u16));
+        is_emitted[best_triangle] = true;
+
+        u32 new_cache[k_vertex_cache_size + 3];
+        u32 new_cache_count = 0;
+
+        for (u32 corner = 0; corner < 3; corner++)
+        {
+            const u16 vertex = tri[corner];
+
+            // Close the triangle in the vertex's range by swapping it behind the open ones
+            u32* triangles = vertex_triangles.data() + triangle_offsets[vertex];
+            u32& num_open = num_open_triangles[vertex];
+            for (u32 i = 0; i < num_open; i++)
+            {
+                if (triangles[i] == best_triangle)
+                {
+                    triangles[i] = triangles[num_open - 1];
+                    triangles[num_open - 1] = best_triangle;
+                    num_open--;
+                    break;
+                }
+            }
+
+            if (std::find(new_cache, new_cache + new_cache_count, vertex) == new_cache + new_cache_count)
+            {
+                new_cache[new_cache_count++] = vertex;
+            }
+        }
+
+        for (u32 i = 0; i < cache_count; i++)
+        {
+            const u32 vertex = cache[i];
+            if (vertex != tri[0] && vertex != tri[1] && vertex != tri[2])
+            {
+                new_cache[new_cache_count++] = vertex;
+            }
+        }
+
+        // Vertices that fell out of the cache are rescored too, their triangles get updated below
+        for (u32 i = 0; i < new_cache_count; i++)
+        {
+            const u32 vertex = new_cache[i];
+            cache_positions[vertex] = i < k_vertex_cache_size ? i : k_unused_vertex;
+            vertex_scores[vertex] = get_vertex_score(s_score_tables, cache_positions[vertex], num_open_triangles[vertex]);
+        }
+
+        cache_count = ZV::min(new_cache_count, k_vertex_cache_size);
+        memcpy(cache, new_cache, cache_count * sizeof(u32));
+
+        // Only triangles around the touched vertices changed score, the best next one is among them
+        best_triangle = k_invalid_triangle;
+        f32 best_score = -1.0f;
+
+        for (u32 i = 0; i < new_cache_count; i++)
+        {
+            const u32 vertex = new_cache[i];
+            const u32* triangles = vertex_triangles.data() + triangle_offsets[vertex];
+
+            for (u32 j = 0; j < num_open_triangles[vertex]; j++)
+            {
+                const u32 triangle = triangles[j];
+                const u16* open_tri = indices + triangle * 3;
+                triangle_scores[triangle] = vertex_scores[open_tri[0]] + vertex_scores[open_tri[1]] + vertex_scores[open_tri[2]];
+
+                if (triangle_scores[triangle] > best_score)
+                {
+                    best_score = triangle_scores[triangle];
+                    best_triangle = triangle;
+                }
+            }
+        }
+    }
+}
+
+u32 optimize_vertex_fetch(MeshVertex* dst_vertices, u16* indices, size_t num_indices, const MeshVertex* vertices, size_t num_vertices)
+{
+    zv_assert_msg(dst_vertices != vertices, "Vertex fetch optimization can't run in place");
+
+    DynamicArray<u32> remap(num_vertices, k_unused_vertex);
+    u32 num_kept = 0;
+
+    for (size_t i = 0; i < num_indices; i++)
+    {
+        const u16 index = indices[i];
+        if (remap[index] == k_unused_vertex)
+        {
+            remap[index] = num_kept;
+            dst_vertices[num_kept++] = vertices[index];
+        }
+
+        indices[i] = static_cast<u16>(remap[index]);
+    }
+
+    return num_kept;
+}
+
+void optimize_mesh(MeshGeometryData* geometry, MeshOptimizationStats* out_stats)
+{
+    const size_t num_indices = geometry->m_indices.size();
+    const size_t num_vertices = geometry->m_vertices.size();
+
+    if (num_indices < 3 || num_indices % 3 != 0)
+    {
+        return;
+    }
+
+    if (out_stats)
+    {
+        out_stats->m_before = analyze_vertex_cache(geometry->m_indices.data(), num_indices, num_vertices);
+    }
+
+    DynamicArray<u16> indices(num_indices);
+    optimize_vertex_cache(indices.data(), geometry->m_indices.data(), num_indices, num_vertices);
+
+    DynamicArray<MeshVertex> vertices(num_vertices);
+    const u32 num_kept = optimize_vertex_fetch(vertices.data(), indices.data(), num_indices, geometry->m_vertices.data(), num_vertices);
+    vertices.resize(num_kept);
+
+    geometry->m_indices = move_ptr(indices);
+    geometry->m_vertices = move_ptr(vertices);
+    geometry->m_packed_vertices.clear();  // Stale now, repacked on demand
+    geometry->m_positions.clear();
+    geometry->m_attributes.clear();
+    geometry->m_lods.clear();
+
+    if (out_stats)
+    {
+        out_stats->m_after = analyze_vertex_cache(geometry->m_indices.data(), num_indices, num_kept);
+        out_stats->m_num_removed_vertices = static_cast<u32>(num_vertices - num_kept);
+    }
+}
+
+void repair_mesh(MeshGeometryData* geometry, MeshRepairStats* out_stats)
+{
+    MeshRepairStats stats{};
+    const size_t num_vertices = geometry->m_vertices.size();
+    MeshVertex* vertices = geometry->m_vertices.data();
+
+    // A trailing partial triangle can't be drawn
+    const size_t num_indices = geometry->m_indices.size() - geometry->m_indices.size() % 3;
+    stats.m_num_invalid_triangles += geometry->m_indices.size() != num_indices ? 1 : 0;
+
+    // Every vertex maps to the first exact copy of itself, vertices with unusable positions stay unmapped. The table uses
+    // open addressing with linear probing and is at most half full.
+    DynamicArray<u32> weld(num_vertices, k_unused_vertex);
+    size_t table_size = 1;
+    while (table_size < num_vertices * 2)
+    {
+        table_size *= 2;
+    }
+    DynamicArray<u32> table(table_size, k_unused_vertex);
+    const size_t table_mask = table_size - 1;
+
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+        bool fixed = false;
+        const bool valid = sanitize_vertex(&vertices[i], &fixed);
+        stats.m_num_fixed_vertices += fixed ? 1 : 0;
+
+        if (!valid)
+        {
+            continue;
+        }
+
+        size_t slot = hash_vertex(vertices[i]) & table_mask;
+        while (table[slot] != k_unused_vertex && memcmp(&vertices[table[slot]], &vertices[i], sizeof(MeshVertex)) != 0)
+        {
+            slot = (slot + 1) & table_mask;
+        }
+
+        if (table[slot] == k_unused_vertex)
+        {
+            table[slot] = static_cast<u32>(i);
+        }
+        else
+        {
+            stats.m_num_welded_vertices++;
+        }
+        weld[i] = table[slot];
+    }
+
+    // Drop triangles that can't be drawn or cover no pixels, compacting the index buffer in place
+    u16* indices = geometry->m_indices.data();
+    DynamicArray<u8> referenced(num_vertices, 0);
+    size_t num_kept_indices = 0;
+
+    for (size_t i = 0; i < num_indices; i += 3)
+    {
+        const u32 i0 = indices[i + 0];
+        const u32 i1 = indices[i + 1];
+        const u32 i2 = indices[i + 2];
+
+        if (i0 >= num_vertices || i1 >= num_vertices || i2 >= num_vertices ||
+            weld[i0] == k_unused_vertex || weld[i1] == k_unused_vertex || weld[i2] == k_unused_vertex)
+        {
+            stats.m_num_invalid_triangles++;
+            continue;
+        }
+
+        const u32 v0 = weld[i0];
+        const u32 v1 = weld[i1];
+        const u32 v2 = weld[i2];
+
+        if (v0 == v1 || v1 == v2 || v2 == v0)
+        {
+            stats.m_num_degenerate_triangles++;
+            continue;
+        }
+
+        const Vector3& p0 = vertices[v0].position;
+        const Vector3& p1 = vertices[v1].position;
+        const Vector3& p2 = vertices[v2].position;
+
+        f64 n[3];
+        compute_triangle_normal(p0, p1, p2, n);
+        const f64 twice_area = ZV::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        const f64 edge_lengths = static_cast<f64>((p1 - p0).LengthSquared()) + (p2 - p0).LengthSquared();
+        if (twice_area <= k_min_triangle_sine * edge_lengths)
+        {
+            stats.m_num_zero_area_triangles++;
+            continue;
+        }
+
+        referenced[v0] = referenced[v1] = referenced[v2] = 1;
+        indices[num_kept_indices++] = static_cast<u16>(v0);
+        indices[num_kept_indices++] = static_cast<u16>(v1);
+        indices[num_kept_indices++] = static_cast<u16>(v2);
+    }
+
+    // Compact the referenced vertices in place, keeping their order
+    DynamicArray<u32> remap(num_vertices, k_unused_vertex);
+    u32 num_kept_vertices = 0;
+    for (size_t i = 0; i < num_vertices; i++)
+    {
+        if (referenced[i])
+        {
+            remap[i] = num_kept_vertices;
+            vertices[num_kept_vertices++] = vertices[i];
+        }
+    }
+
+    for (size_t i = 0; i < num_kept_indices; i++)
+    {
+        indices[i] = static_cast<u16>(remap[indices[i]]);
+    }
+
+    stats.m_num_removed_vertices = static_cast<u32>(num_vertices - num_kept_vertices) - stats.m_num_welded_vertices;
+
+    if (num_kept_vertices != num_vertices || num_kept_indices != geometry->m_indices.size() || stats.m_num_fixed_vertices > 0)
+    {
+        geometry->m_vertices.resize(num_kept_vertices);
+        geometry->m_indices.resize(num_kept_indices);
+        geometry->m_packed_vertices.clear();  // Stale now, repacked on demand
+        geometry->m_positions.clear();
+        geometry->m_attributes.clear();
+        geometry->m_lods.clear();
+        compute_mesh_bounds(geometry);        // The imported bounds may include dropped or non finite positions
+    }
+
+    if (out_stats)
+    {
+        *out_stats = stats;
+    }
+}
+
+u32 simplify_mesh(
+    u16* dst_indices, const u16* indices, size_t num_indices,
+    const MeshVertex* vertices, size_t num_vertices,
+    size_t target_index_count, f32 target_error, f32* out_rms_error)
+{
+    zv_assert_msg(num_indices % 3 == 0, "Index count must be a multiple of 3");
+
+    DynamicArray<u16> result(indices, indices + num_indices);
+    size_t count = num_indices;
+    f64 max_cost = 0.0;
+
+    DynamicArray<SimplifyVertexKind> kinds;
+    DynamicArray<u32> position_ids;
+    DynamicArray<u32> next_copies;
+    classify_simplify_vertices(indices, num_indices, vertices, num_vertices, kinds, position_ids, next_copies);
+
+    // Quadrics are kept per position, so both sides of a seam measure the same surface
+    DynamicArray<Quadric> quadrics(num_vertices);
+    for (size_t i = 0; i < num_indices; i += 3)
+    {
+        const Quadric q = make_triangle_quadric(vertices[indices[i]].position, vertices[indices[i + 1]].position, vertices[indices[i + 2]].position);
+        for (u32 corner = 0; corner < 3; corner++)
+        {
+            quadrics[position_ids[indices[i + corner]]].add(q);
+        }
+    }
+
+    const f64 max_allowed_cost = static_cast<f64>(target_error) * target_error;
+
+    DynamicArray<u32> remap(num_vertices);
+    fill_sequential(remap.begin(), remap.end(), 0u);
+
+    DynamicArray<u32> triangle_offsets(num_vertices + 1);
+    DynamicArray<u32> vertex_triangles;
+    DynamicArray<CollapseCandidate> candidates;
+    DynamicArray<bool> is_touched;
+
+    // Walks the triangles around from as they are after this pass' collapses so far. Returns false if moving from onto to
+    // would flip one of them, out_num_removed receives the number of triangles the collapse removes.
+    auto check_collapse = [&](u32 from, u32 to, u32* out_num_removed)
+    {
+        const Vector3& to_position = vertices[to].position;
+        u32 num_removed = 0;
+
+        for (u32 j = triangle_offsets[from]; j < triangle_offsets[from + 1]; j++)
+        {
+            const u16* tri = result.data() + vertex_triangles[j] * 3;
+            const u32 corners[3] = { remap[tri[0]], remap[tri[1]], remap[tri[2]] };
+
+            if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0])
+            {
+                continue;  // Already removed by an earlier collapse
+            }
+
+            if (corners[0] == to || corners[1] == to || corners[2] == to)
+            {
+                num_removed++;
+                continue;
+            }
+
+            const Vector3* positions[3] = { &vertices[corners[0]].position, &vertices[corners[1]].position, &vertices[corners[2]].position };
+
+            f64 old_normal[3];
+            compute_triangle_normal(*positions[0], *positions[1], *positions[2], old_normal);
+
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                if (corners[corner] == from)
+                {
+                    positions[corner] = &to_position;
+                }
+            }
+
+            f64 new_normal[3];
+            compute_triangle_normal(*positions[0], *positions[1], *positions[2], new_normal);
+
+            const f64 old_length_sq = old_normal[0] * old_normal[0] + old_normal[1] * old_normal[1] + old_normal[2] * old_normal[2];
+            const f64 new_length_sq = new_normal[0] * new_normal[0] + new_normal[1] * new_normal[1] + new_normal[2] * new_normal[2];
+            const f64 dot = old_normal[0] * new_normal[0] + old_normal[1] * new_normal[1] + old_normal[2] * new_normal[2];
+
+            // Slivers without an area have no orientation to lose
+            if (old_length_sq > 0.0 && dot <= k_min_flip_cosine * ZV::sqrt(old_length_sq * new_length_sq))
+            {
+                return false;
+            }
+        }
+
+        *out_num_removed = num_removed;
+        return num_removed > 0;
+    };
+
+    // Seam edges are used by one triangle only, whose twin belongs to the other copies of the two positions
+    auto is_seam_edge = [&](u32 a, u32 b)
+    {
+        bool has_forward = false;
+        bool has_backward = false;
+        for (u32 j = triangle_offsets[a]; j < triangle_offsets[a + 1]; j++)
+        {
+            const u16* tri = result.data() + vertex_triangles[j] * 3;
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                const u32 corner_vertex = remap[tri[corner]];
+                const u32 next_vertex = remap[tri[(corner + 1) % 3]];
+                has_forward |= corner_vertex == a && next_vertex == b;
+                has_backward |= corner_vertex == b && next_vertex == a;
+            }
+        }
+        return has_forward != has_backward;
+    };
+
+    // Each pass collapses the cheapest independent edges, then the index buffer is rebuilt
+    while (count > target_index_count)
+    {
+        const u32 num_triangles = static_cast<u32>(count / 3);
+
+        std::fill(triangle_offsets.begin(), triangle_offsets.end(), 0u);
+        for (size_t i = 0; i < count; i++)
+        {
+            triangle_offsets[result[i] + 1]++;
+        }
+        for (size_t vertex = 0; vertex < num_vertices; vertex++)
+        {
+            triangle_offsets[vertex + 1] += triangle_offsets[vertex];
+        }
+
+        vertex_triangles.resize(count);
+        {
+            DynamicArray<u32> fill_counts(num_vertices, 0);
+            for (size_t i = 0; i < count; i++)
+            {
+                const u16 vertex = result[i];
+                vertex_triangles[triangle_offsets[vertex] + fill_counts[vertex]++] = static_cast<u32>(i / 3);
+            }
+        }
+
+        // Every directed edge of a free vertex is a candidate, the opposite direction comes from the neighbouring triangle.
+        // Seam edges have no neighbouring triangle on their side, so seam vertices take both directions.
+        candidates.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            const u32 from = result[i];
+            if (kinds[from] == SimplifyVertexKind::Locked)
+            {
+                continue;
+            }
+
+            const size_t first = i - i % 3;
+            const u32 neighbours[2] = { result[first + (i % 3 + 1) % 3], result[first + (i % 3 + 2) % 3] };
+            const u32 num_neighbours = kinds[from] == SimplifyVertexKind::Seam ? 2 : 1;
+
+            for (u32 n = 0; n < num_neighbours; n++)
+            {
+                const u32 to = neighbours[n];
+                if (kinds[from] == SimplifyVertexKind::Seam && (next_copies[to] == to || !is_seam_edge(from, to)))
+                {
+                    continue;
+                }
+
+                Quadric q = quadrics[position_ids[from]];
+                q.add(quadrics[position_ids[to]]);
+
+                const f64 cost = evaluate_quadric(q, vertices[to].position);
+                if (cost <= max_allowed_cost)
+                {
+                    candidates.push_back({ cost, from, to });
+                }
+            }
+        }
+
+        auto candidate_less = [](const CollapseCandidate& a, const CollapseCandidate& b)
+        {
+            if (a.m_cost != b.m_cost) return a.m_cost < b.m_cost;
+            if (a.m_from != b.m_from) return a.m_from < b.m_from;
+            return a.m_to < b.m_to;
+        };
+        sort_container(candidates.begin(), candidates.end(), candidate_less);
+
+        is_touched.assign(num_vertices, false);
+
+        u32 num_remaining = num_triangles;
+        u32 num_collapses = 0;
+        const u32 target_triangles = static_cast<u32>(target_index_count / 3);
+
+        // A collapse removes about two triangles. Cheap collapses blocked by a touched vertex are left for the next pass
+        // instead of reaching further down the list, past the cost the target needs, for expensive ones. Passes near the
+        // target still look at a share of the list, and every pass does a share of the collapses still needed, so flipping
+        // candidates that stay cheap can't shrink the passes to a handful of collapses each.
+        const size_t num_needed = static_cast<size_t>(num_remaining - ZV::min(num_remaining, target_triangles)) / 2;
+        const size_t goal = ZV::min(ZV::max(num_needed, candidates.size() / k_min_pass_share), candidates.size());
+        const f64 pass_max_cost = goal > 0 ? candidates[goal - 1].m_cost * k_pass_cost_slack : 0.0;
+        const size_t min_pass_collapses = ZV::max(num_needed / k_min_pass_share, static_cast<size_t>(1));
+
+        for (const CollapseCandidate& candidate : candidates)
+        {
+            if (num_remaining <= target_triangles || (candidate.m_cost > pass_max_cost && num_collapses >= min_pass_collapses))
+            {
+                break;
+            }
+
+            const u32 from = candidate.m_from;
+            const u32 to = candidate.m_to;
+
+            // Touched vertices keep the triangle fans below exact for the rest of the pass
+            if (is_touched[from] || is_touched[to])
+            {
+                continue;
+            }
+
+            u32 num_removed = 0;
+            if (!check_collapse(from, to, &num_removed))
+            {
+                continue;
+            }
+
+            // A seam vertex moves along the seam, its twin follows onto the copy of to on the other side
+            if (kinds[from] == SimplifyVertexKind::Seam)
+            {
+                const u32 twin = next_copies[from];
+                if (is_touched[twin])
+                {
+                    continue;
+                }
+
+                u32 twin_to = UINT32_MAX;
+                for (u32 copy = next_copies[to]; copy != to && twin_to == UINT32_MAX; copy = next_copies[copy])
+                {
+                    twin_to = !is_touched[copy] && is_seam_edge(twin, copy) ? copy : UINT32_MAX;
+                }
+
+                u32 num_twin_removed = 0;
+                if (twin_to == UINT32_MAX || !check_collapse(twin, twin_to, &num_twin_removed))
+                {
+                    continue;
+                }
+
+                remap[twin] = twin_to;
+                is_touched[twin] = true;
+                is_touched[twin_to] = true;
+                num_removed += num_twin_removed;
+            }
+
+            remap[from] = to;
+            is_touched[from] = true;
+            is_touched[to] = true;
+            quadrics[position_ids[to]].add(quadrics[position_ids[from]]);
+
+            max_cost = ZV::max(max_cost, candidate.m_cost);
+            num_remaining -= num_removed;
+            num_collapses++;
+        }
+
+        if (num_collapses == 0)
+        {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i < count; i += 3)
+        {
+            const u16 a = static_cast<u16>(remap[result[i]]);
+            const u16 b = static_cast<u16>(remap[result[i + 1]]);
+            const u16 c = static_cast<u16>(remap[result[i + 2]]);
+
+            if (a != b && b != c && c != a)
+            {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        count = write;
+    }
+
+    memcpy(dst_indices, result.data(), count * sizeof(u16));
+
+    if (out_rms_error)
+    {
+        *out_rms_error = static_cast<f32>(ZV::sqrt(max_cost));
+    }
+
+    return static_cast<u32>(count);
+}
+
+void generate_mesh_lods(MeshGeometryData* geometry, const LodChainSettings& settings)
+{
+    geometry->m_lods.clear();
+
+    const size_t num_indices = geometry->m_indices.size();
+    const size_t num_vertices = geometry->m_vertices.size();
+
+    if (num_indices < 3 || num_indices % 3 != 0)
+    {
+        return;
+    }
+
+    Vector3 bounds_min = geometry->m_vertices[0].position;
+    Vector3 bounds_max = geometry->m_vertices[0].position;
+    for (const MeshVertex& vertex : geometry->m_vertices)
+    {
+        bounds_min = Vector3::Min(bounds_min, vertex.position);
+        bounds_max = Vector3::Max(bounds_max, vertex.position);
+    }
+
+    const Vector3 extent = bounds_max - bounds_min;
+    const f32 max_error = settings.m_max_relative_error * ZV::sqrt(extent.x * extent.x + extent.y * extent.y + extent.z * extent.z);
+
+    DynamicArray<u16> lod_indices(num_indices);
+    size_t previous_count = num_indices;
+    f32 previous_error = 0.0f;
+
+    for (u32 lod = 0; lod < settings.m_max_lods; lod++)
+    {
+        const size_t previous_triangles = previous_count / 3;
+        const size_t target_triangles = ZV::max(static_cast<size_t>(previous_triangles * settings.m_triangle_ratio), static_cast<size_t>(settings.m_min_triangles));
+
+        if (target_triangles >= previous_triangles)
+        {
+            break;
+        }
+
+        f32 error = 0.0f;
+        const u32 count = simplify_mesh(
+            lod_indices.data(), geometry->m_indices.data(), num_indices,
+            geometry->m_vertices.data(), num_vertices,
+            target_triangles * 3, max_error, &error);
+
+        // Locked borders and seams or the error limit stalled the reduction, a level this close to the last one isn't worth keeping
+        if (static_cast<size_t>(count) * 10 > previous_count * 9)
+        {
+            break;
+        }
+
+        MeshLod& mesh_lod = geometry->m_lods.emplace_back();
+        mesh_lod.m_indices.resize(count);
+        optimize_vertex_cache(mesh_lod.m_indices.data(), lod_indices.data(), count, num_vertices);
+
+        // Every level starts from LOD 0, keep the error monotonic so distance based selection never refines when moving away
+        mesh_lod.m_rms_error = ZV::max(error, previous_error);
+
+        previous_count = count;
+        previous_error = mesh_lod.m_rms_error;
+    }
+}
+
+void build_meshlets(const MeshGeometryData& geometry, MeshletData* out_meshlets)
+{
+    out_meshlets->m_meshlets.clear();
+    out_meshlets->m_vertices.clear();
+    out_meshlets->m_triangles.clear();
+
+    const u16* indices = geometry.m_indices.data();
+    const size_t num_indices = geometry.m_indices.size();
+    const size_t num_vertices = geometry.m_vertices.size();
+    const MeshVertex* vertices = geometry.m_vertices.data();
+
+    zv_assert_msg(num_indices % 3 == 0, "Index count must be a multiple of 3");
+
+    const u32 num_triangles = static_cast<u32>(num_indices / 3);
+    if (num_triangles == 0)
+    {
+        return;
+    }
+
+    DynamicArray<Vector3> triangle_normals(num_triangles);
+    DynamicArray<Vector3> triangle_centroids(num_triangles);
+    DynamicArray<f32> triangle_areas(num_triangles);
+    for (u32 triangle = 0; triangle < num_triangles; triangle++)
+    {
+        const u16* tri = indices + triangle * 3;
+        const Vector3& p0 = vertices[tri[0]].position;
+        const Vector3& p1 = vertices[tri[1]].position;
+        const Vector3& p2 = vertices[tri[2]].position;
+
+        triangle_normals[triangle] = compute_unit_normal(p0, p1, p2);
+        triangle_centroids[triangle] = (p0 + p1 + p2) / 3.0f;
+        triangle_areas[triangle] = 0.5f * (p1 - p0).Cross(p2 - p0).Length();
+    }
+
+    DynamicArray<u32> triangle_offsets(num_vertices + 1, 0);
+    for (size_t i = 0; i < num_indices; i++)
+    {
+        triangle_offsets[indices[i] + 1]++;
+    }
+    for (size_t vertex = 0; vertex < num_vertices; vertex++)
+    {
+        triangle_offsets[vertex + 1] += triangle_offsets[vertex];
+    }
+
+    DynamicArray<u32> vertex_triangles(num_indices);
+    {
+        DynamicArray<u32> fill_counts(num_vertices, 0);
+        for (size_t i = 0; i < num_indices; i++)
+        {
+            const u16 vertex = indices[i];
+            vertex_triangles[triangle_offsets[vertex] + fill_counts[vertex]++] = static_cast<u32>(i / 3);
+        }
+    }
+
+    DynamicArray<bool> is_emitted(num_triangles, false);
+    DynamicArray<u8> local_vertices(num_vertices, k_unused_local_vertex);
+    u32 meshlet_triangle_ids[k_meshlet_max_triangles];
+
+    Meshlet meshlet{};
+    Vector3 normal_sum(0.0f, 0.0f, 0.0f);
+    Vector3 centroid_sum(0.0f, 0.0f, 0.0f);
+    f32 area_sum = 0.0f;
+    u32 input_cursor = 0;
+
+    // Lowest unemitted triangle touching the meshlet, the next meshlet grows from there to stay next to this one
+    auto find_adjacent_triangle = [&]()
+    {
+        u32 seed = k_invalid_triangle;
+        for (u32 i = 0; i < meshlet.m_vertex_count; i++)
+        {
+            const u16 vertex = out_meshlets->m_vertices[meshlet.m_vertex_offset + i];
+            for (u32 j = triangle_offsets[vertex]; j < triangle_offsets[vertex + 1]; j++)
+            {
+                if (!is_emitted[vertex_triangles[j]])
+                {
+                    seed = ZV::min(seed, vertex_triangles[j]);
+                }
+            }
+        }
+        return seed;
+    };
+
+    auto finish_meshlet = [&]()
+    {
+        compute_meshlet_bounds(*out_meshlets, vertices, triangle_normals, meshlet_triangle_ids, &meshlet);
+        out_meshlets->m_meshlets.emplace_back(meshlet);
+
+        for (u32 i = 0; i < meshlet.m_vertex_count; i++)
+        {
+            local_vertices[out_meshlets->m_vertices[meshlet.m_vertex_offset + i]] = k_unused_local_vertex;
+        }
+
+        meshlet = {};
+        meshlet.m_vertex_offset = static_cast<u32>(out_meshlets->m_vertices.size());
+        meshlet.m_triangle_offset = static_cast<u32>(out_meshlets->m_triangles.size() / 3);
+        normal_sum = Vector3(0.0f, 0.0f, 0.0f);
+        centroid_sum = Vector3(0.0f, 0.0f, 0.0f);
+        area_sum = 0.0f;
+    };
+
+    u32 seed = k_invalid_triangle;
+
+    for (u32 num_emitted = 0; num_emitted < num_triangles; num_emitted++)
+    {
+        u32 best_triangle = k_invalid_triangle;
+
+        if (meshlet.m_triangle_count > 0)
+        {
+            Vector3 axis = normal_sum;
+            axis.Normalize();
+
+            const Vector3 centroid = centroid_sum / static_cast<f32>(meshlet.m_triangle_count);
+            const f32 inv_radius = area_sum > 0.0f ? 1.0f / ZV::sqrt(area_sum / ZV_PI) : 0.0f;
+
+            f32 best_score = FLT_MAX;
+
+            for (u32 i = 0; i < meshlet.m_vertex_count; i++)
+            {
+                const u16 vertex = out_meshlets->m_vertices[meshlet.m_vertex_offset + i];
+
+                for (u32 j = triangle_offsets[vertex]; j < triangle_offsets[vertex + 1]; j++)
+                {
+                    const u32 triangle = vertex_triangles[j];
+                    if (is_emitted[triangle])
+                    {
+                        continue;
+                    }
+
+                    const u16* tri = indices + triangle * 3;
+                    const u32 num_new_vertices =
+                        (local_vertices[tri[0]] == k_unused_local_vertex) +
+                        (local_vertices[tri[1]] == k_unused_local_vertex) +
+                        (local_vertices[tri[2]] == k_unused_local_vertex);
+
+                    if (meshlet.m_vertex_count + num_new_vertices > k_meshlet_max_vertices)
+                    {
+                        continue;
+                    }
+
+                    const f32 distance = Vector3::Distance(centroid, triangle_centroids[triangle]);
+                    const f32 score =
+                        static_cast<f32>(num_new_vertices) +
+                        k_meshlet_cone_weight * (1.0f - triangle_normals[triangle].Dot(axis)) +
+                        k_meshlet_distance_weight * distance * inv_radius;
+                    if (score < best_score || (score == best_score && triangle < best_triangle))
+                    {
+                        best_score = score;
+                        best_triangle = triangle;
+                    }
+                }
+            }
+
+            if (best_triangle == k_invalid_triangle)
+            {
+                seed = find_adjacent_triangle();
+
+                // Small disconnected pieces share a meshlet instead of each getting a mostly empty one
+                if (seed != k_invalid_triangle || meshlet.m_vertex_count + 3 > k_meshlet_max_vertices)
+                {
+                    finish_meshlet();
+                }
+            }
+        }
+
+        if (best_triangle == k_invalid_triangle)
+        {
+            if (seed == k_invalid_triangle || is_emitted[seed])
+            {
+                while (is_emitted[input_cursor])
+                {
+                    input_cursor++;
+                }
+                seed = input_cursor;
+            }
+
+            best_triangle = seed;
+            seed = k_invalid_triangle;
+        }
+
+        const u16* tri = indices + best_triangle * 3;
+        for (u32 corner = 0; corner < 3; corner++)
+        {
+            const u16 vertex = tri[corner];
+            if (local_vertices[vertex] == k_unused_local_vertex)
+            {
+                local_vertices[vertex] = static_cast<u8>(meshlet.m_vertex_count++);
+                out_meshlets->m_vertices.push_back(vertex);
+            }
+            out_meshlets->m_triangles.push_back(local_vertices[vertex]);
+        }
+
+        meshlet_triangle_ids[meshlet.m_triangle_count++] = best_triangle;
+        normal_sum += triangle_normals[best_triangle];
+        centroid_sum += triangle_centroids[best_triangle];
+        area_sum += triangle_areas[best_triangle];
+        is_emitted[best_triangle] = true;
+
+        if (meshlet.m_triangle_count == k_meshlet_max_triangles)
+        {
+            seed = find_adjacent_triangle();
+            finish_meshlet();
+        }
+    }
+
+    if (meshlet.m_triangle_count > 0)
+    {
+        finish_meshlet();
+    }
+}
+
+MeshletStats analyze_meshlets(const MeshletData& meshlets)
+{
+    MeshletStats stats{};
+    stats.m_num_meshlets = static_cast<u32>(meshlets.m_meshlets.size());
+
+    for (const Meshlet& meshlet : meshlets.m_meshlets)
+    {
+        stats.m_num_triangles += meshlet.m_triangle_count;
+        stats.m_num_vertices += meshlet.m_vertex_count;
+
+        if (meshlet.m_cone_cutoff < 1.0f)
+        {
+            stats.m_num_cullable++;
+            stats.m_cone_angle_sum += asin(static_cast<f64>(meshlet.m_cone_cutoff));
+        }
+    }
+
+    return stats;
+}
+
+bool is_meshlet_backfacing(const Meshlet& meshlet, const Vector3& view_position)
+{
+    if (meshlet.m_cone_cutoff >= 1.0f)
+    {
+        return false;
+    }
+
+    const Vector3 direction = meshlet.m_cone_apex - view_position;
+    const f32 distance = direction.Length();
+
+    return direction.Dot(meshlet.m_cone_axis) >= meshlet.m_cone_cutoff * distance;
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <CoreDefs.h>
+#include <Geometry.h>
+
+constexpr u32 k_vertex_cache_size = 32;  // Cache size the triangle order is optimized for
+
+enum class VertexCacheModel : u8
+{
+    FIFO = 0,  // How most GPUs reuse transformed vertices
+    LRU = 1,
+};
+
+struct VertexCacheStats
+{
+    u32 m_num_transformed = 0;  // Cache misses
+    u32 m_num_triangles = 0;
+    u32 m_num_vertices = 0;     // Referenced vertices
+
+    // Average cache miss ratio, transformed vertices per triangle. Approaches 0.5 for large regular grids.
+    f32 get_acmr() const { return m_num_triangles ? static_cast<f32>(m_num_transformed) / m_num_triangles : 0.0f; }
+    // Average transform to vertex ratio, 1.0 means every vertex is transformed exactly once
+    f32 get_atvr() const { return m_num_vertices ? static_cast<f32>(m_num_transformed) / m_num_vertices : 0.0f; }
+
+    void add(const VertexCacheStats& other)
+    {
+        m_num_transformed += other.m_num_transformed;
+        m_num_triangles += other.m_num_triangles;
+        m_num_vertices += other.m_num_vertices;
+    }
+};
+
+struct MeshOptimizationStats
+{
+    VertexCacheStats m_before{};
+    VertexCacheStats m_after{};
+    u32 m_num_removed_vertices = 0;  // Vertices no triangle referenced
+
+    void add(const MeshOptimizationStats& other)
+    {
+        m_before.add(other.m_before);
+        m_after.add(other.m_after);
+        m_num_removed_vertices += other.m_num_removed_vertices;
+    }
+};
+
+struct MeshRepairStats
+{
+    u32 m_num_welded_vertices = 0;       // Exact duplicates merged into their first copy
+    u32 m_num_removed_vertices = 0;      // Vertices no remaining triangle referenced
+    u32 m_num_fixed_vertices = 0;        // NaN or infinite uvs, normals or tangents reset to defaults
+    u32 m_num_invalid_triangles = 0;     // Out of range indices, non finite positions or a trailing partial triangle
+    u32 m_num_degenerate_triangles = 0;  // Two corners on the same vertex after welding
+    u32 m_num_zero_area_triangles = 0;   // Distinct vertices on a line or a point
+
+    u32 get_num_dropped_triangles() const { return m_num_invalid_triangles + m_num_degenerate_triangles + m_num_zero_area_triangles; }
+
+    void add(const MeshRepairStats& other)
+    {
+        m_num_welded_vertices += other.m_num_welded_vertices;
+        m_num_removed_vertices += other.m_num_removed_vertices;
+        m_num_fixed_vertices += other.m_num_fixed_vertices;
+        m_num_invalid_triangles += other.m_num_invalid_triangles;
+        m_num_degenerate_triangles += other.m_num_degenerate_triangles;
+        m_num_zero_area_triangles += other.m_num_zero_area_triangles;
+    }
+};
+
+struct LodChainSettings
+{
+    u32 m_max_lods = 4;              // Levels generated after LOD 0
+    f32 m_triangle_ratio = 0.5f;     // Target triangle count of each level relative to the previous one
+    u32 m_min_triangles = 64;        // No level goes below this
+    f32 m_max_relative_error = 0.02f;  // Largest allowed RMS error as a fraction of the bounds diagonal
+};
+
+struct MeshletStats
+{
+    u32 m_num_meshlets = 0;
+    u32 m_num_triangles = 0;
+    u32 m_num_vertices = 0;         // Meshlet vertices, a mesh vertex counts once for every meshlet using it
+    u32 m_num_cullable = 0;         // Meshlets whose normal cone can reject them
+    f64 m_cone_angle_sum = 0.0;     // Half angles of the cullable cones in radians
+
+    // Average share of the meshlet limits that is used
+    f32 get_triangle_fill() const { return m_num_meshlets ? static_cast<f32>(m_num_triangles) / (m_num_meshlets * k_meshlet_max_triangles) : 0.0f; }
+    f32 get_vertex_fill() const { return m_num_meshlets ? static_cast<f32>(m_num_vertices) / (m_num_meshlets * k_meshlet_max_vertices) : 0.0f; }
+    // Average spread of the cones that can cull, in degrees
+    f32 get_average_cone_angle() const { return m_num_cullable ? static_cast<f32>(m_cone_angle_sum / m_num_cullable) * ZV_RAD_TO_DEG : 0.0f; }
+
+    void add(const MeshletStats& other)
+    {
+        m_num_meshlets += other.m_num_meshlets;
+        m_num_triangles += other.m_num_triangles;
+        m_num_vertices += other.m_num_vertices;
+        m_num_cullable += other.m_num_cullable;
+        m_cone_angle_sum += other.m_cone_angle_sum;
+    }
+};
+
+// Simulates a post-transform cache of the given size over the index buffer
+VertexCacheStats analyze_vertex_cache(const u16* indices, size_t num_indices, size_t num_vertices, u32 cache_size = 16, VertexCacheModel model = VertexCacheModel::FIFO);
+
+// Reorders triangles for post-transform cache reuse (Forsyth, "Linear-Speed Vertex Cache Optimisation"). dst must not alias indices.
+void optimize_vertex_cache(u16* dst_indices, const u16* indices, size_t num_indices, size_t num_vertices);
+
+// Reorders vertices by first use in the index buffer and drops unreferenced ones, so vertex fetches walk memory linearly.
+// Returns the number of vertices kept.
+u32 optimize_vertex_fetch(MeshVertex* dst_vertices, u16* indices, size_t num_indices, const MeshVertex* vertices, size_t num_vertices);
+
+// Cache order first, then fetch order. Drops m_lods, m_packed_vertices and the split streams, which refer to the old order. out_stats is optional.
+void optimize_mesh(MeshGeometryData* geometry, MeshOptimizationStats* out_stats = nullptr);
+
+// Cleans up imported geometry in linear time: resets non finite attributes, welds bitwise identical vertices through a hash
+// table, drops triangles with invalid indices, repeated vertices or no area, and compacts out unreferenced vertices without
+// reordering the rest. Derived data (packed and split vertices, LODs) is dropped and the bounds are recomputed if anything
+// changed. out_stats is optional.
+void repair_mesh(MeshGeometryData* geometry, MeshRepairStats* out_stats = nullptr);
+
+// Quadric error metric edge collapse (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics").
+// Vertices are only ever collapsed onto a neighbour, so the vertex buffer stays valid and only indices are written.
+// Vertices on open borders never move, which keeps submesh and material boundaries crack free. A vertex on a uv or normal
+// seam only collapses along the seam, together with its copy on the other side, so the seam stays closed. Seam ends,
+// seam corners and positions shared by more than two vertices stay put. Collapses that would flip a triangle are rejected.
+// A collapse costs the area weighted mean squared distance of the kept vertex to the planes of every triangle merged into
+// it, so errors are RMS distances in mesh units. A single spike can stick out further than that.
+// Stops once the index count is at or below target_index_count or the next collapse would exceed target_error (RMS).
+// out_rms_error receives the largest RMS error of any collapse. Deterministic for a given input. dst may alias indices.
+// Returns the number of indices written.
+u32 simplify_mesh(
+    u16* dst_indices, const u16* indices, size_t num_indices,
+    const MeshVertex* vertices, size_t num_vertices,
+    size_t target_index_count, f32 target_error, f32* out_rms_error = nullptr);
+
+// Replaces geometry->m_lods with a chain of simplified index lists. Every level is simplified from LOD 0 so its
+// m_rms_error is the RMS distance to the full detail mesh. Stops early once a level no longer reduces the triangle count.
+void generate_mesh_lods(MeshGeometryData* geometry, const LodChainSettings& settings = {});
+
+// Splits the triangles of m_indices into meshlets. Each meshlet grows from a seed triangle by adding the neighbouring
+// triangle that brings the fewest new vertices and deviates least from the meshlet's average normal, so clusters stay
+// compact and flat enough for their normal cones to cull.
+void build_meshlets(const MeshGeometryData& geometry, MeshletData* out_meshlets);
+
+MeshletStats analyze_meshlets(const MeshletData& meshlets);
+
+// True if every triangle of the meshlet faces away from view_position (mesh space)
+bool is_meshlet_backfacing(const Meshlet& meshlet, const Vector3& view_position);
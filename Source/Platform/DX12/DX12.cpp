@@ -432,6 +432,8 @@ DX12State::DX12State(HWND window_handle, u32 client_width, u32 client_height, bo
     m_upload_contexts[frameIndex] = make_unique_ptr<DX12UploadCommandContext>(this);
   }
 
+  m_constant_upload_ring = make_unique_ptr<DX12UploadRing>(this, k_constant_upload_ring_size);
+
   // The -1 and starting at index 1 accounts for the imgui descriptor.
   m_free_reserved_descriptor_indices.resize(k_num_reserved_srv_descriptors - 1);
   fill_sequential(m_free_reserved_descriptor_indices.begin(), m_free_reserved_descriptor_indices.end(), 1);
@@ -473,6 +475,8 @@ DX12State::~DX12State()
     destroy_buffer_resource(m_upload_contexts[frame_index]->return_texture_heap());
   }
 
+  destroy_buffer_resource(m_constant_upload_ring->return_buffer());
+
   for (u32 i = 0; i < k_num_frames_in_flight; ++i)
   {
     process_destructions(i);
@@ -496,6 +500,8 @@ DX12State::~DX12State()
     m_upload_contexts[i].reset();
   }
 
+  m_constant_upload_ring.reset();
+
   m_device.reset();
 
 #ifdef ZV_DEBUG
@@ -558,6 +564,9 @@ void DX12State::begin_frame()
 
   process_destructions(m_frame_index);
 
+  // Older frames may have finished too, not just the one waited for
+  m_constant_upload_ring->reclaim(m_graphics_queue->poll_current_fence_value());
+
   m_upload_contexts[m_frame_index]->reset();
 }
 
@@ -577,6 +586,8 @@ void DX12State::present()
   check_hresult(m_swap_chain->Present(sync_interval, present_flags));
 
   m_frame_fence_values[m_frame_index].m_graphics_queue_fence = m_graphics_queue->signal_fence();
+
+  m_constant_upload_ring->end_frame(m_frame_fence_values[m_frame_index].m_graphics_queue_fence);
 }
 
 void DX12State::resize(u32 width, u32 height)
@@ -658,7 +669,7 @@ UniquePtr<DX12PipelineState> DX12State::create_graphics_pipeline(const DX12Pipel
   UniquePtr<DX12PipelineState> new_pipeline = make_unique_ptr<DX12PipelineState>();
   new_pipeline->m_type = DX12PipelineStateType::Graphics;
 
-  ID3D12RootSignature* root_sig = create_root_signature(desc.m_spaces, new_pipeline->m_resource_mapping);
+  ID3D12RootSignature* root_sig = create_root_signature(desc.m_spaces, desc.m_bindless_srv_space, new_pipeline->m_resource_mapping);
   new_pipeline->m_root_signature.reset(root_sig);
 
   // Load shaders (you'll need to compile these first)
@@ -779,7 +790,7 @@ UniquePtr<DX12BufferResource> DX12State::create_buffer_resource(const DX12Buffer
     srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
     srv_desc.Format = desc.m_is_raw_access ? DXGI_FORMAT_R32_TYPELESS : DXGI_FORMAT_UNKNOWN;
     srv_desc.Buffer.FirstElement = 0;
-    srv_desc.Buffer.NumElements = static_cast<uint32_t>(desc.m_is_raw_access ? (desc.m_size / 4) : buffer->m_size);
+    srv_desc.Buffer.NumElements = static_cast<uint32_t>(desc.m_is_raw_access ? (desc.m_size / 4) : (desc.m_size / desc.m_stride));
     srv_desc.Buffer.StructureByteStride = desc.m_is_raw_access ? 0 : buffer->m_stride;
     srv_desc.Buffer.Flags = desc.m_is_raw_access ? D3D12_BUFFER_SRV_FLAG_RAW : D3D12_BUFFER_SRV_FLAG_NONE;
 
@@ -948,6 +959,19 @@ UniquePtr<DX12TextureResource> DX12State::create_texture_resource(const DX12Text
         srv_desc.TextureCube.ResourceMinLODClamp = 0.0f;
         srv_desc_pointer = &srv_desc;
       }
+      else if (desc.m_is_array_view)
+      {
+        srv_desc.Format = shader_resource_view_format;
+        srv_desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+        srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srv_desc.Texture2DArray.MostDetailedMip = 0;
+        srv_desc.Texture2DArray.MipLevels = desc.m_mip_levels;
+        srv_desc.Texture2DArray.FirstArraySlice = 0;
+        srv_desc.Texture2DArray.ArraySize = desc.m_depth_or_array_size;
+        srv_desc.Texture2DArray.PlaneSlice = 0;
+        srv_desc.Texture2DArray.ResourceMinLODClamp = 0.0f;
+        srv_desc_pointer = &srv_desc;
+      }
 
       m_device->CreateShaderResourceView(texture->m_resource.get(), srv_desc_pointer, texture->m_srv_descriptor.m_cpu_handle);
     }
@@ -1115,7 +1139,20 @@ UniquePtr<DX12TextureData> DX12State::create_texture_data(TextureAsset* texture_
   bool is_3d_texture = dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D;
   DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
 
-  if (texture_asset->m_format == TextureFormat::Linear)
+  if (texture_asset->is_block_compressed())
+  {
+    const bool is_srgb = texture_asset->m_format == TextureFormat::SRGB;
+
+    switch (texture_asset->m_compression)
+    {
+      case TextureCompression::BC1: format = is_srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM; break;
+      case TextureCompression::BC4: format = DXGI_FORMAT_BC4_UNORM; break;
+      case TextureCompression::BC5: format = DXGI_FORMAT_BC5_UNORM; break;
+      case TextureCompression::BC7: format = is_srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM; break;
+      default: zv_assert_msg(false, "Invalid texture compression"); break;
+    }
+  }
+  else if (texture_asset->m_format == TextureFormat::Linear)
   {
     if (texture_asset->m_num_channels == 1)
     {
@@ -1153,85 +1190,62 @@ UniquePtr<DX12TextureData> DX12State::create_texture_data(TextureAsset* texture_
   desc.m_layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
   desc.m_alignment = 0;
   desc.m_view_flags = DX12TextureViewFlags::SRV;
+  // Material textures are all sampled as arrays, so grouped and standalone textures can share a slot
+  desc.m_is_array_view = !is_3d_texture;
 
   UniquePtr<DX12TextureData> texture_data = make_unique_ptr<DX12TextureData>();
   texture_data->m_texture_resource = create_texture_resource(desc);
 
-  // Calculate subresource layouts using GetCopyableFootprints
-  D3D12_RESOURCE_DESC resource_desc = {};
-  resource_desc.Dimension = desc.m_dimension;
-  resource_desc.Width = desc.m_width;
-  resource_desc.Height = desc.m_height;
-  resource_desc.DepthOrArraySize = desc.m_depth_or_array_size;
-  resource_desc.MipLevels = desc.m_mip_levels;
-  resource_desc.Format = desc.m_format;
-  resource_desc.SampleDesc = desc.m_sample_desc;
-  resource_desc.Layout = desc.m_layout;
-  resource_desc.Flags = desc.m_flags;
-
-  u32 num_sub_resources = desc.m_mip_levels * desc.m_depth_or_array_size;
-  DX12SubResourceLayouts sub_resource_layouts = {};
-  u32 num_rows[k_max_texture_subresource_count] = {};
-  u64 row_sizes_in_bytes[k_max_texture_subresource_count] = {};
-  u64 total_size = 0;
-
-  m_device->GetCopyableFootprints(
-    &resource_desc, 
-    0, 
-    num_sub_resources, 
-    0, 
-    sub_resource_layouts.data(), 
-    num_rows, 
-    row_sizes_in_bytes, 
-    &total_size
-  );
-
-  // Create properly laid out texture data
-  texture_data->m_texture_data = make_unique_ptr<u8[]>(total_size);
-  texture_data->m_size = total_size;
-  texture_data->m_num_sub_resources = num_sub_resources;
-  texture_data->m_sub_resource_layouts = sub_resource_layouts;
+  // The loader already wrote the data in the upload layout, only the footprints need translating
+  zv_assert_msg(texture_asset->has_upload_layout(), "Texture {} is not in the upload layout", texture_asset->m_id.name().c_str());
+
+  const u32 num_sub_resources = texture_asset->get_subresource_count();
+  DX12SubResourceLayouts sub_resource_layouts(num_sub_resources);
+
+  for (u32 i = 0; i < num_sub_resources; i++)
+  {
+    const TextureFootprint& footprint = texture_asset->m_footprints[i];
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT& layout = sub_resource_layouts[i];
+    layout.Offset = footprint.m_offset;
+    layout.Footprint.Format = desc.m_format;
+    layout.Footprint.Width = footprint.m_width;
+    layout.Footprint.Height = footprint.m_height;
+    layout.Footprint.Depth = footprint.m_depth;
+    layout.Footprint.RowPitch = footprint.m_row_pitch;
+  }
 
-  for (u32 array_index = 0; array_index < desc.m_depth_or_array_size; array_index++)
+#if ZV_DEBUG
   {
-    for (u32 mip_index = 0; mip_index < desc.m_mip_levels; mip_index++)
+    D3D12_RESOURCE_DESC resource_desc = {};
+    resource_desc.Dimension = desc.m_dimension;
+    resource_desc.Width = desc.m_width;
+    resource_desc.Height = desc.m_height;
+    resource_desc.DepthOrArraySize = desc.m_depth_or_array_size;
+    resource_desc.MipLevels = desc.m_mip_levels;
+    resource_desc.Format = desc.m_format;
+    resource_desc.SampleDesc = desc.m_sample_desc;
+    resource_desc.Layout = desc.m_layout;
+    resource_desc.Flags = desc.m_flags;
+
+    DX12SubResourceLayouts device_layouts(num_sub_resources);
+    u64 total_size = 0;
+    m_device->GetCopyableFootprints(&resource_desc, 0, num_sub_resources, 0, device_layouts.data(), nullptr, nullptr, &total_size);
+
+    zv_assert_msg(total_size == texture_asset->m_upload_size, "Texture upload size {} differs from the device's {}", texture_asset->m_upload_size, total_size);
+    for (u32 i = 0; i < num_sub_resources; i++)
     {
-      const u32 sub_resource_index = mip_index + (array_index * desc.m_mip_levels);
-      
-      const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& sub_resource_layout = sub_resource_layouts[sub_resource_index];
-      const u32 sub_resource_height = num_rows[sub_resource_index];
-      const u32 sub_resource_pitch = align_u32(sub_resource_layout.Footprint.RowPitch, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
-      const u32 sub_resource_depth = sub_resource_layout.Footprint.Depth;
-      u8* dest_sub_resource_memory = texture_data->m_texture_data.get() + sub_resource_layout.Offset;
-
-      // For now, we'll handle the simple case where we have one subresource
-      // In a full implementation, you'd need to calculate the source data for each mip level
-      if (sub_resource_index == 0) // First/only subresource
-      {
-        const u8* src_data = texture_asset->m_data.get();
-        const u32 src_pitch = texture_asset->m_width * texture_asset->m_num_channels;
-        
-        for (u32 slice_index = 0; slice_index < sub_resource_depth; slice_index++)
-        {
-          for (u32 height = 0; height < sub_resource_height; height++)
-          {
-            // Copy the row data, handling pitch differences
-            const u32 copy_size = ZV::min(sub_resource_pitch, src_pitch);
-            memcpy(dest_sub_resource_memory, src_data, copy_size);
-            dest_sub_resource_memory += sub_resource_pitch;
-            src_data += src_pitch;
-          }
-        }
-      }
-      else
-      {
-        // For additional mip levels, you would need to generate the downsampled data
-        // This is a simplified version - in practice you'd need proper mip generation
-        // For now, we'll just zero out additional mip levels
-        memset(dest_sub_resource_memory, 0, sub_resource_pitch * sub_resource_height * sub_resource_depth);
-      }
+      zv_assert_msg(memcmp(&device_layouts[i], &sub_resource_layouts[i], sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT)) == 0,
+                    "Footprint of subresource {} differs from the device's", i);
     }
   }
+#endif
+
+  // Take over the loader's buffer, the CPU copy is not needed once it is uploaded
+  texture_data->m_texture_data = move_ptr(texture_asset->m_data);
+  texture_data->m_size = texture_asset->m_upload_size;
+  texture_data->m_num_sub_resources = num_sub_resources;
+  texture_data->m_sub_resource_layouts = move_ptr(sub_resource_layouts);
 
   return texture_data;
 }
@@ -1292,6 +1306,7 @@ StaticArray<const CD3DX12_STATIC_SAMPLER_DESC, 6> DX12State::get_static_samplers
 
 ID3D12RootSignature* DX12State::create_root_signature(
   const DX12PipelineResourceSpaces& spaces, 
+  u32 bindless_srv_space,
   DX12PipelineResourceMapping& resource_mapping)
 {
   DynamicArray<D3D12_ROOT_PARAMETER1> root_parameters;
@@ -1362,6 +1377,29 @@ ID3D12RootSignature* DX12State::create_root_signature(
     }
   }
 
+  // Unbounded, the table starts at the first reserved descriptor and shaders only index the ones in use
+  D3D12_DESCRIPTOR_RANGE1 bindless_range{};
+  if (bindless_srv_space != k_invalid_resource_space)
+  {
+    zv_assert_msg(bindless_srv_space >= DX12ResourceSpace::NumSpaces || spaces[bindless_srv_space] == nullptr, "Bindless space {} also has resource bindings", bindless_srv_space);
+
+    bindless_range.BaseShaderRegister = 0;
+    bindless_range.NumDescriptors = UINT_MAX;
+    bindless_range.OffsetInDescriptorsFromTableStart = 0;
+    bindless_range.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    bindless_range.Flags = D3D12_DESCRIPTOR_RANGE_FLAG_DESCRIPTORS_VOLATILE | D3D12_DESCRIPTOR_RANGE_FLAG_DATA_VOLATILE;
+    bindless_range.RegisterSpace = bindless_srv_space;
+
+    D3D12_ROOT_PARAMETER1 bindless_table{};
+    bindless_table.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    bindless_table.ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    bindless_table.DescriptorTable.NumDescriptorRanges = 1;
+    bindless_table.DescriptorTable.pDescriptorRanges = &bindless_range;
+
+    resource_mapping.m_bindless_table_mapping = static_cast<u32>(root_parameters.size());
+    root_parameters.push_back(bindless_table);
+  }
+
   auto static_samplers = get_static_samplers();
 
   D3D12_VERSIONED_ROOT_SIGNATURE_DESC root_signature_desc{};
@@ -1583,7 +1621,23 @@ void DX12CommandContext::flush_barriers()
 
 DX12GraphicsCommandContext::DX12GraphicsCommandContext(DX12State* dx12_state)
   : DX12CommandContext(dx12_state, D3D12_COMMAND_LIST_TYPE_DIRECT)
+  , m_command_backend(m_command_list.get())
+  , m_state_filter(&m_command_backend)
+  , m_descriptor_table_heap(dx12_state->get_device())
+  , m_descriptor_table_cache(&m_descriptor_table_heap)
+{
+}
+
+void DX12GraphicsCommandContext::reset()
 {
+  DX12CommandContext::reset();
+
+  m_current_pipeline = nullptr;
+  m_state_filter.reset();
+
+  // Tables copied into the heap before its reset are gone
+  m_descriptor_table_heap.set_heap(m_srv_render_pass_descriptor_heap);
+  m_descriptor_table_cache.reset();
 }
 
 void DX12GraphicsCommandContext::set_render_targets(u32 num_rtvs, const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, D3D12_CPU_DESCRIPTOR_HANDLE dsv)
@@ -1593,20 +1647,16 @@ void DX12GraphicsCommandContext::set_render_targets(u32 num_rtvs, const D3D12_CP
 
 void DX12GraphicsCommandContext::set_viewport_and_scissor(u32 width, u32 height)
 {
-  D3D12_VIEWPORT viewport = {};
-  viewport.Width = static_cast<f32>(width);
-  viewport.Height = static_cast<f32>(height);
-  viewport.MinDepth = 0.0f;
-  viewport.MaxDepth = 1.0f;
-  viewport.TopLeftX = 0.0f;
-  viewport.TopLeftY = 0.0f;
+  FilteredViewport viewport{};
+  viewport.m_width = static_cast<f32>(width);
+  viewport.m_height = static_cast<f32>(height);
 
-  D3D12_RECT scissor = {};
-  scissor.right = width;
-  scissor.bottom = height;
+  FilteredScissor scissor{};
+  scissor.m_right = static_cast<s32>(width);
+  scissor.m_bottom = static_cast<s32>(height);
 
-  m_command_list->RSSetViewports(1, &viewport);
-  m_command_list->RSSetScissorRects(1, &scissor);
+  m_state_filter.set_viewport(viewport);
+  m_state_filter.set_scissor(scissor);
 }
 
 void DX12GraphicsCommandContext::clear_render_target(DX12TextureResource* target, f32 color[4])
@@ -1625,8 +1675,19 @@ void DX12GraphicsCommandContext::set_pipeline(const DX12PipelineInfo& pipeline_i
 
   if (!pipeline_expected_bound_externally)
   {
-    m_command_list->SetPipelineState(pipeline_info.m_pipeline->m_pso.get());
-    m_command_list->SetGraphicsRootSignature(pipeline_info.m_pipeline->m_root_signature.get());
+    m_state_filter.set_pipeline_state(pipeline_info.m_pipeline->m_pso.get());
+    m_state_filter.set_root_signature(pipeline_info.m_pipeline->m_root_signature.get());
+
+    const u32 bindless_table_mapping = pipeline_info.m_pipeline->m_resource_mapping.m_bindless_table_mapping;
+    if (bindless_table_mapping != k_invalid_resource_table_index)
+    {
+      m_state_filter.set_root_descriptor_table(bindless_table_mapping, m_srv_render_pass_descriptor_heap->get_reserved_descriptor(0).m_gpu_handle.ptr);
+    }
+  }
+  else
+  {
+    // The caller records its own state straight into the command list
+    m_state_filter.invalidate();
   }
 
   m_current_pipeline = pipeline_info.m_pipeline;
@@ -1654,23 +1715,20 @@ void DX12GraphicsCommandContext::set_pipeline_resources(u32 space, DX12PipelineR
   zv_assert(m_current_pipeline);
   zv_assert(resources->is_locked());
 
-  static const u32 k_max_handles_per_binding = 16;
-  static const u32 k_single_descriptor_range_copy_array[k_max_handles_per_binding]{ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 ,1 };
-  
   const DX12BufferResource* cbv = resources->get_cbv();
   const auto& uavs = resources->get_uavs();
   const auto& srvs = resources->get_srvs();
   const u32 num_table_handles = static_cast<u32>(uavs.size() + srvs.size());
-  D3D12_CPU_DESCRIPTOR_HANDLE handles[k_max_handles_per_binding]{};
+  u64 handles[k_max_descriptor_table_size]{};
   u32 current_handle_index = 0;
-  zv_assert(num_table_handles <= k_max_handles_per_binding);
+  zv_assert(num_table_handles <= k_max_descriptor_table_size);
 
   if (cbv)
   {
       auto cbv_mapping = m_current_pipeline->m_resource_mapping.m_cbv_mapping[space];
       // zv_assert(cbv_mapping.has_value());
 
-      m_command_list->SetGraphicsRootConstantBufferView(cbv_mapping, cbv->m_gpu_address);
+      m_state_filter.set_root_constant_buffer_view(cbv_mapping, resources->get_cbv_address());
 
       // switch (m_current_pipeline->m_type)
       // {
@@ -1695,11 +1753,11 @@ void DX12GraphicsCommandContext::set_pipeline_resources(u32 space, DX12PipelineR
   {
     if (uav.m_resource->m_type == DX12ResourceType::Buffer)
     {
-      handles[current_handle_index++] = static_cast<DX12BufferResource *>(uav.m_resource)->m_uav_descriptor.m_cpu_handle;
+      handles[current_handle_index++] = static_cast<DX12BufferResource *>(uav.m_resource)->m_uav_descriptor.m_cpu_handle.ptr;
     }
     else
     {
-      handles[current_handle_index++] = static_cast<DX12TextureResource *>(uav.m_resource)->m_uav_descriptor.m_cpu_handle;
+      handles[current_handle_index++] = static_cast<DX12TextureResource *>(uav.m_resource)->m_uav_descriptor.m_cpu_handle.ptr;
     }
   }
 
@@ -1707,21 +1765,21 @@ void DX12GraphicsCommandContext::set_pipeline_resources(u32 space, DX12PipelineR
   {
     if (srv.m_resource->m_type == DX12ResourceType::Buffer)
     {
-      handles[current_handle_index++] = static_cast<DX12BufferResource *>(srv.m_resource)->m_srv_descriptor.m_cpu_handle;
+      handles[current_handle_index++] = static_cast<DX12BufferResource *>(srv.m_resource)->m_srv_descriptor.m_cpu_handle.ptr;
     }
     else
     {
-      handles[current_handle_index++] = static_cast<DX12TextureResource *>(srv.m_resource)->m_srv_descriptor.m_cpu_handle;
+      handles[current_handle_index++] = static_cast<DX12TextureResource *>(srv.m_resource)->m_srv_descriptor.m_cpu_handle.ptr;
     }
   }
 
-  DX12Descriptor block_start = m_srv_render_pass_descriptor_heap->allocate_user_descriptor_block(num_table_handles);
-  m_dx12_state->get_device()->CopyDescriptors(1, &block_start.m_cpu_handle, &num_table_handles, num_table_handles, handles, k_single_descriptor_range_copy_array, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+  // Spaces binding the same descriptors again during the frame share one copy
+  const u64 table_start = m_descriptor_table_cache.get_descriptor_table(handles, num_table_handles);
 
   auto table_mapping = m_current_pipeline->m_resource_mapping.m_table_mapping[space];
   // zv_assert(table_mapping.has_value());
 
-  m_command_list->SetGraphicsRootDescriptorTable(table_mapping, block_start.m_gpu_handle);
+  m_state_filter.set_root_descriptor_table(table_mapping, table_start);
 
   // switch (m_current_pipeline->m_type)
   // {
@@ -1739,27 +1797,37 @@ void DX12GraphicsCommandContext::set_pipeline_resources(u32 space, DX12PipelineR
 
 void DX12GraphicsCommandContext::set_vertex_buffer(const DX12BufferResource* vertex_buffer)
 {
-  D3D12_VERTEX_BUFFER_VIEW vertex_buffer_view = {};
-  vertex_buffer_view.BufferLocation = vertex_buffer->m_gpu_address;
-  vertex_buffer_view.StrideInBytes = vertex_buffer->m_stride;
-  vertex_buffer_view.SizeInBytes = vertex_buffer->m_size;
-  
-  m_command_list->IASetVertexBuffers(0, 1, &vertex_buffer_view);
+  set_vertex_buffers(&vertex_buffer, 1);
+}
+
+void DX12GraphicsCommandContext::set_vertex_buffers(const DX12BufferResource* const* vertex_buffers, u32 num_vertex_buffers)
+{
+  zv_assert_msg(num_vertex_buffers <= D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT, "Too many vertex buffers: {}", num_vertex_buffers);
+
+  FilteredBufferView vertex_buffer_views[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+  for (u32 i = 0; i < num_vertex_buffers; ++i)
+  {
+    vertex_buffer_views[i].m_address = vertex_buffers[i]->m_gpu_address;
+    vertex_buffer_views[i].m_stride_or_format = vertex_buffers[i]->m_stride;
+    vertex_buffer_views[i].m_size = vertex_buffers[i]->m_size;
+  }
+
+  m_state_filter.set_vertex_buffers(vertex_buffer_views, num_vertex_buffers);
 }
 
 void DX12GraphicsCommandContext::set_index_buffer(const DX12BufferResource* index_buffer)
 {
-    D3D12_INDEX_BUFFER_VIEW index_buffer_view;
-    index_buffer_view.Format = index_buffer->m_stride == 4 ? DXGI_FORMAT_R32_UINT : index_buffer->m_stride == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_UNKNOWN;
-    index_buffer_view.SizeInBytes = static_cast<uint32_t>(index_buffer->m_size);
-    index_buffer_view.BufferLocation = index_buffer->m_resource->GetGPUVirtualAddress();
+    FilteredBufferView index_buffer_view{};
+    index_buffer_view.m_stride_or_format = index_buffer->m_stride == 4 ? DXGI_FORMAT_R32_UINT : index_buffer->m_stride == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_UNKNOWN;
+    index_buffer_view.m_size = static_cast<uint32_t>(index_buffer->m_size);
+    index_buffer_view.m_address = index_buffer->m_resource->GetGPUVirtualAddress();
 
-    m_command_list->IASetIndexBuffer(&index_buffer_view);
+    m_state_filter.set_index_buffer(index_buffer_view);
 }
 
 void DX12GraphicsCommandContext::set_primitive_topology(D3D12_PRIMITIVE_TOPOLOGY topology)
 {
-  m_command_list->IASetPrimitiveTopology(topology);
+  m_state_filter.set_primitive_topology(static_cast<u32>(topology));
 }
 
 void DX12GraphicsCommandContext::resolve_msaa_render_target(DX12TextureResource* msaa_rt, DX12TextureResource* current_back_buffer)
@@ -1772,6 +1840,11 @@ void DX12GraphicsCommandContext::draw_indexed(u32 index_count, u32 start_index,
   m_command_list->DrawIndexedInstanced(index_count, 1, start_index, base_vertex, 0);
 }
 
+void DX12GraphicsCommandContext::draw_indexed_instanced(u32 index_count, u32 instance_count, u32 start_index, u32 base_vertex)
+{
+  m_command_list->DrawIndexedInstanced(index_count, instance_count, start_index, base_vertex, 0);
+}
+
 void DX12GraphicsCommandContext::draw(u32 vertex_count, u32 start_vertex)
 {
   m_command_list->DrawInstanced(vertex_count, 1, start_vertex, 0);
@@ -1781,6 +1854,97 @@ void DX12GraphicsCommandContext::draw(u32 vertex_count, u32 start_vertex)
 //  DX12UploadContext Implementation
 //-------------------------------
 
+u64 DX12DescriptorTableHeap::copy_descriptor_table(const u64* source_descriptors, u32 num_descriptors)
+{
+  static const u32 k_single_descriptor_range_copy_array[k_max_descriptor_table_size]{ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 ,1 };
+
+  zv_assert(num_descriptors <= k_max_descriptor_table_size);
+
+  D3D12_CPU_DESCRIPTOR_HANDLE source_handles[k_max_descriptor_table_size]{};
+  for (u32 i = 0; i < num_descriptors; i++)
+  {
+    source_handles[i].ptr = static_cast<SIZE_T>(source_descriptors[i]);
+  }
+
+  DX12Descriptor block_start = m_heap->allocate_user_descriptor_block(num_descriptors);
+  m_device->CopyDescriptors(1, &block_start.m_cpu_handle, &num_descriptors, num_descriptors, source_handles, k_single_descriptor_range_copy_array, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+  return block_start.m_gpu_handle.ptr;
+}
+
+void DX12GraphicsCommandBackend::set_pipeline_state(void* pipeline_state)
+{
+  m_command_list->SetPipelineState(static_cast<ID3D12PipelineState*>(pipeline_state));
+}
+
+void DX12GraphicsCommandBackend::set_root_signature(void* root_signature)
+{
+  m_command_list->SetGraphicsRootSignature(static_cast<ID3D12RootSignature*>(root_signature));
+}
+
+void DX12GraphicsCommandBackend::set_viewport(const FilteredViewport& viewport)
+{
+  D3D12_VIEWPORT d3d12_viewport = {};
+  d3d12_viewport.TopLeftX = viewport.m_x;
+  d3d12_viewport.TopLeftY = viewport.m_y;
+  d3d12_viewport.Width = viewport.m_width;
+  d3d12_viewport.Height = viewport.m_height;
+  d3d12_viewport.MinDepth = viewport.m_min_depth;
+  d3d12_viewport.MaxDepth = viewport.m_max_depth;
+
+  m_command_list->RSSetViewports(1, &d3d12_viewport);
+}
+
+void DX12GraphicsCommandBackend::set_scissor(const FilteredScissor& scissor)
+{
+  D3D12_RECT rect = {};
+  rect.left = scissor.m_left;
+  rect.top = scissor.m_top;
+  rect.right = scissor.m_right;
+  rect.bottom = scissor.m_bottom;
+
+  m_command_list->RSSetScissorRects(1, &rect);
+}
+
+void DX12GraphicsCommandBackend::set_primitive_topology(u32 topology)
+{
+  m_command_list->IASetPrimitiveTopology(static_cast<D3D12_PRIMITIVE_TOPOLOGY>(topology));
+}
+
+void DX12GraphicsCommandBackend::set_vertex_buffers(const FilteredBufferView* views, u32 num_views)
+{
+  D3D12_VERTEX_BUFFER_VIEW vertex_buffer_views[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+  for (u32 i = 0; i < num_views; ++i)
+  {
+    vertex_buffer_views[i].BufferLocation = views[i].m_address;
+    vertex_buffer_views[i].StrideInBytes = views[i].m_stride_or_format;
+    vertex_buffer_views[i].SizeInBytes = views[i].m_size;
+  }
+
+  m_command_list->IASetVertexBuffers(0, num_views, vertex_buffer_views);
+}
+
+void DX12GraphicsCommandBackend::set_index_buffer(const FilteredBufferView& view)
+{
+  D3D12_INDEX_BUFFER_VIEW index_buffer_view;
+  index_buffer_view.BufferLocation = view.m_address;
+  index_buffer_view.SizeInBytes = view.m_size;
+  index_buffer_view.Format = static_cast<DXGI_FORMAT>(view.m_stride_or_format);
+
+  m_command_list->IASetIndexBuffer(&index_buffer_view);
+}
+
+void DX12GraphicsCommandBackend::set_root_constant_buffer_view(u32 root_index, u64 address)
+{
+  m_command_list->SetGraphicsRootConstantBufferView(root_index, address);
+}
+
+void DX12GraphicsCommandBackend::set_root_descriptor_table(u32 root_index, u64 base_descriptor)
+{
+  D3D12_GPU_DESCRIPTOR_HANDLE handle{ base_descriptor };
+  m_command_list->SetGraphicsRootDescriptorTable(root_index, handle);
+}
+
 DX12UploadCommandContext::DX12UploadCommandContext(DX12State *dx12_state)
     : DX12CommandContext(dx12_state, D3D12_COMMAND_LIST_TYPE_COPY)
 {
@@ -1797,14 +1961,27 @@ DX12UploadCommandContext::DX12UploadCommandContext(DX12State *dx12_state)
   m_texture_upload_heap = move_ptr(m_dx12_state->create_buffer_resource(texture_upload_heap_desc));
 }
 
-void DX12UploadCommandContext::record_buffer_upload(DX12BufferResource* dest_buffer, const void* data, u32 size)
+void DX12UploadCommandContext::record_buffer_upload(DX12BufferResource* dest_buffer, const void* data, u32 size, u32 dest_offset)
 {
   BufferUpload upload = {};
   upload.m_dest_buffer = dest_buffer->m_resource.get();
   upload.m_data = data;
   upload.m_size = size;
+  upload.m_dest_offset = dest_offset;
+
+  m_pending_buffer_uploads.emplace_back(move_ptr(upload));
+}
 
-  m_pending_buffer_uploads.emplace_back(upload);
+void DX12UploadCommandContext::record_buffer_upload(DX12BufferResource* dest_buffer, DynamicArray<u8>&& data, u32 dest_offset)
+{
+  BufferUpload upload = {};
+  upload.m_dest_buffer = dest_buffer->m_resource.get();
+  upload.m_size = data.size();
+  upload.m_dest_offset = dest_offset;
+  upload.m_owned_data = move_ptr(data);
+  upload.m_data = upload.m_owned_data.data();  // The heap block stays put when the upload is moved
+
+  m_pending_buffer_uploads.emplace_back(move_ptr(upload));
 }
 
 void DX12UploadCommandContext::record_texture_upload(DX12TextureData* texture_data)
@@ -1869,7 +2046,7 @@ void DX12UploadCommandContext::process_buffer_uploads()
       memcpy(m_buffer_upload_heap->m_mapped_data + buffer_upload_heap_offset, current_upload.m_data, current_upload.m_size);
 
       m_command_list->CopyBufferRegion(
-          current_upload.m_dest_buffer, 0,
+          current_upload.m_dest_buffer, current_upload.m_dest_offset,
           m_buffer_upload_heap->m_resource.get(), buffer_upload_heap_offset,
           current_upload.m_size);
 
@@ -1942,6 +2119,144 @@ void DX12UploadCommandContext::process_texture_uploads()
     }
 }
 
+//-------------------------------
+//  DX12UploadRing Implementation
+//-------------------------------
+
+DX12UploadRing::DX12UploadRing(DX12State* dx12_state, u32 capacity)
+  : m_dx12_state(dx12_state)
+  , m_ring(capacity)
+{
+  create_buffer();
+}
+
+DX12UploadAllocation DX12UploadRing::allocate(u32 size)
+{
+  u64 offset = 0;
+  if (!m_ring.allocate(size, &offset))
+  {
+    // Frames in flight still read the old buffer, it is destroyed with this frame's resources
+    m_dx12_state->destroy_buffer_resource(move_ptr(m_buffer));
+    m_ring.grow(size);
+    create_buffer();
+
+    zv_warning("Constant upload ring is full, grown to {} bytes", m_ring.get_capacity());
+
+    if (!m_ring.allocate(size, &offset))
+    {
+      zv_fatal("Failed to allocate {} bytes from the constant upload ring", size);
+    }
+  }
+
+  DX12UploadAllocation allocation{};
+  allocation.m_cpu_address = m_buffer->m_mapped_data + offset;
+  allocation.m_gpu_address = m_buffer->m_gpu_address + offset;
+  return allocation;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS DX12UploadRing::upload(const void* data, u32 size)
+{
+  DX12UploadAllocation allocation = allocate(size);
+  memcpy(allocation.m_cpu_address, data, size);
+  return allocation.m_gpu_address;
+}
+
+void DX12UploadRing::end_frame(u64 fence_value)
+{
+  m_ring.end_frame(fence_value);
+}
+
+void DX12UploadRing::reclaim(u64 completed_fence_value)
+{
+  m_ring.reclaim(completed_fence_value);
+}
+
+UniquePtr<DX12BufferResource> DX12UploadRing::return_buffer()
+{
+  return move_ptr(m_buffer);
+}
+
+void DX12UploadRing::create_buffer()
+{
+  DX12BufferResource::Desc buffer_desc{};
+  buffer_desc.m_size = static_cast<u32>(m_ring.get_capacity());
+  buffer_desc.m_access = DX12ResourceAccess::HostWritable;
+
+  m_buffer = m_dx12_state->create_buffer_resource(buffer_desc);
+}
+
+//-------------------------------
+//  DX12ConstantTable Implementation
+//-------------------------------
+
+DX12ConstantTable::DX12ConstantTable(DX12State* dx12_state, u32 entry_size, u32 capacity)
+  : m_dx12_state(dx12_state)
+  , m_entries(entry_size, capacity)
+{
+  grow_buffers();
+}
+
+u32 DX12ConstantTable::acquire_entry()
+{
+  const u32 entry = m_entries.acquire_entry();
+  if (m_entries.get_capacity() != m_buffer_capacity)
+  {
+    grow_buffers();
+  }
+  return entry;
+}
+
+void DX12ConstantTable::update(u32 entry, const void* data, u8* dirty_frames, ConstantUploadStats* stats)
+{
+  const u32 frame_index = m_dx12_state->get_frame_id();
+  if (m_entries.update(entry, frame_index, dirty_frames, stats))
+  {
+    const u32 entry_size = m_entries.get_entry_size();
+    memcpy(m_buffers[frame_index]->m_mapped_data + entry * entry_size, data, entry_size);
+  }
+}
+
+DX12BufferResource* DX12ConstantTable::get_buffer()
+{
+  return m_buffers[m_dx12_state->get_frame_id()].get();
+}
+
+DynamicArray<UniquePtr<DX12BufferResource>> DX12ConstantTable::return_buffers()
+{
+  DynamicArray<UniquePtr<DX12BufferResource>> buffers;
+  for (auto& buffer : m_buffers)
+  {
+    buffers.emplace_back(move_ptr(buffer));
+  }
+  return buffers;
+}
+
+void DX12ConstantTable::grow_buffers()
+{
+  const u32 entry_size = m_entries.get_entry_size();
+
+  DX12BufferResource::Desc buffer_desc{};
+  buffer_desc.m_size = m_entries.get_capacity() * entry_size;
+  buffer_desc.m_stride = entry_size;
+  buffer_desc.m_access = DX12ResourceAccess::HostWritable;
+  buffer_desc.m_view_flags.set(DX12BufferViewFlags::SRV);
+
+  // The entries keep their contents, skipped writes rely on them. Frames in flight still read the old buffers, they are
+  // destroyed with this frame's resources.
+  for (auto& buffer : m_buffers)
+  {
+    UniquePtr<DX12BufferResource> new_buffer = m_dx12_state->create_buffer_resource(buffer_desc);
+    if (buffer)
+    {
+      memcpy(new_buffer->m_mapped_data, buffer->m_mapped_data, m_buffer_capacity * entry_size);
+      m_dx12_state->destroy_buffer_resource(move_ptr(buffer));
+    }
+    buffer = move_ptr(new_buffer);
+  }
+
+  m_buffer_capacity = m_entries.get_capacity();
+}
+
 //-------------------------------
 //  DX12DescriptorHeap Implementation
 //-------------------------------
@@ -2083,6 +2398,7 @@ DX12Descriptor DX12RenderPassDescriptorHeap::allocate_user_descriptor_block(u32
     {
       new_handle_id = m_current_descriptor_index;
       m_current_descriptor_index = block_end;
+      m_high_water_mark = ZV::max(m_high_water_mark, block_end - m_reserved_handle_count);
     }
     else
     {
@@ -2109,6 +2425,15 @@ void DX12RenderPassDescriptorHeap::reset()
   m_current_descriptor_index = m_reserved_handle_count;
 }
 
+DX12DescriptorHeapStats DX12RenderPassDescriptorHeap::get_user_stats() const
+{
+  DX12DescriptorHeapStats stats{};
+  stats.m_num_used = m_current_descriptor_index - m_reserved_handle_count;
+  stats.m_high_water_mark = m_high_water_mark;
+  stats.m_capacity = m_max_descriptors - m_reserved_handle_count;
+  return stats;
+}
+
 //-------------------------------
 //  DX12PipelineResourceSpace Implementation
 //-------------------------------
@@ -2129,11 +2454,25 @@ void DX12PipelineResourceSpace::set_cbv(DX12BufferResource* resource)
     else
     {
       m_cbv = resource;
+      m_cbv_address = resource ? resource->m_gpu_address : 0;
     }
   }
   else
   {
     m_cbv = resource;
+    m_cbv_address = resource ? resource->m_gpu_address : 0;
+  }
+}
+
+void DX12PipelineResourceSpace::set_cbv(D3D12_GPU_VIRTUAL_ADDRESS gpu_address)
+{
+  if (m_cbv == nullptr)
+  {
+    zv_error("Setting a constant buffer address in a resource space without a constant buffer");
+  }
+  else
+  {
+    m_cbv_address = gpu_address;
   }
 }
 
@@ -8,6 +8,10 @@
 #include <BitFlags.h>
 #include <Platform/DX12/DX12Utility.h>
 #include <Log.h>
+#include <UploadRing.h>
+#include <ConstantTable.h>
+#include <GraphicsStateFilter.h>
+#include <DescriptorTableCache.h>
 
 class DX12State;
 struct TextureAsset;
@@ -20,6 +24,7 @@ constexpr u32 k_num_srv_staging_descriptors = 4096;
 constexpr u32 k_num_reserved_srv_descriptors = 8192;
 constexpr u32 k_num_srv_render_pass_user_descriptors = 65536;
 constexpr u32 k_invalid_resource_table_index = UINT_MAX;
+constexpr u32 k_invalid_resource_space = UINT_MAX;
 constexpr u32 k_max_texture_subresource_count = 32;
 constexpr u32 k_max_resource_barriers = 16;
 constexpr u32 k_max_input_layout_elements = 16;
@@ -27,6 +32,7 @@ constexpr u32 k_imgui_reserved_descriptor_index = 0;
 
 constexpr u32 k_buffer_upload_heap_size = Megabytes(32);
 constexpr u32 k_texture_upload_heap_size = Megabytes(128);
+constexpr u32 k_constant_upload_ring_size = Megabytes(4);
 
 struct DX12Descriptor
 {
@@ -76,6 +82,13 @@ private:
     Mutex m_usage_mutex;
 };
 
+struct DX12DescriptorHeapStats
+{
+  u32 m_num_used = 0;         // User descriptors allocated since the last reset
+  u32 m_high_water_mark = 0;  // Most user descriptors allocated between two resets
+  u32 m_capacity = 0;
+};
+
 class DX12RenderPassDescriptorHeap final : public DX12DescriptorHeap
 {
 public:
@@ -85,9 +98,12 @@ public:
   DX12Descriptor allocate_user_descriptor_block(u32 count);
   DX12Descriptor get_reserved_descriptor(u32 index);
 
+  DX12DescriptorHeapStats get_user_stats() const;
+
 private:
   u32 m_reserved_handle_count = 0;
   u32 m_current_descriptor_index = 0;
+  u32 m_high_water_mark = 0;
   Mutex m_usage_mutex;
 };
 
@@ -185,6 +201,7 @@ struct DX12TextureResource final : public DX12Resource
     DX12TextureViewBitFlags m_view_flags{ DX12TextureViewFlags::None };
     DX12ResourceAccess m_access = DX12ResourceAccess::GpuOnly;
     bool m_is_msaa_enabled = false;
+    bool m_is_array_view = false;  // Create a Texture2DArray SRV even for a single slice
   };
 
   DX12TextureResource() : DX12Resource()
@@ -199,7 +216,7 @@ struct DX12TextureResource final : public DX12Resource
 };
 
 // TODO: move
-using DX12SubResourceLayouts = StaticArray<D3D12_PLACED_SUBRESOURCE_FOOTPRINT, k_max_texture_subresource_count>;
+using DX12SubResourceLayouts = DynamicArray<D3D12_PLACED_SUBRESOURCE_FOOTPRINT>;  // One per mip of every array slice
 
 // TODO: Clean or move
 struct DX12TextureData
@@ -239,11 +256,14 @@ class DX12PipelineResourceSpace
 {
 public:
   void set_cbv(DX12BufferResource* resource);
+  // Binds constants that live inside a bigger buffer, the space needs a buffer set before it is locked for its layout
+  void set_cbv(D3D12_GPU_VIRTUAL_ADDRESS gpu_address);
   void set_srv(const DX12PipelineResourceBinding& binding);
   void set_uav(const DX12PipelineResourceBinding& binding);
   void lock();
 
   const DX12BufferResource* get_cbv() const { return m_cbv; }
+  D3D12_GPU_VIRTUAL_ADDRESS get_cbv_address() const { return m_cbv_address; }
   const DynamicArray<DX12PipelineResourceBinding>& get_uavs() const { return m_uavs; }
   const DynamicArray<DX12PipelineResourceBinding>& get_srvs() const { return m_srvs; }
 
@@ -254,6 +274,7 @@ private:
 
 private:
   DX12BufferResource* m_cbv = nullptr;
+  D3D12_GPU_VIRTUAL_ADDRESS m_cbv_address = 0;
   DynamicArray<DX12PipelineResourceBinding> m_uavs;
   DynamicArray<DX12PipelineResourceBinding> m_srvs;
   bool m_is_locked = false;
@@ -263,6 +284,7 @@ struct DX12PipelineResourceMapping
 {
   StaticArray<u32, DX12ResourceSpace::NumSpaces> m_cbv_mapping{};
   StaticArray<u32, DX12ResourceSpace::NumSpaces> m_table_mapping{};
+  u32 m_bindless_table_mapping = k_invalid_resource_table_index;
 };
 
 using DX12PipelineResourceSpaces = StaticArray<DX12PipelineResourceSpace*, DX12ResourceSpace::NumSpaces>;
@@ -296,6 +318,9 @@ struct DX12PipelineState
 
     DX12PipelineInputLayout m_input_layout;
     DX12PipelineResourceSpaces m_spaces{ nullptr };
+    // Register space whose SRV registers t0 and up are the reserved descriptors, for shaders that index resources by
+    // m_descriptor_heap_index. The space can't have a resource space in m_spaces.
+    u32 m_bindless_srv_space = k_invalid_resource_space;
   };
 
   UniquePtr<ID3D12PipelineState, COMDeleter<ID3D12PipelineState>> m_pso;
@@ -387,12 +412,57 @@ protected:
   D3D12_CPU_DESCRIPTOR_HANDLE m_srv_render_pass_descriptor_heap_handle{ 0 };
 };
 
-// Specialized context for rendering operations
+// Forwards the calls a GraphicsStateFilter lets through to a command list
+class DX12GraphicsCommandBackend final : public GraphicsCommandBackend
+{
+public:
+  explicit DX12GraphicsCommandBackend(ID3D12GraphicsCommandList* command_list) : m_command_list(command_list) {}
+
+  void set_pipeline_state(void* pipeline_state) override;
+  void set_root_signature(void* root_signature) override;
+  void set_viewport(const FilteredViewport& viewport) override;
+  void set_scissor(const FilteredScissor& scissor) override;
+  void set_primitive_topology(u32 topology) override;
+  void set_vertex_buffers(const FilteredBufferView* views, u32 num_views) override;
+  void set_index_buffer(const FilteredBufferView& view) override;
+  void set_root_constant_buffer_view(u32 root_index, u64 address) override;
+  void set_root_descriptor_table(u32 root_index, u64 base_descriptor) override;
+
+private:
+  ID3D12GraphicsCommandList* m_command_list = nullptr;
+};
+
+// Copies descriptor tables into a frame's render pass descriptor heap for a DescriptorTableCache
+class DX12DescriptorTableHeap final : public DescriptorTableHeap
+{
+public:
+  explicit DX12DescriptorTableHeap(ID3D12Device* device) : m_device(device) {}
+
+  void set_heap(DX12RenderPassDescriptorHeap* heap) { m_heap = heap; }
+
+  // Returns the GPU handle of the copy
+  u64 copy_descriptor_table(const u64* source_descriptors, u32 num_descriptors) override;
+
+private:
+  ID3D12Device* m_device = nullptr;
+  DX12RenderPassDescriptorHeap* m_heap = nullptr;
+};
+
+// Specialized context for rendering operations. State setting calls that match what is already bound on the command
+// list are dropped.
 class DX12GraphicsCommandContext : public DX12CommandContext
 {
 public:
   explicit DX12GraphicsCommandContext(DX12State* dx12_state);
 
+  // Hides DX12CommandContext::reset, the bound state is forgotten with the command list
+  void reset();
+
+  // Calls issued and filtered since the last reset
+  const StateFilterStats& get_state_filter_stats() const { return m_state_filter.get_stats(); }
+  // Descriptor tables reused or copied since the last reset
+  const DescriptorTableCacheStats& get_descriptor_table_cache_stats() const { return m_descriptor_table_cache.get_stats(); }
+
   // Render state
   void set_render_targets(u32 num_rtvs, const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, D3D12_CPU_DESCRIPTOR_HANDLE dsv);
   void set_viewport_and_scissor(u32 width, u32 height);
@@ -404,6 +474,8 @@ public:
   void set_pipeline(const DX12PipelineInfo& pipeline_info);
   void set_pipeline_resources(u32 space, DX12PipelineResourceSpace* resources);
   void set_vertex_buffer(const DX12BufferResource* vertex_buffer);
+  // Binds one buffer per input slot, starting at slot 0
+  void set_vertex_buffers(const DX12BufferResource* const* vertex_buffers, u32 num_vertex_buffers);
   void set_index_buffer(const DX12BufferResource* index_buffer);
 
   void set_primitive_topology(D3D12_PRIMITIVE_TOPOLOGY topology);
@@ -412,10 +484,15 @@ public:
 
   // Drawing
   void draw_indexed(u32 index_count, u32 start_index = 0, u32 base_vertex = 0);
+  void draw_indexed_instanced(u32 index_count, u32 instance_count, u32 start_index = 0, u32 base_vertex = 0);
   void draw(u32 vertex_count, u32 start_vertex = 0);
 
 private:
   DX12PipelineState* m_current_pipeline = nullptr;
+  DX12GraphicsCommandBackend m_command_backend;
+  GraphicsStateFilter m_state_filter;
+  DX12DescriptorTableHeap m_descriptor_table_heap;
+  DescriptorTableCache m_descriptor_table_cache;
 };
 
 // Specialized context for resource uploads
@@ -429,7 +506,10 @@ public:
   UniquePtr<DX12BufferResource> return_texture_heap();
 
   // Upload operations
-  void record_buffer_upload(DX12BufferResource* dest_buffer, const void* data, u32 size);
+  // data is read when the upload is processed, not when it is recorded, and has to stay alive until then
+  void record_buffer_upload(DX12BufferResource* dest_buffer, const void* data, u32 size, u32 dest_offset = 0);
+  // Takes ownership of data built on the fly for the upload
+  void record_buffer_upload(DX12BufferResource* dest_buffer, DynamicArray<u8>&& data, u32 dest_offset = 0);
   void record_texture_upload(DX12TextureData* texture_data);
   void process_uploads();
 
@@ -443,6 +523,8 @@ private:
     ID3D12Resource* m_dest_buffer;
     const void* m_data;
     u64 m_size;
+    u64 m_dest_offset = 0;
+    DynamicArray<u8> m_owned_data{};  // m_data points into it for uploads that own their data
   };
   DynamicArray<BufferUpload> m_pending_buffer_uploads{};
 
@@ -452,7 +534,7 @@ private:
     const void* m_data;
     u64 m_size;
     u32 m_num_sub_resources = 0;
-    DX12SubResourceLayouts m_sub_resource_layouts{ 0 };
+    DX12SubResourceLayouts m_sub_resource_layouts{};
   };
   DynamicArray<TextureUpload> m_pending_texture_uploads{};
 
@@ -460,6 +542,74 @@ private:
   UniquePtr<DX12BufferResource> m_texture_upload_heap = nullptr;
 };
 
+struct DX12UploadAllocation
+{
+  u8* m_cpu_address = nullptr;
+  D3D12_GPU_VIRTUAL_ADDRESS m_gpu_address = 0;
+};
+
+// One persistently mapped buffer that all frames sub-allocate their dynamic data from, such as constants.
+// A full ring is replaced by a bigger buffer, the old one is destroyed once the frames using it are done.
+class DX12UploadRing
+{
+public:
+  DX12UploadRing(DX12State* dx12_state, u32 capacity);
+
+  // Valid until the frame it is allocated in completes on the GPU, aligned to k_upload_ring_alignment
+  DX12UploadAllocation allocate(u32 size);
+  D3D12_GPU_VIRTUAL_ADDRESS upload(const void* data, u32 size);
+
+  void end_frame(u64 fence_value);
+  void reclaim(u64 completed_fence_value);
+
+  const UploadRingStats& get_stats() const { return m_ring.get_stats(); }
+
+  // For cleanup
+  UniquePtr<DX12BufferResource> return_buffer();
+
+private:
+  void create_buffer();
+
+private:
+  DX12State* m_dx12_state = nullptr;
+  UploadRing m_ring;
+  UniquePtr<DX12BufferResource> m_buffer = nullptr;
+};
+
+// Constants that rarely change, such as per object and per material constants. Every entry has a fixed place in one host
+// writable structured buffer per frame in flight, so an entry that didn't change since a frame's buffer was last written
+// is skipped. Shaders index the buffer by entry. The entries and their dirty masks are kept by ConstantTableEntries.
+class DX12ConstantTable
+{
+public:
+  DX12ConstantTable(DX12State* dx12_state, u32 entry_size, u32 capacity);
+
+  u32 acquire_entry();
+  void release_entry(u32 entry) { m_entries.release_entry(entry); }
+
+  // Starts counting the entries' stats anew, call once per frame before the updates
+  void begin_frame() { m_entries.begin_frame(); }
+
+  // Copies data into the current frame's buffer when the frame's bit is set in dirty_frames and clears the bit.
+  // stats is optional, an entry updated several times in a frame is only counted the first time.
+  void update(u32 entry, const void* data, u8* dirty_frames, ConstantUploadStats* stats = nullptr);
+
+  // The current frame's buffer, a table that grows replaces its buffers
+  DX12BufferResource* get_buffer();
+
+  // For cleanup
+  DynamicArray<UniquePtr<DX12BufferResource>> return_buffers();
+
+private:
+  void grow_buffers();
+
+private:
+  DX12State* m_dx12_state = nullptr;
+  ConstantTableEntries m_entries;
+  u32 m_buffer_capacity = 0;  // Entries the buffers hold
+  StaticArray<UniquePtr<DX12BufferResource>, k_num_frames_in_flight> m_buffers{};
+};
+
 class DX12CommandQueue
 {
 public:
@@ -522,6 +672,7 @@ public:
   // Context creation
   UniquePtr<DX12GraphicsCommandContext> create_graphics_context();
   DX12UploadCommandContext* get_upload_context_for_current_frame() { return m_upload_contexts[m_frame_index].get(); }
+  DX12UploadRing* get_constant_upload_ring() { return m_constant_upload_ring.get(); }
   
   // Context submission
   void submit_context(DX12CommandContext* context);
@@ -563,6 +714,7 @@ private:
 
   ID3D12RootSignature* create_root_signature(
     const DX12PipelineResourceSpaces& spaces, 
+    u32 bindless_srv_space,
     DX12PipelineResourceMapping& resource_mapping);
 
 private:
@@ -583,6 +735,7 @@ private:
   StaticArray<FrameFences, k_num_frames_in_flight> m_frame_fence_values;
 
   StaticArray<UniquePtr<DX12UploadCommandContext>, k_num_frames_in_flight> m_upload_contexts;
+  UniquePtr<DX12UploadRing> m_constant_upload_ring;
 
   UniquePtr<DX12StagingDescriptorHeap> m_rtv_staging_descriptor_heap;
   UniquePtr<DX12StagingDescriptorHeap> m_dsv_staging_descriptor_heap;
@@ -24,6 +24,9 @@ struct JobQueue;
 #define JOB_QUEUE_CALLBACK(name) void name(JobQueue* queue, void* data)
 typedef JOB_QUEUE_CALLBACK(JobQueueCallback);
 
+#define PARALLEL_FOR_CALLBACK(name) void name(u32 begin, u32 end, void* data)
+typedef PARALLEL_FOR_CALLBACK(ParallelForCallback);
+
 // typedef void job_queue_add_entry(JobQueue* queue, JobQueueCallback* callback, void* data);
 // typedef void job_queue_complete_all_work(JobQueue* queue);
 
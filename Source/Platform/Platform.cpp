@@ -2,11 +2,16 @@
 
 #include <Rendering.h>
 
+#include <thread>
+
 namespace { struct PlatformApplication; }
 static UniquePtr<PlatformApplication> s_platform_application{ nullptr };
 
 namespace
 {
+    // Pauses while waiting for the helpers of a parallel_for before the core is handed to other threads
+    constexpr u32 k_parallel_for_spin_count = 1024;
+
     struct PlatformApplication
     {
     #if ZV_OS_WINDOWS
@@ -14,6 +19,47 @@ namespace
     #endif
         UniquePtr<Renderer> m_renderer{ nullptr };
     };
+
+    struct ParallelForContext
+    {
+        ParallelForCallback* m_callback = nullptr;
+        void* m_data = nullptr;
+        u32 m_count = 0;
+        u32 m_batch_size = 1;
+        u32 m_num_batches = 0;
+        std::atomic<u32> m_next_batch{0};
+        std::atomic<u32> m_completed_batches{0};
+    };
+
+    // Helpers keep the context alive on their own, they may start after the caller already returned
+    struct ParallelForJob
+    {
+        SharedPtr<ParallelForContext> m_context;
+    };
+
+    void parallel_for_run_batches(ParallelForContext* context)
+    {
+        for (;;)
+        {
+            const u32 batch_index = context->m_next_batch.fetch_add(1, std::memory_order_relaxed);
+            if (batch_index >= context->m_num_batches)
+            {
+                return;
+            }
+
+            const u32 begin = batch_index * context->m_batch_size;
+            const u32 end = ZV::min(begin + context->m_batch_size, context->m_count);
+            context->m_callback(begin, end, context->m_data);
+
+            context->m_completed_batches.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    void parallel_for_job(JobQueue*, void* data)
+    {
+        UniquePtr<ParallelForJob> job(static_cast<ParallelForJob*>(data)); // auto-delete
+        parallel_for_run_batches(job->m_context.get());
+    }
 };
 
 void Platform::initialize(const CreationInfo& creation_info)
@@ -88,6 +134,61 @@ void Platform::complete_all_jobs(JobPriority priority)
 #endif
 }
 
+void Platform::parallel_for(u32 count, u32 batch_size, ParallelForCallback* callback, void* data)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    SharedPtr<ParallelForContext> context = make_shared_ptr<ParallelForContext>();
+    context->m_callback = callback;
+    context->m_data = data;
+    context->m_count = count;
+    context->m_batch_size = ZV::max(batch_size, 1u);
+    context->m_num_batches = (count + context->m_batch_size - 1) / context->m_batch_size;
+
+    // The calling thread takes part, so only spawn helpers for the remaining batches
+    const u32 num_helpers = ZV::min(get_worker_thread_count(), context->m_num_batches - 1);
+    for (u32 helper_index = 0; helper_index < num_helpers; helper_index++)
+    {
+        add_job(JobPriority::Low, &parallel_for_job, new ParallelForJob{ context });
+    }
+
+    parallel_for_run_batches(context.get());
+
+    // Helpers still finish their last batches. Short ones end within the spin, long ones get the core to themselves.
+    u32 num_spins = 0;
+    while (context->m_completed_batches.load(std::memory_order_acquire) != context->m_num_batches)
+    {
+        if (num_spins < k_parallel_for_spin_count)
+        {
+#if ZV_OS_WINDOWS
+            YieldProcessor();
+#endif
+            num_spins++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+u32 Platform::get_worker_thread_count()
+{
+    if (s_platform_application == nullptr)
+    {
+        return 0;
+    }
+
+#if ZV_OS_WINDOWS
+    return s_platform_application->m_state.m_worker_thread_count;
+#else
+    return 0;
+#endif
+}
+
 bool Platform::window_resize(u32 width, u32 height)
 {
     zv_assert_msg(s_platform_application != nullptr, "Platform application not initialized");
@@ -37,6 +37,10 @@ namespace Platform
 
     void add_job(JobPriority priority, JobQueueCallback* callback, void* data);
     void complete_all_jobs(JobPriority priority);
+    // Splits [0, count) into batches that are processed by the low priority workers and the calling thread.
+    // Returns once every batch is done, so it is safe to call from inside another job.
+    void parallel_for(u32 count, u32 batch_size, ParallelForCallback* callback, void* data);
+    u32 get_worker_thread_count();
 
     bool window_resize(u32 width, u32 height);
     void window_toggle_fullscreen();
@@ -135,7 +135,7 @@ int CALLBACK WinMain(
     DebugPrimitive* debug_primitive_grid = renderer->create_debug_primitive(geometry);
     debug_primitive_grid->m_material_info.m_albedo_texture_id = AssetId("grid_albedo");
     debug_primitive_grid->m_material_info.m_normal_texture_id = AssetId("grid_normal");
-    debug_primitive_grid->m_material_info.m_metallic_roughness_texture_id = AssetId("grid_roughness");
+    debug_primitive_grid->m_material_info.m_orms_texture_id = AssetId("grid_roughness");
     debug_primitive_grid->m_material_info.m_overlay_texture_id = AssetId("grid_overlay");
     debug_primitive_grid->m_material_info.m_channel_packing = ChannelPacking::Roughness;
     debug_primitive_grid->m_material_info.m_albedo_color = {1.0f, 0.533f, 0.153f};
@@ -145,7 +145,7 @@ int CALLBACK WinMain(
     DebugPrimitive* debug_primitive_grid2 = renderer->create_debug_primitive(geometry);
     debug_primitive_grid2->m_material_info.m_albedo_texture_id = AssetId("grid_albedo");
     debug_primitive_grid2->m_material_info.m_normal_texture_id = AssetId("grid_normal");
-    debug_primitive_grid2->m_material_info.m_metallic_roughness_texture_id = AssetId("grid_roughness");
+    debug_primitive_grid2->m_material_info.m_orms_texture_id = AssetId("grid_roughness");
     debug_primitive_grid2->m_material_info.m_overlay_texture_id = AssetId("grid_overlay");
     debug_primitive_grid2->m_material_info.m_channel_packing = ChannelPacking::Roughness;
     debug_primitive_grid2->m_material_info.m_albedo_color = { 0.145f, 0.631f, 1.0f };
@@ -161,50 +161,40 @@ int CALLBACK WinMain(
     DebugPrimitive* debug_primitive_mat_probe_brick_wall = renderer->create_debug_primitive(geometry2);
     debug_primitive_mat_probe_brick_wall->m_material_info.m_albedo_texture_id = AssetId("brick_wall_albedo");
     debug_primitive_mat_probe_brick_wall->m_material_info.m_normal_texture_id = AssetId("brick_wall_normal");
-    debug_primitive_mat_probe_brick_wall->m_material_info.m_metallic_roughness_texture_id = AssetId("brick_wall_roughness");
-    debug_primitive_mat_probe_brick_wall->m_material_info.m_ao_texture_id = AssetId("brick_wall_ao");
-    debug_primitive_mat_probe_brick_wall->m_material_info.m_specular_texture_id = AssetId("brick_wall_specular");
-    debug_primitive_mat_probe_brick_wall->m_material_info.m_channel_packing = ChannelPacking::Roughness;
+    debug_primitive_mat_probe_brick_wall->m_material_info.m_orms_texture_id = AssetId("brick_wall_orms");
+    debug_primitive_mat_probe_brick_wall->m_material_info.m_channel_packing = ChannelPacking::Occlusion | ChannelPacking::Roughness | ChannelPacking::Specular;
     debug_primitive_mat_probe_brick_wall->m_world_matrix = Matrix::CreateTranslation(2.5f, 0.0f, -2.5f);
     renderer->push_debug_primitive(debug_primitive_mat_probe_brick_wall);
 
     DebugPrimitive* debug_primitive_mat_probe_metal_sheet = renderer->create_debug_primitive(geometry2);
     debug_primitive_mat_probe_metal_sheet->m_material_info.m_albedo_texture_id = AssetId("metal_sheet_albedo");
     debug_primitive_mat_probe_metal_sheet->m_material_info.m_normal_texture_id = AssetId("metal_sheet_normal");
-    debug_primitive_mat_probe_metal_sheet->m_material_info.m_metallic_roughness_texture_id = AssetId("metal_sheet_metalRoughness");
-    debug_primitive_mat_probe_metal_sheet->m_material_info.m_specular_texture_id = AssetId("metal_sheet_specular");
-    debug_primitive_mat_probe_metal_sheet->m_material_info.m_ao_texture_id = AssetId("metal_sheet_ao");
-    debug_primitive_mat_probe_metal_sheet->m_material_info.m_channel_packing = ChannelPacking::Roughness | ChannelPacking::Metalness;
+    debug_primitive_mat_probe_metal_sheet->m_material_info.m_orms_texture_id = AssetId("metal_sheet_orms");
+    debug_primitive_mat_probe_metal_sheet->m_material_info.m_channel_packing = ChannelPacking::Occlusion | ChannelPacking::Roughness | ChannelPacking::Metalness | ChannelPacking::Specular;
     debug_primitive_mat_probe_metal_sheet->m_world_matrix = Matrix::CreateTranslation(-2.5f, 0.0f, 0.0f);
     renderer->push_debug_primitive(debug_primitive_mat_probe_metal_sheet);
 
     DebugPrimitive* debug_primitive_mat_probe_planks = renderer->create_debug_primitive(geometry2);
     debug_primitive_mat_probe_planks->m_material_info.m_albedo_texture_id = AssetId("planks_albedo");
     debug_primitive_mat_probe_planks->m_material_info.m_normal_texture_id = AssetId("planks_normal");
-    debug_primitive_mat_probe_planks->m_material_info.m_metallic_roughness_texture_id = AssetId("planks_roughness");
-    debug_primitive_mat_probe_planks->m_material_info.m_specular_texture_id = AssetId("planks_specular");
-    debug_primitive_mat_probe_planks->m_material_info.m_ao_texture_id = AssetId("planks_ao");
-    debug_primitive_mat_probe_planks->m_material_info.m_channel_packing = ChannelPacking::Roughness;
+    debug_primitive_mat_probe_planks->m_material_info.m_orms_texture_id = AssetId("planks_orms");
+    debug_primitive_mat_probe_planks->m_material_info.m_channel_packing = ChannelPacking::Occlusion | ChannelPacking::Roughness | ChannelPacking::Specular;
     debug_primitive_mat_probe_planks->m_world_matrix = Matrix::CreateTranslation(2.5f, 0.0f, 0.0f);
     renderer->push_debug_primitive(debug_primitive_mat_probe_planks);
 
     DebugPrimitive* debug_primitive_mat_probe_tiles = renderer->create_debug_primitive(geometry2);
     debug_primitive_mat_probe_tiles->m_material_info.m_albedo_texture_id = AssetId("tiles_albedo");
     debug_primitive_mat_probe_tiles->m_material_info.m_normal_texture_id = AssetId("tiles_normal");
-    debug_primitive_mat_probe_tiles->m_material_info.m_metallic_roughness_texture_id = AssetId("tiles_roughness");
-    debug_primitive_mat_probe_tiles->m_material_info.m_specular_texture_id = AssetId("tiles_specular");
-    debug_primitive_mat_probe_tiles->m_material_info.m_ao_texture_id = AssetId("tiles_ao");
-    debug_primitive_mat_probe_tiles->m_material_info.m_channel_packing = ChannelPacking::Roughness;
+    debug_primitive_mat_probe_tiles->m_material_info.m_orms_texture_id = AssetId("tiles_orms");
+    debug_primitive_mat_probe_tiles->m_material_info.m_channel_packing = ChannelPacking::Occlusion | ChannelPacking::Roughness | ChannelPacking::Specular;
     debug_primitive_mat_probe_tiles->m_world_matrix = Matrix::CreateTranslation(-2.5f, 0.0f, 2.5f);
     renderer->push_debug_primitive(debug_primitive_mat_probe_tiles);
 
     DebugPrimitive* debug_primitive_mat_probe_wood = renderer->create_debug_primitive(geometry2);
     debug_primitive_mat_probe_wood->m_material_info.m_albedo_texture_id = AssetId("wood_albedo");
     debug_primitive_mat_probe_wood->m_material_info.m_normal_texture_id = AssetId("wood_normal");
-    debug_primitive_mat_probe_wood->m_material_info.m_metallic_roughness_texture_id = AssetId("wood_roughness");
-    debug_primitive_mat_probe_wood->m_material_info.m_specular_texture_id = AssetId("wood_specular");
-    debug_primitive_mat_probe_wood->m_material_info.m_ao_texture_id = AssetId("wood_ao");
-    debug_primitive_mat_probe_wood->m_material_info.m_channel_packing = ChannelPacking::Roughness;
+    debug_primitive_mat_probe_wood->m_material_info.m_orms_texture_id = AssetId("wood_orms");
+    debug_primitive_mat_probe_wood->m_material_info.m_channel_packing = ChannelPacking::Occlusion | ChannelPacking::Roughness | ChannelPacking::Specular;
     debug_primitive_mat_probe_wood->m_world_matrix = Matrix::CreateTranslation(2.5f, 0.0f, 2.5f);
     renderer->push_debug_primitive(debug_primitive_mat_probe_wood);
 
@@ -363,6 +353,32 @@ int CALLBACK WinMain(
       ImGui::Text(ZV::format("{}, {}, {}, {}", pm._31, pm._32, pm._33, pm._34).c_str());
       ImGui::Text(ZV::format("{}, {}, {}, {}", pm._41, pm._42, pm._43, pm._44).c_str());
 
+      const PrimitiveGeometryCacheStats primitive_stats = get_primitive_geometry_cache_stats();
+      const RenderGeometryStats& geometry_stats = renderer->get_render_geometry_stats();
+
+      ImGui::Text("Geometry");
+      ImGui::Text(ZV::format("Primitive cache: {} hits, {} misses, {} live", primitive_stats.m_num_hits, primitive_stats.m_num_misses, primitive_stats.m_num_live).c_str());
+      ImGui::Text(ZV::format("GPU buffers: {} hits, {} uploads, {} live, {} KB", geometry_stats.m_num_hits, geometry_stats.m_num_misses, geometry_stats.m_num_live, geometry_stats.m_num_bytes / 1024).c_str());
+
+      const CullingStats& culling_stats = renderer->get_culling_stats();
+      ImGui::Text(ZV::format("Frustum culling: {} of {} objects visible", culling_stats.m_num_visible, culling_stats.m_num_tested).c_str());
+
+      const UploadRingStats& upload_ring_stats = renderer->get_upload_ring_stats();
+      ImGui::Text(ZV::format("Upload ring: {} KB in {} allocations, {} of {} KB peak", upload_ring_stats.m_frame_bytes / 1024, upload_ring_stats.m_frame_allocations, upload_ring_stats.m_high_water_mark / 1024, upload_ring_stats.m_capacity / 1024).c_str());
+
+      const ConstantUploadStats& constant_upload_stats = renderer->get_constant_upload_stats();
+      ImGui::Text(ZV::format("Constants: {} bytes uploaded, {} bytes skipped", constant_upload_stats.m_uploaded_bytes, constant_upload_stats.m_skipped_bytes).c_str());
+
+      const InstancingStats& instancing_stats = renderer->get_instancing_stats();
+      ImGui::Text(ZV::format("Instancing: {} instances in {} draws", instancing_stats.m_num_instances, instancing_stats.m_num_draws).c_str());
+
+      const StateFilterStats& state_filter_stats = renderer->get_state_filter_stats();
+      ImGui::Text(ZV::format("State calls: {} issued, {} filtered", state_filter_stats.m_num_issued, state_filter_stats.m_num_filtered).c_str());
+
+      const DescriptorTableCacheStats& descriptor_table_stats = renderer->get_descriptor_table_cache_stats();
+      const DX12DescriptorHeapStats& descriptor_heap_stats = renderer->get_descriptor_heap_stats();
+      ImGui::Text(ZV::format("Descriptor tables: {} hits, {} misses, heap {} used, {} of {} peak", descriptor_table_stats.m_num_hits, descriptor_table_stats.m_num_misses, descriptor_heap_stats.m_num_used, descriptor_heap_stats.m_high_water_mark, descriptor_heap_stats.m_capacity).c_str());
+
       ImGui::Text("Input");
       ImGui::Text(ZV::format("Mouse Position: {}, {}", ZV::Input::get_mouse_position().x, ZV::Input::get_mouse_position().y).c_str());
       ImGui::Text(ZV::format("Mouse Delta: {}, {}", ZV::Input::get_mouse_delta().x, ZV::Input::get_mouse_delta().y).c_str());
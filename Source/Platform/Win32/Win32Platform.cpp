@@ -266,6 +266,8 @@ void win32_create_state(Win32State* state, HINSTANCE instance, const wchar_t* wi
         win32_create_job_queue(&state->m_high_priority_queue, thread_count);
         win32_create_job_queue(&state->m_low_priority_queue, thread_count);
     }
+
+    state->m_worker_thread_count = thread_count;
 }
 
 void win32_process_pending_messages(InputState* input_state)
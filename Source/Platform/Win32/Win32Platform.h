@@ -33,6 +33,7 @@ struct Win32State
 
     JobQueue m_high_priority_queue;
     JobQueue m_low_priority_queue;
+    u32 m_worker_thread_count = 0;
 };
 
 void win32_create_state(Win32State* state, HINSTANCE instance, const wchar_t* window_title, u32 width, u32 height, u32 thread_count);
@@ -0,0 +1,117 @@
+#include <RenderQueue.h>
+
+namespace
+{
+    constexpr u32 k_radix_bits = 8;
+    constexpr u32 k_radix_size = 1 << k_radix_bits;
+    constexpr u32 k_radix_passes = 64 / k_radix_bits;
+
+    constexpr u64 k_depth_mask = (1ull << k_sort_key_depth_bits) - 1;
+
+    inline u64 get_field(u32 value, u32 bits)
+    {
+        return static_cast<u64>(value) & ((1ull << bits) - 1);
+    }
+
+    // The bits of a non-negative float sort like the float itself. The sign bit is always clear, so the top 22 of the
+    // remaining 31 bits keep the whole exponent range at a relative precision of 2^-14.
+    inline u64 quantize_depth(f32 depth)
+    {
+        if (!(depth > 0.0f))
+        {
+            return 0;
+        }
+
+        u32 bits;
+        memcpy(&bits, &depth, sizeof(bits));
+        return static_cast<u64>(bits >> (31 - k_sort_key_depth_bits));
+    }
+
+    // The exponent, the top bits of the quantized depth
+    inline u64 get_depth_octave(u64 quantized_depth)
+    {
+        return quantized_depth >> (k_sort_key_depth_bits - k_sort_key_depth_octave_bits);
+    }
+}
+
+u64 make_opaque_sort_key(u32 pipeline, u32 geometry, f32 depth)
+{
+    const u64 quantized_depth = quantize_depth(depth);
+
+    u64 key = static_cast<u64>(RenderPass::Opaque);
+    key = (key << k_sort_key_pipeline_bits) | get_field(pipeline, k_sort_key_pipeline_bits);
+    key = (key << k_sort_key_depth_octave_bits) | get_depth_octave(quantized_depth);
+    key = (key << k_opaque_sort_key_geometry_bits) | get_field(geometry, k_opaque_sort_key_geometry_bits);
+    key = (key << k_sort_key_depth_bits) | quantized_depth;
+    return key;
+}
+
+u64 make_transparent_sort_key(u32 pipeline, u32 material, u32 geometry, f32 depth)
+{
+    u64 key = static_cast<u64>(RenderPass::Transparent);
+    key = (key << k_sort_key_depth_bits) | (k_depth_mask - quantize_depth(depth));
+    key = (key << k_sort_key_pipeline_bits) | get_field(pipeline, k_sort_key_pipeline_bits);
+    key = (key << k_sort_key_material_bits) | get_field(material, k_sort_key_material_bits);
+    key = (key << k_sort_key_geometry_bits) | get_field(geometry, k_sort_key_geometry_bits);
+    return key;
+}
+
+RenderPass get_sort_key_pass(u64 key)
+{
+    return static_cast<RenderPass>(key >> (64 - k_sort_key_pass_bits));
+}
+
+void RenderQueue::sort()
+{
+    const size_t num_entries = m_entries.size();
+    if (num_entries < 2)
+    {
+        return;
+    }
+
+    // All histograms in one read of the keys
+    StaticArray<StaticArray<u32, k_radix_size>, k_radix_passes> histograms{};
+    for (const RenderQueueEntry& entry : m_entries)
+    {
+        for (u32 pass = 0; pass < k_radix_passes; pass++)
+        {
+            histograms[pass][(entry.m_key >> (pass * k_radix_bits)) & (k_radix_size - 1)]++;
+        }
+    }
+
+    m_scratch.resize(num_entries);
+    RenderQueueEntry* src = m_entries.data();
+    RenderQueueEntry* dst = m_scratch.data();
+
+    for (u32 pass = 0; pass < k_radix_passes; pass++)
+    {
+        StaticArray<u32, k_radix_size>& histogram = histograms[pass];
+        const u32 shift = pass * k_radix_bits;
+
+        // Every key has the same digit, the pass wouldn't move anything
+        if (histogram[(src[0].m_key >> shift) & (k_radix_size - 1)] == num_entries)
+        {
+            continue;
+        }
+
+        u32 offset = 0;
+        for (u32& count : histogram)
+        {
+            const u32 bucket_size = count;
+            count = offset;
+            offset += bucket_size;
+        }
+
+        for (size_t i = 0; i < num_entries; i++)
+        {
+            dst[histogram[(src[i].m_key >> shift) & (k_radix_size - 1)]++] = src[i];
+        }
+
+        std::swap(src, dst);
+    }
+
+    if (src != m_entries.data())
+    {
+        m_entries.swap(m_scratch);
+    }
+}
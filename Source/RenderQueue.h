@@ -0,0 +1,54 @@
+#pragma once
+
+#include <CoreDefs.h>
+
+// Draws are submitted as 64 bit keys and executed in key order. Every layout starts with the pass, so passes never mix.
+//   Opaque:      pass 2 | pipeline 8 | depth octave 8 | geometry 24 | depth 22
+//   Transparent: pass 2 | inverted depth 22 | pipeline 8 | material 16 | geometry 16, back to front first
+// Opaque draws go front to back in steps of a power of two in depth, so near objects fill the depth buffer first.
+// Within a step they are grouped by geometry for instancing and ordered by depth again. Materials are bindless and stay
+// out of the opaque key. Pipeline, material and geometry ids keep their low bits only, wider ids still sort but may
+// interleave.
+enum class RenderPass : u8
+{
+    Opaque = 0,
+    Transparent = 1,
+};
+
+constexpr u32 k_sort_key_pass_bits = 2;
+constexpr u32 k_sort_key_pipeline_bits = 8;
+constexpr u32 k_sort_key_material_bits = 16;
+constexpr u32 k_sort_key_geometry_bits = 16;
+constexpr u32 k_sort_key_depth_bits = 22;
+constexpr u32 k_sort_key_depth_octave_bits = 8;
+constexpr u32 k_opaque_sort_key_geometry_bits = 24;
+
+static_assert(k_sort_key_pass_bits + k_sort_key_pipeline_bits + k_sort_key_material_bits + k_sort_key_geometry_bits + k_sort_key_depth_bits == 64,
+              "Sort key fields must fill 64 bits");
+static_assert(k_sort_key_pass_bits + k_sort_key_pipeline_bits + k_sort_key_depth_octave_bits + k_opaque_sort_key_geometry_bits + k_sort_key_depth_bits == 64,
+              "Opaque sort key fields must fill 64 bits");
+
+// View space depth, the distance along the camera's forward axis. Negative depths sort as 0.
+u64 make_opaque_sort_key(u32 pipeline, u32 geometry, f32 depth);
+u64 make_transparent_sort_key(u32 pipeline, u32 material, u32 geometry, f32 depth);
+
+RenderPass get_sort_key_pass(u64 key);
+
+struct RenderQueueEntry
+{
+    u64 m_key = 0;
+    u32 m_item = 0;  // Caller defined, usually an index into the frame's draw list
+};
+
+struct RenderQueue
+{
+    DynamicArray<RenderQueueEntry> m_entries{};
+    DynamicArray<RenderQueueEntry> m_scratch{};  // Ping-pong buffer of the sort, kept to avoid reallocating every frame
+
+    void clear() { m_entries.clear(); }
+    void push(u64 key, u32 item) { m_entries.push_back(RenderQueueEntry{ key, item }); }
+
+    // Stable LSD radix sort, 8 bits per pass. Passes over digits that every key shares are skipped, so the unused high
+    // bits of a frame cost one histogram pass. Equal keys keep their submission order.
+    void sort();
+};
@@ -1,6 +1,8 @@
 #include <Rendering.h>
 
 #include <Geometry.h>
+#include <Platform/Platform.h>
+#include <Platform/Jobs.h>
 
 #include <ThirdParty/imgui/imgui.h>
 #include <ThirdParty/imgui/imgui_impl_win32.h>
@@ -23,16 +25,11 @@ namespace
       texture_info.m_type = MaterialTextureType::Normal;
       out_material_data->set_bound_texture(texture_info, material_info.m_normal_texture_id);
     }
-    if (material_info.m_metallic_roughness_texture_id.is_valid())
+    if (material_info.m_orms_texture_id.is_valid())
     {
-      texture_info.m_type = MaterialTextureType::MetallicRoughness;
+      texture_info.m_type = MaterialTextureType::ORMS;
       texture_info.m_channel_packing = material_info.m_channel_packing;
-      out_material_data->set_bound_texture(texture_info, material_info.m_metallic_roughness_texture_id);
-    }
-    if (material_info.m_ao_texture_id.is_valid())
-    {
-      texture_info.m_type = MaterialTextureType::AO;
-      out_material_data->set_bound_texture(texture_info, material_info.m_ao_texture_id);
+      out_material_data->set_bound_texture(texture_info, material_info.m_orms_texture_id);
     }
     if (material_info.m_emissive_texture_id.is_valid())
     {
@@ -44,11 +41,6 @@ namespace
       texture_info.m_type = MaterialTextureType::Overlay;
       out_material_data->set_bound_texture(texture_info, material_info.m_overlay_texture_id);
     }
-    if (material_info.m_specular_texture_id.is_valid())
-    {
-      texture_info.m_type = MaterialTextureType::Specular;
-      out_material_data->set_bound_texture(texture_info, material_info.m_specular_texture_id);
-    }
 
     out_material_data->m_constants.albedo_color = material_info.m_albedo_color;
     out_material_data->m_constants.roughness = material_info.m_roughness;
@@ -56,20 +48,107 @@ namespace
     out_material_data->m_constants.specular = material_info.m_specular;
     out_material_data->m_constants.emissive = material_info.m_emissive;
     out_material_data->m_constants.sampler_mode = material_info.m_sampler_mode;
+    out_material_data->mark_constants_dirty();
+  }
+
+  struct UpdateCullingBoundsContext
+  {
+    RenderObject* const* m_render_objects = nullptr;
+    CullingBounds* m_bounds = nullptr;
+  };
+
+  PARALLEL_FOR_CALLBACK(update_culling_bounds_job)
+  {
+    UpdateCullingBoundsContext& context = *static_cast<UpdateCullingBoundsContext*>(data);
+
+    for (u32 i = begin; i < end; i++)
+    {
+      const RenderObject& render_object = *context.m_render_objects[i];
+      context.m_bounds->set(i, transform_aabb(render_object.m_bounds, render_object.m_constants.world_matrix));
+    }
   }
+
+  // Coarsest level whose RMS error, seen at the nearest point of the bounding sphere, stays below max_pixel_error.
+  // pixels_per_unit is the projected size in pixels of one unit at distance one. Returns nullptr for LOD 0.
+  inline const RenderObjectLod* select_render_object_lod(const RenderObject& render_object, const Vector3& camera_position, f32 pixels_per_unit, f32 max_pixel_error)
+  {
+    const Matrix& world_matrix = render_object.m_constants.world_matrix;
+    const Vector3 center = Vector3::Transform(render_object.m_bounds_center, world_matrix);
+
+    // LOD errors are in mesh units, take the largest axis scale of the object
+    const f32 scale = ZV::max(ZV::max(world_matrix.Right().Length(), world_matrix.Up().Length()), world_matrix.Backward().Length());
+    const f32 distance = Vector3::Distance(center, camera_position) - render_object.m_bounds_radius * scale;
+
+    if (distance <= ZV_EPSILON)
+    {
+      return nullptr;
+    }
+
+    const RenderObjectLod* selected_lod = nullptr;
+    for (const RenderObjectLod& lod : render_object.m_geometry->m_lods)
+    {
+      if (lod.m_rms_error * scale * pixels_per_unit / distance > max_pixel_error)
+      {
+        break;
+      }
+      selected_lod = &lod;
+    }
+
+    return selected_lod;
+  }
+
+  constexpr u32 k_initial_instance_capacity = 1024;
+
+  // Records the batcher's draws, each draw finds its instances in the frame's instance buffer from its first instance
+  class CommandListDrawRecorder final : public DrawRecorder
+  {
+  public:
+    void record_draw(const InstancedDraw& draw) override
+    {
+      PerDrawConstants draw_constants{};
+      draw_constants.instance_offset = draw.m_first_instance;
+      m_per_draw_resource_space->set_cbv(m_constant_upload_ring->upload(&draw_constants, sizeof(PerDrawConstants)));
+      m_graphics_ctx->set_pipeline_resources(DX12ResourceSpace::PerObjectSpace, m_per_draw_resource_space);
+
+      // Every instance of a draw shares the geometry, take it from the first
+      const RenderGeometry* geometry = m_render_objects[draw.m_first_item]->m_geometry;
+      if (geometry->m_attribute_buffer)
+      {
+        const DX12BufferResource* vertex_buffers[] = { geometry->m_vertex_buffer.get(), geometry->m_attribute_buffer.get() };
+        m_graphics_ctx->set_vertex_buffers(vertex_buffers, 2);
+      }
+      else
+      {
+        m_graphics_ctx->set_vertex_buffer(geometry->m_vertex_buffer.get());
+      }
+      m_graphics_ctx->set_index_buffer(geometry->m_index_buffer.get());
+
+      m_graphics_ctx->draw_indexed_instanced(draw.m_key.m_index_count, draw.m_instance_count, draw.m_key.m_start_index);
+    }
+
+    DX12GraphicsCommandContext* m_graphics_ctx = nullptr;
+    DX12UploadRing* m_constant_upload_ring = nullptr;
+    DX12PipelineResourceSpace* m_per_draw_resource_space = nullptr;
+    RenderObject* const* m_render_objects = nullptr;
+  };
 }
 
 
-Renderer::Renderer(HWND window_handle, u32 client_width, u32 client_height, bool msaa_enabled, DX12OutputMode output_mode, TonemapType tonemap_type)
+Renderer::Renderer(HWND window_handle, u32 client_width, u32 client_height, bool msaa_enabled, DX12OutputMode output_mode, TonemapType tonemap_type, bool packed_vertices_enabled, bool split_vertex_streams_enabled)
   : m_client_width(client_width)
   , m_client_height(client_height)
   , m_msaa_enabled(msaa_enabled)
+  , m_packed_vertices_enabled(packed_vertices_enabled)
+  , m_split_vertex_streams_enabled(split_vertex_streams_enabled)
   , m_tonemap_type(tonemap_type)
 {
   m_dx12_state = make_unique_ptr<DX12State>(window_handle, client_width, client_height, false, msaa_enabled, output_mode);
 
   m_dx12_graphics_ctx = m_dx12_state->create_graphics_context();
 
+  m_per_object_constant_table = make_unique_ptr<DX12ConstantTable>(m_dx12_state.get(), static_cast<u32>(sizeof(PerObjectConstants)), 1024);
+  m_per_material_constant_table = make_unique_ptr<DX12ConstantTable>(m_dx12_state.get(), static_cast<u32>(sizeof(PerMaterialConstants)), 256);
+
   create_default_graphics_pipeline();
 
   initialize_imgui(window_handle);
@@ -109,32 +188,34 @@ Renderer::~Renderer()
     m_dx12_state->destroy_texture_resource(move_ptr(render_texture->m_texture->m_texture_resource));
   }
 
-  m_dx12_state->destroy_buffer_resource(move_ptr(m_per_object_constant_buffer_dummy));
-  m_dx12_state->destroy_buffer_resource(move_ptr(m_per_material_constant_buffer_dummy));
+  m_dx12_state->destroy_buffer_resource(move_ptr(m_per_draw_constant_buffer_dummy));
+  m_dx12_state->destroy_buffer_resource(move_ptr(m_per_pass_constant_buffer_dummy));
+  m_dx12_state->destroy_buffer_resource(move_ptr(m_per_frame_constant_buffer_dummy));
 
-  for (auto& render_object : m_render_objects)
+  for (auto& buffer : m_per_object_constant_table->return_buffers())
   {
-    m_dx12_state->destroy_buffer_resource(move_ptr(render_object->m_vertex_buffer));
-    m_dx12_state->destroy_buffer_resource(move_ptr(render_object->m_index_buffer));
+    m_dx12_state->destroy_buffer_resource(move_ptr(buffer));
+  }
 
-    for (auto& constant_buffer : render_object->m_constant_buffers)
-    {
-      m_dx12_state->destroy_buffer_resource(move_ptr(constant_buffer));
-    }
+  for (auto& buffer : m_per_material_constant_table->return_buffers())
+  {
+    m_dx12_state->destroy_buffer_resource(move_ptr(buffer));
   }
 
-  for (auto& material_data : m_material_data)
+  for (auto& buffer : m_instance_buffers)
   {
-    for (auto& constant_buffer : material_data->m_constant_buffers)
-    {
-      m_dx12_state->destroy_buffer_resource(move_ptr(constant_buffer));
-    }
+    m_dx12_state->destroy_buffer_resource(move_ptr(buffer));
   }
 
-  for (auto& frame_resource : m_frame_resources)
+  for (auto& pair : m_render_geometries)
   {
-    m_dx12_state->destroy_buffer_resource(move_ptr(frame_resource.m_per_pass_constant_buffer));
-    m_dx12_state->destroy_buffer_resource(move_ptr(frame_resource.m_per_frame_constant_buffer));
+    m_dx12_state->destroy_buffer_resource(move_ptr(pair.second->m_vertex_buffer));
+    m_dx12_state->destroy_buffer_resource(move_ptr(pair.second->m_index_buffer));
+
+    if (pair.second->m_attribute_buffer)
+    {
+      m_dx12_state->destroy_buffer_resource(move_ptr(pair.second->m_attribute_buffer));
+    }
   }
 
   if (m_default_graphics_pipeline)
@@ -249,25 +330,47 @@ void Renderer::setup_render_resources(ModelAsset* model_asset, const Matrix& wor
     }
   }
 
-  for (auto& submesh : model_asset->m_submeshes)
+  // Raycasts find the model through the scene BVH, the submeshes' triangle BVHs are built when the model first joins it
+  const u32 first_instance = add_model_to_scene_bvh(model_asset, &m_scene_bvh);
+
+  for (u32 i = 0; i < static_cast<u32>(model_asset->m_submeshes.size()); i++)
   {
+    SubmeshData& submesh = model_asset->m_submeshes[i];
     MaterialData* material_data = create_material_data();
     read_material_data_from_info(submesh.m_material_info, material_data);
 
     RenderObject* render_object = create_render_object(&submesh.m_data, material_data);
     if (submesh.m_parent == SubmeshHandle::Invalid)
     {
-      render_object->m_constants.world_matrix = submesh.m_world_transform * world_matrix;
+      render_object->set_world_matrix(submesh.m_world_transform * world_matrix);
     }
     else
     {
-      render_object->m_constants.world_matrix = submesh.m_world_transform;
+      render_object->set_world_matrix(submesh.m_world_transform);
     }
+    set_scene_bvh_instance_transform(&m_scene_bvh, first_instance + i, render_object->m_constants.world_matrix);
   }
+
+  build_scene_bvh(&m_scene_bvh);
 }
 
 void Renderer::setup_render_resources(TextureAsset* texture_asset)
 {
+  if (texture_asset->is_view())
+  {
+    // Grouped textures share the GPU resource of their array or atlas, which is published together with them
+    TextureAsset* parent_asset = Assets::get_texture_asset(texture_asset->m_parent_id);
+    zv_assert_msg(parent_asset != nullptr, "Parent texture not found: {}", texture_asset->m_parent_id.name().c_str());
+
+    if (!parent_asset->is_ready())
+    {
+      setup_render_resources(parent_asset);
+    }
+
+    texture_asset->m_texture_data = parent_asset->m_texture_data;
+    return;
+  }
+
   UniquePtr<RenderTexture> render_texture = make_unique_ptr<RenderTexture>();
   render_texture->m_texture = move_ptr(m_dx12_state->create_texture_data(texture_asset));
 #if ZV_DEBUG
@@ -294,7 +397,8 @@ void Renderer::setup_render_resources(DebugPrimitive* debug_primitive)
   read_material_data_from_info(debug_primitive->m_material_info, material_data);
 
   RenderObject* render_object = create_render_object(debug_primitive->m_geometry.get(), material_data);
-  render_object->m_constants.world_matrix = debug_primitive->m_world_matrix;
+  render_object->set_world_matrix(debug_primitive->m_world_matrix);
+  debug_primitive->m_render_object = render_object;
 }
 
 bool Renderer::check_dependencies(const MaterialInfo& material_info)
@@ -321,11 +425,9 @@ bool Renderer::check_dependencies(const MaterialInfo& material_info)
 
   all_dependencies_ready &= check_texture(material_info.m_albedo_texture_id);
   all_dependencies_ready &= check_texture(material_info.m_normal_texture_id);
-  all_dependencies_ready &= check_texture(material_info.m_metallic_roughness_texture_id);
-  all_dependencies_ready &= check_texture(material_info.m_ao_texture_id);
+  all_dependencies_ready &= check_texture(material_info.m_orms_texture_id);
   all_dependencies_ready &= check_texture(material_info.m_emissive_texture_id);
   all_dependencies_ready &= check_texture(material_info.m_overlay_texture_id);
-  all_dependencies_ready &= check_texture(material_info.m_specular_texture_id);
 
   return all_dependencies_ready;
 }
@@ -347,67 +449,303 @@ void Renderer::push_debug_primitive(DebugPrimitive* debug_primitive)
   setup_render_resources(debug_primitive);
 }
 
+void Renderer::pop_debug_primitive(DebugPrimitive* debug_primitive)
+{
+  if (debug_primitive->m_render_object)
+  {
+    destroy_render_object(debug_primitive->m_render_object);
+  }
+
+  m_pending_debug_primitive_loads.erase(std::remove(m_pending_debug_primitive_loads.begin(), m_pending_debug_primitive_loads.end(), debug_primitive), m_pending_debug_primitive_loads.end());
+  m_previous_pending_debug_primitive_loads.erase(std::remove(m_previous_pending_debug_primitive_loads.begin(), m_previous_pending_debug_primitive_loads.end(), debug_primitive), m_previous_pending_debug_primitive_loads.end());
+
+  // Drops the reference to the geometry, which leaves the primitive cache once nobody else holds it
+  m_debug_primitives.erase(std::remove_if(m_debug_primitives.begin(), m_debug_primitives.end(), [debug_primitive](const UniquePtr<DebugPrimitive>& entry) { return entry.get() == debug_primitive; }), m_debug_primitives.end());
+}
+
 MaterialData* Renderer::create_material_data()
 {
   m_material_data.emplace_back(make_unique_ptr<MaterialData>());
 
   MaterialData* material_data = m_material_data.back().get();
+  material_data->m_constants_entry = m_per_material_constant_table->acquire_entry();
 
-  DX12BufferResource::Desc per_material_cb_desc{};
-  per_material_cb_desc.m_size = sizeof(PerMaterialConstants);
-  per_material_cb_desc.m_access = DX12ResourceAccess::HostWritable;
-  per_material_cb_desc.m_view_flags.set(DX12BufferViewFlags::CBV);
-
-  for (u32 i = 0; i < k_num_frames_in_flight; ++i)
-  {
-    material_data->m_constant_buffers[i] = m_dx12_state->create_buffer_resource(per_material_cb_desc);
-  }
-  material_data->m_constant_buffers[0]->copy_data(&material_data->m_constants, sizeof(PerMaterialConstants));
+  PerMaterialConstants& constants = material_data->m_constants;
+  constants.albedo_texture = constants.normal_texture = constants.orms_texture = constants.emissive_texture = constants.overlay_texture = m_dummy_texture_index;
 
   return material_data;
 }
 
-RenderObject* Renderer::create_render_object(MeshGeometryData* geometry, MaterialData* material_data)
+RenderObject* Renderer::create_render_object(const MeshGeometryData* geometry, MaterialData* material_data)
 {
   m_render_objects.emplace_back(make_unique_ptr<RenderObject>());
 
   RenderObject* render_object = m_render_objects.back().get();
-  render_object->m_draw_count = static_cast<u32>(geometry->m_indices.size());
   material_data->m_render_objects.emplace_back(render_object);
 
+  render_object->m_geometry = acquire_render_geometry(geometry);
+  render_object->m_constants_entry = m_per_object_constant_table->acquire_entry();
+
+  if (m_packed_vertices_enabled)
+  {
+    const VertexQuantization& quantization = geometry->m_quantization;
+    render_object->m_constants.position_scale = Vector4(quantization.m_position_scale.x, quantization.m_position_scale.y, quantization.m_position_scale.z, 0.0f);
+    render_object->m_constants.position_offset = Vector4(quantization.m_position_offset.x, quantization.m_position_offset.y, quantization.m_position_offset.z, 0.0f);
+  }
+
+  render_object->m_bounds = geometry->m_bounds;
+  render_object->m_bounds_center = geometry->m_bounding_sphere.m_center;
+  render_object->m_bounds_radius = geometry->m_bounding_sphere.m_radius;
+
+  return render_object;
+}
+
+void Renderer::destroy_render_object(RenderObject* render_object)
+{
+  for (auto& material_data : m_material_data)
+  {
+    material_data->m_render_objects.erase(std::remove(material_data->m_render_objects.begin(), material_data->m_render_objects.end(), render_object), material_data->m_render_objects.end());
+  }
+
+  m_per_object_constant_table->release_entry(render_object->m_constants_entry);
+
+  release_render_geometry(render_object->m_geometry);
+
+  m_render_objects.erase(std::remove_if(m_render_objects.begin(), m_render_objects.end(), [render_object](const UniquePtr<RenderObject>& entry) { return entry.get() == render_object; }), m_render_objects.end());
+}
+
+RenderGeometry* Renderer::acquire_render_geometry(const MeshGeometryData* geometry)
+{
+  auto it = m_render_geometries.find(geometry);
+  if (it != m_render_geometries.end())
+  {
+    ++m_render_geometry_stats.m_num_hits;
+    ++it->second->m_ref_count;
+    return it->second.get();
+  }
+
+  ++m_render_geometry_stats.m_num_misses;
+
+  // Geometry may be shared across threads, e.g. cached primitives, so it is packed and bounded where it is created and only read here
+  zv_assert_msg(!m_packed_vertices_enabled || geometry->is_packed(), "Geometry has to be packed when it is created");
+  zv_assert_msg(geometry->m_bounds.is_valid(), "Geometry has to be bounded when it is created");
+
+  UniquePtr<RenderGeometry> render_geometry = make_unique_ptr<RenderGeometry>();
+  render_geometry->m_source = geometry;
+  render_geometry->m_id = m_next_render_geometry_id++;
+  render_geometry->m_ref_count = 1;
+  render_geometry->m_draw_count = static_cast<u32>(geometry->m_indices.size());
+
   DX12UploadCommandContext* dx12_upload_ctx = m_dx12_state->get_upload_context_for_current_frame();
 
-  // Create vertex buffer
+  const u32 num_vertices = static_cast<u32>(geometry->m_vertices.size());
+
   DX12BufferResource::Desc vb_desc{};
-  vb_desc.m_size = static_cast<u32>(geometry->vertices_size());
-  vb_desc.m_stride = sizeof(MeshVertex);
   vb_desc.m_access = DX12ResourceAccess::GpuOnly;
   vb_desc.m_buffer_type = DX12BufferResource::Desc::BufferType::VertexBuffer;
-  render_object->m_vertex_buffer = move_ptr(m_dx12_state->create_buffer_resource(vb_desc));
-  dx12_upload_ctx->record_buffer_upload(render_object->m_vertex_buffer.get(), geometry->m_vertices.data(), static_cast<u32>(geometry->vertices_size()));
 
-  // Create index buffer
+  // Every upload gets its own copy of the data, the upload runs later in the frame and the geometry may be gone by then
+  if (m_split_vertex_streams_enabled)
+  {
+    DX12BufferResource::Desc attribute_desc = vb_desc;
+    DynamicArray<u8> positions;
+    DynamicArray<u8> attributes;
+
+    if (m_packed_vertices_enabled)
+    {
+      positions.resize(num_vertices * sizeof(PackedMeshVertexPosition));
+      attributes.resize(num_vertices * sizeof(PackedMeshVertexAttributes));
+      split_packed_vertices(
+        geometry->m_packed_vertices.data(), num_vertices,
+        reinterpret_cast<PackedMeshVertexPosition*>(positions.data()),
+        reinterpret_cast<PackedMeshVertexAttributes*>(attributes.data()));
+
+      vb_desc.m_stride = sizeof(PackedMeshVertexPosition);
+      attribute_desc.m_stride = sizeof(PackedMeshVertexAttributes);
+    }
+    else
+    {
+      positions.resize(num_vertices * sizeof(Vector3));
+      attributes.resize(num_vertices * sizeof(MeshVertexAttributes));
+      split_vertices(
+        geometry->m_vertices.data(), num_vertices,
+        reinterpret_cast<Vector3*>(positions.data()),
+        reinterpret_cast<MeshVertexAttributes*>(attributes.data()));
+
+      vb_desc.m_stride = sizeof(Vector3);
+      attribute_desc.m_stride = sizeof(MeshVertexAttributes);
+    }
+
+    vb_desc.m_size = static_cast<u32>(positions.size());
+    attribute_desc.m_size = static_cast<u32>(attributes.size());
+
+    render_geometry->m_vertex_buffer = move_ptr(m_dx12_state->create_buffer_resource(vb_desc));
+    render_geometry->m_attribute_buffer = move_ptr(m_dx12_state->create_buffer_resource(attribute_desc));
+    dx12_upload_ctx->record_buffer_upload(render_geometry->m_vertex_buffer.get(), move_ptr(positions));
+    dx12_upload_ctx->record_buffer_upload(render_geometry->m_attribute_buffer.get(), move_ptr(attributes));
+  }
+  else
+  {
+    const u8* vertex_data = m_packed_vertices_enabled
+      ? reinterpret_cast<const u8*>(geometry->m_packed_vertices.data())
+      : reinterpret_cast<const u8*>(geometry->m_vertices.data());
+    vb_desc.m_stride = m_packed_vertices_enabled ? sizeof(PackedMeshVertex) : sizeof(MeshVertex);
+    vb_desc.m_size = static_cast<u32>(m_packed_vertices_enabled ? geometry->packed_vertices_size() : geometry->vertices_size());
+
+    render_geometry->m_vertex_buffer = move_ptr(m_dx12_state->create_buffer_resource(vb_desc));
+    dx12_upload_ctx->record_buffer_upload(render_geometry->m_vertex_buffer.get(), DynamicArray<u8>(vertex_data, vertex_data + vb_desc.m_size));
+  }
+
+  // Create index buffer, LODs follow LOD 0 and share its vertices
+  u32 num_indices = static_cast<u32>(geometry->m_indices.size());
+  for (const MeshLod& mesh_lod : geometry->m_lods)
+  {
+    RenderObjectLod& lod = render_geometry->m_lods.emplace_back();
+    lod.m_start_index = num_indices;
+    lod.m_index_count = static_cast<u32>(mesh_lod.m_indices.size());
+    lod.m_rms_error = mesh_lod.m_rms_error;
+
+    num_indices += lod.m_index_count;
+  }
+
+  DynamicArray<u8> indices(num_indices * sizeof(u16));
+  memcpy(indices.data(), geometry->m_indices.data(), geometry->indices_size());
+  for (size_t i = 0; i < geometry->m_lods.size(); i++)
+  {
+    const DynamicArray<u16>& lod_indices = geometry->m_lods[i].m_indices;
+    memcpy(indices.data() + render_geometry->m_lods[i].m_start_index * sizeof(u16), lod_indices.data(), lod_indices.size() * sizeof(u16));
+  }
+
   DX12BufferResource::Desc ib_desc{};
-  ib_desc.m_size = static_cast<u32>(geometry->indices_size());
+  ib_desc.m_size = static_cast<u32>(indices.size());
   ib_desc.m_stride = sizeof(u16);
   ib_desc.m_access = DX12ResourceAccess::GpuOnly;
   ib_desc.m_buffer_type = DX12BufferResource::Desc::BufferType::IndexBuffer;
-  render_object->m_index_buffer = move_ptr(m_dx12_state->create_buffer_resource(ib_desc));
-  dx12_upload_ctx->record_buffer_upload(render_object->m_index_buffer.get(), geometry->m_indices.data(), static_cast<u32>(geometry->indices_size()));
+  render_geometry->m_index_buffer = move_ptr(m_dx12_state->create_buffer_resource(ib_desc));
+  dx12_upload_ctx->record_buffer_upload(render_geometry->m_index_buffer.get(), move_ptr(indices));
+
+  ++m_render_geometry_stats.m_num_live;
+  m_render_geometry_stats.m_num_bytes += render_geometry->m_vertex_buffer->m_size + render_geometry->m_index_buffer->m_size;
+  m_render_geometry_stats.m_num_bytes += render_geometry->m_attribute_buffer ? render_geometry->m_attribute_buffer->m_size : 0;
+
+  RenderGeometry* result = render_geometry.get();
+  m_render_geometries.emplace(geometry, move_ptr(render_geometry));
+
+  return result;
+}
+
+void Renderer::release_render_geometry(RenderGeometry* render_geometry)
+{
+  zv_assert_msg(render_geometry->m_ref_count > 0, "Render geometry released more often than acquired");
 
-  // Create per object constant buffer
+  if (--render_geometry->m_ref_count > 0)
+  {
+    return;
+  }
+
+  --m_render_geometry_stats.m_num_live;
+  m_render_geometry_stats.m_num_bytes -= render_geometry->m_vertex_buffer->m_size + render_geometry->m_index_buffer->m_size;
+  m_render_geometry_stats.m_num_bytes -= render_geometry->m_attribute_buffer ? render_geometry->m_attribute_buffer->m_size : 0;
 
-  DX12BufferResource::Desc per_object_cb_desc{};
-  per_object_cb_desc.m_size = sizeof(PerObjectConstants);
-  per_object_cb_desc.m_access = DX12ResourceAccess::HostWritable;
-  per_object_cb_desc.m_view_flags.set(DX12BufferViewFlags::CBV);
-  for (u32 i = 0; i < k_num_frames_in_flight; ++i)
+  // Destruction is deferred until the frames that may still draw the buffers have completed
+  m_dx12_state->destroy_buffer_resource(move_ptr(render_geometry->m_vertex_buffer));
+  m_dx12_state->destroy_buffer_resource(move_ptr(render_geometry->m_index_buffer));
+
+  if (render_geometry->m_attribute_buffer)
   {
-    render_object->m_constant_buffers[i] = m_dx12_state->create_buffer_resource(per_object_cb_desc);
+    m_dx12_state->destroy_buffer_resource(move_ptr(render_geometry->m_attribute_buffer));
   }
-  render_object->m_constant_buffers[0]->copy_data(&render_object->m_constants, sizeof(PerObjectConstants));
 
-  return render_object;
+  m_render_geometries.erase(render_geometry->m_source);
+}
+
+void Renderer::cull_render_objects()
+{
+  m_culled_objects.clear();
+  m_culled_material_indices.clear();
+  for (u32 i = 0; i < static_cast<u32>(m_material_data.size()); i++)
+  {
+    const DynamicArray<RenderObject*>& render_objects = m_material_data[i]->m_render_objects;
+    m_culled_objects.insert(m_culled_objects.end(), render_objects.begin(), render_objects.end());
+    m_culled_material_indices.insert(m_culled_material_indices.end(), render_objects.size(), i);
+  }
+
+  const u32 num_objects = static_cast<u32>(m_culled_objects.size());
+  if (!m_frustum_culling_enabled)
+  {
+    m_visible_objects.resize(num_objects);
+    fill_sequential(m_visible_objects.begin(), m_visible_objects.end(), 0u);
+    m_culling_stats.m_num_tested = num_objects;
+    m_culling_stats.m_num_visible = num_objects;
+    return;
+  }
+
+  // Anyone can move a render object through its constants, so the world bounds are refreshed every frame
+  UpdateCullingBoundsContext context{};
+  context.m_render_objects = m_culled_objects.data();
+  context.m_bounds = &m_culling_bounds;
+  m_culling_bounds.resize(num_objects);
+  Platform::parallel_for(num_objects, k_culling_batch_size, &update_culling_bounds_job, &context);
+
+  const Frustum frustum = extract_frustum(m_per_pass_constants.view_matrix * m_per_pass_constants.projection_matrix);
+  cull_frustum(frustum, m_culling_bounds, &m_visible_objects, &m_culling_stats);
+}
+
+void Renderer::build_instanced_draws()
+{
+  // Front to back by the view space depth of each bounding sphere's center. Materials are bindless and selected per
+  // instance, so objects drawing the same geometry and LOD merge into one draw whatever their materials.
+  const Matrix& view_matrix = m_per_pass_constants.view_matrix;
+  const Vector3 camera_position(m_per_pass_constants.camera_position.x, m_per_pass_constants.camera_position.y, m_per_pass_constants.camera_position.z);
+  const f32 pixels_per_unit = 0.5f * static_cast<f32>(m_client_height) * m_per_pass_constants.projection_matrix._22;
+
+  m_instanced_objects.clear();
+  for (const u32 object_index : m_visible_objects)
+  {
+    const RenderObject* render_object = m_culled_objects[object_index];
+    const Vector3 world_center = Vector3::Transform(render_object->m_bounds_center, render_object->m_constants.world_matrix);
+
+    InstancedObject& object = m_instanced_objects.emplace_back();
+    object.m_key.m_geometry = render_object->m_geometry->m_id;
+    object.m_key.m_index_count = render_object->m_geometry->m_draw_count;
+    object.m_depth = Vector3::Transform(world_center, view_matrix).z;
+    object.m_item = object_index;
+
+    const RenderObjectLod* lod = m_lod_pixel_error > 0.0f ? select_render_object_lod(*render_object, camera_position, pixels_per_unit, m_lod_pixel_error) : nullptr;
+    if (lod)
+    {
+      object.m_key.m_index_count = lod->m_index_count;
+      object.m_key.m_start_index = lod->m_start_index;
+    }
+  }
+
+  batch_instanced_objects(m_instanced_objects.data(), static_cast<u32>(m_instanced_objects.size()), &m_render_queue, &m_instance_batcher);
+}
+
+DX12BufferResource* Renderer::get_instance_buffer(u32 num_instances)
+{
+  if (num_instances > m_instance_buffer_capacity)
+  {
+    m_instance_buffer_capacity = ZV::max(num_instances, m_instance_buffer_capacity * 2);
+
+    DX12BufferResource::Desc instance_buffer_desc{};
+    instance_buffer_desc.m_size = m_instance_buffer_capacity * sizeof(InstanceData);
+    instance_buffer_desc.m_stride = sizeof(InstanceData);
+    instance_buffer_desc.m_access = DX12ResourceAccess::HostWritable;
+    instance_buffer_desc.m_view_flags.set(DX12BufferViewFlags::SRV);
+
+    // Frames in flight may still read the old buffers, their destruction waits for them
+    for (auto& buffer : m_instance_buffers)
+    {
+      if (buffer)
+      {
+        m_dx12_state->destroy_buffer_resource(move_ptr(buffer));
+      }
+      buffer = m_dx12_state->create_buffer_resource(instance_buffer_desc);
+    }
+  }
+
+  return m_instance_buffers[m_dx12_state->get_frame_id()].get();
 }
 
 void Renderer::create_default_graphics_pipeline()
@@ -429,15 +767,12 @@ void Renderer::create_default_graphics_pipeline()
 
   // Prepare frame resources
 
-  DX12BufferResource::Desc per_object_cb_desc{};
-  per_object_cb_desc.m_size = sizeof(PerObjectConstants);
-  per_object_cb_desc.m_access = DX12ResourceAccess::HostWritable;
-  per_object_cb_desc.m_view_flags.set(DX12BufferViewFlags::CBV);
+  m_dummy_texture_index = dummy_texture->m_texture_resource->m_descriptor_heap_index;
 
-  DX12BufferResource::Desc per_material_cb_desc{};
-  per_material_cb_desc.m_size = sizeof(PerMaterialConstants);
-  per_material_cb_desc.m_access = DX12ResourceAccess::HostWritable;
-  per_material_cb_desc.m_view_flags.set(DX12BufferViewFlags::CBV);
+  DX12BufferResource::Desc per_draw_cb_desc{};
+  per_draw_cb_desc.m_size = sizeof(PerDrawConstants);
+  per_draw_cb_desc.m_access = DX12ResourceAccess::HostWritable;
+  per_draw_cb_desc.m_view_flags.set(DX12BufferViewFlags::CBV);
 
   DX12BufferResource::Desc per_pass_cb_desc{};
   per_pass_cb_desc.m_size = sizeof(PerPassConstants);
@@ -449,72 +784,39 @@ void Renderer::create_default_graphics_pipeline()
   per_frame_cb_desc.m_access = DX12ResourceAccess::HostWritable;
   per_frame_cb_desc.m_view_flags.set(DX12BufferViewFlags::CBV);
 
-  for (u32 i = 0; i < k_num_frames_in_flight; ++i)
-  {
-    m_frame_resources[i].m_per_pass_constant_buffer = m_dx12_state->create_buffer_resource(per_pass_cb_desc);
-    m_frame_resources[i].m_per_frame_constant_buffer = m_dx12_state->create_buffer_resource(per_frame_cb_desc);
-  }
-
-  // Initialize per object constant buffer
+  // Initialize per draw constant buffer
 
-  m_per_object_constant_buffer_dummy = m_dx12_state->create_buffer_resource(per_object_cb_desc);
+  m_per_draw_constant_buffer_dummy = m_dx12_state->create_buffer_resource(per_draw_cb_desc);
 
-  PerObjectConstants object_constants{};
-  m_per_object_constant_buffer_dummy->copy_data(&object_constants, sizeof(PerObjectConstants));
+  PerDrawConstants draw_constants{};
+  m_per_draw_constant_buffer_dummy->copy_data(&draw_constants, sizeof(PerDrawConstants));
 
-  m_per_object_resource_space.set_cbv(m_per_object_constant_buffer_dummy.get());
+  m_per_object_resource_space.set_cbv(m_per_draw_constant_buffer_dummy.get());
   m_per_object_resource_space.lock();
 
-  // Initialize per material constant buffer
-
-  m_per_material_constant_buffer_dummy = m_dx12_state->create_buffer_resource(per_material_cb_desc);
-
-  PerMaterialConstants material_constants{};
-  m_per_material_constant_buffer_dummy->copy_data(&material_constants, sizeof(PerMaterialConstants));
-
-  DX12PipelineResourceBinding diffuse_texture_binding{};
-  diffuse_texture_binding.m_resource = dummy_texture->m_texture_resource.get();
-  diffuse_texture_binding.m_binding_index = 0;
-
-  DX12PipelineResourceBinding normal_texture_binding{};
-  normal_texture_binding.m_resource = dummy_texture->m_texture_resource.get();
-  normal_texture_binding.m_binding_index = 1;
-
-  DX12PipelineResourceBinding metallic_roughness_texture_binding{};
-  metallic_roughness_texture_binding.m_resource = dummy_texture->m_texture_resource.get();
-  metallic_roughness_texture_binding.m_binding_index = 2;
-
-  DX12PipelineResourceBinding ao_texture_binding{};
-  ao_texture_binding.m_resource = dummy_texture->m_texture_resource.get();
-  ao_texture_binding.m_binding_index = 3;
-
-  DX12PipelineResourceBinding emissive_texture_binding{};
-  emissive_texture_binding.m_resource = dummy_texture->m_texture_resource.get();
-  emissive_texture_binding.m_binding_index = 4;
+  // Initialize per pass constant buffer
 
-  DX12PipelineResourceBinding specular_texture_binding{};
-  specular_texture_binding.m_resource = dummy_texture->m_texture_resource.get();
-  specular_texture_binding.m_binding_index = 5;
+  m_per_pass_constant_buffer_dummy = m_dx12_state->create_buffer_resource(per_pass_cb_desc);
+  m_per_pass_constant_buffer_dummy->copy_data(&m_per_pass_constants, sizeof(PerPassConstants));
 
-  DX12PipelineResourceBinding overlay_texture_binding{};
-  overlay_texture_binding.m_resource = dummy_texture->m_texture_resource.get();
-  overlay_texture_binding.m_binding_index = 6;
+  // The instances and the object and material constants they index, render() points these at the current frame's buffers
 
-  m_per_material_resource_space.set_cbv(m_per_material_constant_buffer_dummy.get());
-  m_per_material_resource_space.set_srv(diffuse_texture_binding);
-  m_per_material_resource_space.set_srv(normal_texture_binding);
-  m_per_material_resource_space.set_srv(metallic_roughness_texture_binding);
-  m_per_material_resource_space.set_srv(ao_texture_binding);
-  m_per_material_resource_space.set_srv(emissive_texture_binding);
-  m_per_material_resource_space.set_srv(specular_texture_binding);
-  m_per_material_resource_space.set_srv(overlay_texture_binding);
-  m_per_material_resource_space.lock();
+  DX12PipelineResourceBinding instances_binding{};
+  instances_binding.m_resource = get_instance_buffer(k_initial_instance_capacity);
+  instances_binding.m_binding_index = 0;
 
-  // Initialize per pass constant buffer
+  DX12PipelineResourceBinding object_constants_binding{};
+  object_constants_binding.m_resource = m_per_object_constant_table->get_buffer();
+  object_constants_binding.m_binding_index = 1;
 
-  m_frame_resources[0].m_per_pass_constant_buffer->copy_data(&m_per_pass_constants, sizeof(PerPassConstants));
+  DX12PipelineResourceBinding material_constants_binding{};
+  material_constants_binding.m_resource = m_per_material_constant_table->get_buffer();
+  material_constants_binding.m_binding_index = 2;
 
-  m_per_pass_resource_space.set_cbv(m_frame_resources[0].m_per_pass_constant_buffer.get());
+  m_per_pass_resource_space.set_cbv(m_per_pass_constant_buffer_dummy.get());
+  m_per_pass_resource_space.set_srv(instances_binding);
+  m_per_pass_resource_space.set_srv(object_constants_binding);
+  m_per_pass_resource_space.set_srv(material_constants_binding);
   m_per_pass_resource_space.lock();
 
   // Initialize per frame constant buffer
@@ -523,27 +825,42 @@ void Renderer::create_default_graphics_pipeline()
   m_per_frame_constants.reference_white_nits = m_dx12_state->get_reference_white_nits();
   m_per_frame_constants.exposure = 1.0f;
   m_per_frame_constants.tonemap_type = m_tonemap_type;
-  m_frame_resources[0].m_per_frame_constant_buffer->copy_data(&m_per_frame_constants, sizeof(PerFrameConstants));
+  m_per_frame_constant_buffer_dummy = m_dx12_state->create_buffer_resource(per_frame_cb_desc);
+  m_per_frame_constant_buffer_dummy->copy_data(&m_per_frame_constants, sizeof(PerFrameConstants));
 
-  m_per_frame_resource_space.set_cbv(m_frame_resources[0].m_per_frame_constant_buffer.get());
+  m_per_frame_resource_space.set_cbv(m_per_frame_constant_buffer_dummy.get());
   m_per_frame_resource_space.lock();
 
   // Create pipeline state object
 
   DX12PipelineState::Desc pipeline_desc = get_default_pipeline_state_desc();
-  pipeline_desc.m_vs_path = L"Shaders/Default_vs.cso";
+  pipeline_desc.m_vs_path = m_packed_vertices_enabled ? L"Shaders/Default_packed_vs.cso" : L"Shaders/Default_vs.cso";
   pipeline_desc.m_ps_path = L"Shaders/Default_ps.cso";
   pipeline_desc.m_render_target_desc.m_num_render_targets = 1;
   pipeline_desc.m_render_target_desc.m_render_target_formats[0] = m_dx12_state->get_back_buffer_format();
   pipeline_desc.m_render_target_desc.m_depth_stencil_format = DXGI_FORMAT_D32_FLOAT;
   pipeline_desc.m_spaces[DX12ResourceSpace::PerObjectSpace] = &m_per_object_resource_space;
-  pipeline_desc.m_spaces[DX12ResourceSpace::PerMaterialSpace] = &m_per_material_resource_space;
+  pipeline_desc.m_bindless_srv_space = DX12ResourceSpace::PerMaterialSpace;
   pipeline_desc.m_spaces[DX12ResourceSpace::PerPassSpace] = &m_per_pass_resource_space;
   pipeline_desc.m_spaces[DX12ResourceSpace::PerFrameSpace] = &m_per_frame_resource_space;
-  pipeline_desc.m_input_layout.m_elements[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
-  pipeline_desc.m_input_layout.m_elements[1] = { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
-  pipeline_desc.m_input_layout.m_elements[2] = { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
-  pipeline_desc.m_input_layout.m_elements[3] = { "TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+  // Split streams read the position from slot 0 and the rest from slot 1, the offsets restart in the second stream
+  const u32 attribute_slot = m_split_vertex_streams_enabled ? 1 : 0;
+  if (m_packed_vertices_enabled)
+  {
+    const u32 attribute_offset = m_split_vertex_streams_enabled ? 0 : 8;
+    pipeline_desc.m_input_layout.m_elements[0] = { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+    pipeline_desc.m_input_layout.m_elements[1] = { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, attribute_slot, attribute_offset + 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+    pipeline_desc.m_input_layout.m_elements[2] = { "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, attribute_slot, attribute_offset + 4, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+    pipeline_desc.m_input_layout.m_elements[3] = { "TANGENT", 0, DXGI_FORMAT_R16G16_SNORM, attribute_slot, attribute_offset + 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+  }
+  else
+  {
+    const u32 attribute_offset = m_split_vertex_streams_enabled ? 0 : 12;
+    pipeline_desc.m_input_layout.m_elements[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+    pipeline_desc.m_input_layout.m_elements[1] = { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, attribute_slot, attribute_offset + 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+    pipeline_desc.m_input_layout.m_elements[2] = { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, attribute_slot, attribute_offset + 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+    pipeline_desc.m_input_layout.m_elements[3] = { "TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, attribute_slot, attribute_offset + 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 };
+  }
   pipeline_desc.m_input_layout.m_num_elements = 4;
   pipeline_desc.m_depth_stencil_desc.DepthEnable = true;
   pipeline_desc.m_depth_stencil_desc.DepthWriteMask = D3D12_DEPTH_WRITE_MASK_ALL;
@@ -643,75 +960,67 @@ void Renderer::render()
   pipeline_info.m_depth_stencil_target = depth_buffer;
   m_dx12_graphics_ctx->set_pipeline(pipeline_info);
 
-  FrameResources* frame_resources = &m_frame_resources[m_dx12_state->get_frame_id()];
+  // Pass and frame constants are written into the upload ring every frame, object and material constants only when they changed
+  DX12UploadRing* constant_upload_ring = m_dx12_state->get_constant_upload_ring();
+  m_constant_upload_stats = {};
+  m_per_object_constant_table->begin_frame();
+  m_per_material_constant_table->begin_frame();
 
-  frame_resources->m_per_frame_constant_buffer->copy_data(&m_per_frame_constants, sizeof(PerFrameConstants));
-  m_per_frame_resource_space.set_cbv(frame_resources->m_per_frame_constant_buffer.get());
+  m_per_frame_resource_space.set_cbv(constant_upload_ring->upload(&m_per_frame_constants, sizeof(PerFrameConstants)));
 
   m_dx12_graphics_ctx->set_pipeline_resources(DX12ResourceSpace::PerFrameSpace, &m_per_frame_resource_space);
 
-  frame_resources->m_per_pass_constant_buffer->copy_data(&m_per_pass_constants, sizeof(PerPassConstants));
-  m_per_pass_resource_space.set_cbv(frame_resources->m_per_pass_constant_buffer.get());
+  cull_render_objects();
+  build_instanced_draws();
 
-  m_dx12_graphics_ctx->set_pipeline_resources(DX12ResourceSpace::PerPassSpace, &m_per_pass_resource_space);
-
-  for (auto& material_data : m_material_data)
+  // Every visible object is an instance, which finds its object and material constants through the instance buffer
+  const DynamicArray<u32>& instance_items = m_instance_batcher.get_instance_items();
+  const u32 num_instances = static_cast<u32>(instance_items.size());
+  DX12BufferResource* instance_buffer = get_instance_buffer(num_instances);
+  InstanceData* instances = reinterpret_cast<InstanceData*>(instance_buffer->m_mapped_data);
+  for (u32 instance_index = 0; instance_index < num_instances; instance_index++)
   {
-    material_data->m_constant_buffers[m_dx12_state->get_frame_id()]->copy_data(&material_data->m_constants, sizeof(PerMaterialConstants));
-    m_per_material_resource_space.set_cbv(material_data->m_constant_buffers[m_dx12_state->get_frame_id()].get());
+    const u32 item = instance_items[instance_index];
+    RenderObject* render_object = m_culled_objects[item];
+    MaterialData* material_data = m_material_data[m_culled_material_indices[item]].get();
 
-    MaterialTexture& albedo_texture = material_data->m_textures[static_cast<u32>(MaterialTextureType::Albedo)];
-    MaterialTexture& normal_texture = material_data->m_textures[static_cast<u32>(MaterialTextureType::Normal)];
-    MaterialTexture& metallic_roughness_texture = material_data->m_textures[static_cast<u32>(MaterialTextureType::MetallicRoughness)];
-    MaterialTexture& specular_texture = material_data->m_textures[static_cast<u32>(MaterialTextureType::Specular)];
-    MaterialTexture& ao_texture = material_data->m_textures[static_cast<u32>(MaterialTextureType::AO)];
-    MaterialTexture& overlay_texture = material_data->m_textures[static_cast<u32>(MaterialTextureType::Overlay)];
-    MaterialTexture& emissive_texture = material_data->m_textures[static_cast<u32>(MaterialTextureType::Emissive)];
+    m_per_object_constant_table->update(render_object->m_constants_entry, &render_object->m_constants, &render_object->m_dirty_frames, &m_constant_upload_stats);
+    m_per_material_constant_table->update(material_data->m_constants_entry, &material_data->m_constants, &material_data->m_dirty_frames, &m_constant_upload_stats);
 
-    if (albedo_texture.is_valid())
-    {
-      m_per_material_resource_space.set_srv(albedo_texture.m_texture_binding);
-    }
-    if (normal_texture.is_valid())
-    {
-      m_per_material_resource_space.set_srv(normal_texture.m_texture_binding);
-    }
-    if (metallic_roughness_texture.is_valid())
-    {
-      m_per_material_resource_space.set_srv(metallic_roughness_texture.m_texture_binding);
-    }
-    if (specular_texture.is_valid())
-    {
-      m_per_material_resource_space.set_srv(specular_texture.m_texture_binding);
-    }
-    if (ao_texture.is_valid())
-    {
-      m_per_material_resource_space.set_srv(ao_texture.m_texture_binding);
-    }
-    if (emissive_texture.is_valid())
-    {
-      m_per_material_resource_space.set_srv(emissive_texture.m_texture_binding);
-    }
-    if (overlay_texture.is_valid())
-    {
-      m_per_material_resource_space.set_srv(overlay_texture.m_texture_binding);
-    }
+    instances[instance_index].object_index = render_object->m_constants_entry;
+    instances[instance_index].material_index = material_data->m_constants_entry;
+  }
 
-    m_dx12_graphics_ctx->set_pipeline_resources(DX12ResourceSpace::PerMaterialSpace, &m_per_material_resource_space);
+  // Each table has a buffer per frame in flight, and acquire_entry replaces them when the table grows. Bind the current
+  // frame's buffers as they are now.
+  DX12PipelineResourceBinding instances_binding{};
+  instances_binding.m_resource = instance_buffer;
+  instances_binding.m_binding_index = 0;
 
-    for (auto& render_object : material_data->m_render_objects)
-    {
-      render_object->m_constant_buffers[m_dx12_state->get_frame_id()]->copy_data(&render_object->m_constants, sizeof(PerObjectConstants));
-      m_per_object_resource_space.set_cbv(render_object->m_constant_buffers[m_dx12_state->get_frame_id()].get());
-
-      m_dx12_graphics_ctx->set_pipeline_resources(DX12ResourceSpace::PerObjectSpace, &m_per_object_resource_space);
-      m_dx12_graphics_ctx->set_vertex_buffer(render_object->m_vertex_buffer.get());
-      m_dx12_graphics_ctx->set_index_buffer(render_object->m_index_buffer.get());
-      m_dx12_graphics_ctx->set_viewport_and_scissor(m_client_width, m_client_height);
-      m_dx12_graphics_ctx->set_primitive_topology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-      m_dx12_graphics_ctx->draw_indexed(render_object->m_draw_count);
-    }
-  }
+  DX12PipelineResourceBinding object_constants_binding{};
+  object_constants_binding.m_resource = m_per_object_constant_table->get_buffer();
+  object_constants_binding.m_binding_index = 1;
+
+  DX12PipelineResourceBinding material_constants_binding{};
+  material_constants_binding.m_resource = m_per_material_constant_table->get_buffer();
+  material_constants_binding.m_binding_index = 2;
+
+  m_per_pass_resource_space.set_cbv(constant_upload_ring->upload(&m_per_pass_constants, sizeof(PerPassConstants)));
+  m_per_pass_resource_space.set_srv(instances_binding);
+  m_per_pass_resource_space.set_srv(object_constants_binding);
+  m_per_pass_resource_space.set_srv(material_constants_binding);
+
+  m_dx12_graphics_ctx->set_pipeline_resources(DX12ResourceSpace::PerPassSpace, &m_per_pass_resource_space);
+
+  m_dx12_graphics_ctx->set_viewport_and_scissor(m_client_width, m_client_height);
+  m_dx12_graphics_ctx->set_primitive_topology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+  CommandListDrawRecorder draw_recorder{};
+  draw_recorder.m_graphics_ctx = m_dx12_graphics_ctx.get();
+  draw_recorder.m_constant_upload_ring = constant_upload_ring;
+  draw_recorder.m_per_draw_resource_space = &m_per_object_resource_space;
+  draw_recorder.m_render_objects = m_culled_objects.data();
+  m_instance_batcher.record(&draw_recorder, &m_instancing_stats);
 
   if (m_msaa_enabled)
   {
@@ -742,6 +1051,10 @@ void Renderer::render()
   m_dx12_graphics_ctx->add_barrier(render_target, D3D12_RESOURCE_STATE_PRESENT);
   m_dx12_graphics_ctx->flush_barriers();
 
+  m_state_filter_stats = m_dx12_graphics_ctx->get_state_filter_stats();
+  m_descriptor_table_cache_stats = m_dx12_graphics_ctx->get_descriptor_table_cache_stats();
+  m_descriptor_heap_stats = m_dx12_state->get_srv_heap(m_dx12_state->get_frame_id())->get_user_stats();
+
   m_dx12_state->submit_context(m_dx12_graphics_ctx.get());
 
   m_dx12_state->end_frame();
@@ -778,20 +1091,35 @@ void MaterialData::set_bound_texture(const MaterialTextureInfo& info, const Asse
   zv_assert_msg(texture_asset != nullptr, "Texture asset not found: {}", id.name().c_str());
   zv_assert_msg(texture_asset->is_ready(), "Texture asset not ready: {}", id.name().c_str());
 
-  m_textures[static_cast<u32>(info.m_type)].m_texture_binding.m_resource = texture_asset->m_texture_data->m_texture_resource.get();
-  m_textures[static_cast<u32>(info.m_type)].m_texture_binding.m_binding_index = static_cast<u32>(info.m_type);
+  const u32 texture_index = texture_asset->m_texture_data->m_texture_resource->m_descriptor_heap_index;
+  const u32 slice = texture_asset->m_array_slice;
+  const Vector4& uv_transform = texture_asset->m_uv_transform;
 
   switch (info.m_type)
   {
   case MaterialTextureType::Albedo:
     m_feature_flags.set(MaterialFeature::AlbedoMap);
+    m_constants.albedo_texture = texture_index;
+    m_constants.albedo_slice = slice;
+    m_constants.albedo_uv_transform = uv_transform;
     break;
   case MaterialTextureType::Normal:
     m_feature_flags.set(MaterialFeature::NormalMap);
+    m_constants.normal_texture = texture_index;
+    m_constants.normal_slice = slice;
+    m_constants.normal_uv_transform = uv_transform;
     break;
-  case MaterialTextureType::MetallicRoughness:
+  case MaterialTextureType::ORMS:
   {
-    zv_assert_msg(info.m_channel_packing != ChannelPacking::None, "Channel packing info is required for metallic roughness texture!");
+    m_constants.orms_texture = texture_index;
+    m_constants.orms_slice = slice;
+    m_constants.orms_uv_transform = uv_transform;
+
+    zv_assert_msg(info.m_channel_packing != ChannelPacking::None, "Channel packing info is required for ORMS texture!");
+    if (info.m_channel_packing.is_set(ChannelPacking::Occlusion))
+    {
+      m_feature_flags.set(MaterialFeature::AOMap);
+    }
     if (info.m_channel_packing.is_set(ChannelPacking::Roughness))
     {
       m_feature_flags.set(MaterialFeature::RoughnessMap);
@@ -800,23 +1128,28 @@ void MaterialData::set_bound_texture(const MaterialTextureInfo& info, const Asse
     {
       m_feature_flags.set(MaterialFeature::MetalnessMap);
     }
+    if (info.m_channel_packing.is_set(ChannelPacking::Specular))
+    {
+      m_feature_flags.set(MaterialFeature::SpecularMap);
+    }
     break;
   }
-  case MaterialTextureType::Specular:
-    m_feature_flags.set(MaterialFeature::SpecularMap);
-    break;
-  case MaterialTextureType::AO:
-    m_feature_flags.set(MaterialFeature::AOMap);
-    break;
   case MaterialTextureType::Overlay:
     m_feature_flags.set(MaterialFeature::OverlayMap);
+    m_constants.overlay_texture = texture_index;
+    m_constants.overlay_slice = slice;
+    m_constants.overlay_uv_transform = uv_transform;
     break;
   case MaterialTextureType::Emissive:
     m_feature_flags.set(MaterialFeature::EmissiveMap);
+    m_constants.emissive_texture = texture_index;
+    m_constants.emissive_slice = slice;
+    m_constants.emissive_uv_transform = uv_transform;
     break;
   default:
     break;
   }
 
   m_constants.feature_flags = m_feature_flags.value();
+  mark_constants_dirty();
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <Asset.h>
+#include <Culling.h>
+#include <Instancing.h>
+#include <RenderQueue.h>
 #include <Shaders/Shared.h>
 #include <Platform/DX12/DX12.h>
 #include <CoreDefs.h>
@@ -8,11 +11,14 @@
 
 struct MeshGeometryData;
 
+struct RenderObject;
+
 struct DebugPrimitive
 {
   SharedPtr<PrimitiveMeshGeometryData> m_geometry = nullptr;
   MaterialInfo m_material_info{};
   Matrix m_world_matrix = {};
+  RenderObject* m_render_object = nullptr;  // Set once the primitive is pushed and its textures are ready
 };
 
 struct ModelLoadData
@@ -34,13 +40,55 @@ public:
   void get_transform(Vector3& position, Quaternion& rotation);
 };
 
+// Index range of a reduced detail level inside the render object's index buffer
+struct RenderObjectLod
+{
+  u32 m_start_index = 0;
+  u32 m_index_count = 0;
+  f32 m_rms_error = 0.0f;  // Mesh units, see MeshLod
+};
+
+// GPU copy of a mesh, shared by every render object that draws the same geometry
+struct RenderGeometry
+{
+  UniquePtr<DX12BufferResource> m_vertex_buffer = nullptr;     // Positions only if the streams are split
+  UniquePtr<DX12BufferResource> m_attribute_buffer = nullptr;  // Second stream, nullptr for interleaved vertices
+  UniquePtr<DX12BufferResource> m_index_buffer = nullptr;
+  u32 m_draw_count = 0;  // LOD 0, the other levels follow it in the index buffer
+  DynamicArray<RenderObjectLod> m_lods{};
+  const MeshGeometryData* m_source = nullptr;  // Key in the renderer's geometry map
+  u32 m_id = 0;          // Unique per upload, groups draws of the same buffers in the render queue
+  u32 m_ref_count = 0;   // Render objects using the buffers, they are destroyed when it drops to 0
+};
+
+struct RenderGeometryStats
+{
+  u32 m_num_hits = 0;    // Render objects that reused uploaded buffers
+  u32 m_num_misses = 0;  // Uploads
+  u32 m_num_live = 0;
+  u64 m_num_bytes = 0;   // Vertex, attribute and index buffer memory of the live geometries
+
+  f32 get_hit_rate() const { return m_num_hits + m_num_misses ? static_cast<f32>(m_num_hits) / (m_num_hits + m_num_misses) : 0.0f; }
+};
+
+// One bit per frame in flight whose copy of some constants is out of date
+constexpr u8 k_all_frames_dirty = (1 << k_num_frames_in_flight) - 1;
+static_assert(k_num_frames_in_flight <= 8, "Dirty frame masks are 8 bits");
+
 struct RenderObject
 {
   PerObjectConstants m_constants{};
-  UniquePtr<DX12BufferResource> m_vertex_buffer = nullptr;
-  UniquePtr<DX12BufferResource> m_index_buffer = nullptr;
-  StaticArray<UniquePtr<DX12BufferResource>, k_num_frames_in_flight> m_constant_buffers = {};
-  u32 m_draw_count = 0;
+  RenderGeometry* m_geometry = nullptr;
+  u32 m_constants_entry = 0;                  // In the renderer's per object constant table
+  u8 m_dirty_frames = k_all_frames_dirty;     // Call mark_constants_dirty() after writing m_constants directly
+
+  // Local space bounds, the box for frustum culling and the sphere for LOD selection
+  AABB m_bounds{};
+  Vector3 m_bounds_center{};
+  f32 m_bounds_radius = 0.0f;
+
+  void set_world_matrix(const Matrix& world_matrix) { m_constants.world_matrix = world_matrix; mark_constants_dirty(); }
+  void mark_constants_dirty() { m_dirty_frames = k_all_frames_dirty; }
 };
 
 struct RenderTexture
@@ -66,22 +114,16 @@ enum class MaterialFeature : u32
 };
 using MaterialFeatureFlags = BitFlags<MaterialFeature>;
 
-struct MaterialTexture
-{
-  DX12PipelineResourceBinding m_texture_binding;
-
-  bool is_valid() const { return m_texture_binding.m_resource != nullptr; }
-};
-
 struct MaterialData
 {
   MaterialFeatureFlags m_feature_flags{MaterialFeature::None};
-  PerMaterialConstants m_constants = {};
-  StaticArray<MaterialTexture, k_num_material_textures> m_textures = {};
+  PerMaterialConstants m_constants = {};  // Textures are referenced by their reserved descriptor index
   DynamicArray<RenderObject*> m_render_objects{};
-  StaticArray<UniquePtr<DX12BufferResource>, k_num_frames_in_flight> m_constant_buffers = {};
+  u32 m_constants_entry = 0;                  // In the renderer's per material constant table
+  u8 m_dirty_frames = k_all_frames_dirty;     // Call mark_constants_dirty() after writing m_constants directly
 
   void set_bound_texture(const MaterialTextureInfo& info, const AssetId& id);
+  void mark_constants_dirty() { m_dirty_frames = k_all_frames_dirty; }
 };
 
 class Renderer
@@ -92,7 +134,9 @@ public:
     u32 client_width, u32 client_height, 
     bool msaa_enabled = false, 
     DX12OutputMode output_mode = DX12OutputMode::SDR,
-    TonemapType tonemap_type = TonemapType::Linear
+    TonemapType tonemap_type = TonemapType::Linear,
+    bool packed_vertices_enabled = true,
+    bool split_vertex_streams_enabled = true
   );
   ~Renderer();
 
@@ -102,12 +146,18 @@ public:
   void push_model(const AssetId& id, const Matrix& world_matrix = {});
   // TODO: pop_model?
   void push_debug_primitive(DebugPrimitive* debug_primitive);
+  // Destroys the primitive and its render object, the geometry buffers are released once no other object uses them
+  void pop_debug_primitive(DebugPrimitive* debug_primitive);
 
   void process_previous_frame_loads();
 
   // DX12TextureData* create_texture(const char* path, TextureFormat format = TextureFormat::SRGB, u32 request_channels = 4);
   MaterialData* create_material_data();
-  RenderObject* create_render_object(MeshGeometryData* geometry, MaterialData* material_data);
+  // Render objects created from the same geometry share its vertex and index buffers. The geometry must stay alive
+  // while render objects use it, its address identifies the uploaded buffers. It is only read, so it has to come
+  // packed and bounded (imported meshes and primitives are), the buffers are filled from copies.
+  RenderObject* create_render_object(const MeshGeometryData* geometry, MaterialData* material_data);
+  void destroy_render_object(RenderObject* render_object);
   DebugPrimitive* create_debug_primitive(SharedPtr<PrimitiveMeshGeometryData> geometry, const MaterialInfo& material_info = {}, const Matrix& world_matrix = {});
   
   DX12State* get_dx12_state() { return m_dx12_state.get(); }
@@ -130,6 +180,28 @@ public:
   PunctualLight* create_punctual_light(const PunctualLight& initial = {});
 
   void set_client_size(u32 width, u32 height) { m_client_width = width; m_client_height = height; }
+  // Objects draw the coarsest LOD whose error projects to less than this many pixels, 0 always draws LOD 0
+  void set_lod_pixel_error(f32 pixels) { m_lod_pixel_error = pixels; }
+
+  const RenderGeometryStats& get_render_geometry_stats() const { return m_render_geometry_stats; }
+
+  // Skips render objects whose world bounds are outside the active camera's frustum
+  void set_frustum_culling_enabled(bool enabled) { m_frustum_culling_enabled = enabled; }
+  const CullingStats& get_culling_stats() const { return m_culling_stats; }
+  const UploadRingStats& get_upload_ring_stats() const { return m_dx12_state->get_constant_upload_ring()->get_stats(); }
+  // Per object and per material constants written or skipped by the last frame
+  const ConstantUploadStats& get_constant_upload_stats() const { return m_constant_upload_stats; }
+  // Visible objects and the instanced draws they were merged into by the last frame
+  const InstancingStats& get_instancing_stats() const { return m_instancing_stats; }
+  // State setting calls the graphics context issued or dropped as redundant in the last frame
+  const StateFilterStats& get_state_filter_stats() const { return m_state_filter_stats; }
+  // Descriptor tables of the last frame and the shader visible heap space they took
+  const DescriptorTableCacheStats& get_descriptor_table_cache_stats() const { return m_descriptor_table_cache_stats; }
+  const DX12DescriptorHeapStats& get_descriptor_heap_stats() const { return m_descriptor_heap_stats; }
+
+  // Closest hit of a world space ray against the triangles of every model set up so far, for picking.
+  // out_hit->m_instance is the submesh's instance in the scene BVH.
+  bool raycast(const Ray& ray, RayHit* out_hit) const { *out_hit = {}; return raycast_scene_bvh(m_scene_bvh, ray, out_hit); }
 
   void begin_frame_imgui();
   void end_frame_imgui();
@@ -148,26 +220,41 @@ private:
   void setup_render_resources(TextureAsset* texture_asset);
   void setup_render_resources(DebugPrimitive* debug_primitive);
 
+  RenderGeometry* acquire_render_geometry(const MeshGeometryData* geometry);
+  void release_render_geometry(RenderGeometry* render_geometry);
+
+  void cull_render_objects();
+  void build_instanced_draws();
+  DX12BufferResource* get_instance_buffer(u32 num_instances);
+
 private:
   UniquePtr<DX12State> m_dx12_state = nullptr;
   UniquePtr<DX12GraphicsCommandContext> m_dx12_graphics_ctx = nullptr;
 
-  DX12PipelineResourceSpace m_per_object_resource_space{};
-  DX12PipelineResourceSpace m_per_material_resource_space{};
+  DX12PipelineResourceSpace m_per_object_resource_space{};  // Per draw, materials are bindless
   DX12PipelineResourceSpace m_per_pass_resource_space{};
   DX12PipelineResourceSpace m_per_frame_resource_space{};
 
-  struct FrameResources
-  {
-    // UniquePtr<DX12BufferResource> m_per_object_constant_buffer = nullptr;
-    // UniquePtr<DX12BufferResource> m_per_material_constant_buffer = nullptr;
-    UniquePtr<DX12BufferResource> m_per_pass_constant_buffer = nullptr;
-    UniquePtr<DX12BufferResource> m_per_frame_constant_buffer = nullptr;
-  };
-  StaticArray<FrameResources, k_num_frames_in_flight> m_frame_resources = {};
+  // Only give the resource spaces their layout, the constants are bound from the tables below and the constant upload ring
+  UniquePtr<DX12BufferResource> m_per_draw_constant_buffer_dummy = nullptr;
+  UniquePtr<DX12BufferResource> m_per_pass_constant_buffer_dummy = nullptr;
+  UniquePtr<DX12BufferResource> m_per_frame_constant_buffer_dummy = nullptr;
+
+  // Object and material constants only change on setup or edits, each frame in flight keeps its own copy of them
+  UniquePtr<DX12ConstantTable> m_per_object_constant_table = nullptr;
+  UniquePtr<DX12ConstantTable> m_per_material_constant_table = nullptr;
+  ConstantUploadStats m_constant_upload_stats{};
+
+  // Object and material indices of every instance drawn this frame, one buffer per frame in flight
+  StaticArray<UniquePtr<DX12BufferResource>, k_num_frames_in_flight> m_instance_buffers{};
+  u32 m_instance_buffer_capacity = 0;
+  InstanceBatcher m_instance_batcher{};
+  InstancingStats m_instancing_stats{};
+  StateFilterStats m_state_filter_stats{};
+  DescriptorTableCacheStats m_descriptor_table_cache_stats{};
+  DX12DescriptorHeapStats m_descriptor_heap_stats{};
 
-  UniquePtr<DX12BufferResource> m_per_object_constant_buffer_dummy = nullptr;
-  UniquePtr<DX12BufferResource> m_per_material_constant_buffer_dummy = nullptr;
+  u32 m_dummy_texture_index = 0;  // Reserved descriptor index of the texture materials without a map point at
 
   UniquePtr<DX12PipelineState> m_default_graphics_pipeline = nullptr;
 
@@ -178,9 +265,25 @@ private:
   u32 m_client_width = 0;
   u32 m_client_height = 0;
   bool m_msaa_enabled = false;
+  bool m_packed_vertices_enabled = true;  // Upload PackedMeshVertex (20 bytes) instead of MeshVertex (48 bytes)
+  bool m_split_vertex_streams_enabled = true;  // Positions in input slot 0 and the other attributes in slot 1
+  f32 m_lod_pixel_error = 1.0f;
   TonemapType m_tonemap_type = TonemapType::Linear;
   DynamicArray<UniquePtr<RenderTexture>> m_textures{};
   DynamicArray<UniquePtr<RenderObject>> m_render_objects{};
+  HashMap<const MeshGeometryData*, UniquePtr<RenderGeometry>> m_render_geometries{};
+  SceneBvh m_scene_bvh{};  // Every model's submeshes, placed like their render objects
+  RenderGeometryStats m_render_geometry_stats{};
+  u32 m_next_render_geometry_id = 0;
+
+  bool m_frustum_culling_enabled = true;
+  DynamicArray<RenderObject*> m_culled_objects{};  // Every material's render objects, indexed by the lists below
+  DynamicArray<u32> m_culled_material_indices{};   // Into m_material_data
+  CullingBounds m_culling_bounds{};
+  DynamicArray<u32> m_visible_objects{};
+  CullingStats m_culling_stats{};
+  DynamicArray<InstancedObject> m_instanced_objects{};  // Visible objects, items index m_culled_objects
+  RenderQueue m_render_queue{};                         // Sorts m_instanced_objects by their state and depth
   DynamicArray<UniquePtr<MaterialData>> m_material_data{};
 
   DynamicArray<UniquePtr<Camera>> m_cameras{};
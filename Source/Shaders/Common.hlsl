@@ -13,13 +13,10 @@
 #define per_pass_space      space2
 #define per_frame_space     space3
 
-#define texture_diffuse_slot             t0
-#define texture_normal_slot              t1
-#define texture_metallic_roughness_slot  t2
-#define texture_ao_slot                  t3
-#define texture_emissive_slot            t4
-#define texture_specular_slot            t5
-#define texture_overlay_slot             t6
+// Per pass draw data, indexed per instance
+#define instances_slot                   t0
+#define object_constants_slot            t1
+#define material_constants_slot          t2
 
 #define PunctualLightType_Point 0u
 #define PunctualLightType_Spot  1u
@@ -52,6 +49,7 @@ struct VertexShaderOutput
     float2 uv         : TEXCOORD0;
     float3 normal_w   : NORMAL0;
     float4 tangent_w  : TANGENT0;
+    nointerpolation uint material_index : MATERIAL_INDEX;
 };
 
 float3 linear_to_srgb(float3 color)
@@ -136,7 +134,10 @@ float3 tonemap_filmic_alu(float3 color)
 
 float3 normal_sample_to_world(float3 normal_sample, float3 normal_w, float4 tangent_w)
 {
-    float3 normal_t = 2.0f * normal_sample - 1.0f;
+    // Normal maps are stored as BC5 (RG only), so z is always reconstructed
+    float3 normal_t;
+    normal_t.xy = 2.0f * normal_sample.xy - 1.0f;
+    normal_t.z = sqrt(saturate(1.0f - dot(normal_t.xy, normal_t.xy)));
 
     float3 n = normal_w;
     float3 t = normalize(tangent_w.xyz - dot(tangent_w.xyz, n) * n);
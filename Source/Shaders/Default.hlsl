@@ -7,114 +7,171 @@ SamplerState sampler_linear_clamp      : register(s3);
 SamplerState sampler_anisotropic_wrap  : register(s4);
 SamplerState sampler_anisotropic_clamp : register(s5);
 
-Texture2D texture_diffuse   : register(texture_diffuse_slot, per_material_space);
-Texture2D texture_normal    : register(texture_normal_slot, per_material_space);
-Texture2D texture_metallic_roughness : register(texture_metallic_roughness_slot, per_material_space);
-Texture2D texture_specular  : register(texture_specular_slot, per_material_space);
-Texture2D texture_ao        : register(texture_ao_slot, per_material_space);
-Texture2D texture_emissive  : register(texture_emissive_slot, per_material_space);
-Texture2D texture_overlay   : register(texture_overlay_slot, per_material_space);
-
-ConstantBuffer<PerObjectConstants> per_object_cb : register(b0, per_object_space);
-ConstantBuffer<PerMaterialConstants> per_material_cb : register(b0, per_material_space);
+// Every reserved descriptor, materials index their textures in it so instances of one draw can use different materials.
+// Material textures are arrays so textures grouped at import can share one resource.
+Texture2DArray material_textures[] : register(t0, per_material_space);
+
+StructuredBuffer<InstanceData> instances : register(instances_slot, per_pass_space);
+StructuredBuffer<PerObjectConstants> object_constants : register(object_constants_slot, per_pass_space);
+StructuredBuffer<PerMaterialConstants> material_constants : register(material_constants_slot, per_pass_space);
+
+ConstantBuffer<PerDrawConstants> per_draw_cb : register(b0, per_object_space);
 ConstantBuffer<PerPassConstants> per_pass_cb : register(b0, per_pass_space);
 ConstantBuffer<PerFrameConstants> per_frame_cb : register(b0, per_frame_space);
 
 
-VertexShaderOutput VS(MeshVertex IN)
+InstanceData get_instance(uint instance_id)
+{
+    return instances[per_draw_cb.instance_offset + instance_id];
+}
+
+VertexShaderOutput transform_vertex(MeshVertex IN, PerObjectConstants object, uint material_index)
 {
     VertexShaderOutput OUT;
 
-    float4 position_world = mul(per_object_cb.world_matrix, float4(IN.position, 1.0f));
+    float4 position_world = mul(object.world_matrix, float4(IN.position, 1.0f));
     OUT.position_w = position_world.xyz;
 
-    OUT.normal_w = normalize(mul((float3x3)per_object_cb.world_matrix, IN.normal));
-    OUT.tangent_w = float4(normalize(mul((float3x3)per_object_cb.world_matrix, IN.tangent.xyz)), IN.tangent.w);
+    OUT.normal_w = normalize(mul((float3x3)object.world_matrix, IN.normal));
+    OUT.tangent_w = float4(normalize(mul((float3x3)object.world_matrix, IN.tangent.xyz)), IN.tangent.w);
 
     OUT.position_h = mul(per_pass_cb.view_matrix, position_world);
     OUT.position_h = mul(per_pass_cb.projection_matrix, OUT.position_h);
 
     OUT.uv = IN.uv;
+    OUT.material_index = material_index;
 
     return OUT;
 }
 
+VertexShaderOutput VS(MeshVertex IN, uint instance_id : SV_InstanceID)
+{
+    InstanceData instance = get_instance(instance_id);
+    return transform_vertex(IN, object_constants[instance.object_index], instance.material_index);
+}
+
+// Inverse of encode_octahedral in Geometry.cpp
+float3 decode_octahedral(float2 e)
+{
+    float3 n = float3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0f ? -t : t;
+    return normalize(n);
+}
+
+VertexShaderOutput VS_packed(PackedMeshVertex IN, uint instance_id : SV_InstanceID)
+{
+    InstanceData instance = get_instance(instance_id);
+    PerObjectConstants object = object_constants[instance.object_index];
+
+    MeshVertex vertex;
+    vertex.position = IN.position.xyz * object.position_scale.xyz + object.position_offset.xyz;
+    vertex.uv = IN.uv;
+    vertex.normal = decode_octahedral(IN.normal);
+    vertex.tangent = float4(decode_octahedral(IN.tangent), IN.position.w * 2.0f - 1.0f);
+
+    return transform_vertex(vertex, object, instance.material_index);
+}
+
 // TODO: Use sampler descriptor heap!!!
-float4 sample_texture(Texture2D tex, uint sampler_mode, float2 uv)
+float4 sample_texture(Texture2DArray tex, uint sampler_mode, float2 uv, uint slice, float4 uv_transform)
 {
+    if (any(uv_transform != float4(1.0f, 1.0f, 0.0f, 0.0f)))
+    {
+        // Atlas entry: wrap or clamp inside the region, gradients of the unwrapped uv keep the mip selection continuous at the seams
+        float2 ddx_uv = ddx(uv) * uv_transform.xy;
+        float2 ddy_uv = ddy(uv) * uv_transform.xy;
+        float2 region_uv = sampler_mode == 0 ? saturate(uv) : frac(uv);
+        float2 atlas_uv = region_uv * uv_transform.xy + uv_transform.zw;
+
+        if (sampler_mode == 0)
+        {
+            // The gutter repeats the opposite edge, keep the bilinear footprint of the sampled level inside the region
+            uint width, height, elements, levels;
+            tex.GetDimensions(0, width, height, elements, levels);
+            float lod = max(log2(max(length(ddx_uv * float2(width, height)), length(ddy_uv * float2(width, height)))), 0.0f);
+            float2 half_texel = 0.5f * exp2(min(ceil(lod), levels - 1.0f)) / float2(width, height);
+            atlas_uv = clamp(atlas_uv, uv_transform.zw + half_texel, uv_transform.zw + uv_transform.xy - half_texel);
+        }
+
+        return tex.SampleGrad(sampler_anisotropic_clamp, float3(atlas_uv, slice), ddx_uv, ddy_uv);
+    }
+
     if (sampler_mode == 0)
     {
-        return tex.Sample(sampler_anisotropic_clamp, uv);
+        return tex.Sample(sampler_anisotropic_clamp, float3(uv, slice));
     }
     else
     {
-        return tex.Sample(sampler_anisotropic_wrap, uv);
+        return tex.Sample(sampler_anisotropic_wrap, float3(uv, slice));
     }
 }
 
+// The material differs between the instances of a draw, so texture indices aren't uniform
+#define get_material_texture(index) material_textures[NonUniformResourceIndex(index)]
+
 float4 PS(VertexShaderOutput IN) : SV_Target
 {
-    float4 final_albedo_color = float4(per_material_cb.albedo_color, 1.0f);
-    if (per_material_cb.feature_flags & MaterialFeature_AlbedoMap)
+    PerMaterialConstants material = material_constants[IN.material_index];
+
+    float4 final_albedo_color = float4(material.albedo_color, 1.0f);
+    if (material.feature_flags & MaterialFeature_AlbedoMap)
     {
-        final_albedo_color = final_albedo_color * sample_texture(texture_diffuse, per_material_cb.sampler_mode, IN.uv);
+        final_albedo_color = final_albedo_color * sample_texture(get_material_texture(material.albedo_texture), material.sampler_mode, IN.uv, material.albedo_slice, material.albedo_uv_transform);
         
         clip(final_albedo_color.a < 0.1f ? -1:1);
     }
 
-    if (per_material_cb.feature_flags & MaterialFeature_OverlayMap)
+    if (material.feature_flags & MaterialFeature_OverlayMap)
     {
-        float4 overlay_color = sample_texture(texture_overlay, per_material_cb.sampler_mode, IN.uv);
+        float4 overlay_color = sample_texture(get_material_texture(material.overlay_texture), material.sampler_mode, IN.uv, material.overlay_slice, material.overlay_uv_transform);
         final_albedo_color = lerp(final_albedo_color, overlay_color, overlay_color.a);
     }
 
     float3 normal_world = IN.normal_w;
-    if (per_material_cb.feature_flags & MaterialFeature_NormalMap)
+    if (material.feature_flags & MaterialFeature_NormalMap)
     {
-        float4 normal_sample = sample_texture(texture_normal, per_material_cb.sampler_mode, IN.uv);
-        if (per_material_cb.feature_flags & MaterialFeature_FlipNormals)
+        float4 normal_sample = sample_texture(get_material_texture(material.normal_texture), material.sampler_mode, IN.uv, material.normal_slice, material.normal_uv_transform);
+        if (material.feature_flags & MaterialFeature_FlipNormals)
         {
             normal_sample.g = 1.0f - normal_sample.g;
         }
         normal_world = normal_sample_to_world(normal_sample.rgb, IN.normal_w, IN.tangent_w);
     }
 
-    float metalness = per_material_cb.metallic;
-    float roughness = per_material_cb.roughness;
-    bool has_metallic_map = per_material_cb.feature_flags & MaterialFeature_MetalnessMap;
-    bool has_roughness_map = per_material_cb.feature_flags & MaterialFeature_RoughnessMap;
+    float metalness = material.metallic;
+    float roughness = material.roughness;
+    float specular = material.specular;
+    float ao = 1.0f;
 
-    if (has_metallic_map || has_roughness_map)
+    const uint orms_features = MaterialFeature_AOMap | MaterialFeature_RoughnessMap | MaterialFeature_MetalnessMap | MaterialFeature_SpecularMap;
+    if (material.feature_flags & orms_features)
     {
-        float4 metallic_roughness_sample = sample_texture(texture_metallic_roughness, per_material_cb.sampler_mode, IN.uv);
-        if (has_roughness_map)
+        float4 orms_sample = sample_texture(get_material_texture(material.orms_texture), material.sampler_mode, IN.uv, material.orms_slice, material.orms_uv_transform);
+        if (material.feature_flags & MaterialFeature_AOMap)
+        {
+            ao = orms_sample.r;
+        }
+        if (material.feature_flags & MaterialFeature_RoughnessMap)
         {
-            roughness = metallic_roughness_sample.g;
+            roughness = orms_sample.g;
             // roughness = lerp(0.015f, 1.0f, roughness);
         }
-        if (has_metallic_map)
+        if (material.feature_flags & MaterialFeature_MetalnessMap)
         {
-            metalness = metallic_roughness_sample.b;
+            metalness = orms_sample.b;
+        }
+        if (material.feature_flags & MaterialFeature_SpecularMap)
+        {
+            specular = orms_sample.a;
         }
-    }
-
-    float specular = per_material_cb.specular;
-    if (per_material_cb.feature_flags & MaterialFeature_SpecularMap)
-    {
-        specular = sample_texture(texture_specular, per_material_cb.sampler_mode, IN.uv).r;
-    }
-
-    float ao = 1.0f;
-    if (per_material_cb.feature_flags & MaterialFeature_AOMap)
-    {
-        ao = sample_texture(texture_ao, per_material_cb.sampler_mode, IN.uv).r;
     }
 
     // TODO
-    float4 emissive_color = float4(per_material_cb.emissive, per_material_cb.emissive, per_material_cb.emissive, 1.0f);
-    if (per_material_cb.feature_flags & MaterialFeature_EmissiveMap)
+    float4 emissive_color = float4(material.emissive, material.emissive, material.emissive, 1.0f);
+    if (material.feature_flags & MaterialFeature_EmissiveMap)
     {
-        emissive_color = sample_texture(texture_emissive, per_material_cb.sampler_mode, IN.uv);
+        emissive_color = sample_texture(get_material_texture(material.emissive_texture), material.sampler_mode, IN.uv, material.emissive_slice, material.emissive_uv_transform);
     }
 
     // Indirect lighting
@@ -126,7 +183,7 @@ float4 PS(VertexShaderOutput IN) : SV_Target
         per_frame_cb.global_light, 
         per_frame_cb.punctual_lights, 
         per_frame_cb.num_punctual_lights, 
-        per_material_cb, 
+        material, 
         final_albedo_color.rgb,
         IN.position_w, 
         normal_world, 
@@ -29,6 +29,15 @@ struct MeshVertex
     Vector4 tangent  : TANGENT;
 };
 
+// Compact layout of MeshVertex, see pack_mesh_vertex
+struct PackedMeshVertex
+{
+    Vector4 position : POSITION;  // xyz quantized to the mesh bounds, w is the tangent sign (0 = -1, 1 = +1)
+    Vector2 uv       : TEXCOORD;
+    Vector2 normal   : NORMAL;    // Octahedral
+    Vector2 tangent  : TANGENT;   // Octahedral
+};
+
 #else
 
 #include <CoreDefs.h>
@@ -48,6 +57,14 @@ struct MeshVertex
     Vector4 tangent;
 };
 
+struct PackedMeshVertex
+{
+    u16 position[4];  // R16G16B16A16_UNORM, xyz in the mesh bounds, w is the tangent sign
+    u16 uv[2];        // R16G16_FLOAT
+    s16 normal[2];    // R16G16_SNORM, octahedral
+    s16 tangent[2];   // R16G16_SNORM, octahedral
+};
+
 enum class PunctualLightType : u32
 {
     Point = 0,
@@ -124,9 +141,35 @@ struct PunctualLight
 #pragma pack(pop)
 #endif
 
+// One per instance of an instanced draw, indexes the object and material constants of the frame
+struct InstanceData
+{
+    u32 object_index;
+    u32 material_index;
+};
+
+struct PerDrawConstants
+{
+    u32 instance_offset;  // SV_InstanceID starts at 0 for every draw, the draw's instances start here
+    u32 pad0;
+    u32 pad1;
+    u32 pad2;
+};
+
 struct PerObjectConstants
 {
     Matrix world_matrix;
+    Vector4 position_scale;   // Dequantizes packed vertex positions, position = packed * scale + offset
+    Vector4 position_offset;
+
+#ifdef __cplusplus
+    PerObjectConstants()
+    {
+        world_matrix = Matrix();
+        position_scale = Vector4(1.0f, 1.0f, 1.0f, 0.0f);
+        position_offset = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+#endif
 };
 
 struct PerMaterialConstants
@@ -139,6 +182,25 @@ struct PerMaterialConstants
     u32 feature_flags;
     SamplerAddressMode sampler_mode;
 
+    // Array slice and atlas region (xy scale, zw offset) of each material texture
+    u32 albedo_slice;
+    u32 normal_slice;
+    u32 orms_slice;
+    u32 emissive_slice;
+    u32 overlay_slice;
+    // Reserved descriptor index of each material texture
+    u32 albedo_texture;
+    u32 normal_texture;
+    u32 orms_texture;
+    u32 emissive_texture;
+    u32 overlay_texture;
+    u32 pad0;
+    Vector4 albedo_uv_transform;
+    Vector4 normal_uv_transform;
+    Vector4 orms_uv_transform;
+    Vector4 emissive_uv_transform;
+    Vector4 overlay_uv_transform;
+
 #ifdef __cplusplus
     PerMaterialConstants()
     {
@@ -149,6 +211,10 @@ struct PerMaterialConstants
         emissive = 0.0f;
         feature_flags = 0;
         sampler_mode = SamplerAddressMode::Clamp;
+        albedo_slice = normal_slice = orms_slice = emissive_slice = overlay_slice = 0;
+        albedo_texture = normal_texture = orms_texture = emissive_texture = overlay_texture = 0;
+        pad0 = 0;
+        albedo_uv_transform = normal_uv_transform = orms_uv_transform = emissive_uv_transform = overlay_uv_transform = Vector4(1.0f, 1.0f, 0.0f, 0.0f);
     }
 #endif
 };
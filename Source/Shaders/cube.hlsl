@@ -33,6 +33,7 @@ VertexShaderOutput VS(MeshVertex IN)
     OUT.normal_w = IN.normal;
     OUT.tangent_w = IN.tangent;
     OUT.uv = IN.uv;
+    OUT.material_index = 0;
 
     return OUT;
 }
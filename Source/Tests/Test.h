@@ -0,0 +1,89 @@
+#pragma once
+
+#include <CoreDefs.h>
+
+#include <chrono>
+#include <cmath>
+
+// Self registering tests and benchmarks for the modules that don't need a device. The Tests executable runs every test and
+// returns the number of failures, with --bench it runs the benchmarks instead and prints their timings.
+
+struct TestContext
+{
+    u32 m_num_checks = 0;
+    u32 m_num_failures = 0;
+};
+
+#define TEST_CALLBACK(name) void name(TestContext* context)
+typedef TEST_CALLBACK(TestCallback);
+
+struct TestCase
+{
+    const char* m_name = nullptr;
+    TestCallback* m_callback = nullptr;
+    bool m_is_benchmark = false;
+};
+
+DynamicArray<TestCase>& get_test_cases();
+
+struct TestRegistration
+{
+    TestRegistration(const char* name, TestCallback* callback, bool is_benchmark) { get_test_cases().push_back({ name, callback, is_benchmark }); }
+};
+
+#define zv_test(name)                                                                   \
+    static TEST_CALLBACK(name);                                                         \
+    static const TestRegistration s_##name##_registration(#name, &name, false);         \
+    static TEST_CALLBACK(name)
+
+// Benchmarks only report timings, they get no context to check against
+#define zv_benchmark(name)                                                              \
+    static void name(TestContext*);                                                     \
+    static const TestRegistration s_##name##_registration(#name, &name, true);          \
+    static void name(TestContext*)
+
+void test_check(TestContext* context, bool passed, const char* expression, const char* file, u32 line);
+
+// Failed checks are reported and counted, the test keeps running
+#define zv_check(expr) test_check(context, static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+#define zv_check_near(a, b, tolerance) test_check(context, std::abs((a) - (b)) <= (tolerance), #a " ~= " #b, __FILE__, __LINE__)
+
+void report_timing(const char* label, f64 milliseconds);
+void report_count(const char* label, u64 count);
+
+// What Platform::get_worker_thread_count reports, parallel_for keeps running the batches on the calling thread
+void set_test_worker_thread_count(u32 num_threads);
+
+// Number of global operator new calls since the start of the process, on every thread
+u64 get_allocation_count();
+
+// Fastest of num_runs calls in milliseconds, the minimum filters out interruptions
+template <typename Function>
+f64 measure_best_ms(u32 num_runs, Function&& function)
+{
+    f64 best = 1e30;
+    for (u32 run = 0; run < num_runs; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        const f64 elapsed = std::chrono::duration<f64, std::milli>(end - start).count();
+        best = elapsed < best ? elapsed : best;
+    }
+    return best;
+}
+
+// Deterministic xorshift, so every run checks and times the same data
+struct TestRandom
+{
+    u32 m_state = 0x9e3779b9u;
+
+    u32 next_u32()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+    f32 next_f32(f32 min, f32 max) { return min + (max - min) * static_cast<f32>(next_u32() >> 8) * (1.0f / 16777216.0f); }
+};
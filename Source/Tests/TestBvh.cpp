@@ -0,0 +1,396 @@
+#include <Tests/TestMeshes.h>
+
+#include <Bvh.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // Wavy grid plus random slivers across it, so leaves overlap the way they do in imported meshes
+    MeshGeometryData make_bvh_test_mesh(u32 num_segments, TestRandom* random)
+    {
+        MeshGeometryData geometry = make_grid_mesh(num_segments);
+        for (MeshVertex& vertex : geometry.m_vertices)
+        {
+            vertex.position.z = 3.0f * std::sin(vertex.position.x * 0.3f) * std::cos(vertex.position.y * 0.2f);
+        }
+        for (u32 i = 0; i < 20; i++)
+        {
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                geometry.m_indices.push_back(static_cast<u16>(random->next_u32() % geometry.m_vertices.size()));
+            }
+        }
+        return geometry;
+    }
+
+    DynamicArray<AABB> get_triangle_bounds(const MeshGeometryData& geometry)
+    {
+        DynamicArray<AABB> bounds(geometry.m_indices.size() / 3);
+        for (size_t triangle = 0; triangle < bounds.size(); triangle++)
+        {
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                bounds[triangle].add(geometry.m_vertices[geometry.m_indices[triangle * 3 + corner]].position);
+            }
+        }
+        return bounds;
+    }
+
+    bool raycast_brute_force(const MeshGeometryData& geometry, const Ray& ray, RayHit* in_out_hit)
+    {
+        bool has_hit = false;
+        for (u32 triangle = 0; triangle < geometry.m_indices.size() / 3; triangle++)
+        {
+            f32 distance = 0.0f;
+            f32 u = 0.0f;
+            f32 v = 0.0f;
+            const u16* indices = geometry.m_indices.data() + triangle * 3;
+            if (intersect_ray_triangle(ray, geometry.m_vertices[indices[0]].position, geometry.m_vertices[indices[1]].position, geometry.m_vertices[indices[2]].position, &distance, &u, &v) &&
+                distance < in_out_hit->m_distance)
+            {
+                in_out_hit->m_distance = distance;
+                in_out_hit->m_triangle = triangle;
+                has_hit = true;
+            }
+        }
+        return has_hit;
+    }
+
+    // Every primitive in exactly one leaf, children after their parent and inside its bounds
+    void check_bvh(TestContext* context, const Bvh& bvh, const AABB* primitive_bounds, u32 num_primitives)
+    {
+        DynamicArray<u32> num_references(num_primitives, 0);
+        u32 num_bad_nodes = 0;
+        const auto contains = [](const AABB& outer, const AABB& inner)
+        {
+            AABB merged = outer;
+            merged.add(inner);
+            return memcmp(&merged, &outer, sizeof(AABB)) == 0;
+        };
+
+        for (size_t i = 0; i < bvh.m_nodes.size(); i++)
+        {
+            const BvhNode& node = bvh.m_nodes[i];
+            if (node.is_leaf())
+            {
+                for (u32 j = node.m_first; j < node.m_first + node.m_count; j++)
+                {
+                    num_references[bvh.m_primitives[j]]++;
+                    num_bad_nodes += contains(node.m_bounds, primitive_bounds[bvh.m_primitives[j]]) ? 0 : 1;
+                }
+            }
+            else
+            {
+                num_bad_nodes += node.m_first > i ? 0 : 1;
+                num_bad_nodes += contains(node.m_bounds, bvh.m_nodes[node.m_first].m_bounds) ? 0 : 1;
+                num_bad_nodes += contains(node.m_bounds, bvh.m_nodes[node.m_first + 1].m_bounds) ? 0 : 1;
+            }
+        }
+        zv_check(num_bad_nodes == 0);
+        zv_check(std::count(num_references.begin(), num_references.end(), 1u) == static_cast<std::ptrdiff_t>(num_primitives));
+    }
+
+    Ray make_random_ray(TestRandom* random, f32 extent)
+    {
+        Ray ray{};
+        ray.m_origin = Vector3(random->next_f32(-20.0f, extent + 20.0f), random->next_f32(-20.0f, extent + 20.0f), random->next_f32(-10.0f, 10.0f));
+        ray.m_direction = Vector3(random->next_f32(-1.0f, 1.0f), random->next_f32(-1.0f, 1.0f), random->next_f32(-1.0f, 1.0f));
+        if (random->next_u32() % 4 == 0)
+        {
+            ray.m_direction = Vector3(0.0f, 0.0f, -1.0f);
+        }
+        if (random->next_u32() % 8 == 0)
+        {
+            ray.m_max_distance = random->next_f32(1.0f, 50.0f);
+        }
+        return ray;
+    }
+
+    // From around the box towards a point inside it, most rays hit a closed mesh that fills the box
+    Ray make_random_ray_into_bounds(TestRandom* random, const AABB& bounds)
+    {
+        const Vector3 extent = bounds.m_max - bounds.m_min;
+        const auto random_point = [&](f32 margin)
+        {
+            return Vector3(
+                random->next_f32(bounds.m_min.x - margin * extent.x, bounds.m_max.x + margin * extent.x),
+                random->next_f32(bounds.m_min.y - margin * extent.y, bounds.m_max.y + margin * extent.y),
+                random->next_f32(bounds.m_min.z - margin * extent.z, bounds.m_max.z + margin * extent.z));
+        };
+
+        Ray ray{};
+        ray.m_origin = random_point(1.0f);
+        ray.m_direction = random_point(0.0f) - ray.m_origin;
+        return ray;
+    }
+
+    Matrix make_random_instance_transform(TestRandom* random)
+    {
+        return Matrix::CreateScale(random->next_f32(0.2f, 2.0f)) * Matrix::CreateRotationY(random->next_f32(0.0f, ZV_2PI)) *
+            Matrix::CreateTranslation(random->next_f32(-500.0f, 500.0f), random->next_f32(-20.0f, 20.0f), random->next_f32(-500.0f, 500.0f));
+    }
+
+    bool raycast_scene_brute_force(const SceneBvh& scene, const Ray& ray, RayHit* in_out_hit)
+    {
+        bool has_hit = false;
+        for (u32 instance = 0; instance < scene.m_instances.size(); instance++)
+        {
+            const Matrix& inverse = scene.m_instances[instance].m_inverse_world_transform;
+            Ray mesh_ray = ray;
+            mesh_ray.m_origin = Vector3::Transform(ray.m_origin, inverse);
+            mesh_ray.m_direction = Vector3::TransformNormal(ray.m_direction, inverse);
+            if (raycast_brute_force(*scene.m_instances[instance].m_geometry, mesh_ray, in_out_hit))
+            {
+                in_out_hit->m_instance = instance;
+                has_hit = true;
+            }
+        }
+        return has_hit;
+    }
+}
+
+zv_test(mesh_bvh_is_complete_and_deterministic)
+{
+    TestRandom random{};
+    const MeshGeometryData geometry = make_bvh_test_mesh(100, &random);
+    const DynamicArray<AABB> triangle_bounds = get_triangle_bounds(geometry);
+
+    Bvh bvh{};
+    build_mesh_bvh(geometry, &bvh);
+    check_bvh(context, bvh, triangle_bounds.data(), static_cast<u32>(triangle_bounds.size()));
+
+    Bvh rebuilt{};
+    build_mesh_bvh(geometry, &rebuilt);
+    zv_check(rebuilt.m_nodes.size() == bvh.m_nodes.size());
+    zv_check(memcmp(rebuilt.m_nodes.data(), bvh.m_nodes.data(), bvh.m_nodes.size() * sizeof(BvhNode)) == 0);
+    zv_check(rebuilt.m_primitives == bvh.m_primitives);
+
+    const BvhStats stats = analyze_bvh(bvh);
+    zv_check(stats.m_num_primitives == triangle_bounds.size());
+    zv_check(stats.m_max_depth <= k_bvh_max_depth);
+    zv_check(stats.get_average_leaf_size() <= static_cast<f32>(k_bvh_max_leaf_size));
+
+    Bvh empty{};
+    build_bvh(nullptr, 0, &empty);
+    zv_check(empty.is_empty());
+}
+
+zv_test(mesh_bvh_of_an_imported_mesh_matches_brute_force)
+{
+    TestRandom random{};
+    const MeshGeometryData& geometry = get_damaged_helmet_mesh();
+    zv_check(!geometry.m_indices.empty());
+    const DynamicArray<AABB> triangle_bounds = get_triangle_bounds(geometry);
+
+    Bvh bvh{};
+    build_mesh_bvh(geometry, &bvh);
+    check_bvh(context, bvh, triangle_bounds.data(), static_cast<u32>(triangle_bounds.size()));
+
+    u32 num_hits = 0;
+    u32 num_ray_mismatches = 0;
+    for (u32 i = 0; i < 500; i++)
+    {
+        const Ray ray = make_random_ray_into_bounds(&random, geometry.m_bounds);
+        RayHit expected{};
+        RayHit hit{};
+        const bool has_expected_hit = raycast_brute_force(geometry, ray, &expected);
+        const bool has_hit = raycast_mesh_bvh(bvh, geometry, ray, &hit);
+        num_hits += has_hit ? 1 : 0;
+        num_ray_mismatches += has_hit != has_expected_hit || hit.m_distance != expected.m_distance ? 1 : 0;
+    }
+    zv_check(num_ray_mismatches == 0);
+    zv_check(num_hits > 250);
+}
+
+zv_test(mesh_bvh_queries_match_brute_force)
+{
+    TestRandom random{};
+    MeshGeometryData geometry = make_bvh_test_mesh(64, &random);
+    const DynamicArray<AABB> triangle_bounds = get_triangle_bounds(geometry);
+
+    // Both position sources must give the same tree and the same answers
+    for (bool split : { false, true })
+    {
+        if (split)
+        {
+            split_vertex_streams(&geometry);
+        }
+        Bvh bvh{};
+        build_mesh_bvh(geometry, &bvh);
+
+        u32 num_hits = 0;
+        u32 num_ray_mismatches = 0;
+        for (u32 i = 0; i < 2000; i++)
+        {
+            const Ray ray = make_random_ray(&random, 64.0f);
+            RayHit hit{};
+            RayHit expected{};
+            const bool has_hit = raycast_mesh_bvh(bvh, geometry, ray, &hit);
+            const bool has_expected_hit = raycast_brute_force(geometry, ray, &expected);
+            num_hits += has_hit ? 1 : 0;
+            num_ray_mismatches += has_hit != has_expected_hit || hit.m_distance != expected.m_distance ? 1 : 0;
+        }
+        zv_check(num_ray_mismatches == 0);
+        zv_check(num_hits > 200);
+
+        u32 num_box_mismatches = 0;
+        for (u32 i = 0; i < 100; i++)
+        {
+            AABB box{};
+            box.add(Vector3(random.next_f32(0.0f, 64.0f), random.next_f32(0.0f, 64.0f), random.next_f32(-3.0f, 3.0f)));
+            box.add(Vector3(random.next_f32(0.0f, 64.0f), random.next_f32(0.0f, 64.0f), random.next_f32(-3.0f, 3.0f)));
+
+            DynamicArray<u32> triangles{};
+            query_mesh_bvh(bvh, geometry, box, &triangles);
+            std::sort(triangles.begin(), triangles.end());
+
+            DynamicArray<u32> expected{};
+            for (u32 triangle = 0; triangle < triangle_bounds.size(); triangle++)
+            {
+                if (triangle_bounds[triangle].intersects(box))
+                {
+                    expected.push_back(triangle);
+                }
+            }
+            num_box_mismatches += triangles != expected ? 1 : 0;
+        }
+        zv_check(num_box_mismatches == 0);
+
+        u32 num_frustum_mismatches = 0;
+        for (u32 i = 0; i < 50; i++)
+        {
+            const Vector3 eye(random.next_f32(0.0f, 64.0f), random.next_f32(-40.0f, 0.0f), random.next_f32(5.0f, 30.0f));
+            const Vector3 target(random.next_f32(0.0f, 64.0f), random.next_f32(0.0f, 64.0f), 0.0f);
+            const Matrix view = Matrix::CreateLookAt(eye, target, Vector3(0.0f, 0.0f, 1.0f));
+            const Matrix projection = Matrix::CreatePerspectiveFieldOfView(random.next_f32(0.3f, 1.5f), 1.5f, 0.5f, random.next_f32(20.0f, 200.0f));
+            const Frustum frustum = extract_frustum(view * projection);
+
+            DynamicArray<u32> triangles{};
+            query_mesh_bvh(bvh, geometry, frustum, &triangles);
+            std::sort(triangles.begin(), triangles.end());
+
+            DynamicArray<u32> expected{};
+            for (u32 triangle = 0; triangle < triangle_bounds.size(); triangle++)
+            {
+                if (test_frustum_aabb(frustum, triangle_bounds[triangle]) != Containment::Outside)
+                {
+                    expected.push_back(triangle);
+                }
+            }
+            num_frustum_mismatches += triangles != expected ? 1 : 0;
+        }
+        zv_check(num_frustum_mismatches == 0);
+    }
+}
+
+zv_test(scene_bvh_matches_brute_force_after_refit)
+{
+    TestRandom random{};
+    const MeshGeometryData geometry = make_bvh_test_mesh(20, &random);
+    Bvh mesh_bvh{};
+    build_mesh_bvh(geometry, &mesh_bvh);
+
+    SceneBvh scene{};
+    const u32 num_instances = 300;
+    for (u32 i = 0; i < num_instances; i++)
+    {
+        zv_check(add_scene_bvh_instance(&scene, &mesh_bvh, &geometry, make_random_instance_transform(&random)) == i);
+    }
+    build_scene_bvh(&scene);
+    check_bvh(context, scene.m_bvh, scene.m_world_bounds.data(), num_instances);
+
+    for (u32 pass = 0; pass < 2; pass++)
+    {
+        if (pass == 1)
+        {
+            for (u32 i = 0; i < num_instances; i += 3)
+            {
+                set_scene_bvh_instance_transform(&scene, i, make_random_instance_transform(&random));
+            }
+            refit_scene_bvh(&scene);
+            check_bvh(context, scene.m_bvh, scene.m_world_bounds.data(), num_instances);
+        }
+
+        u32 num_hits = 0;
+        u32 num_mismatches = 0;
+        for (u32 i = 0; i < 300; i++)
+        {
+            Ray ray{};
+            ray.m_origin = Vector3(random.next_f32(-500.0f, 500.0f), 50.0f, random.next_f32(-500.0f, 500.0f));
+            ray.m_direction = Vector3(random.next_f32(-0.3f, 0.3f), -1.0f, random.next_f32(-0.3f, 0.3f));
+
+            RayHit hit{};
+            RayHit expected{};
+            const bool has_hit = raycast_scene_bvh(scene, ray, &hit);
+            const bool has_expected_hit = raycast_scene_brute_force(scene, ray, &expected);
+            num_hits += has_hit ? 1 : 0;
+            // Distances come back through the instance transforms, allow for their rounding
+            num_mismatches += has_hit != has_expected_hit ||
+                (has_hit && (hit.m_instance != expected.m_instance || std::abs(hit.m_distance - expected.m_distance) > 1e-4f * expected.m_distance)) ? 1 : 0;
+        }
+        zv_check(num_mismatches == 0);
+        zv_check(num_hits > 0);
+
+        AABB box{};
+        box.add(Vector3(-100.0f, -50.0f, -100.0f));
+        box.add(Vector3(100.0f, 50.0f, 100.0f));
+        DynamicArray<u32> instances{};
+        query_scene_bvh(scene, box, &instances);
+        const std::ptrdiff_t num_expected = std::count_if(scene.m_world_bounds.begin(), scene.m_world_bounds.end(), [&](const AABB& bounds) { return bounds.intersects(box); });
+        zv_check(static_cast<std::ptrdiff_t>(instances.size()) == num_expected);
+    }
+
+    SceneBvh empty{};
+    RayHit hit{};
+    zv_check(!raycast_scene_bvh(empty, Ray{}, &hit));
+}
+
+zv_benchmark(mesh_bvh_damaged_helmet)
+{
+    TestRandom random{};
+    const MeshGeometryData& geometry = get_damaged_helmet_mesh();
+
+    Bvh bvh{};
+    const f64 build_milliseconds = measure_best_ms(5, [&]() { build_mesh_bvh(geometry, &bvh); });
+    report_timing("build_mesh_bvh, 15452 triangles", build_milliseconds);
+
+    DynamicArray<Ray> rays(100000);
+    for (Ray& ray : rays)
+    {
+        ray = make_random_ray_into_bounds(&random, geometry.m_bounds);
+    }
+    u32 num_hits = 0;
+    const f64 raycast_milliseconds = measure_best_ms(3, [&]()
+    {
+        for (const Ray& ray : rays)
+        {
+            RayHit hit{};
+            num_hits += raycast_mesh_bvh(bvh, geometry, ray, &hit) ? 1 : 0;
+        }
+    });
+    report_timing("raycast_mesh_bvh, 100000 rays", raycast_milliseconds);
+    report_count("hits over all runs", num_hits);
+}
+
+zv_benchmark(scene_bvh_10k_instances)
+{
+    TestRandom random{};
+    const MeshGeometryData& geometry = get_damaged_helmet_mesh();
+    Bvh mesh_bvh{};
+    build_mesh_bvh(geometry, &mesh_bvh);
+
+    SceneBvh scene{};
+    for (u32 i = 0; i < 10000; i++)
+    {
+        add_scene_bvh_instance(&scene, &mesh_bvh, &geometry, make_random_instance_transform(&random));
+    }
+    report_timing("build_scene_bvh, 10000 instances", measure_best_ms(5, [&]() { build_scene_bvh(&scene); }));
+
+    for (u32 i = 0; i < 10000; i += 3)
+    {
+        set_scene_bvh_instance_transform(&scene, i, make_random_instance_transform(&random));
+    }
+    report_timing("refit_scene_bvh, 10000 instances", measure_best_ms(5, [&]() { refit_scene_bvh(&scene); }));
+}
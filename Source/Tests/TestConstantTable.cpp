@@ -0,0 +1,88 @@
+#include <Tests/Test.h>
+
+#include <ConstantTable.h>
+
+namespace
+{
+    constexpr u32 k_test_frames_in_flight = 3;
+    constexpr u8 k_test_all_frames_dirty = (1 << k_test_frames_in_flight) - 1;
+}
+
+zv_test(constant_table_uploads_a_dirty_entry_once_per_frame_in_flight)
+{
+    ConstantTableEntries entries(96, 4);
+    const u32 entry = entries.acquire_entry();
+    u8 dirty_frames = k_test_all_frames_dirty;
+
+    // Dirtied in frame 4, every frame's copy is written the next time that frame comes around, then never again
+    u32 num_uploads = 0;
+    for (u32 frame = 0; frame < 12; frame++)
+    {
+        const u32 frame_index = frame % k_test_frames_in_flight;
+        if (frame == 4)
+        {
+            dirty_frames = k_test_all_frames_dirty;
+        }
+
+        entries.begin_frame();
+        const bool is_uploaded = entries.update(entry, frame_index, &dirty_frames);
+        zv_check(is_uploaded == (frame < k_test_frames_in_flight || (frame >= 4 && frame < 4 + k_test_frames_in_flight)));
+        num_uploads += is_uploaded ? 1 : 0;
+    }
+    zv_check(num_uploads == 2 * k_test_frames_in_flight);
+    zv_check(dirty_frames == 0);
+}
+
+zv_test(constant_table_counts_stats_once_per_entry_per_frame)
+{
+    ConstantTableEntries entries(96, 4);
+    const u32 material = entries.acquire_entry();
+    const u32 object = entries.acquire_entry();
+    u8 material_dirty_frames = k_test_all_frames_dirty;
+    u8 object_dirty_frames = 0;
+
+    // The material is updated by each of the five objects drawing it, the first update uploads and the rest don't count
+    ConstantUploadStats stats{};
+    entries.begin_frame();
+    for (u32 i = 0; i < 5; i++)
+    {
+        zv_check(entries.update(material, 0, &material_dirty_frames, &stats) == (i == 0));
+    }
+    entries.update(object, 0, &object_dirty_frames, &stats);
+    zv_check(stats.m_num_uploaded == 1 && stats.m_uploaded_bytes == 96);
+    zv_check(stats.m_num_skipped == 1 && stats.m_skipped_bytes == 96);
+
+    // Counted again in the next frame
+    stats = {};
+    entries.begin_frame();
+    for (u32 i = 0; i < 5; i++)
+    {
+        entries.update(material, 1, &material_dirty_frames, &stats);
+    }
+    zv_check(stats.m_num_uploaded == 1 && stats.m_num_skipped == 0);
+
+    // A released entry handed out again is counted in the frame it was acquired in
+    stats = {};
+    entries.begin_frame();
+    entries.update(object, 1, &object_dirty_frames, &stats);
+    entries.release_entry(object);
+    zv_check(entries.acquire_entry() == object);
+    object_dirty_frames = k_test_all_frames_dirty;
+    entries.update(object, 1, &object_dirty_frames, &stats);
+    zv_check(stats.m_num_skipped == 1 && stats.m_num_uploaded == 1);
+}
+
+zv_test(constant_table_doubles_when_full_and_reuses_released_entries)
+{
+    ConstantTableEntries entries(16, 2);
+    zv_check(entries.acquire_entry() == 0);
+    zv_check(entries.acquire_entry() == 1);
+    zv_check(entries.get_capacity() == 2);
+
+    zv_check(entries.acquire_entry() == 2);
+    zv_check(entries.get_capacity() == 4);
+
+    entries.release_entry(0);
+    zv_check(entries.acquire_entry() == 0);
+    zv_check(entries.get_num_entries() == 3);
+}
@@ -0,0 +1,129 @@
+#include <Tests/Test.h>
+
+#include <Culling.h>
+
+namespace
+{
+    // Boxes scattered around the origin, every 97th one left invalid
+    DynamicArray<AABB> make_random_boxes(u32 count, TestRandom* random)
+    {
+        DynamicArray<AABB> boxes(count);
+        for (u32 i = 0; i < count; i++)
+        {
+            if (i % 97 == 0)
+            {
+                continue;
+            }
+            const Vector3 center(random->next_f32(-500.0f, 500.0f), random->next_f32(-500.0f, 500.0f), random->next_f32(-500.0f, 500.0f));
+            const Vector3 extent(random->next_f32(0.1f, 10.0f), random->next_f32(0.1f, 10.0f), random->next_f32(0.1f, 20.0f));
+            boxes[i].add(center - extent);
+            boxes[i].add(center + extent);
+        }
+        return boxes;
+    }
+
+    Frustum make_random_frustum(TestRandom* random)
+    {
+        const Vector3 eye(random->next_f32(-100.0f, 100.0f), random->next_f32(-100.0f, 100.0f), random->next_f32(-100.0f, 100.0f));
+        const Vector3 target(random->next_f32(-300.0f, 300.0f), random->next_f32(-300.0f, 300.0f), random->next_f32(-300.0f, 300.0f));
+        const Matrix view = Matrix::CreateLookAt(eye, target, Vector3(0.0f, 1.0f, 0.0f));
+        const Matrix projection = Matrix::CreatePerspectiveFieldOfView(random->next_f32(0.3f, 1.8f), 16.0f / 9.0f, 0.1f, random->next_f32(50.0f, 800.0f));
+        return extract_frustum(view * projection);
+    }
+
+    DynamicArray<u32> cull_reference(const Frustum& frustum, const DynamicArray<AABB>& boxes, u32 count)
+    {
+        DynamicArray<u32> visible{};
+        for (u32 i = 0; i < count; i++)
+        {
+            // test_frustum_aabb leaves invalid boxes to the caller, the culling bounds never show them
+            if (boxes[i].is_valid() && test_frustum_aabb(frustum, boxes[i]) != Containment::Outside)
+            {
+                visible.push_back(i);
+            }
+        }
+        return visible;
+    }
+}
+
+zv_test(cull_frustum_matches_test_frustum_aabb)
+{
+    TestRandom random{};
+    const DynamicArray<AABB> boxes = make_random_boxes(20000, &random);
+
+    CullingBounds bounds{};
+    bounds.resize(static_cast<u32>(boxes.size()));
+    for (u32 i = 0; i < boxes.size(); i++)
+    {
+        bounds.set(i, boxes[i]);
+    }
+
+    u32 num_mismatches = 0;
+    u32 num_visible = 0;
+    for (u32 i = 0; i < 20; i++)
+    {
+        const Frustum frustum = make_random_frustum(&random);
+        DynamicArray<u32> visible{};
+        CullingStats stats{};
+        cull_frustum(frustum, bounds, &visible, &stats);
+
+        const DynamicArray<u32> expected = cull_reference(frustum, boxes, static_cast<u32>(boxes.size()));
+        num_mismatches += visible != expected ? 1 : 0;
+        num_mismatches += stats.m_num_tested != boxes.size() || stats.m_num_visible != visible.size() ? 1 : 0;
+        num_visible += static_cast<u32>(visible.size());
+    }
+    zv_check(num_mismatches == 0);
+    zv_check(num_visible > 0);
+}
+
+zv_test(cull_frustum_handles_partial_groups_and_resizes)
+{
+    TestRandom random{};
+    const DynamicArray<AABB> boxes = make_random_boxes(9000, &random);
+    const Frustum frustum = make_random_frustum(&random);
+
+    // Counts off the kernel width and the batch size, shrinking and growing the same bounds
+    CullingBounds bounds{};
+    u32 num_mismatches = 0;
+    for (u32 count : { 0u, 1u, 3u, 5u, 4097u, 8193u, 2u, 9000u })
+    {
+        bounds.resize(count);
+        for (u32 i = 0; i < count; i++)
+        {
+            bounds.set(i, boxes[i]);
+        }
+        zv_check(bounds.m_center_x.size() % k_culling_simd_width == 0);
+
+        DynamicArray<u32> visible{ 1, 2, 3 };  // Replaced, not appended to
+        cull_frustum(frustum, bounds, &visible);
+        num_mismatches += visible != cull_reference(frustum, boxes, count) ? 1 : 0;
+    }
+    zv_check(num_mismatches == 0);
+
+    // Grown boxes stay invisible until they are set
+    bounds.resize(4);
+    bounds.set(0, boxes[1]);
+    bounds.resize(8);
+    DynamicArray<u32> visible{};
+    cull_frustum(frustum, bounds, &visible);
+    zv_check(visible.size() <= 1);
+}
+
+zv_benchmark(cull_frustum_100k)
+{
+    TestRandom random{};
+    const DynamicArray<AABB> boxes = make_random_boxes(100000, &random);
+    CullingBounds bounds{};
+    bounds.resize(static_cast<u32>(boxes.size()));
+    for (u32 i = 0; i < boxes.size(); i++)
+    {
+        bounds.set(i, boxes[i]);
+    }
+    const Frustum frustum = make_random_frustum(&random);
+
+    DynamicArray<u32> visible{};
+    CullingStats stats{};
+    report_timing("cull_frustum, 100000 boxes", measure_best_ms(20, [&]() { cull_frustum(frustum, bounds, &visible, &stats); }));
+    report_timing("test_frustum_aabb loop, 100000 boxes", measure_best_ms(20, [&]() { visible = cull_reference(frustum, boxes, static_cast<u32>(boxes.size())); }));
+    report_count("visible boxes", stats.m_num_visible);
+}
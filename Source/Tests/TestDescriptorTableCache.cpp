@@ -0,0 +1,175 @@
+#include <Tests/Test.h>
+
+#include <DescriptorTableCache.h>
+
+namespace
+{
+    // Copies into one growing array, a table's handle is the index of its first descriptor
+    class FakeDescriptorTableHeap final : public DescriptorTableHeap
+    {
+    public:
+        u64 copy_descriptor_table(const u64* source_descriptors, u32 num_descriptors) override
+        {
+            const u64 handle = m_descriptors.size();
+            m_descriptors.insert(m_descriptors.end(), source_descriptors, source_descriptors + num_descriptors);
+            m_num_copies++;
+            return handle;
+        }
+
+        DynamicArray<u64> m_descriptors{};
+        u32 m_num_copies = 0;
+    };
+
+    // The hash DescriptorTableCache.cpp keys tables by
+    u64 hash_descriptors(const u64* descriptors, u32 num_descriptors)
+    {
+        u64 hash = (0xcbf29ce484222325 ^ num_descriptors) * 0x100000001b3;
+        for (u32 i = 0; i < num_descriptors; i++)
+        {
+            hash = (hash ^ descriptors[i]) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    bool is_copy_of(const FakeDescriptorTableHeap& heap, u64 handle, const u64* source_descriptors, u32 num_descriptors)
+    {
+        for (u32 i = 0; i < num_descriptors; i++)
+        {
+            if (handle + i >= heap.m_descriptors.size() || heap.m_descriptors[handle + i] != source_descriptors[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+zv_test(descriptor_table_cache_reuses_equal_tables)
+{
+    FakeDescriptorTableHeap heap{};
+    DescriptorTableCache cache(&heap);
+    const u64 table[3] = { 10, 20, 30 };
+
+    const u64 handle = cache.get_descriptor_table(table, 3);
+    zv_check(is_copy_of(heap, handle, table, 3));
+
+    u32 num_wrong_handles = 0;
+    for (u32 i = 0; i < 10; i++)
+    {
+        num_wrong_handles += cache.get_descriptor_table(table, 3) != handle ? 1 : 0;
+    }
+    zv_check(num_wrong_handles == 0);
+    zv_check(heap.m_num_copies == 1);
+
+    const DescriptorTableCacheStats& stats = cache.get_stats();
+    zv_check(stats.m_num_hits == 10 && stats.m_num_misses == 1);
+    zv_check(stats.m_num_copied_descriptors == 3);
+    zv_check(stats.m_num_reused_descriptors == 30);
+    zv_check_near(stats.get_hit_rate(), 10.0f / 11.0f, 1e-6f);
+}
+
+zv_test(descriptor_table_cache_misses_on_different_tables)
+{
+    FakeDescriptorTableHeap heap{};
+    DescriptorTableCache cache(&heap);
+    const u64 table[3] = { 10, 20, 30 };
+    const u64 reordered[3] = { 30, 20, 10 };
+    const u64 changed[3] = { 10, 20, 31 };
+    const u64 prefix[2] = { 10, 20 };
+
+    const u64 handle = cache.get_descriptor_table(table, 3);
+    const u64 reordered_handle = cache.get_descriptor_table(reordered, 3);
+    const u64 changed_handle = cache.get_descriptor_table(changed, 3);
+    const u64 prefix_handle = cache.get_descriptor_table(prefix, 2);
+
+    zv_check(cache.get_stats().m_num_misses == 4 && cache.get_stats().m_num_hits == 0);
+    zv_check(is_copy_of(heap, handle, table, 3));
+    zv_check(is_copy_of(heap, reordered_handle, reordered, 3));
+    zv_check(is_copy_of(heap, changed_handle, changed, 3));
+    zv_check(is_copy_of(heap, prefix_handle, prefix, 2));
+    zv_check(cache.get_stats().m_num_copied_descriptors == 11);
+
+    // Every one of them is remembered
+    zv_check(cache.get_descriptor_table(reordered, 3) == reordered_handle);
+    zv_check(cache.get_descriptor_table(prefix, 2) == prefix_handle);
+    zv_check(cache.get_stats().m_num_hits == 2);
+}
+
+zv_test(descriptor_table_cache_checks_hash_hits_against_the_sources)
+{
+    // The second descriptor of the colliding table cancels the difference in the first
+    const u64 table[2] = { 10, 20 };
+    u64 colliding[2] = { 11, 0 };
+    const u64 first_hash = (0xcbf29ce484222325 ^ 2) * 0x100000001b3;
+    colliding[1] = ((first_hash ^ table[0]) * 0x100000001b3) ^ table[1] ^ ((first_hash ^ colliding[0]) * 0x100000001b3);
+    zv_check(hash_descriptors(table, 2) == hash_descriptors(colliding, 2));
+
+    FakeDescriptorTableHeap heap{};
+    DescriptorTableCache cache(&heap);
+    const u64 handle = cache.get_descriptor_table(table, 2);
+    const u64 colliding_handle = cache.get_descriptor_table(colliding, 2);
+    zv_check(colliding_handle != handle);
+    zv_check(is_copy_of(heap, colliding_handle, colliding, 2));
+    zv_check(cache.get_stats().m_num_misses == 2 && cache.get_stats().m_num_hits == 0);
+
+    // The colliding table took the slot, the first one is copied again instead of handing out the wrong table
+    zv_check(cache.get_descriptor_table(colliding, 2) == colliding_handle);
+    const u64 second_handle = cache.get_descriptor_table(table, 2);
+    zv_check(is_copy_of(heap, second_handle, table, 2));
+    zv_check(cache.get_stats().m_num_misses == 3 && cache.get_stats().m_num_hits == 1);
+}
+
+zv_test(descriptor_table_cache_reset_forgets_everything)
+{
+    FakeDescriptorTableHeap heap{};
+    DescriptorTableCache cache(&heap);
+    const u64 table[3] = { 10, 20, 30 };
+    cache.get_descriptor_table(table, 3);
+    cache.get_descriptor_table(table, 3);
+
+    // The heap starts over with the cache, so stale handles would point at other tables' descriptors
+    cache.reset();
+    heap.m_descriptors.clear();
+    zv_check(cache.get_stats().m_num_hits == 0 && cache.get_stats().m_num_misses == 0);
+    zv_check(cache.get_stats().m_num_copied_descriptors == 0 && cache.get_stats().m_num_reused_descriptors == 0);
+
+    const u64 handle = cache.get_descriptor_table(table, 3);
+    zv_check(is_copy_of(heap, handle, table, 3));
+    zv_check(heap.m_num_copies == 2);
+    zv_check(cache.get_stats().m_num_misses == 1 && cache.get_stats().m_num_hits == 0);
+}
+
+zv_benchmark(descriptor_table_cache_100k_tables)
+{
+    // 100000 material tables of 5 textures from 500 materials, as a frame of many objects binds them
+    TestRandom random{};
+    DynamicArray<StaticArray<u64, 5>> materials(500);
+    for (StaticArray<u64, 5>& material : materials)
+    {
+        for (u64& descriptor : material)
+        {
+            descriptor = 0x10000 + (random.next_u32() % 4096) * 32;
+        }
+    }
+    DynamicArray<u32> draws(100000);
+    for (u32& draw : draws)
+    {
+        draw = random.next_u32() % 500;
+    }
+
+    FakeDescriptorTableHeap heap{};
+    DescriptorTableCache cache(&heap);
+    u64 checksum = 0;
+    const f64 milliseconds = measure_best_ms(10, [&]()
+    {
+        cache.reset();
+        heap.m_descriptors.clear();
+        for (u32 draw : draws)
+        {
+            checksum += cache.get_descriptor_table(materials[draw].data(), 5);
+        }
+    });
+    report_timing("100000 tables, 500 distinct", milliseconds);
+    report_count("descriptors copied", cache.get_stats().m_num_copied_descriptors);
+    report_count("descriptors reused", cache.get_stats().m_num_reused_descriptors);
+}
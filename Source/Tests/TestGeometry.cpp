@@ -0,0 +1,762 @@
+#include <Tests/TestMeshes.h>
+
+#include <Geometry.h>
+
+#include <cstring>
+
+namespace
+{
+    Vector3 random_unit_vector(TestRandom* random)
+    {
+        for (;;)
+        {
+            Vector3 v(random->next_f32(-1.0f, 1.0f), random->next_f32(-1.0f, 1.0f), random->next_f32(-1.0f, 1.0f));
+            const f32 length_squared = v.LengthSquared();
+            if (length_squared > 0.01f && length_squared <= 1.0f)
+            {
+                return v / std::sqrt(length_squared);
+            }
+        }
+    }
+
+    f32 get_angle_degrees(const Vector3& a, const Vector3& b)
+    {
+        // acos loses too much precision for the small angles measured here
+        return std::atan2(a.Cross(b).Length(), a.Dot(b)) * ZV_RAD_TO_DEG;
+    }
+
+    AABB make_aabb(const Vector3& min, const Vector3& max)
+    {
+        AABB aabb{};
+        aabb.add(min);
+        aabb.add(max);
+        return aabb;
+    }
+
+    f32 get_max_aabb_difference(const AABB& a, const AABB& b)
+    {
+        const Vector3 min_difference = a.m_min - b.m_min;
+        const Vector3 max_difference = a.m_max - b.m_max;
+        return ZV::max(ZV::max(ZV::max(ZV::abs(min_difference.x), ZV::abs(min_difference.y)), ZV::max(ZV::abs(min_difference.z), ZV::abs(max_difference.x))),
+                       ZV::max(ZV::abs(max_difference.y), ZV::abs(max_difference.z)));
+    }
+}
+
+zv_test(half_float_round_trip)
+{
+    // Every finite half converts to a float and back to the same bits
+    u32 num_mismatches = 0;
+    for (u32 bits = 0; bits < 0x10000; bits++)
+    {
+        if ((bits & 0x7C00) == 0x7C00)
+        {
+            continue;
+        }
+        num_mismatches += float_to_half(half_to_float(static_cast<u16>(bits))) != bits ? 1 : 0;
+    }
+    zv_check(num_mismatches == 0);
+
+    zv_check(float_to_half(1.0f) == 0x3C00);
+    zv_check(float_to_half(-2.0f) == 0xC000);
+    zv_check(float_to_half(65504.0f) == 0x7BFF);
+    zv_check(float_to_half(1e6f) == 0x7C00);
+    zv_check(float_to_half(1e-9f) == 0);
+    // Ties round to even
+    zv_check(float_to_half(1.0f + 1.0f / 2048.0f) == 0x3C00);
+    zv_check(float_to_half(1.0f + 3.0f / 2048.0f) == 0x3C02);
+}
+
+zv_test(octahedral_round_trip)
+{
+    TestRandom random{};
+    f32 max_angle = 0.0f;
+    for (u32 i = 0; i < 10000; i++)
+    {
+        const Vector3 n = random_unit_vector(&random);
+        max_angle = ZV::max(max_angle, get_angle_degrees(n, decode_octahedral(encode_octahedral(n))));
+    }
+    zv_check(max_angle < 0.001f);
+
+    const Vector3 axes[] = { Vector3(0, 0, 1), Vector3(0, 0, -1), Vector3(1, 0, 0), Vector3(0, -1, 0) };
+    for (const Vector3& axis : axes)
+    {
+        zv_check(get_angle_degrees(axis, decode_octahedral(encode_octahedral(axis))) < 0.001f);
+    }
+}
+
+zv_test(packed_vertices_stay_within_documented_errors)
+{
+    TestRandom random{};
+    DynamicArray<MeshVertex> vertices(4096);
+    for (MeshVertex& vertex : vertices)
+    {
+        vertex.position = Vector3(random.next_f32(-3.0f, 5.0f), random.next_f32(0.0f, 0.5f), random.next_f32(-100.0f, 100.0f));
+        vertex.uv = Vector2(random.next_f32(-2.0f, 2.0f), random.next_f32(0.0f, 1.0f));
+        vertex.normal = random_unit_vector(&random);
+        const Vector3 tangent = random_unit_vector(&random);
+        vertex.tangent = Vector4(tangent.x, tangent.y, tangent.z, random.next_u32() & 1 ? 1.0f : -1.0f);
+    }
+
+    const VertexQuantization quantization = compute_vertex_quantization(vertices.data(), vertices.size());
+    const Vector3 step = quantization.m_position_scale * (0.5f / 65535.0f);
+
+    bool positions_ok = true;
+    bool uvs_ok = true;
+    bool signs_ok = true;
+    f32 max_normal_angle = 0.0f;
+    f32 max_tangent_angle = 0.0f;
+    for (const MeshVertex& vertex : vertices)
+    {
+        const MeshVertex unpacked = unpack_mesh_vertex(pack_mesh_vertex(vertex, quantization), quantization);
+        const Vector3 error = unpacked.position - vertex.position;
+        positions_ok = positions_ok && std::abs(error.x) <= step.x * 1.01f && std::abs(error.y) <= step.y * 1.01f && std::abs(error.z) <= step.z * 1.01f;
+        uvs_ok = uvs_ok && std::abs(unpacked.uv.x - vertex.uv.x) <= std::abs(vertex.uv.x) / 2048.0f + 1e-7f;
+        uvs_ok = uvs_ok && std::abs(unpacked.uv.y - vertex.uv.y) <= std::abs(vertex.uv.y) / 2048.0f + 1e-7f;
+        signs_ok = signs_ok && unpacked.tangent.w == vertex.tangent.w;
+        max_normal_angle = ZV::max(max_normal_angle, get_angle_degrees(vertex.normal, unpacked.normal));
+        max_tangent_angle = ZV::max(max_tangent_angle, get_angle_degrees(Vector3(vertex.tangent), Vector3(unpacked.tangent)));
+    }
+    zv_check(positions_ok);
+    zv_check(uvs_ok);
+    zv_check(signs_ok);
+    zv_check(max_normal_angle < 0.04f);
+    zv_check(max_tangent_angle < 0.04f);
+}
+
+zv_test(pack_mesh_geometry_fills_packed_vertices)
+{
+    MeshGeometryData geometry = make_sphere_mesh(16, 8);
+    zv_check(!geometry.is_packed());
+    pack_mesh_geometry(&geometry);
+    zv_check(geometry.is_packed());
+    zv_check(geometry.packed_vertices_size() == geometry.m_vertices.size() * 20);
+}
+
+zv_benchmark(pack_mesh_geometry_65k)
+{
+    MeshGeometryData source = make_grid_mesh(255);
+    const f64 milliseconds = measure_best_ms(10, [&]()
+    {
+        pack_mesh_geometry(&source);
+    });
+    report_timing("pack_mesh_geometry, 65536 vertices", milliseconds);
+}
+
+zv_test(tangents_follow_the_uv_directions)
+{
+    // Flat grid in the xy plane, u runs along +x and v along +y
+    MeshGeometryData grid = make_grid_mesh(16);
+    for (MeshVertex& vertex : grid.m_vertices)
+    {
+        vertex.position.z = 0.0f;
+        vertex.tangent = Vector4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    generate_tangents(grid.m_vertices.data(), grid.m_vertices.size(), grid.m_indices.data(), grid.m_indices.size());
+
+    f32 max_angle = 0.0f;
+    bool signs_ok = true;
+    for (const MeshVertex& vertex : grid.m_vertices)
+    {
+        max_angle = ZV::max(max_angle, get_angle_degrees(Vector3(vertex.tangent), Vector3(1.0f, 0.0f, 0.0f)));
+        // The bitangent cross(normal, tangent) * w points along +v
+        signs_ok = signs_ok && vertex.tangent.w == 1.0f;
+    }
+    zv_check(max_angle < 0.01f);
+    zv_check(signs_ok);
+
+    // Mirroring u flips the tangent and its sign
+    for (MeshVertex& vertex : grid.m_vertices)
+    {
+        vertex.uv.x = 1.0f - vertex.uv.x;
+    }
+    generate_tangents(grid.m_vertices.data(), grid.m_vertices.size(), grid.m_indices.data(), grid.m_indices.size());
+
+    max_angle = 0.0f;
+    signs_ok = true;
+    for (const MeshVertex& vertex : grid.m_vertices)
+    {
+        max_angle = ZV::max(max_angle, get_angle_degrees(Vector3(vertex.tangent), Vector3(-1.0f, 0.0f, 0.0f)));
+        signs_ok = signs_ok && vertex.tangent.w == -1.0f;
+    }
+    zv_check(max_angle < 0.01f);
+    zv_check(signs_ok);
+}
+
+zv_test(tangents_are_unit_and_orthogonal_to_normals)
+{
+    MeshGeometryData sphere = make_sphere_mesh(32, 16);
+    generate_tangents(sphere.m_vertices.data(), sphere.m_vertices.size(), sphere.m_indices.data(), sphere.m_indices.size());
+
+    f32 max_length_error = 0.0f;
+    f32 max_dot = 0.0f;
+    f32 max_angle = 0.0f;
+    for (const MeshVertex& vertex : sphere.m_vertices)
+    {
+        const Vector3 tangent(vertex.tangent);
+        max_length_error = ZV::max(max_length_error, std::abs(tangent.Length() - 1.0f));
+        max_dot = ZV::max(max_dot, std::abs(tangent.Dot(vertex.normal)));
+        // Away from the poles the tangent follows the rings of the sphere. Vertices on the uv seam only see the triangles on
+        // one side, whose edges are off by at most half a segment.
+        if (std::abs(vertex.position.y) < 0.9f)
+        {
+            const Vector3 ring_direction = Vector3(0.0f, 1.0f, 0.0f).Cross(vertex.position);
+            max_angle = ZV::max(max_angle, get_angle_degrees(tangent, ring_direction));
+        }
+    }
+    zv_check(max_length_error < 1e-4f);
+    zv_check(max_dot < 1e-4f);
+    zv_check(max_angle < 180.0f / 32.0f);
+}
+
+zv_benchmark(generate_tangents_65k)
+{
+    MeshGeometryData geometry = make_grid_mesh(255);
+    const f64 milliseconds = measure_best_ms(10, [&]()
+    {
+        generate_tangents(geometry.m_vertices.data(), geometry.m_vertices.size(), geometry.m_indices.data(), geometry.m_indices.size());
+    });
+    report_timing("generate_tangents, 130050 triangles", milliseconds);
+}
+
+namespace
+{
+    // Welded closed meshes use every edge once in each direction
+    bool is_closed_manifold(const MeshGeometryData& geometry)
+    {
+        HashMap<u32, u32> directed_edges{};
+        const DynamicArray<u16>& indices = geometry.m_indices;
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            const u16 a = indices[i];
+            const u16 b = indices[i - i % 3 + (i % 3 + 1) % 3];
+            directed_edges[(static_cast<u32>(a) << 16) | b]++;
+        }
+
+        for (const auto& [edge, count] : directed_edges)
+        {
+            const u32 reverse = (edge << 16) | (edge >> 16);
+            if (count != 1 || directed_edges.find(reverse) == directed_edges.end())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+zv_test(subdivided_icosphere_is_welded)
+{
+    for (u32 num_subdivisions = 0; num_subdivisions <= 4; num_subdivisions++)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> icosphere = create_icosphere(2.0f, num_subdivisions);
+
+        // Shared midpoints: V + E vertices after every step, 10 * 4^n + 2 in total
+        zv_check(icosphere->m_vertices.size() == 10u * (1u << (2 * num_subdivisions)) + 2u);
+        zv_check(icosphere->m_indices.size() == 60u * (1u << (2 * num_subdivisions)));
+        zv_check(is_closed_manifold(*icosphere));
+
+        f32 max_radius_error = 0.0f;
+        for (const MeshVertex& vertex : icosphere->m_vertices)
+        {
+            max_radius_error = ZV::max(max_radius_error, std::abs(vertex.position.Length() - 2.0f));
+        }
+        zv_check(max_radius_error < 1e-5f);
+    }
+}
+
+zv_test(subdivided_box_faces_are_welded)
+{
+    for (u32 num_subdivisions = 0; num_subdivisions <= 3; num_subdivisions++)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> box = create_box(1.0f, 2.0f, 3.0f, num_subdivisions);
+
+        // Faces keep their own vertices for their normals, within a face every midpoint is shared
+        const u32 face_side = (1u << num_subdivisions) + 1u;
+        zv_check(box->m_vertices.size() == 6u * face_side * face_side);
+        zv_check(box->m_indices.size() == 36u * (1u << (2 * num_subdivisions)));
+
+        // The cache hands out shared geometry, it comes packed so the renderer never writes to it
+        zv_check(box->is_packed());
+    }
+}
+
+zv_benchmark(create_icosphere_5)
+{
+    // Nothing holds on to the result, so the cache generates it again every run
+    const f64 milliseconds = measure_best_ms(10, []()
+    {
+        create_icosphere(1.0f, 5);
+    });
+    report_timing("create_icosphere, 5 subdivisions", milliseconds);
+}
+
+namespace
+{
+    // Every index in range, every normal unit length and every triangle wound the same way relative to its normals
+    void check_primitive_geometry(TestContext* context, const MeshGeometryData& geometry)
+    {
+        bool indices_ok = true;
+        for (u16 index : geometry.m_indices)
+        {
+            indices_ok = indices_ok && index < geometry.m_vertices.size();
+        }
+        zv_check(indices_ok);
+        if (!indices_ok)
+        {
+            return;
+        }
+
+        f32 max_normal_error = 0.0f;
+        for (const MeshVertex& vertex : geometry.m_vertices)
+        {
+            max_normal_error = ZV::max(max_normal_error, std::abs(vertex.normal.Length() - 1.0f));
+        }
+        zv_check(max_normal_error < 1e-5f);
+
+        u32 num_front = 0;
+        u32 num_back = 0;
+        for (size_t i = 0; i < geometry.m_indices.size(); i += 3)
+        {
+            const MeshVertex& a = geometry.m_vertices[geometry.m_indices[i + 0]];
+            const MeshVertex& b = geometry.m_vertices[geometry.m_indices[i + 1]];
+            const MeshVertex& c = geometry.m_vertices[geometry.m_indices[i + 2]];
+            const Vector3 face_normal = (b.position - a.position).Cross(c.position - a.position);
+            // Pole rows of the capsule caps collapse into slivers
+            if (face_normal.LengthSquared() < 1e-12f)
+            {
+                continue;
+            }
+            const f32 facing = face_normal.Dot(a.normal + b.normal + c.normal);
+            num_front += facing > 0.0f ? 1 : 0;
+            num_back += facing < 0.0f ? 1 : 0;
+        }
+        zv_check(num_front == 0 || num_back == 0);
+        zv_check(num_front + num_back > 0);
+    }
+}
+
+zv_test(sphere_has_the_computed_size)
+{
+    const u32 segments[][2] = { { 3, 2 }, { 16, 8 }, { 33, 17 } };
+    for (const auto& [width_segments, height_segments] : segments)
+    {
+        SharedPtr<PrimitiveMeshGeometryData> sphere = create_sphere(2.0f, width_segments, height_segments);
+
+        zv_check(sphere->m_vertices.size() == 2 + (height_segments - 1) * (width_segments + 1));
+        zv_check(sphere->m_indices.size() == 6 * width_segments * (height_segments - 1));
+        check_primitive_geometry(context, *sphere);
+
+        f32 max_radius_error = 0.0f;
+        for (const MeshVertex& vertex : sphere->m_vertices)
+        {
+            max_radius_error = ZV::max(max_radius_error, std::abs(vertex.position.Length() - 2.0f));
+        }
+        zv_check(max_radius_error < 1e-5f);
+    }
+}
+
+zv_test(cylinder_and_capsule_have_the_computed_size)
+{
+    const u32 radial_segments = 12;
+    const u32 height_segments = 3;
+    const u32 cap_segments = 5;
+
+    // Side rings share the seam column, a cap is a fan around its center
+    const size_t side_vertices = (height_segments + 1) * (radial_segments + 1);
+    const size_t side_indices = 6 * height_segments * radial_segments;
+
+    SharedPtr<PrimitiveMeshGeometryData> cylinder = create_cylinder(0.5f, 0.25f, 2.0f, radial_segments, height_segments);
+    zv_check(cylinder->m_vertices.size() == side_vertices + 2 * (radial_segments + 2));
+    zv_check(cylinder->m_indices.size() == side_indices + 2 * 3 * radial_segments);
+    check_primitive_geometry(context, *cylinder);
+
+    SharedPtr<PrimitiveMeshGeometryData> capsule = create_capsule(0.5f, 2.0f, radial_segments, height_segments, cap_segments);
+    zv_check(capsule->m_vertices.size() == side_vertices + 2 * (cap_segments + 1) * (radial_segments + 1));
+    zv_check(capsule->m_indices.size() == side_indices + 2 * 6 * cap_segments * radial_segments);
+    check_primitive_geometry(context, *capsule);
+
+    // Every capsule vertex lies on the radius around the segment between the cap centers
+    f32 max_radius_error = 0.0f;
+    for (const MeshVertex& vertex : capsule->m_vertices)
+    {
+        const Vector3 on_axis(0.0f, ZV::max(ZV::min(vertex.position.y, 1.0f), -1.0f), 0.0f);
+        max_radius_error = ZV::max(max_radius_error, std::abs((vertex.position - on_axis).Length() - 0.5f));
+    }
+    zv_check(max_radius_error < 1e-5f);
+}
+
+zv_test(generators_allocate_independently_of_tessellation)
+{
+    // Each generator sizes its arrays once, so finer tessellation must not add allocations. Nothing holds the results,
+    // so every call generates again.
+    const auto count_allocations = [](auto&& generate)
+    {
+        const u64 start = get_allocation_count();
+        generate();
+        return get_allocation_count() - start;
+    };
+
+    zv_check(count_allocations([]() { create_sphere(1.0f, 8, 4); }) == count_allocations([]() { create_sphere(1.0f, 200, 100); }));
+    zv_check(count_allocations([]() { create_cylinder(0.5f, 0.5f, 1.0f, 8, 1); }) == count_allocations([]() { create_cylinder(0.5f, 0.5f, 1.0f, 200, 50); }));
+    zv_check(count_allocations([]() { create_capsule(0.5f, 1.0f, 8, 1, 4); }) == count_allocations([]() { create_capsule(0.5f, 1.0f, 200, 50, 50); }));
+}
+
+zv_test(primitive_cache_shares_equal_primitives)
+{
+    // The cache is global, other tests leave hits, misses and expired entries behind, so only differences are checked
+    const PrimitiveGeometryCacheStats before = get_primitive_geometry_cache_stats();
+    SharedPtr<PrimitiveMeshGeometryData> first = create_sphere(1.5f, 12, 6);
+    SharedPtr<PrimitiveMeshGeometryData> second = create_sphere(1.5f, 12, 6);
+    const PrimitiveGeometryCacheStats after = get_primitive_geometry_cache_stats();
+
+    zv_check(first && first.get() == second.get());
+    zv_check(after.m_num_misses == before.m_num_misses + 1);
+    zv_check(after.m_num_hits == before.m_num_hits + 1);
+    zv_check(after.m_num_live == before.m_num_live + 1);
+
+    // Shared geometry is packed before it is handed out
+    zv_check(!first->m_packed_vertices.empty());
+}
+
+zv_test(primitive_cache_misses_on_changed_parameters)
+{
+    SharedPtr<PrimitiveMeshGeometryData> sphere = create_sphere(1.5f, 12, 6);
+    const PrimitiveGeometryCacheStats before = get_primitive_geometry_cache_stats();
+
+    // A different segment count or radius, the same parameters for another type, and 0.0 against -0.0
+    SharedPtr<PrimitiveMeshGeometryData> others[] = {
+        create_sphere(1.5f, 12, 7),
+        create_sphere(1.25f, 12, 6),
+        create_box(1.5f, 12.0f, 6.0f, 0),
+        create_quad(0.0f, 1.0f),
+        create_quad(-0.0f, 1.0f),
+    };
+    const PrimitiveGeometryCacheStats after = get_primitive_geometry_cache_stats();
+
+    u32 num_shared = 0;
+    for (u32 i = 0; i < 5; i++)
+    {
+        num_shared += others[i].get() == sphere.get() ? 1 : 0;
+        for (u32 j = 0; j < i; j++)
+        {
+            num_shared += others[i].get() == others[j].get() ? 1 : 0;
+        }
+    }
+    zv_check(num_shared == 0);
+    zv_check(others[0]->m_type == PrimitiveMeshGeometryData::Type::Sphere && others[2]->m_type == PrimitiveMeshGeometryData::Type::Box);
+    zv_check(after.m_num_misses == before.m_num_misses + 5);
+    zv_check(after.m_num_hits == before.m_num_hits);
+    zv_check(after.m_num_live == before.m_num_live + 5);
+}
+
+zv_test(primitive_cache_entries_expire_with_their_last_reference)
+{
+    SharedPtr<PrimitiveMeshGeometryData> first = create_icosphere(0.75f, 2);
+    SharedPtr<PrimitiveMeshGeometryData> second = create_icosphere(0.75f, 2);
+    const PrimitiveGeometryCacheStats before = get_primitive_geometry_cache_stats();
+
+    // One remaining reference keeps the entry alive
+    first.reset();
+    SharedPtr<PrimitiveMeshGeometryData> third = create_icosphere(0.75f, 2);
+    zv_check(third.get() == second.get());
+    zv_check(get_primitive_geometry_cache_stats().m_num_hits == before.m_num_hits + 1);
+
+    // Without any, the cache doesn't keep the geometry and the next request generates it again
+    second.reset();
+    third.reset();
+    const PrimitiveGeometryCacheStats released = get_primitive_geometry_cache_stats();
+    zv_check(released.m_num_live == before.m_num_live - 1);
+
+    SharedPtr<PrimitiveMeshGeometryData> regenerated = create_icosphere(0.75f, 2);
+    const PrimitiveGeometryCacheStats after = get_primitive_geometry_cache_stats();
+    zv_check(regenerated && !regenerated->m_indices.empty());
+    zv_check(after.m_num_misses == released.m_num_misses + 1);
+    zv_check(after.m_num_hits == released.m_num_hits);
+    zv_check(after.m_num_live == before.m_num_live);
+}
+
+zv_benchmark(create_sphere_250x250)
+{
+    const u64 start = get_allocation_count();
+    const f64 milliseconds = measure_best_ms(10, []()
+    {
+        create_sphere(1.0f, 250, 250);
+    });
+    report_timing("create_sphere, 250x250 segments, optimize_mesh included", milliseconds);
+    report_count("allocations per call", (get_allocation_count() - start) / 10);
+}
+
+namespace
+{
+    DynamicArray<MeshVertex> make_random_vertices(size_t num_vertices, TestRandom* random)
+    {
+        DynamicArray<MeshVertex> vertices(num_vertices);
+        for (MeshVertex& vertex : vertices)
+        {
+            vertex.position = Vector3(random->next_f32(-10.0f, 10.0f), random->next_f32(-10.0f, 10.0f), random->next_f32(-10.0f, 10.0f));
+            vertex.uv = Vector2(random->next_f32(0.0f, 1.0f), random->next_f32(0.0f, 1.0f));
+            vertex.normal = random_unit_vector(random);
+            const Vector3 tangent = random_unit_vector(random);
+            vertex.tangent = Vector4(tangent.x, tangent.y, tangent.z, random->next_u32() & 1 ? 1.0f : -1.0f);
+        }
+        return vertices;
+    }
+}
+
+zv_test(split_vertices_round_trip_exactly)
+{
+    TestRandom random{};
+    const DynamicArray<MeshVertex> vertices = make_random_vertices(1000, &random);
+
+    DynamicArray<Vector3> positions(vertices.size());
+    DynamicArray<MeshVertexAttributes> attributes(vertices.size());
+    split_vertices(vertices.data(), vertices.size(), positions.data(), attributes.data());
+
+    bool streams_ok = true;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        streams_ok = streams_ok && memcmp(&positions[i], &vertices[i].position, sizeof(Vector3)) == 0;
+        streams_ok = streams_ok && memcmp(&attributes[i].uv, &vertices[i].uv, sizeof(Vector2)) == 0;
+        streams_ok = streams_ok && memcmp(&attributes[i].normal, &vertices[i].normal, sizeof(Vector3)) == 0;
+        streams_ok = streams_ok && memcmp(&attributes[i].tangent, &vertices[i].tangent, sizeof(Vector4)) == 0;
+    }
+    zv_check(streams_ok);
+
+    DynamicArray<MeshVertex> interleaved(vertices.size());
+    interleave_vertices(positions.data(), attributes.data(), vertices.size(), interleaved.data());
+    zv_check(memcmp(interleaved.data(), vertices.data(), vertices.size() * sizeof(MeshVertex)) == 0);
+}
+
+zv_test(split_packed_vertices_round_trip_exactly)
+{
+    // Every bit pattern is a valid packed vertex
+    TestRandom random{};
+    DynamicArray<PackedMeshVertex> vertices(1000);
+    u8* bytes = reinterpret_cast<u8*>(vertices.data());
+    for (size_t i = 0; i < vertices.size() * sizeof(PackedMeshVertex); i++)
+    {
+        bytes[i] = static_cast<u8>(random.next_u32() >> 24);
+    }
+
+    DynamicArray<PackedMeshVertexPosition> positions(vertices.size());
+    DynamicArray<PackedMeshVertexAttributes> attributes(vertices.size());
+    split_packed_vertices(vertices.data(), vertices.size(), positions.data(), attributes.data());
+
+    DynamicArray<PackedMeshVertex> interleaved(vertices.size());
+    interleave_packed_vertices(positions.data(), attributes.data(), vertices.size(), interleaved.data());
+    zv_check(memcmp(interleaved.data(), vertices.data(), vertices.size() * sizeof(PackedMeshVertex)) == 0);
+}
+
+zv_test(split_streams_give_the_same_bounds_and_quantization)
+{
+    MeshGeometryData geometry = make_sphere_mesh(32, 16);
+    for (MeshVertex& vertex : geometry.m_vertices)
+    {
+        vertex.position = vertex.position * 3.0f + Vector3(1.0f, -2.0f, 0.5f);
+    }
+
+    compute_mesh_bounds(&geometry);
+    pack_mesh_geometry(&geometry);
+    const MeshGeometryData interleaved = geometry;
+
+    split_vertex_streams(&geometry);
+    zv_check(geometry.has_split_streams());
+    compute_mesh_bounds(&geometry);
+    pack_mesh_geometry(&geometry);
+
+    zv_check(memcmp(&geometry.m_bounds, &interleaved.m_bounds, sizeof(AABB)) == 0);
+    zv_check(memcmp(&geometry.m_bounding_sphere, &interleaved.m_bounding_sphere, sizeof(BoundingSphere)) == 0);
+    zv_check(memcmp(&geometry.m_quantization, &interleaved.m_quantization, sizeof(VertexQuantization)) == 0);
+    zv_check(memcmp(geometry.m_packed_vertices.data(), interleaved.m_packed_vertices.data(), geometry.packed_vertices_size()) == 0);
+}
+
+zv_test(transform_aabb_of_rotated_and_scaled_boxes)
+{
+    const AABB box = make_aabb(Vector3(-1.0f, -2.0f, -3.0f), Vector3(1.0f, 2.0f, 3.0f));
+
+    // A quarter turn about z swaps the x and y extents, the translation moves the center
+    const AABB turned = transform_aabb(box, Matrix::CreateRotationZ(0.5f * ZV_PI) * Matrix::CreateTranslation(10.0f, 0.0f, 0.0f));
+    zv_check(get_max_aabb_difference(turned, make_aabb(Vector3(8.0f, -1.0f, -3.0f), Vector3(12.0f, 1.0f, 3.0f))) < 1e-5f);
+
+    // Scaling, with z mirrored, keeps min below max
+    const AABB scaled = transform_aabb(box, Matrix::CreateScale(Vector3(2.0f, 0.5f, -1.0f)) * Matrix::CreateTranslation(0.0f, 1.0f, 0.0f));
+    zv_check(get_max_aabb_difference(scaled, make_aabb(Vector3(-2.0f, 0.0f, -3.0f), Vector3(2.0f, 2.0f, 3.0f))) < 1e-6f);
+
+    // An eighth turn about y stands the unit cube on its diagonal, sqrt(2) long in x and centered on zero in z
+    const AABB cube = make_aabb(Vector3(0.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f));
+    const AABB diagonal = transform_aabb(cube, Matrix::CreateRotationY(0.25f * ZV_PI));
+    zv_check(get_max_aabb_difference(diagonal, make_aabb(Vector3(0.0f, 0.0f, -0.5f * ZV::sqrt(2.0f)), Vector3(ZV::sqrt(2.0f), 1.0f, 0.5f * ZV::sqrt(2.0f)))) < 1e-5f);
+
+    // Any affine transform gives exactly the bounds of the transformed corners
+    TestRandom random{};
+    f32 max_difference = 0.0f;
+    for (u32 i = 0; i < 100; i++)
+    {
+        const AABB source = make_aabb(Vector3(random.next_f32(-5.0f, 0.0f), random.next_f32(-5.0f, 0.0f), random.next_f32(-5.0f, 0.0f)),
+                                      Vector3(random.next_f32(0.0f, 5.0f), random.next_f32(0.0f, 5.0f), random.next_f32(0.0f, 5.0f)));
+        const Matrix transform = Matrix::CreateScale(Vector3(random.next_f32(-2.0f, 2.0f), random.next_f32(0.1f, 2.0f), random.next_f32(0.1f, 2.0f))) *
+            Matrix::CreateRotationX(random.next_f32(0.0f, ZV_2PI)) * Matrix::CreateRotationY(random.next_f32(0.0f, ZV_2PI)) *
+            Matrix::CreateTranslation(random.next_f32(-100.0f, 100.0f), random.next_f32(-100.0f, 100.0f), random.next_f32(-100.0f, 100.0f));
+
+        AABB corners{};
+        for (u32 corner = 0; corner < 8; corner++)
+        {
+            const Vector3 point((corner & 1) ? source.m_max.x : source.m_min.x, (corner & 2) ? source.m_max.y : source.m_min.y, (corner & 4) ? source.m_max.z : source.m_min.z);
+            corners.add(Vector3::Transform(point, transform));
+        }
+        max_difference = ZV::max(max_difference, get_max_aabb_difference(transform_aabb(source, transform), corners));
+    }
+    zv_check(max_difference < 1e-4f);
+
+    // Empty bounds stay empty instead of turning into a huge box
+    zv_check(!transform_aabb(AABB{}, Matrix::CreateRotationZ(1.0f)).is_valid());
+}
+
+zv_benchmark(compute_mesh_bounds_1m)
+{
+    // Bounds only read positions, the split stream reads 12 of every 48 bytes the interleaved vertices pull in
+    TestRandom random{};
+    MeshGeometryData geometry{};
+    geometry.m_vertices = make_random_vertices(1 << 20, &random);
+
+    const f64 interleaved_milliseconds = measure_best_ms(10, [&]() { compute_mesh_bounds(&geometry); });
+    report_timing("compute_mesh_bounds, 1M interleaved vertices", interleaved_milliseconds);
+
+    split_vertex_streams(&geometry);
+    const f64 split_milliseconds = measure_best_ms(10, [&]() { compute_mesh_bounds(&geometry); });
+    report_timing("compute_mesh_bounds, 1M split vertices", split_milliseconds);
+}
+
+namespace
+{
+    // The serial loop recalculate_normals replaced: area weighted face normals summed in triangle order
+    void recalculate_normals_serial(MeshVertex* vertices, size_t num_vertices, const u16* indices, size_t num_indices)
+    {
+        DynamicArray<Vector3> normals(num_vertices, Vector3(0.0f, 0.0f, 0.0f));
+        for (size_t i = 0; i < num_indices; i += 3)
+        {
+            const Vector3& a = vertices[indices[i + 0]].position;
+            const Vector3& b = vertices[indices[i + 1]].position;
+            const Vector3& c = vertices[indices[i + 2]].position;
+            const Vector3 normal = (b - a).Cross(c - a);
+            normals[indices[i + 0]] += normal;
+            normals[indices[i + 1]] += normal;
+            normals[indices[i + 2]] += normal;
+        }
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            const f32 length = normals[i].Length();
+            vertices[i].normal = length > 0.0f ? normals[i] / length : normals[i];
+        }
+    }
+
+    MeshGeometryData make_normals_test_mesh(u32 num_segments)
+    {
+        TestRandom random{};
+        MeshGeometryData geometry = make_grid_mesh(num_segments);
+        for (MeshVertex& vertex : geometry.m_vertices)
+        {
+            vertex.position.z = 2.0f * std::sin(vertex.position.x * 0.3f) * std::cos(vertex.position.y * 0.2f);
+        }
+        shuffle_triangles(&geometry.m_indices, &random);
+        return geometry;
+    }
+}
+
+zv_test(recalculate_normals_matches_the_serial_sums)
+{
+    MeshGeometryData geometry = make_normals_test_mesh(64);
+    // A degenerate triangle adds nothing
+    geometry.m_indices.insert(geometry.m_indices.end(), { 5, 5, 6 });
+
+    DynamicArray<MeshVertex> expected = geometry.m_vertices;
+    recalculate_normals_serial(expected.data(), expected.size(), geometry.m_indices.data(), geometry.m_indices.size());
+    recalculate_normals(geometry.m_vertices.data(), geometry.m_vertices.size(), geometry.m_indices.data(), geometry.m_indices.size());
+
+    f32 max_error = 0.0f;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        max_error = ZV::max(max_error, (geometry.m_vertices[i].normal - expected[i].normal).Length());
+    }
+    zv_check(max_error < 1e-6f);
+}
+
+zv_test(recalculate_normals_is_independent_of_the_thread_count)
+{
+    const MeshGeometryData geometry = make_normals_test_mesh(255);
+    for (NormalWeighting weighting : { NormalWeighting::Area, NormalWeighting::Angle })
+    {
+        DynamicArray<MeshVertex> expected = geometry.m_vertices;
+        recalculate_normals(expected.data(), expected.size(), geometry.m_indices.data(), geometry.m_indices.size(), weighting);
+
+        for (u32 num_threads : { 1u, 3u, 7u })
+        {
+            set_test_worker_thread_count(num_threads);
+            DynamicArray<MeshVertex> vertices = geometry.m_vertices;
+            recalculate_normals(vertices.data(), vertices.size(), geometry.m_indices.data(), geometry.m_indices.size(), weighting);
+            zv_check(memcmp(vertices.data(), expected.data(), vertices.size() * sizeof(MeshVertex)) == 0);
+        }
+        set_test_worker_thread_count(0);
+    }
+}
+
+zv_test(recalculate_normals_of_a_sphere_point_outwards)
+{
+    for (NormalWeighting weighting : { NormalWeighting::Area, NormalWeighting::Angle })
+    {
+        MeshGeometryData sphere = make_sphere_mesh(48, 24);
+        recalculate_normals(sphere.m_vertices.data(), sphere.m_vertices.size(), sphere.m_indices.data(), sphere.m_indices.size(), weighting);
+
+        // The seam and pole vertices only see part of their neighbourhood
+        f32 max_angle = 0.0f;
+        for (const MeshVertex& vertex : sphere.m_vertices)
+        {
+            if (std::abs(vertex.position.y) < 0.99f)
+            {
+                max_angle = ZV::max(max_angle, get_angle_degrees(vertex.normal, vertex.position));
+            }
+        }
+        zv_check(max_angle < 360.0f / 48.0f);
+    }
+}
+
+zv_test(angle_weighted_normals_ignore_the_triangulation)
+{
+    // The corner of a cube at the origin, faces towards -x, -y and -z. The -z face is split through the corner, so it
+    // touches the corner with two triangles of the same area as the single triangles of the other faces.
+    MeshGeometryData corner{};
+    const Vector3 positions[] = {
+        Vector3(0.0f, 0.0f, 0.0f),
+        Vector3(1.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f),
+        Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 1.0f, 1.0f), Vector3(1.0f, 0.0f, 1.0f) };
+    for (const Vector3& position : positions)
+    {
+        MeshVertex vertex{};
+        vertex.position = position;
+        corner.m_vertices.push_back(vertex);
+    }
+    corner.m_indices = { 0, 3, 2, 0, 2, 1, 0, 4, 3, 4, 5, 3, 0, 1, 4, 1, 6, 4 };
+
+    recalculate_normals(corner.m_vertices.data(), corner.m_vertices.size(), corner.m_indices.data(), corner.m_indices.size(), NormalWeighting::Angle);
+    zv_check(get_angle_degrees(corner.m_vertices[0].normal, Vector3(-1.0f, -1.0f, -1.0f)) < 1e-3f);
+
+    recalculate_normals(corner.m_vertices.data(), corner.m_vertices.size(), corner.m_indices.data(), corner.m_indices.size(), NormalWeighting::Area);
+    zv_check(get_angle_degrees(corner.m_vertices[0].normal, Vector3(-1.0f, -1.0f, -2.0f)) < 1e-3f);
+}
+
+zv_benchmark(recalculate_normals_65k)
+{
+    MeshGeometryData geometry = make_normals_test_mesh(255);
+    MeshVertex* vertices = geometry.m_vertices.data();
+    const size_t num_vertices = geometry.m_vertices.size();
+    const u16* indices = geometry.m_indices.data();
+    const size_t num_indices = geometry.m_indices.size();
+
+    report_timing("serial loop, 130050 triangles", measure_best_ms(10, [&]() { recalculate_normals_serial(vertices, num_vertices, indices, num_indices); }));
+
+    // Reporting workers makes recalculate_normals split its work as it would on eight cores
+    set_test_worker_thread_count(7);
+    report_timing("area weighted, 130050 triangles", measure_best_ms(10, [&]() { recalculate_normals(vertices, num_vertices, indices, num_indices, NormalWeighting::Area); }));
+    report_timing("angle weighted, 130050 triangles", measure_best_ms(10, [&]() { recalculate_normals(vertices, num_vertices, indices, num_indices, NormalWeighting::Angle); }));
+    set_test_worker_thread_count(0);
+}
@@ -0,0 +1,139 @@
+#include <Tests/TestMeshes.h>
+
+#include <GltfImport.h>
+#include <ThirdParty/cgltf/cgltf.h>
+
+#include <cstring>
+#include <string>
+
+namespace
+{
+    // Three positions as floats followed by three u16 indices, as one buffer
+    const f32 k_triangle_positions[9] = { 1.0f, 2.0f, 3.0f, -1.0f, 5.0f, 0.0f, 4.0f, -2.0f, -3.0f };
+    const u16 k_triangle_indices[3] = { 0, 1, 2 };
+
+    std::string encode_base64(const u8* data, size_t size)
+    {
+        static constexpr char k_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string encoded{};
+        for (size_t i = 0; i < size; i += 3)
+        {
+            const u32 num_bytes = static_cast<u32>(ZV::min(size - i, static_cast<size_t>(3)));
+            u32 bits = 0;
+            for (u32 byte = 0; byte < 3; byte++)
+            {
+                bits = (bits << 8) | (byte < num_bytes ? data[i + byte] : 0u);
+            }
+            for (u32 digit = 0; digit < 4; digit++)
+            {
+                encoded += digit <= num_bytes ? k_alphabet[(bits >> (18 - digit * 6)) & 63u] : '=';
+            }
+        }
+        return encoded;
+    }
+
+    // A glTF file with one triangle whose buffer is embedded as a data uri. accessor_bounds is spliced into the position
+    // accessor, empty leaves out min and max.
+    std::string make_triangle_gltf(const char* accessor_bounds)
+    {
+        u8 buffer[sizeof(k_triangle_positions) + sizeof(k_triangle_indices)] = {};
+        memcpy(buffer, k_triangle_positions, sizeof(k_triangle_positions));
+        memcpy(buffer + sizeof(k_triangle_positions), k_triangle_indices, sizeof(k_triangle_indices));
+
+        std::string json = R"({"asset":{"version":"2.0"},)";
+        json += R"("buffers":[{"byteLength":42,"uri":"data:application/octet-stream;base64,)" + encode_base64(buffer, sizeof(buffer)) + R"("}],)";
+        json += R"("bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":36},{"buffer":0,"byteOffset":36,"byteLength":6}],)";
+        json += R"("accessors":[{"bufferView":0,"componentType":5126,"count":3,"type":"VEC3")" + std::string(accessor_bounds) + "},";
+        json += R"({"bufferView":1,"componentType":5123,"count":3,"type":"SCALAR"}],)";
+        json += R"("meshes":[{"primitives":[{"attributes":{"POSITION":0},"indices":1}]}]})";
+        return json;
+    }
+
+    // Parses the file and reads its only primitive, false if cgltf rejects it
+    bool read_triangle_gltf(const char* accessor_bounds, MeshGeometryData* out_geometry)
+    {
+        const std::string json = make_triangle_gltf(accessor_bounds);
+
+        cgltf_options options{};
+        cgltf_data* data = nullptr;
+        if (cgltf_parse(&options, json.data(), json.size(), &data) != cgltf_result_success)
+        {
+            return false;
+        }
+
+        const bool is_loaded = cgltf_load_buffers(&options, data, nullptr) == cgltf_result_success && data->meshes_count == 1;
+        if (is_loaded)
+        {
+            read_gltf_geometry(&data->meshes[0].primitives[0], out_geometry);
+        }
+        cgltf_free(data);
+        return is_loaded;
+    }
+
+    f32 get_max_aabb_difference(const AABB& a, const Vector3& min, const Vector3& max)
+    {
+        const Vector3 min_difference = a.m_min - min;
+        const Vector3 max_difference = a.m_max - max;
+        return ZV::max(ZV::max(ZV::max(ZV::abs(min_difference.x), ZV::abs(min_difference.y)), ZV::max(ZV::abs(min_difference.z), ZV::abs(max_difference.x))),
+                       ZV::max(ZV::abs(max_difference.y), ZV::abs(max_difference.z)));
+    }
+
+    // Bounding spheres are centered on the box, every vertex has to be inside
+    u32 count_vertices_outside_bounds(const MeshGeometryData& geometry)
+    {
+        u32 num_outside = 0;
+        for (const MeshVertex& vertex : geometry.m_vertices)
+        {
+            const Vector3& p = vertex.position;
+            const bool is_in_box = p.x >= geometry.m_bounds.m_min.x && p.y >= geometry.m_bounds.m_min.y && p.z >= geometry.m_bounds.m_min.z &&
+                p.x <= geometry.m_bounds.m_max.x && p.y <= geometry.m_bounds.m_max.y && p.z <= geometry.m_bounds.m_max.z;
+            const bool is_in_sphere = Vector3::Distance(p, geometry.m_bounding_sphere.m_center) <= geometry.m_bounding_sphere.m_radius * 1.0001f;
+            num_outside += is_in_box && is_in_sphere ? 0 : 1;
+        }
+        return num_outside;
+    }
+}
+
+zv_test(gltf_bounds_are_computed_from_the_vertices_without_accessor_bounds)
+{
+    MeshGeometryData geometry{};
+    zv_check(read_triangle_gltf("", &geometry));
+    zv_check(geometry.m_vertices.size() == 3 && geometry.m_indices.size() == 3);
+
+    // y is flipped into the engine's left handed basis, positions and bounds alike
+    zv_check(geometry.m_vertices[0].position == Vector3(1.0f, -2.0f, 3.0f));
+    zv_check(get_max_aabb_difference(geometry.m_bounds, Vector3(-1.0f, -5.0f, -3.0f), Vector3(4.0f, 2.0f, 3.0f)) == 0.0f);
+    zv_check(geometry.m_bounding_sphere.m_center == geometry.m_bounds.get_center());
+    zv_check(count_vertices_outside_bounds(geometry) == 0);
+}
+
+zv_test(gltf_bounds_come_from_the_accessor_min_and_max)
+{
+    // Exact bounds give the same box as the vertices, so the flip of min and max in y is right
+    MeshGeometryData exact{};
+    zv_check(read_triangle_gltf(R"(,"min":[-1,-2,-3],"max":[4,5,3])", &exact));
+    zv_check(get_max_aabb_difference(exact.m_bounds, Vector3(-1.0f, -5.0f, -3.0f), Vector3(4.0f, 2.0f, 3.0f)) == 0.0f);
+
+    // Padded bounds are taken as they are, the vertices aren't scanned again
+    MeshGeometryData padded{};
+    zv_check(read_triangle_gltf(R"(,"min":[-2,-3,-4],"max":[5,6,4])", &padded));
+    zv_check(get_max_aabb_difference(padded.m_bounds, Vector3(-2.0f, -6.0f, -4.0f), Vector3(5.0f, 3.0f, 4.0f)) == 0.0f);
+    zv_check(padded.m_bounding_sphere.m_center == padded.m_bounds.get_center());
+    zv_check(count_vertices_outside_bounds(padded) == 0);
+}
+
+zv_test(gltf_accessor_bounds_of_an_imported_mesh_match_its_vertices)
+{
+    // DamagedHelmet's exporter wrote min and max, they have to agree with the vertices read through the same flip
+    const MeshGeometryData& helmet = get_damaged_helmet_mesh();
+    zv_check(!helmet.m_vertices.empty());
+
+    AABB vertex_bounds{};
+    for (const MeshVertex& vertex : helmet.m_vertices)
+    {
+        vertex_bounds.add(vertex.position);
+    }
+    zv_check(get_max_aabb_difference(helmet.m_bounds, vertex_bounds.m_min, vertex_bounds.m_max) < 1e-5f);
+    zv_check(count_vertices_outside_bounds(helmet) == 0);
+}
@@ -0,0 +1,171 @@
+#include <Tests/Test.h>
+
+#include <GraphicsStateFilter.h>
+
+namespace
+{
+    using CommandType = GraphicsCommandRecorder::CommandType;
+
+    // Handles only need to be distinct, the filter never dereferences them
+    void* make_handle(u64 value)
+    {
+        return reinterpret_cast<void*>(value);
+    }
+
+    struct TestDrawState
+    {
+        void* m_pipeline_state = make_handle(0x10);
+        void* m_root_signature = make_handle(0x20);
+        FilteredViewport m_viewport{ 0.0f, 0.0f, 800.0f, 600.0f, 0.0f, 1.0f };
+        FilteredScissor m_scissor{ 0, 0, 800, 600 };
+        StaticArray<FilteredBufferView, 2> m_vertex_buffers{ { { 0x100, 64, 20 }, { 0x200, 64, 8 } } };
+        FilteredBufferView m_index_buffer{ 0x300, 32, 42 };
+    };
+
+    // Everything a draw of the renderer sets, in the order it sets it
+    void set_draw_state(GraphicsStateFilter* filter, const TestDrawState& state, u64 object_constants)
+    {
+        filter->set_pipeline_state(state.m_pipeline_state);
+        filter->set_root_signature(state.m_root_signature);
+        filter->set_viewport(state.m_viewport);
+        filter->set_scissor(state.m_scissor);
+        filter->set_primitive_topology(4);
+        filter->set_vertex_buffers(state.m_vertex_buffers.data(), 2);
+        filter->set_index_buffer(state.m_index_buffer);
+        filter->set_root_constant_buffer_view(0, object_constants);
+        filter->set_root_descriptor_table(1, 0x5000);
+    }
+
+    u32 count_commands(const GraphicsCommandRecorder& recorder, CommandType type)
+    {
+        u32 count = 0;
+        for (const GraphicsCommandRecorder::Command& command : recorder.m_commands)
+        {
+            count += command.m_type == type ? 1 : 0;
+        }
+        return count;
+    }
+}
+
+zv_test(state_filter_drops_redundant_calls)
+{
+    GraphicsCommandRecorder recorder{};
+    GraphicsStateFilter filter(&recorder);
+    const TestDrawState state{};
+
+    // Only the per object constants change between the draws
+    for (u32 draw = 0; draw < 4; draw++)
+    {
+        set_draw_state(&filter, state, 0x1000 + draw * 256);
+    }
+    zv_check(recorder.m_commands.size() == 9 + 3);
+    zv_check(count_commands(recorder, CommandType::SetPipelineState) == 1);
+    zv_check(count_commands(recorder, CommandType::SetRootSignature) == 1);
+    zv_check(count_commands(recorder, CommandType::SetVertexBuffers) == 1);
+    zv_check(count_commands(recorder, CommandType::SetIndexBuffer) == 1);
+    zv_check(count_commands(recorder, CommandType::SetRootConstantBufferView) == 4);
+    zv_check(filter.get_stats().m_num_issued == 12);
+    zv_check(filter.get_stats().m_num_filtered == 24);
+    zv_check(filter.get_stats().get_filtered_rate() == 24.0f / 36.0f);
+
+    // A prefix of the bound vertex buffers is already bound, a change in any slot is not
+    filter.set_vertex_buffers(state.m_vertex_buffers.data(), 1);
+    zv_check(recorder.m_commands.size() == 12);
+    StaticArray<FilteredBufferView, 2> changed_vertex_buffers = state.m_vertex_buffers;
+    changed_vertex_buffers[1].m_address = 0x999;
+    filter.set_vertex_buffers(changed_vertex_buffers.data(), 2);
+    zv_check(recorder.m_commands.size() == 13);
+
+    // Different index buffer, pipeline state or viewport each go through once
+    FilteredBufferView changed_index_buffer = state.m_index_buffer;
+    changed_index_buffer.m_stride_or_format = 57;
+    filter.set_index_buffer(changed_index_buffer);
+    filter.set_index_buffer(changed_index_buffer);
+    filter.set_pipeline_state(make_handle(0x11));
+    filter.set_pipeline_state(make_handle(0x11));
+    FilteredViewport changed_viewport = state.m_viewport;
+    changed_viewport.m_max_depth = 0.5f;
+    filter.set_viewport(changed_viewport);
+    filter.set_viewport(changed_viewport);
+    zv_check(recorder.m_commands.size() == 16);
+}
+
+zv_test(state_filter_reissues_root_arguments_after_root_signature_change)
+{
+    GraphicsCommandRecorder recorder{};
+    GraphicsStateFilter filter(&recorder);
+    const TestDrawState state{};
+    set_draw_state(&filter, state, 0x1000);
+    const size_t num_commands = recorder.m_commands.size();
+
+    // The same arguments are lost with the old root signature, the pipeline state and buffers are not
+    TestDrawState other_root_signature_state = state;
+    other_root_signature_state.m_root_signature = make_handle(0x21);
+    set_draw_state(&filter, other_root_signature_state, 0x1000);
+    zv_check(recorder.m_commands.size() == num_commands + 3);
+    if (recorder.m_commands.size() == num_commands + 3)
+    {
+        zv_check(recorder.m_commands[num_commands + 0].m_type == CommandType::SetRootSignature);
+        zv_check(recorder.m_commands[num_commands + 1].m_type == CommandType::SetRootConstantBufferView);
+        zv_check(recorder.m_commands[num_commands + 2].m_type == CommandType::SetRootDescriptorTable);
+        zv_check(recorder.m_commands[num_commands + 2].m_index == 1 && recorder.m_commands[num_commands + 2].m_value == 0x5000);
+    }
+
+    // Setting the bound root signature again keeps the arguments
+    filter.set_root_signature(make_handle(0x21));
+    filter.set_root_descriptor_table(1, 0x5000);
+    zv_check(recorder.m_commands.size() == num_commands + 3);
+
+    // One root index switching between a table and a CBV with the same value is a change
+    filter.set_root_constant_buffer_view(1, 0x5000);
+    filter.set_root_descriptor_table(1, 0x5000);
+    zv_check(recorder.m_commands.size() == num_commands + 5);
+}
+
+zv_test(state_filter_reissues_everything_after_invalidate_and_reset)
+{
+    GraphicsCommandRecorder recorder{};
+    GraphicsStateFilter filter(&recorder);
+    const TestDrawState state{};
+    set_draw_state(&filter, state, 0x1000);
+    set_draw_state(&filter, state, 0x1000);
+    zv_check(recorder.m_commands.size() == 9);
+
+    // Something else recorded into the list, the counters keep going
+    const u32 num_issued = filter.get_stats().m_num_issued;
+    const u32 num_filtered = filter.get_stats().m_num_filtered;
+    filter.invalidate();
+    set_draw_state(&filter, state, 0x1000);
+    zv_check(recorder.m_commands.size() == 18);
+    zv_check(filter.get_stats().m_num_issued == num_issued + 9);
+    zv_check(filter.get_stats().m_num_filtered == num_filtered);
+
+    // A new command list starts with nothing bound and counts from zero
+    filter.reset();
+    zv_check(filter.get_stats().m_num_issued == 0 && filter.get_stats().m_num_filtered == 0);
+    set_draw_state(&filter, state, 0x1000);
+    zv_check(recorder.m_commands.size() == 27);
+    zv_check(filter.get_stats().m_num_issued == 9);
+}
+
+zv_benchmark(state_filter_100k_draws)
+{
+    // 100 pipeline and geometry changes, new object constants every draw
+    GraphicsCommandRecorder recorder{};
+    GraphicsStateFilter filter(&recorder);
+    TestDrawState state{};
+    recorder.m_commands.reserve(1 << 20);
+    const f64 milliseconds = measure_best_ms(10, [&]()
+    {
+        recorder.m_commands.clear();
+        filter.reset();
+        for (u32 draw = 0; draw < 100000; draw++)
+        {
+            state.m_pipeline_state = make_handle(0x10 + draw / 1000);
+            state.m_index_buffer.m_address = 0x300 + (draw / 1000) * 64;
+            set_draw_state(&filter, state, 0x1000 + draw * 256);
+        }
+    });
+    report_timing("900000 calls, 100000 draws", milliseconds);
+    report_count("calls issued", filter.get_stats().m_num_issued);
+}
@@ -0,0 +1,222 @@
+#include <Tests/Test.h>
+
+#include <Instancing.h>
+#include <RenderQueue.h>
+
+namespace
+{
+    InstancedDrawKey make_draw_key(u32 geometry, u32 index_count = 36, u32 start_index = 0)
+    {
+        InstancedDrawKey key{};
+        key.m_geometry = geometry;
+        key.m_index_count = index_count;
+        key.m_start_index = start_index;
+        return key;
+    }
+
+    // Instances cover the instance list once and in order, every draw starts where the one before it ended
+    bool are_draws_contiguous(const DynamicArray<InstancedDraw>& draws, const DynamicArray<u32>& instance_items)
+    {
+        u32 next_instance = 0;
+        for (const InstancedDraw& draw : draws)
+        {
+            if (draw.m_first_instance != next_instance || draw.m_instance_count == 0 || draw.m_first_item != instance_items[draw.m_first_instance])
+            {
+                return false;
+            }
+            next_instance += draw.m_instance_count;
+        }
+        return next_instance == instance_items.size();
+    }
+}
+
+zv_test(instance_batcher_merges_equal_neighbours)
+{
+    InstanceBatcher batcher{};
+    InstancingStats stats{};
+    for (u32 i = 0; i < 8; i++)
+    {
+        batcher.add(make_draw_key(5), i);
+    }
+    DrawListRecorder recorder{};
+    batcher.record(&recorder, &stats);
+    zv_check(recorder.m_draws.size() == 1);
+    zv_check(recorder.m_draws[0].m_first_instance == 0);
+    zv_check(recorder.m_draws[0].m_instance_count == 8);
+    zv_check(stats.m_num_instances == 8 && stats.m_num_draws == 1);
+    zv_check(stats.get_instances_per_draw() == 8.0f);
+
+    // Alternating keys never merge, only neighbours do
+    batcher.clear();
+    for (u32 i = 0; i < 6; i++)
+    {
+        batcher.add(make_draw_key(i % 2), i);
+    }
+    DrawListRecorder alternating_recorder{};
+    batcher.record(&alternating_recorder, &stats);
+    zv_check(alternating_recorder.m_draws.size() == 6);
+    zv_check(stats.m_num_draws == 6);
+    zv_check(are_draws_contiguous(alternating_recorder.m_draws, batcher.get_instance_items()));
+
+    batcher.clear();
+    DrawListRecorder empty_recorder{};
+    batcher.record(&empty_recorder, &stats);
+    zv_check(empty_recorder.m_draws.empty());
+    zv_check(batcher.get_num_draws() == 0);
+    zv_check(stats.get_instances_per_draw() == 0.0f);
+}
+
+zv_test(instance_batcher_splits_on_every_key_field)
+{
+    // A different geometry, LOD range or pipeline each starts a new draw
+    InstancedDrawKey pipeline_key = make_draw_key(2, 12, 36);
+    pipeline_key.m_pipeline = 1;
+
+    InstanceBatcher batcher{};
+    batcher.add(make_draw_key(1), 10);
+    batcher.add(make_draw_key(1), 11);
+    batcher.add(make_draw_key(2), 12);
+    batcher.add(make_draw_key(2, 12, 36), 13);
+    batcher.add(make_draw_key(2, 12, 36), 14);
+    batcher.add(make_draw_key(2, 12, 36), 15);
+    batcher.add(pipeline_key, 16);
+
+    DrawListRecorder recorder{};
+    batcher.record(&recorder);
+    zv_check(recorder.m_draws.size() == 4);
+    zv_check(are_draws_contiguous(recorder.m_draws, batcher.get_instance_items()));
+    if (recorder.m_draws.size() == 4)
+    {
+        zv_check(recorder.m_draws[0].m_instance_count == 2 && recorder.m_draws[0].m_first_item == 10);
+        zv_check(recorder.m_draws[1].m_first_instance == 2 && recorder.m_draws[1].m_instance_count == 1 && recorder.m_draws[1].m_key.m_geometry == 2);
+        zv_check(recorder.m_draws[2].m_first_instance == 3 && recorder.m_draws[2].m_instance_count == 3 && recorder.m_draws[2].m_key.m_start_index == 36);
+        zv_check(recorder.m_draws[3].m_first_instance == 6 && recorder.m_draws[3].m_key.m_pipeline == 1);
+    }
+    zv_check(batcher.get_instance_items()[4] == 14);
+}
+
+zv_test(instance_batcher_batches_sorted_scenes)
+{
+    // Objects sorted by geometry and LOD, the way the render queue hands them over, merge into one draw per pair
+    TestRandom random{};
+    InstanceBatcher batcher{};
+    u32 num_expected_draws = 0;
+    u32 item = 0;
+    for (u32 geometry = 0; geometry < 20; geometry++)
+    {
+        for (u32 lod = 0; lod < 30; lod++)
+        {
+            const u32 num_objects = random.next_u32() % 4;
+            num_expected_draws += num_objects > 0 ? 1 : 0;
+            for (u32 i = 0; i < num_objects; i++)
+            {
+                batcher.add(make_draw_key(geometry, 36, lod * 36), item++);
+            }
+        }
+    }
+
+    DrawListRecorder recorder{};
+    InstancingStats stats{};
+    batcher.record(&recorder, &stats);
+    zv_check(recorder.m_draws.size() == num_expected_draws);
+    zv_check(stats.m_num_instances == item);
+    zv_check(are_draws_contiguous(recorder.m_draws, batcher.get_instance_items()));
+
+    u32 num_unordered_items = 0;
+    u32 num_unmerged_neighbours = 0;
+    for (u32 i = 0; i < item; i++)
+    {
+        num_unordered_items += batcher.get_instance_items()[i] != i ? 1 : 0;
+    }
+    for (size_t i = 1; i < recorder.m_draws.size(); i++)
+    {
+        num_unmerged_neighbours += recorder.m_draws[i].m_key == recorder.m_draws[i - 1].m_key ? 1 : 0;
+    }
+    zv_check(num_unordered_items == 0);
+    zv_check(num_unmerged_neighbours == 0);
+}
+
+zv_test(batch_instanced_objects_merges_probes_with_different_materials)
+{
+    // The renderer's probe scene: eight spheres with a material each and two grid planes in between them. Materials are
+    // selected per instance, so every sphere lands in one draw even though depth interleaves them with the planes.
+    const f32 probe_depths[8] = { 9.0f, 9.5f, 10.0f, 11.0f, 12.0f, 12.5f, 13.0f, 14.0f };
+    const f32 plane_depths[2] = { 10.5f, 13.5f };
+    constexpr u32 k_sphere_geometry = 7;
+    constexpr u32 k_plane_geometry = 3;
+
+    DynamicArray<InstancedObject> objects;
+    for (u32 i = 0; i < 8; i++)
+    {
+        InstancedObject& probe = objects.emplace_back();
+        probe.m_key = make_draw_key(k_sphere_geometry, 2880);
+        probe.m_depth = probe_depths[i];
+        probe.m_item = i;
+    }
+    for (u32 i = 0; i < 2; i++)
+    {
+        InstancedObject& plane = objects.emplace_back();
+        plane.m_key = make_draw_key(k_plane_geometry, 384);
+        plane.m_depth = plane_depths[i];
+        plane.m_item = 8 + i;
+    }
+
+    RenderQueue queue{};
+    InstanceBatcher batcher{};
+    batch_instanced_objects(objects.data(), static_cast<u32>(objects.size()), &queue, &batcher);
+
+    DrawListRecorder recorder{};
+    InstancingStats stats{};
+    batcher.record(&recorder, &stats);
+    zv_check(stats.m_num_instances == 10);
+    zv_check(recorder.m_draws.size() == 2);
+    zv_check(are_draws_contiguous(recorder.m_draws, batcher.get_instance_items()));
+
+    u32 num_probe_draws = 0;
+    for (const InstancedDraw& draw : recorder.m_draws)
+    {
+        if (draw.m_key.m_geometry == k_sphere_geometry)
+        {
+            num_probe_draws++;
+            zv_check(draw.m_instance_count == 8);
+
+            // Front to back within the draw
+            bool is_front_to_back = true;
+            for (u32 i = 1; i < draw.m_instance_count; i++)
+            {
+                const u32 item = batcher.get_instance_items()[draw.m_first_instance + i];
+                const u32 previous_item = batcher.get_instance_items()[draw.m_first_instance + i - 1];
+                is_front_to_back &= objects[previous_item].m_depth <= objects[item].m_depth;
+            }
+            zv_check(is_front_to_back);
+        }
+    }
+    zv_check(num_probe_draws == 1);
+
+    // A probe far enough away for a coarser LOD gets a draw of its own. The queue orders a geometry's objects by depth
+    // only, so the probes in front of it and behind it are drawn separately.
+    objects[3].m_key.m_index_count = 720;
+    objects[3].m_key.m_start_index = 2880;
+    batch_instanced_objects(objects.data(), static_cast<u32>(objects.size()), &queue, &batcher);
+    zv_check(batcher.get_num_draws() == 4);
+}
+
+zv_benchmark(instance_batcher_100k_objects)
+{
+    // 100 geometries times 100 LODs with 10 objects each, as sorted by the render queue
+    InstanceBatcher batcher{};
+    DrawListRecorder recorder{};
+    InstancingStats stats{};
+    const f64 milliseconds = measure_best_ms(20, [&]()
+    {
+        batcher.clear();
+        recorder.m_draws.clear();
+        for (u32 item = 0; item < 100000; item++)
+        {
+            batcher.add(make_draw_key(item / 1000, 36, ((item / 10) % 100) * 36), item);
+        }
+        batcher.record(&recorder, &stats);
+    });
+    report_timing("add and record, 100000 objects", milliseconds);
+    report_count("draws", stats.m_num_draws);
+}
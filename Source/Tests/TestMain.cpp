@@ -0,0 +1,105 @@
+#include <Tests/Test.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace
+{
+    std::atomic<u64> s_num_allocations{ 0 };
+}
+
+// Counting replacements of the global allocation functions, the array forms forward to these
+void* operator new(size_t size)
+{
+    s_num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    abort();
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+u64 get_allocation_count()
+{
+    return s_num_allocations.load(std::memory_order_relaxed);
+}
+
+DynamicArray<TestCase>& get_test_cases()
+{
+    // Function local, registrations run during static initialization in any order
+    static DynamicArray<TestCase> s_test_cases;
+    return s_test_cases;
+}
+
+void test_check(TestContext* context, bool passed, const char* expression, const char* file, u32 line)
+{
+    context->m_num_checks++;
+    if (!passed)
+    {
+        context->m_num_failures++;
+        printf("    %s(%u): check failed: %s\n", file, line, expression);
+    }
+}
+
+void report_timing(const char* label, f64 milliseconds)
+{
+    printf("    %-56s %10.3f ms\n", label, milliseconds);
+}
+
+void report_count(const char* label, u64 count)
+{
+    printf("    %-56s %10llu\n", label, static_cast<unsigned long long>(count));
+}
+
+// Tests [--bench] [filter], the filter runs only the cases whose name contains it
+int main(int argc, char** argv)
+{
+    bool run_benchmarks = false;
+    const char* filter = nullptr;
+    for (int arg_index = 1; arg_index < argc; arg_index++)
+    {
+        if (strcmp(argv[arg_index], "--bench") == 0)
+        {
+            run_benchmarks = true;
+        }
+        else
+        {
+            filter = argv[arg_index];
+        }
+    }
+
+    u32 num_cases = 0;
+    u32 num_failed_cases = 0;
+    u32 num_checks = 0;
+    for (const TestCase& test_case : get_test_cases())
+    {
+        if (test_case.m_is_benchmark != run_benchmarks || (filter && !strstr(test_case.m_name, filter)))
+        {
+            continue;
+        }
+
+        printf("%s\n", test_case.m_name);
+        TestContext context{};
+        test_case.m_callback(&context);
+
+        num_cases++;
+        num_checks += context.m_num_checks;
+        num_failed_cases += context.m_num_failures > 0 ? 1 : 0;
+    }
+
+    printf("%u of %u %s passed, %u checks\n", num_cases - num_failed_cases, num_cases, run_benchmarks ? "benchmarks" : "tests", num_checks);
+    return static_cast<int>(num_failed_cases);
+}
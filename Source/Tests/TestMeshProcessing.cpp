@@ -0,0 +1,468 @@
+#include <Tests/TestMeshes.h>
+
+#include <MeshProcessing.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    // Edges between positions that only one triangle uses in that direction. Zero for closed meshes, however the vertices
+    // are split along seams.
+    u32 count_open_position_edges(const MeshVertex* vertices, size_t num_vertices, const u16* indices, size_t num_indices)
+    {
+        DynamicArray<u32> order(num_vertices);
+        for (u32 i = 0; i < num_vertices; i++)
+        {
+            order[i] = i;
+        }
+        auto position_less = [vertices](u32 a, u32 b)
+        {
+            const Vector3& pa = vertices[a].position;
+            const Vector3& pb = vertices[b].position;
+            return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+        };
+        std::sort(order.begin(), order.end(), position_less);
+
+        DynamicArray<u32> position_ids(num_vertices);
+        for (size_t i = 0; i < num_vertices; i++)
+        {
+            const bool is_new = i == 0 || vertices[order[i]].position != vertices[order[i - 1]].position;
+            position_ids[order[i]] = is_new ? order[i] : position_ids[order[i - 1]];
+        }
+
+        DynamicArray<u32> edges(num_indices);
+        for (size_t i = 0; i < num_indices; i++)
+        {
+            const size_t next = i - i % 3 + (i % 3 + 1) % 3;
+            edges[i] = (position_ids[indices[i]] << 16) | position_ids[indices[next]];
+        }
+        std::sort(edges.begin(), edges.end());
+
+        u32 num_open = 0;
+        for (const u32 edge : edges)
+        {
+            num_open += std::binary_search(edges.begin(), edges.end(), (edge << 16) | (edge >> 16)) ? 0 : 1;
+        }
+        return num_open;
+    }
+}
+
+zv_test(vertex_cache_optimization_lowers_acmr)
+{
+    TestRandom random{};
+    MeshGeometryData grid = make_grid_mesh(100);
+    shuffle_triangles(&grid.m_indices, &random);
+
+    const size_t num_indices = grid.m_indices.size();
+    const size_t num_vertices = grid.m_vertices.size();
+    const VertexCacheStats before = analyze_vertex_cache(grid.m_indices.data(), num_indices, num_vertices);
+
+    DynamicArray<u16> optimized(num_indices);
+    optimize_vertex_cache(optimized.data(), grid.m_indices.data(), num_indices, num_vertices);
+    const VertexCacheStats after = analyze_vertex_cache(optimized.data(), num_indices, num_vertices);
+
+    zv_check(before.m_num_triangles == 20000 && after.m_num_triangles == 20000);
+    zv_check(after.m_num_vertices == num_vertices);
+    // A shuffled grid misses on almost every corner, a 16 entry FIFO over a good order gets below one miss per triangle
+    zv_check(before.get_acmr() > 2.0f);
+    zv_check(after.get_acmr() < 0.8f);
+    zv_check(get_sorted_triangles(grid.m_vertices.data(), optimized.data(), num_indices) ==
+             get_sorted_triangles(grid.m_vertices.data(), grid.m_indices.data(), num_indices));
+}
+
+zv_test(vertex_fetch_optimization_orders_by_first_use)
+{
+    TestRandom random{};
+    MeshGeometryData sphere = make_sphere_mesh(32, 16);
+    shuffle_triangles(&sphere.m_indices, &random);
+
+    // Two more vertices no triangle uses, besides the pole copies at the seam
+    sphere.m_vertices.push_back(sphere.m_vertices[5]);
+    sphere.m_vertices.insert(sphere.m_vertices.begin(), sphere.m_vertices[7]);
+    for (u16& index : sphere.m_indices)
+    {
+        index++;
+    }
+    const auto expected_triangles = get_sorted_triangles(sphere.m_vertices.data(), sphere.m_indices.data(), sphere.m_indices.size());
+
+    DynamicArray<bool> referenced(sphere.m_vertices.size(), false);
+    for (u16 index : sphere.m_indices)
+    {
+        referenced[index] = true;
+    }
+    const u32 num_referenced = static_cast<u32>(std::count(referenced.begin(), referenced.end(), true));
+
+    DynamicArray<u16> indices = sphere.m_indices;
+    DynamicArray<MeshVertex> vertices(sphere.m_vertices.size());
+    const u32 num_kept = optimize_vertex_fetch(vertices.data(), indices.data(), indices.size(), sphere.m_vertices.data(), sphere.m_vertices.size());
+
+    zv_check(num_referenced == sphere.m_vertices.size() - 4);
+    zv_check(num_kept == num_referenced);
+
+    // Every index is either one that was seen before or the next new one
+    u32 next_new = 0;
+    bool first_use_order = true;
+    for (u16 index : indices)
+    {
+        first_use_order = first_use_order && index <= next_new;
+        next_new += index == next_new ? 1 : 0;
+    }
+    zv_check(first_use_order);
+    zv_check(next_new == num_kept);
+    zv_check(get_sorted_triangles(vertices.data(), indices.data(), indices.size()) == expected_triangles);
+}
+
+zv_test(optimize_mesh_reports_stats)
+{
+    TestRandom random{};
+    MeshGeometryData grid = make_grid_mesh(64);
+    shuffle_triangles(&grid.m_indices, &random);
+    grid.m_lods.push_back(MeshLod{ grid.m_indices, 0.0f });
+
+    MeshOptimizationStats stats{};
+    optimize_mesh(&grid, &stats);
+
+    zv_check(stats.m_before.m_num_triangles == stats.m_after.m_num_triangles);
+    zv_check(stats.m_after.get_acmr() < stats.m_before.get_acmr());
+    zv_check(stats.m_num_removed_vertices == 0);
+    zv_check(grid.m_lods.empty());
+}
+
+zv_test(simplify_mesh_reports_rms_error)
+{
+    // Collapses inside a flat plane move nothing off it
+    MeshGeometryData plane = make_grid_mesh(32);
+    for (MeshVertex& vertex : plane.m_vertices)
+    {
+        vertex.position.z = 0.0f;
+    }
+    DynamicArray<u16> indices(plane.m_indices.size());
+    f32 rms_error = -1.0f;
+    const u32 count = simplify_mesh(indices.data(), plane.m_indices.data(), plane.m_indices.size(),
+                                    plane.m_vertices.data(), plane.m_vertices.size(), 0, 1e-4f, &rms_error);
+    zv_check(count < plane.m_indices.size() / 4);
+    zv_check(rms_error >= 0.0f && rms_error < 1e-4f);
+
+    // The curved grid gets coarser level by level, with RMS errors that never shrink and stay within the limit
+    MeshGeometryData grid = make_grid_mesh(64);
+    const LodChainSettings settings{};
+    generate_mesh_lods(&grid, settings);
+    const f32 max_error = settings.m_max_relative_error * ZV::sqrt(64.0f * 64.0f * 2.0f + 0.2f * 0.2f);
+    zv_check(!grid.m_lods.empty());
+
+    size_t previous_count = grid.m_indices.size();
+    f32 previous_error = 0.0f;
+    u32 num_bad_levels = 0;
+    for (const MeshLod& lod : grid.m_lods)
+    {
+        num_bad_levels += lod.m_indices.size() >= previous_count || lod.m_rms_error < previous_error || lod.m_rms_error > max_error ? 1 : 0;
+        previous_count = lod.m_indices.size();
+        previous_error = lod.m_rms_error;
+    }
+    zv_check(num_bad_levels == 0);
+    zv_check(grid.m_lods.back().m_rms_error > 0.0f);
+}
+
+zv_test(simplify_mesh_and_lod_chains_are_deterministic)
+{
+    // Ties between equal collapse costs are broken by vertex and triangle order, never by memory addresses
+    const MeshGeometryData grid = make_grid_mesh(48);
+    DynamicArray<u16> first(grid.m_indices.size());
+    DynamicArray<u16> second(grid.m_indices.size());
+    f32 first_error = 0.0f;
+    f32 second_error = 0.0f;
+    const u32 first_count = simplify_mesh(first.data(), grid.m_indices.data(), grid.m_indices.size(),
+                                          grid.m_vertices.data(), grid.m_vertices.size(), grid.m_indices.size() / 8, 1.0f, &first_error);
+    const u32 second_count = simplify_mesh(second.data(), grid.m_indices.data(), grid.m_indices.size(),
+                                           grid.m_vertices.data(), grid.m_vertices.size(), grid.m_indices.size() / 8, 1.0f, &second_error);
+    zv_check(first_count == second_count && first_error == second_error);
+    zv_check(memcmp(first.data(), second.data(), first_count * sizeof(u16)) == 0);
+
+    // Whole chains, with every level simplified again from LOD 0
+    MeshGeometryData first_sphere = make_sphere_mesh(64, 32);
+    MeshGeometryData second_sphere = first_sphere;
+    generate_mesh_lods(&first_sphere);
+    generate_mesh_lods(&second_sphere);
+    zv_check(!first_sphere.m_lods.empty() && first_sphere.m_lods.size() == second_sphere.m_lods.size());
+
+    u32 num_different_levels = 0;
+    for (size_t lod = 0; lod < ZV::min(first_sphere.m_lods.size(), second_sphere.m_lods.size()); lod++)
+    {
+        num_different_levels += first_sphere.m_lods[lod].m_indices != second_sphere.m_lods[lod].m_indices ||
+            first_sphere.m_lods[lod].m_rms_error != second_sphere.m_lods[lod].m_rms_error ? 1 : 0;
+    }
+    zv_check(num_different_levels == 0);
+}
+
+zv_test(simplify_mesh_keeps_seams_closed)
+{
+    // The uv sphere's seam column and pole rows are copies of other vertices. Seam vertices slide along the seam with their
+    // copy, so the sphere gets coarse along the seam as well and stays closed.
+    const MeshGeometryData sphere = make_sphere_mesh(64, 32);
+    zv_check(count_open_position_edges(sphere.m_vertices.data(), sphere.m_vertices.size(), sphere.m_indices.data(), sphere.m_indices.size()) == 0);
+
+    DynamicArray<u16> indices(sphere.m_indices.size());
+    const u32 count = simplify_mesh(indices.data(), sphere.m_indices.data(), sphere.m_indices.size(),
+                                    sphere.m_vertices.data(), sphere.m_vertices.size(), sphere.m_indices.size() / 8, 1.0f);
+    zv_check(count <= sphere.m_indices.size() / 8);
+    zv_check(count_open_position_edges(sphere.m_vertices.data(), sphere.m_vertices.size(), indices.data(), count) == 0);
+
+    // Columns 0 and 64 are the two sides of the seam, away from the poles
+    u32 num_seam_rows_left = 0;
+    for (u32 row = 1; row < 32; row++)
+    {
+        const u16 seam_vertex = static_cast<u16>(row * 65 + 64);
+        num_seam_rows_left += std::find(indices.begin(), indices.begin() + count, seam_vertex) != indices.begin() + count ? 1 : 0;
+    }
+    zv_check(num_seam_rows_left < 31 / 2);
+}
+
+zv_test(lod_chain_of_an_imported_mesh)
+{
+    // DamagedHelmet is split along uv seams all over and has open borders, which stay put and bound how far it reduces
+    const MeshGeometryData& helmet = get_damaged_helmet_mesh();
+    zv_check(!helmet.m_indices.empty());
+
+    MeshGeometryData geometry = helmet;
+    const LodChainSettings settings{};
+    generate_mesh_lods(&geometry, settings);
+    zv_check(geometry.m_lods.size() >= 2);
+    zv_check(!geometry.m_lods.empty() && geometry.m_lods.back().m_indices.size() * 2 < geometry.m_indices.size());
+
+    MeshGeometryData again = helmet;
+    generate_mesh_lods(&again, settings);
+    zv_check(again.m_lods.size() == geometry.m_lods.size() && again.m_lods.back().m_indices == geometry.m_lods.back().m_indices);
+
+    const f32 max_error = settings.m_max_relative_error * (geometry.m_bounds.m_max - geometry.m_bounds.m_min).Length();
+    const u32 num_open_edges = count_open_position_edges(geometry.m_vertices.data(), geometry.m_vertices.size(), geometry.m_indices.data(), geometry.m_indices.size());
+
+    size_t previous_count = geometry.m_indices.size();
+    f32 previous_error = 0.0f;
+    u32 num_bad_levels = 0;
+    u32 num_bad_triangles = 0;
+    for (const MeshLod& lod : geometry.m_lods)
+    {
+        // Coarser levels deviate further from LOD 0 and open no new cracks along the seams
+        num_bad_levels += lod.m_indices.size() >= previous_count || lod.m_rms_error <= previous_error || lod.m_rms_error > max_error ? 1 : 0;
+        num_bad_levels += count_open_position_edges(geometry.m_vertices.data(), geometry.m_vertices.size(), lod.m_indices.data(), lod.m_indices.size()) > num_open_edges ? 1 : 0;
+        previous_count = lod.m_indices.size();
+        previous_error = lod.m_rms_error;
+
+        for (size_t i = 0; i + 2 < lod.m_indices.size(); i += 3)
+        {
+            const u16 a = lod.m_indices[i];
+            const u16 b = lod.m_indices[i + 1];
+            const u16 c = lod.m_indices[i + 2];
+            num_bad_triangles += a == b || b == c || a == c || ZV::max(a, ZV::max(b, c)) >= geometry.m_vertices.size() ? 1 : 0;
+        }
+    }
+    zv_check(num_bad_levels == 0);
+    zv_check(num_bad_triangles == 0);
+}
+
+zv_benchmark(optimize_mesh_180x180)
+{
+    TestRandom random{};
+    MeshGeometryData source = make_grid_mesh(180);
+    shuffle_triangles(&source.m_indices, &random);
+
+    const f64 milliseconds = measure_best_ms(5, [&]()
+    {
+        MeshGeometryData geometry = source;
+        optimize_mesh(&geometry);
+    });
+    report_timing("optimize_mesh, 64800 triangles", milliseconds);
+}
+
+namespace
+{
+    // Limits, bounding spheres, conservative cone culling and every triangle of the mesh appearing exactly once
+    void check_meshlets(TestContext* context, const MeshGeometryData& geometry, const MeshletData& meshlets)
+    {
+        DynamicArray<u16> meshlet_indices{};
+        u32 num_over_limit = 0;
+        u32 num_outside_sphere = 0;
+        u32 num_wrong_culls = 0;
+        u32 num_culls = 0;
+
+        TestRandom random{};
+        for (const Meshlet& meshlet : meshlets.m_meshlets)
+        {
+            num_over_limit += meshlet.m_vertex_count > k_meshlet_max_vertices || meshlet.m_triangle_count > k_meshlet_max_triangles ? 1 : 0;
+
+            for (u32 corner = 0; corner < meshlet.m_triangle_count * 3; corner++)
+            {
+                const u8 local_index = meshlets.m_triangles[meshlet.m_triangle_offset * 3 + corner];
+                num_over_limit += local_index >= meshlet.m_vertex_count ? 1 : 0;
+                meshlet_indices.push_back(meshlets.m_vertices[meshlet.m_vertex_offset + local_index]);
+            }
+
+            for (u32 i = 0; i < meshlet.m_vertex_count; i++)
+            {
+                const Vector3& position = geometry.m_vertices[meshlets.m_vertices[meshlet.m_vertex_offset + i]].position;
+                num_outside_sphere += Vector3::Distance(meshlet.m_center, position) > meshlet.m_radius * 1.0001f + 1e-6f ? 1 : 0;
+            }
+
+            // A culled meshlet must not have a single triangle facing the viewer
+            for (u32 view = 0; view < 64; view++)
+            {
+                const Vector3 view_position(random.next_f32(-150.0f, 150.0f), random.next_f32(-150.0f, 150.0f), random.next_f32(-150.0f, 150.0f));
+                if (!is_meshlet_backfacing(meshlet, view_position))
+                {
+                    continue;
+                }
+                num_culls++;
+
+                for (u32 triangle = 0; triangle < meshlet.m_triangle_count; triangle++)
+                {
+                    Vector3 corners[3];
+                    for (u32 corner = 0; corner < 3; corner++)
+                    {
+                        const u8 local_index = meshlets.m_triangles[(meshlet.m_triangle_offset + triangle) * 3 + corner];
+                        corners[corner] = geometry.m_vertices[meshlets.m_vertices[meshlet.m_vertex_offset + local_index]].position;
+                    }
+                    const Vector3 normal = (corners[1] - corners[0]).Cross(corners[2] - corners[0]);
+                    num_wrong_culls += normal.Dot(corners[0] - view_position) < -1e-5f ? 1 : 0;
+                }
+            }
+        }
+
+        zv_check(num_over_limit == 0);
+        zv_check(num_outside_sphere == 0);
+        zv_check(num_culls > 0 && num_wrong_culls == 0);
+        zv_check(get_sorted_triangles(geometry.m_vertices.data(), meshlet_indices.data(), meshlet_indices.size()) ==
+                 get_sorted_triangles(geometry.m_vertices.data(), geometry.m_indices.data(), geometry.m_indices.size()));
+    }
+}
+
+zv_test(meshlets_cover_every_triangle_within_limits)
+{
+    MeshGeometryData grid = make_grid_mesh(64);
+    optimize_mesh(&grid);
+    MeshletData grid_meshlets{};
+    build_meshlets(grid, &grid_meshlets);
+    check_meshlets(context, grid, grid_meshlets);
+
+    // A 64x64 quad grid has 8192 triangles, well filled meshlets need few more than 8192 / 124
+    const MeshletStats grid_stats = analyze_meshlets(grid_meshlets);
+    zv_check(grid_stats.m_num_triangles == 8192);
+    zv_check(grid_stats.m_num_meshlets < 90);
+    zv_check(grid_stats.get_triangle_fill() > 0.75f);
+
+    MeshGeometryData sphere = make_sphere_mesh(64, 32);
+    optimize_mesh(&sphere);
+    MeshletData sphere_meshlets{};
+    build_meshlets(sphere, &sphere_meshlets);
+    check_meshlets(context, sphere, sphere_meshlets);
+
+    // Small patches of a sphere have narrow normal cones
+    const MeshletStats sphere_stats = analyze_meshlets(sphere_meshlets);
+    zv_check(sphere_stats.m_num_cullable > sphere_stats.m_num_meshlets / 2);
+}
+
+zv_benchmark(build_meshlets_180x180)
+{
+    MeshGeometryData geometry = make_grid_mesh(180);
+    optimize_mesh(&geometry);
+
+    MeshletData meshlets{};
+    const f64 milliseconds = measure_best_ms(5, [&]()
+    {
+        build_meshlets(geometry, &meshlets);
+    });
+    report_timing("build_meshlets, 64800 triangles", milliseconds);
+}
+
+zv_test(repair_mesh_leaves_clean_meshes_alone)
+{
+    MeshGeometryData grid = make_grid_mesh(16);
+    const MeshGeometryData original = grid;
+
+    MeshRepairStats stats{};
+    repair_mesh(&grid, &stats);
+    zv_check(stats.m_num_welded_vertices == 0 && stats.m_num_removed_vertices == 0 && stats.m_num_fixed_vertices == 0);
+    zv_check(stats.get_num_dropped_triangles() == 0);
+    zv_check(grid.m_indices == original.m_indices);
+    zv_check(grid.m_vertices.size() == original.m_vertices.size());
+    zv_check(memcmp(grid.m_vertices.data(), original.m_vertices.data(), grid.vertices_size()) == 0);
+}
+
+zv_test(repair_mesh_fixes_crafted_bad_meshes)
+{
+    // A flat grid, so three vertices of a row make a zero area triangle
+    MeshGeometryData clean = make_grid_mesh(4);
+    for (MeshVertex& vertex : clean.m_vertices)
+    {
+        vertex.position.z = 0.0f;
+    }
+
+    MeshGeometryData bad = clean;
+    const f32 nan = std::numeric_limits<f32>::quiet_NaN();
+    bad.m_vertices.push_back(clean.m_vertices[6]);  // 25, exact copy
+    bad.m_vertices.push_back(clean.m_vertices[7]);  // 26, a copy once its normal is reset
+    bad.m_vertices.back().normal.y = nan;
+    bad.m_vertices.push_back(clean.m_vertices[8]);  // 27, unusable position
+    bad.m_vertices.back().position.x = nan;
+    bad.m_vertices.push_back(clean.m_vertices[9]);  // 28, no triangle uses it
+    bad.m_vertices.back().position = Vector3(9.0f, 9.0f, 9.0f);
+
+    // Let the first two triangles that use 6 and 7 use the copies instead
+    size_t first_use_of_6 = std::find(bad.m_indices.begin(), bad.m_indices.end(), 6) - bad.m_indices.begin();
+    size_t first_use_of_7 = std::find(bad.m_indices.begin(), bad.m_indices.end(), 7) - bad.m_indices.begin();
+    bad.m_indices[first_use_of_6] = 25;
+    bad.m_indices[first_use_of_7] = 26;
+
+    bad.m_indices.insert(bad.m_indices.end(), {
+        27, 0, 1,     // Unusable position
+        0, 1, 200,    // Out of range
+        6, 25, 7,     // Degenerate once 25 is welded onto 6
+        0, 0, 1,      // Degenerate
+        0, 1, 2,      // On a line
+        3, 4 });      // Partial triangle
+
+    MeshRepairStats stats{};
+    repair_mesh(&bad, &stats);
+    zv_check(stats.m_num_welded_vertices == 2);
+    zv_check(stats.m_num_removed_vertices == 2);
+    zv_check(stats.m_num_fixed_vertices == 1);
+    zv_check(stats.m_num_invalid_triangles == 3);
+    zv_check(stats.m_num_degenerate_triangles == 2);
+    zv_check(stats.m_num_zero_area_triangles == 1);
+
+    // What remains is the clean grid, vertex order included
+    zv_check(bad.m_vertices.size() == clean.m_vertices.size());
+    zv_check(memcmp(bad.m_vertices.data(), clean.m_vertices.data(), clean.vertices_size()) == 0);
+    zv_check(bad.m_indices == clean.m_indices);
+    zv_check(bad.m_bounds.m_min == Vector3(0.0f, 0.0f, 0.0f) && bad.m_bounds.m_max == Vector3(4.0f, 4.0f, 0.0f));
+}
+
+zv_benchmark(repair_mesh_200x200)
+{
+    // Some corners use duplicated vertices and one triangle in a hundred is degenerate, so all the passes have work
+    MeshGeometryData source = make_grid_mesh(200);
+    for (size_t i = 0; i < source.m_indices.size(); i += 30)
+    {
+        const u16 index = source.m_indices[i];
+        if (index % 10 == 0)
+        {
+            source.m_vertices.push_back(source.m_vertices[index]);
+            source.m_indices[i] = static_cast<u16>(source.m_vertices.size() - 1);
+        }
+    }
+    for (size_t i = 0; i < source.m_indices.size(); i += 300)
+    {
+        source.m_indices[i + 1] = source.m_indices[i];
+    }
+
+    MeshRepairStats stats{};
+    const f64 milliseconds = measure_best_ms(10, [&]()
+    {
+        MeshGeometryData geometry = source;
+        repair_mesh(&geometry, &stats);
+    });
+    report_timing("repair_mesh, 80000 triangles, copy included", milliseconds);
+    report_count("welded vertices", stats.m_num_welded_vertices);
+    report_count("dropped triangles", stats.get_num_dropped_triangles());
+}
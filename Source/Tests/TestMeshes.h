@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Tests/Test.h>
+
+#include <Geometry.h>
+#include <GltfImport.h>
+
+// Meshes built directly, so the tests of one module don't depend on the primitive generators of another
+
+// num_segments x num_segments quads in the xy plane, gently curved in z so no two face normals are the same
+inline MeshGeometryData make_grid_mesh(u32 num_segments)
+{
+    MeshGeometryData geometry{};
+    for (u32 y = 0; y <= num_segments; y++)
+    {
+        for (u32 x = 0; x <= num_segments; x++)
+        {
+            MeshVertex vertex{};
+            vertex.position = Vector3(static_cast<f32>(x), static_cast<f32>(y), 0.1f * std::sin(static_cast<f32>(x) * 0.3f));
+            vertex.uv = Vector2(static_cast<f32>(x) / static_cast<f32>(num_segments), static_cast<f32>(y) / static_cast<f32>(num_segments));
+            vertex.normal = Vector3(0.0f, 0.0f, 1.0f);
+            vertex.tangent = Vector4(1.0f, 0.0f, 0.0f, 1.0f);
+            geometry.m_vertices.push_back(vertex);
+        }
+    }
+
+    for (u32 y = 0; y < num_segments; y++)
+    {
+        for (u32 x = 0; x < num_segments; x++)
+        {
+            const u16 a = static_cast<u16>(y * (num_segments + 1) + x);
+            const u16 b = static_cast<u16>(a + 1);
+            const u16 c = static_cast<u16>(a + num_segments + 1);
+            const u16 d = static_cast<u16>(c + 1);
+            geometry.m_indices.insert(geometry.m_indices.end(), { a, b, d, a, d, c });
+        }
+    }
+    return geometry;
+}
+
+// Unit uv sphere with the seam column and the pole rows duplicated, the way create_sphere lays it out
+inline MeshGeometryData make_sphere_mesh(u32 width_segments, u32 height_segments)
+{
+    MeshGeometryData geometry{};
+    for (u32 y = 0; y <= height_segments; y++)
+    {
+        for (u32 x = 0; x <= width_segments; x++)
+        {
+            const f32 u = static_cast<f32>(x) / static_cast<f32>(width_segments);
+            const f32 v = static_cast<f32>(y) / static_cast<f32>(height_segments);
+            const f32 theta = u * ZV_2PI;
+            const f32 phi = v * ZV_PI;
+
+            MeshVertex vertex{};
+            vertex.position = Vector3(-std::cos(theta) * std::sin(phi), std::cos(phi), std::sin(theta) * std::sin(phi));
+            if (x == width_segments)
+            {
+                vertex.position = geometry.m_vertices[y * (width_segments + 1)].position;
+            }
+            if (y == 0 || y == height_segments)
+            {
+                vertex.position = Vector3(0.0f, y == 0 ? 1.0f : -1.0f, 0.0f);
+            }
+            vertex.uv = Vector2(u, v);
+            vertex.normal = vertex.position;
+            vertex.tangent = Vector4(std::sin(theta), 0.0f, std::cos(theta), 1.0f);
+            geometry.m_vertices.push_back(vertex);
+        }
+    }
+
+    for (u32 y = 0; y < height_segments; y++)
+    {
+        for (u32 x = 0; x < width_segments; x++)
+        {
+            const u16 a = static_cast<u16>(y * (width_segments + 1) + x + 1);
+            const u16 b = static_cast<u16>(y * (width_segments + 1) + x);
+            const u16 c = static_cast<u16>((y + 1) * (width_segments + 1) + x);
+            const u16 d = static_cast<u16>((y + 1) * (width_segments + 1) + x + 1);
+            if (y != 0)
+            {
+                geometry.m_indices.insert(geometry.m_indices.end(), { a, b, d });
+            }
+            if (y != height_segments - 1)
+            {
+                geometry.m_indices.insert(geometry.m_indices.end(), { b, c, d });
+            }
+        }
+    }
+    return geometry;
+}
+
+// Fisher-Yates over whole triangles, the order an unoptimized exporter might leave
+inline void shuffle_triangles(DynamicArray<u16>* indices, TestRandom* random)
+{
+    const u32 num_triangles = static_cast<u32>(indices->size() / 3);
+    for (u32 i = num_triangles; i > 1; i--)
+    {
+        const u32 j = random->next_u32() % i;
+        for (u32 corner = 0; corner < 3; corner++)
+        {
+            std::swap((*indices)[(i - 1) * 3 + corner], (*indices)[j * 3 + corner]);
+        }
+    }
+}
+
+// Triangles by the positions of their corners, rotated so the smallest corner comes first, and sorted. Equal for two
+// index lists that draw the same triangles in any order, even after vertices were renumbered.
+inline DynamicArray<StaticArray<f32, 9>> get_sorted_triangles(const MeshVertex* vertices, const u16* indices, size_t num_indices)
+{
+    DynamicArray<StaticArray<f32, 9>> triangles{};
+    for (size_t i = 0; i + 2 < num_indices; i += 3)
+    {
+        StaticArray<f32, 9> corners{};
+        for (u32 corner = 0; corner < 3; corner++)
+        {
+            const Vector3& position = vertices[indices[i + corner]].position;
+            corners[corner * 3 + 0] = position.x;
+            corners[corner * 3 + 1] = position.y;
+            corners[corner * 3 + 2] = position.z;
+        }
+
+        // Keep the winding, only rotate the corners
+        StaticArray<f32, 9> best = corners;
+        for (u32 rotation = 1; rotation < 3; rotation++)
+        {
+            StaticArray<f32, 9> rotated{};
+            for (u32 corner = 0; corner < 3; corner++)
+            {
+                for (u32 axis = 0; axis < 3; axis++)
+                {
+                    rotated[corner * 3 + axis] = corners[((corner + rotation) % 3) * 3 + axis];
+                }
+            }
+            best = rotated < best ? rotated : best;
+        }
+        triangles.push_back(best);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// DamagedHelmet's one mesh, read the way the asset import reads it. Loaded once, empty when the file is missing.
+inline const MeshGeometryData& get_damaged_helmet_mesh()
+{
+    static const MeshGeometryData s_mesh = []()
+    {
+        DynamicArray<MeshGeometryData> geometries{};
+        load_gltf_mesh_geometries(ZV_TEST_ASSET_DIR "Models/DamagedHelmet/DamagedHelmet.gltf", &geometries);
+        return geometries.size() == 1 ? geometries.front() : MeshGeometryData{};
+    }();
+    return s_mesh;
+}
@@ -0,0 +1,30 @@
+#include <Platform/Platform.h>
+
+// The tests link the modules without the platform layer and its renderer. Work is split into the same batches but runs
+// on the calling thread, which is what Platform::parallel_for does before the worker threads exist. Benchmarks therefore
+// time a single core. The reported worker count can be raised, so tests can check that modules which split their work by
+// it give the same results for any thread count.
+
+namespace
+{
+    u32 s_num_test_worker_threads = 0;
+}
+
+void set_test_worker_thread_count(u32 num_threads)
+{
+    s_num_test_worker_threads = num_threads;
+}
+
+void Platform::parallel_for(u32 count, u32 batch_size, ParallelForCallback* callback, void* data)
+{
+    batch_size = ZV::max(batch_size, 1u);
+    for (u32 begin = 0; begin < count; begin += batch_size)
+    {
+        callback(begin, ZV::min(begin + batch_size, count), data);
+    }
+}
+
+u32 Platform::get_worker_thread_count()
+{
+    return s_num_test_worker_threads;
+}
@@ -0,0 +1,134 @@
+#include <Tests/Test.h>
+
+#include <RenderQueue.h>
+
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+    // Keys the way a frame builds them, a tenth transparent and a seventh sharing their low bits so equal keys show up
+    void fill_render_queue(RenderQueue* queue, u32 count, bool render_keys, TestRandom* random)
+    {
+        queue->clear();
+        for (u32 i = 0; i < count; i++)
+        {
+            u64 key = (static_cast<u64>(random->next_u32()) << 32) | random->next_u32();
+            if (render_keys)
+            {
+                const u32 pipeline = random->next_u32() % 2;
+                const u32 material = random->next_u32() % 300;
+                const u32 geometry = random->next_u32() % 500;
+                const f32 depth = random->next_f32(0.1f, 300.0f);
+                key = i % 10 == 0 ? make_transparent_sort_key(0, material, geometry, depth) : make_opaque_sort_key(pipeline, geometry, depth);
+            }
+            if (i % 7 == 0)
+            {
+                key &= ~0xFFFFull;
+            }
+            queue->push(key, i);
+        }
+    }
+
+    DynamicArray<RenderQueueEntry> sort_reference(const DynamicArray<RenderQueueEntry>& entries)
+    {
+        DynamicArray<RenderQueueEntry> sorted = entries;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const RenderQueueEntry& a, const RenderQueueEntry& b) { return a.m_key < b.m_key; });
+        return sorted;
+    }
+
+    bool are_entries_equal(const DynamicArray<RenderQueueEntry>& a, const DynamicArray<RenderQueueEntry>& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (a[i].m_key != b[i].m_key || a[i].m_item != b[i].m_item)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+zv_test(render_queue_sort_matches_stable_sort)
+{
+    TestRandom random{};
+    RenderQueue queue{};
+    for (u32 count : { 0u, 1u, 2u, 255u, 257u, 20000u })
+    {
+        for (bool render_keys : { false, true })
+        {
+            fill_render_queue(&queue, count, render_keys, &random);
+            const DynamicArray<RenderQueueEntry> expected = sort_reference(queue.m_entries);
+            queue.sort();
+            zv_check(are_entries_equal(queue.m_entries, expected));
+        }
+    }
+
+    // Every key equal, the sort must keep the submission order
+    queue.clear();
+    for (u32 i = 0; i < 1000; i++)
+    {
+        queue.push(42, i);
+    }
+    const DynamicArray<RenderQueueEntry> expected = queue.m_entries;
+    queue.sort();
+    zv_check(are_entries_equal(queue.m_entries, expected));
+}
+
+zv_test(sort_keys_order_passes_and_depths)
+{
+    const u64 opaque_near = make_opaque_sort_key(0, 1, 1.0f);
+    const u64 opaque_far = make_opaque_sort_key(0, 1, 100.0f);
+    const u64 opaque_behind = make_opaque_sort_key(0, 1, -5.0f);
+    const u64 transparent_near = make_transparent_sort_key(0, 1, 1, 1.0f);
+    const u64 transparent_far = make_transparent_sort_key(0, 1, 1, 100.0f);
+
+    zv_check(opaque_near < opaque_far);
+    zv_check(opaque_behind < opaque_near);
+    zv_check(opaque_behind == make_opaque_sort_key(0, 1, 0.0f));
+    zv_check(transparent_far < transparent_near);
+    zv_check(opaque_far < transparent_far);
+    zv_check(get_sort_key_pass(opaque_far) == RenderPass::Opaque);
+    zv_check(get_sort_key_pass(transparent_near) == RenderPass::Transparent);
+
+    // Opaque draws order by pipeline, then front to back by powers of two, grouping geometries within each of those
+    zv_check(make_opaque_sort_key(0, 9, 1.0f) < make_opaque_sort_key(1, 0, 1.0f));
+    zv_check(make_opaque_sort_key(0, 9, 3.0f) < make_opaque_sort_key(0, 1, 20.0f));
+    zv_check(make_opaque_sort_key(0, 1, 15.0f) < make_opaque_sort_key(0, 2, 9.0f));
+    zv_check(make_opaque_sort_key(0, 2, 9.0f) < make_opaque_sort_key(0, 2, 10.0f));
+
+    // Depth before state for transparent draws
+    zv_check(make_transparent_sort_key(1, 9, 9, 100.0f) < make_transparent_sort_key(0, 0, 0, 1.0f));
+
+    // Infinite depths sort after every finite one and stay inside the depth field
+    zv_check(make_opaque_sort_key(0, 0, FLT_MAX) <= make_opaque_sort_key(0, 0, INFINITY));
+    zv_check(get_sort_key_pass(make_opaque_sort_key(255, 0xFFFFFF, INFINITY)) == RenderPass::Opaque);
+}
+
+zv_benchmark(render_queue_sort_100k)
+{
+    TestRandom random{};
+    RenderQueue queue{};
+    for (bool render_keys : { false, true })
+    {
+        fill_render_queue(&queue, 100000, render_keys, &random);
+        const DynamicArray<RenderQueueEntry> unsorted = queue.m_entries;
+
+        const f64 radix_ms = measure_best_ms(20, [&]()
+        {
+            queue.m_entries = unsorted;
+            queue.sort();
+        });
+        const f64 stable_sort_ms = measure_best_ms(20, [&]()
+        {
+            queue.m_entries = sort_reference(unsorted);
+        });
+        report_timing(render_keys ? "radix sort, 100000 render keys" : "radix sort, 100000 random keys", radix_ms);
+        report_timing(render_keys ? "std::stable_sort, 100000 render keys" : "std::stable_sort, 100000 random keys", stable_sort_ms);
+    }
+}
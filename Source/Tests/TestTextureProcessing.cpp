@@ -0,0 +1,956 @@
+#include <Tests/Test.h>
+
+#include <TextureProcessing.h>
+
+#include <climits>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    UniquePtr<TextureAsset> make_test_texture(u32 width, u32 height, u32 num_channels, TextureFormat format, TestRandom* random, u32 mip_levels = 1)
+    {
+        UniquePtr<TextureAsset> texture = make_unique_ptr<TextureAsset>();
+        texture->m_width = width;
+        texture->m_height = height;
+        texture->m_num_channels = num_channels;
+        texture->m_dimension = TextureDimension::Texture2D;
+        texture->m_format = format;
+        texture->m_mip_levels = static_cast<u16>(mip_levels);
+        texture->m_data = make_unique_ptr<u8[]>(texture->get_data_size());
+
+        u8* data = texture->m_data.get();
+        for (size_t i = 0; i < texture->get_data_size(); i++)
+        {
+            data[i] = random ? static_cast<u8>(random->next_u32() >> 24) : static_cast<u8>(37 + 50 * (i % num_channels));
+        }
+        return texture;
+    }
+
+    // Largest difference of any level after the first to the reference downsample of the level above it
+    s32 get_max_reference_error(const TextureAsset& texture, const MipGenerationSettings& settings)
+    {
+        s32 max_error = 0;
+        for (u32 mip = 1; mip < texture.m_mip_levels; mip++)
+        {
+            DynamicArray<u8> expected(texture.get_mip_size(mip));
+            downsample_mip_level_reference(
+                texture.m_data.get() + texture.get_mip_offset(mip - 1), texture.get_mip_width(mip - 1), texture.get_mip_height(mip - 1),
+                expected.data(), texture.get_mip_width(mip), texture.get_mip_height(mip),
+                texture.m_num_channels, settings);
+
+            const u8* actual = texture.m_data.get() + texture.get_mip_offset(mip);
+            for (size_t i = 0; i < expected.size(); i++)
+            {
+                max_error = ZV::max(max_error, ZV::abs(static_cast<s32>(expected[i]) - static_cast<s32>(actual[i])));
+            }
+        }
+        return max_error;
+    }
+
+    struct BlockBitReader
+    {
+        const u8* m_data = nullptr;
+        u32 m_bit_offset = 0;
+
+        u32 read(u32 num_bits)
+        {
+            u32 value = 0;
+            for (u32 bit = 0; bit < num_bits; bit++, m_bit_offset++)
+            {
+                value |= ((m_data[m_bit_offset >> 3] >> (m_bit_offset & 7u)) & 1u) << bit;
+            }
+            return value;
+        }
+    };
+
+    u32 expand_bits(u32 value, u32 num_bits)
+    {
+        return (value << (8 - num_bits)) | (value >> (2 * num_bits - 8));
+    }
+
+    void read_bc7_indices(BlockBitReader* reader, u32 index_bits, u32* indices)
+    {
+        indices[0] = reader->read(index_bits - 1);
+        for (u32 i = 1; i < 16; i++)
+        {
+            indices[i] = reader->read(index_bits);
+        }
+    }
+
+    u32 interpolate_bc7(u32 endpoint0, u32 endpoint1, u32 index, u32 index_bits)
+    {
+        static const u32 k_weights2[4] = { 0, 21, 43, 64 };
+        static const u32 k_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+        static const u32 k_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        const u32 weight = index_bits == 2 ? k_weights2[index] : index_bits == 3 ? k_weights3[index] : k_weights4[index];
+        return ((64 - weight) * endpoint0 + weight * endpoint1 + 32) >> 6;
+    }
+
+    // Decoder for the single subset modes the encoder writes, returns the mode or UINT_MAX for any other
+    u32 decode_bc7_block(const u8* block, u8 (*texels)[4])
+    {
+        BlockBitReader reader{ block };
+        u32 mode = 0;
+        while (mode < 8 && reader.read(1) == 0)
+        {
+            mode++;
+        }
+
+        u32 endpoints[2][4] = {};
+        u32 color_indices[16] = {};
+        u32 alpha_indices[16] = {};
+        u32 color_index_bits = 0;
+        u32 alpha_index_bits = 0;
+        u32 rotation = 0;
+
+        if (mode == 6)
+        {
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                endpoints[0][channel] = reader.read(7) << 1;
+                endpoints[1][channel] = reader.read(7) << 1;
+            }
+            const u32 pbits[2] = { reader.read(1), reader.read(1) };
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                endpoints[0][channel] |= pbits[0];
+                endpoints[1][channel] |= pbits[1];
+            }
+            read_bc7_indices(&reader, 4, color_indices);
+            memcpy(alpha_indices, color_indices, sizeof(color_indices));
+            color_index_bits = alpha_index_bits = 4;
+        }
+        else if (mode == 4 || mode == 5)
+        {
+            rotation = reader.read(2);
+            const u32 index_mode = mode == 4 ? reader.read(1) : 0;
+            const u32 color_bits = mode == 4 ? 5 : 7;
+            const u32 alpha_bits = mode == 4 ? 6 : 8;
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                const u32 num_bits = channel < 3 ? color_bits : alpha_bits;
+                endpoints[0][channel] = expand_bits(reader.read(num_bits), num_bits);
+                endpoints[1][channel] = expand_bits(reader.read(num_bits), num_bits);
+            }
+
+            u32 indices2[16] = {};
+            u32 indices3[16] = {};
+            read_bc7_indices(&reader, 2, indices2);
+            read_bc7_indices(&reader, mode == 4 ? 3 : 2, mode == 4 ? indices3 : alpha_indices);
+            if (mode == 5)
+            {
+                memcpy(color_indices, indices2, sizeof(indices2));
+                color_index_bits = alpha_index_bits = 2;
+            }
+            else
+            {
+                memcpy(index_mode == 0 ? color_indices : alpha_indices, indices2, sizeof(indices2));
+                memcpy(index_mode == 0 ? alpha_indices : color_indices, indices3, sizeof(indices3));
+                color_index_bits = index_mode == 0 ? 2 : 3;
+                alpha_index_bits = index_mode == 0 ? 3 : 2;
+            }
+        }
+        else
+        {
+            return UINT_MAX;
+        }
+
+        for (u32 i = 0; i < 16; i++)
+        {
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                const bool is_alpha = channel == 3;
+                texels[i][channel] = static_cast<u8>(interpolate_bc7(endpoints[0][channel], endpoints[1][channel],
+                                                                     is_alpha ? alpha_indices[i] : color_indices[i],
+                                                                     is_alpha ? alpha_index_bits : color_index_bits));
+            }
+            if (rotation > 0)
+            {
+                std::swap(texels[i][rotation - 1], texels[i][3]);
+            }
+        }
+        return mode;
+    }
+
+    // Compresses a 4x4 RGBA block as BC7 and decodes it again, returns the mode it was encoded with
+    u32 round_trip_bc7_block(const u8 (*texels)[4], u8 (*decoded)[4])
+    {
+        UniquePtr<TextureAsset> texture = make_test_texture(4, 4, 4, TextureFormat::Linear, nullptr);
+        texture->m_usage = TextureUsage::Data;
+        memcpy(texture->m_data.get(), texels, 64);
+        compress_texture(texture.get(), TextureCompression::BC7);
+        return decode_bc7_block(texture->m_data.get() + texture->m_footprints[0].m_offset, decoded);
+    }
+
+    s32 get_max_block_error(const u8 (*expected)[4], const u8 (*actual)[4])
+    {
+        s32 max_error = 0;
+        for (u32 i = 0; i < 16; i++)
+        {
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                max_error = ZV::max(max_error, ZV::abs(static_cast<s32>(expected[i][channel]) - static_cast<s32>(actual[i][channel])));
+            }
+        }
+        return max_error;
+    }
+
+    // Color0 above color1 selects the four color ramp, otherwise the third color is the midpoint and the fourth transparent black
+    void decode_bc1_block(const u8* block, u8 (*texels)[4])
+    {
+        u16 packed[2] = {};
+        memcpy(packed, block, 4);
+
+        u32 colors[4][4] = {};
+        for (u32 endpoint = 0; endpoint < 2; endpoint++)
+        {
+            const u32 r = (packed[endpoint] >> 11) & 31u;
+            const u32 g = (packed[endpoint] >> 5) & 63u;
+            const u32 b = packed[endpoint] & 31u;
+            colors[endpoint][0] = (r << 3) | (r >> 2);
+            colors[endpoint][1] = (g << 2) | (g >> 4);
+            colors[endpoint][2] = (b << 3) | (b >> 2);
+            colors[endpoint][3] = 255;
+        }
+
+        for (u32 channel = 0; channel < 3; channel++)
+        {
+            if (packed[0] > packed[1])
+            {
+                colors[2][channel] = (2 * colors[0][channel] + colors[1][channel] + 1) / 3;
+                colors[3][channel] = (colors[0][channel] + 2 * colors[1][channel] + 1) / 3;
+            }
+            else
+            {
+                colors[2][channel] = (colors[0][channel] + colors[1][channel]) / 2;
+            }
+        }
+        colors[2][3] = 255;
+        colors[3][3] = packed[0] > packed[1] ? 255 : 0;
+
+        u32 indices = 0;
+        memcpy(&indices, block + 4, 4);
+        for (u32 i = 0; i < 16; i++)
+        {
+            const u32* color = colors[(indices >> (i * 2)) & 3u];
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                texels[i][channel] = static_cast<u8>(color[channel]);
+            }
+        }
+    }
+
+    // Value0 above value1 selects eight interpolated values, otherwise six with 0 and 255 as the last two
+    void decode_bc4_block(const u8* block, u32 channel, u8 (*texels)[4])
+    {
+        u32 values[8] = { block[0], block[1] };
+        for (u32 i = 2; i < 8; i++)
+        {
+            if (block[0] > block[1])
+            {
+                values[i] = ((8 - i) * values[0] + (i - 1) * values[1] + 3) / 7;
+            }
+            else if (i < 6)
+            {
+                values[i] = ((6 - i) * values[0] + (i - 1) * values[1] + 2) / 5;
+            }
+            else
+            {
+                values[i] = i == 6 ? 0 : 255;
+            }
+        }
+
+        u64 indices = 0;
+        memcpy(&indices, block + 2, 6);
+        for (u32 i = 0; i < 16; i++)
+        {
+            texels[i][channel] = static_cast<u8>(values[(indices >> (i * 3)) & 7u]);
+        }
+    }
+
+    // Decodes a mip of a BC1, BC4 or BC5 texture to RGBA, edge blocks are cropped to the texels inside the mip
+    DynamicArray<u8> decode_bc_mip(const TextureAsset& texture, u32 mip)
+    {
+        const TextureFootprint& footprint = texture.m_footprints[mip];
+        const u32 width = texture.get_mip_width(mip);
+        const u32 height = texture.get_mip_height(mip);
+        const u32 bytes_per_block = texture.get_bytes_per_block();
+
+        DynamicArray<u8> decoded(static_cast<size_t>(width) * height * 4);
+        for (u32 block_y = 0; block_y < footprint.m_num_rows; block_y++)
+        {
+            for (u32 block_x = 0; block_x < footprint.m_row_size / bytes_per_block; block_x++)
+            {
+                const u8* block = texture.m_data.get() + footprint.m_offset + block_y * footprint.m_row_pitch + block_x * bytes_per_block;
+                u8 texels[16][4] = {};
+                switch (texture.m_compression)
+                {
+                    case TextureCompression::BC1:
+                    {
+                        decode_bc1_block(block, texels);
+                        break;
+                    }
+                    case TextureCompression::BC4:
+                    {
+                        decode_bc4_block(block, 0, texels);
+                        break;
+                    }
+                    default:
+                    {
+                        decode_bc4_block(block, 0, texels);
+                        decode_bc4_block(block + 8, 1, texels);
+                        break;
+                    }
+                }
+
+                for (u32 i = 0; i < 16; i++)
+                {
+                    const u32 x = block_x * 4 + i % 4;
+                    const u32 y = block_y * 4 + i / 4;
+                    if (x < width && y < height)
+                    {
+                        memcpy(&decoded[(static_cast<size_t>(y) * width + x) * 4], texels[i], 4);
+                    }
+                }
+            }
+        }
+        return decoded;
+    }
+
+    // Compresses every mip of the texture and returns the RMS error over the channels the format stores
+    f32 round_trip_bc_texture(TextureAsset* texture, TextureCompression compression, s32* out_max_error)
+    {
+        const DynamicArray<u8> source(texture->m_data.get(), texture->m_data.get() + texture->get_data_size());
+        DynamicArray<size_t> source_offsets(texture->m_mip_levels);
+        for (u32 mip = 0; mip < texture->m_mip_levels; mip++)
+        {
+            source_offsets[mip] = texture->get_mip_offset(mip);
+        }
+
+        compress_texture(texture, compression);
+        const u32 num_compared_channels = compression == TextureCompression::BC1 ? 3 : compression == TextureCompression::BC4 ? 1 : 2;
+
+        f64 squared_error = 0.0;
+        size_t num_values = 0;
+        *out_max_error = 0;
+        for (u32 mip = 0; mip < texture->m_mip_levels; mip++)
+        {
+            const DynamicArray<u8> decoded = decode_bc_mip(*texture, mip);
+            const u8* expected = source.data() + source_offsets[mip];
+            for (size_t texel = 0; texel < decoded.size() / 4; texel++)
+            {
+                for (u32 channel = 0; channel < num_compared_channels; channel++)
+                {
+                    const s32 difference = static_cast<s32>(expected[texel * texture->m_num_channels + channel]) - static_cast<s32>(decoded[texel * 4 + channel]);
+                    *out_max_error = ZV::max(*out_max_error, ZV::abs(difference));
+                    squared_error += static_cast<f64>(difference * difference);
+                    num_values++;
+                }
+            }
+        }
+        return ZV::sqrt(static_cast<f32>(squared_error / static_cast<f64>(num_values)));
+    }
+
+    // Only the description, compute_texture_footprints doesn't read the data
+    TextureAsset make_footprint_texture(u32 width, u32 height, u32 num_channels, TextureCompression compression, u32 mip_levels, u32 array_size = 1)
+    {
+        TextureAsset texture{};
+        texture.m_width = width;
+        texture.m_height = height;
+        texture.m_num_channels = num_channels;
+        texture.m_dimension = TextureDimension::Texture2D;
+        texture.m_compression = compression;
+        texture.m_mip_levels = static_cast<u16>(mip_levels);
+        texture.m_array_size = static_cast<u16>(array_size);
+        return texture;
+    }
+
+    bool is_footprint(const TextureFootprint& footprint, u64 offset, u32 width, u32 height, u32 row_pitch, u32 num_rows, u32 row_size)
+    {
+        return footprint.m_offset == offset && footprint.m_width == width && footprint.m_height == height && footprint.m_depth == 1 &&
+            footprint.m_row_pitch == row_pitch && footprint.m_num_rows == num_rows && footprint.m_row_size == row_size;
+    }
+
+    // Number of placed rects that leave the atlas or overlap an earlier one
+    u32 count_bad_placements(const DynamicArray<AtlasRect>& rects, const DynamicArray<AtlasPlacement>& placements, u32 atlas_width, u32 atlas_height)
+    {
+        u32 num_bad = 0;
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            const bool is_inside = placements[i].m_x + rects[i].m_width <= atlas_width && placements[i].m_y + rects[i].m_height <= atlas_height;
+            bool is_overlapping = false;
+            for (size_t j = 0; j < i; j++)
+            {
+                is_overlapping |= placements[i].m_x < placements[j].m_x + rects[j].m_width && placements[j].m_x < placements[i].m_x + rects[i].m_width &&
+                    placements[i].m_y < placements[j].m_y + rects[j].m_height && placements[j].m_y < placements[i].m_y + rects[i].m_height;
+            }
+            num_bad += is_inside && !is_overlapping ? 0 : 1;
+        }
+        return num_bad;
+    }
+}
+
+zv_test(mip_level_count)
+{
+    zv_check(get_mip_level_count(1, 1) == 1);
+    zv_check(get_mip_level_count(256, 256) == 9);
+    zv_check(get_mip_level_count(256, 1) == 9);
+    zv_check(get_mip_level_count(5, 3) == 3);
+}
+
+zv_test(mip_chain_keeps_constant_images_constant)
+{
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        for (TextureFormat format : { TextureFormat::Linear, TextureFormat::SRGB })
+        {
+            UniquePtr<TextureAsset> texture = make_test_texture(64, 32, 4, format, nullptr);
+            MipGenerationSettings settings{};
+            settings.m_filter = filter;
+            settings.m_is_srgb = format == TextureFormat::SRGB;
+            generate_mip_chain(texture.get(), settings);
+
+            zv_check(texture->m_mip_levels == 7);
+            zv_check(texture->get_mip_width(6) == 1 && texture->get_mip_height(6) == 1);
+
+            u32 num_wrong_texels = 0;
+            const u8* data = texture->m_data.get();
+            for (size_t i = 0; i < texture->get_data_size(); i++)
+            {
+                num_wrong_texels += data[i] != data[i % 4] ? 1 : 0;
+            }
+            zv_check(num_wrong_texels == 0);
+        }
+    }
+}
+
+zv_test(mip_chain_matches_reference_downsample)
+{
+    TestRandom random{};
+    const u32 sizes[][2] = { { 64, 64 }, { 37, 19 }, { 1, 16 } };
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        for (u32 num_channels = 1; num_channels <= 4; num_channels++)
+        {
+            for (const auto& size : sizes)
+            {
+                UniquePtr<TextureAsset> texture = make_test_texture(size[0], size[1], num_channels, TextureFormat::SRGB, &random);
+                MipGenerationSettings settings{};
+                settings.m_filter = filter;
+                settings.m_is_srgb = num_channels >= 3;
+                generate_mip_chain(texture.get(), settings);
+
+                zv_check(texture->m_mip_levels == get_mip_level_count(size[0], size[1]));
+                // The linear to sRGB table can be off by one step in the darks
+                zv_check(get_max_reference_error(*texture, settings) <= 2);
+            }
+        }
+    }
+}
+
+zv_test(mip_chain_respects_max_levels)
+{
+    UniquePtr<TextureAsset> texture = make_test_texture(128, 128, 4, TextureFormat::Linear, nullptr);
+    MipGenerationSettings settings{};
+    settings.m_max_mip_levels = 3;
+    generate_mip_chain(texture.get(), settings);
+    zv_check(texture->m_mip_levels == 3);
+}
+
+zv_test(atlas_gutter_keeps_neighbours_out_of_every_mip)
+{
+    // The same entry next to different neighbours has to come out of the mip chain unchanged, including the texel around it
+    TestRandom random{};
+    UniquePtr<TextureAsset> entry = make_test_texture(32, 32, 4, TextureFormat::SRGB, &random);
+    UniquePtr<TextureAsset> black = make_test_texture(32, 32, 4, TextureFormat::SRGB, nullptr);
+    UniquePtr<TextureAsset> white = make_test_texture(32, 32, 4, TextureFormat::SRGB, nullptr);
+    memset(black->m_data.get(), 0, black->get_data_size());
+    memset(white->m_data.get(), 255, white->get_data_size());
+
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        MipGenerationSettings settings{};
+        settings.m_filter = filter;
+        settings.m_is_srgb = true;
+        settings.m_max_mip_levels = k_atlas_max_mip_levels;
+
+        const TextureAsset* black_sources[2] = { entry.get(), black.get() };
+        const TextureAsset* white_sources[2] = { entry.get(), white.get() };
+        TextureAsset black_atlas{};
+        TextureAsset white_atlas{};
+        Vector4 black_uv_transforms[2] = {};
+        Vector4 white_uv_transforms[2] = {};
+        zv_check(build_texture_atlas(black_sources, 2, settings, &black_atlas, black_uv_transforms));
+        zv_check(build_texture_atlas(white_sources, 2, settings, &white_atlas, white_uv_transforms));
+        generate_mip_chain(&black_atlas, settings);
+        generate_mip_chain(&white_atlas, settings);
+        zv_check(black_atlas.m_width == white_atlas.m_width && black_atlas.m_mip_levels == k_atlas_max_mip_levels);
+
+        const u32 entry_x = static_cast<u32>(black_uv_transforms[0].z * static_cast<f32>(black_atlas.m_width) + 0.5f);
+        const u32 entry_y = static_cast<u32>(black_uv_transforms[0].w * static_cast<f32>(black_atlas.m_height) + 0.5f);
+        zv_check(entry_x % 4 == 0 && entry_y % 4 == 0);
+
+        u32 num_different_texels = 0;
+        for (u32 mip = 0; mip < black_atlas.m_mip_levels; mip++)
+        {
+            const u32 mip_width = black_atlas.get_mip_width(mip);
+            const u8* black_mip = black_atlas.m_data.get() + black_atlas.get_mip_offset(mip);
+            const u8* white_mip = white_atlas.m_data.get() + white_atlas.get_mip_offset(mip);
+            const u32 first_x = (entry_x >> mip) - 1;
+            const u32 first_y = (entry_y >> mip) - 1;
+            const u32 last_x = ((entry_x + entry->m_width) >> mip) + 1;
+            const u32 last_y = ((entry_y + entry->m_height) >> mip) + 1;
+
+            for (u32 y = first_y; y < last_y; y++)
+            {
+                for (u32 x = first_x; x < last_x; x++)
+                {
+                    const size_t offset = (static_cast<size_t>(y) * mip_width + x) * 4;
+                    num_different_texels += memcmp(black_mip + offset, white_mip + offset, 4) != 0 ? 1 : 0;
+                }
+            }
+        }
+        zv_check(num_different_texels == 0);
+    }
+}
+
+zv_test(bc7_keeps_alpha_independent_of_color)
+{
+    // Color changes left to right, alpha top to bottom, no single RGBA line through the block fits both
+    u8 texels[16][4] = {};
+    for (u32 i = 0; i < 16; i++)
+    {
+        const u8 x = static_cast<u8>(i % 4);
+        const u8 y = static_cast<u8>(i / 4);
+        texels[i][0] = static_cast<u8>(40 + x * 60);
+        texels[i][1] = static_cast<u8>(200 - x * 50);
+        texels[i][2] = static_cast<u8>(90 + x * 20);
+        texels[i][3] = static_cast<u8>(y * 85);
+    }
+
+    u8 decoded[16][4] = {};
+    const u32 mode = round_trip_bc7_block(texels, decoded);
+    zv_check(mode == 4 || mode == 5);
+    zv_check(get_max_block_error(texels, decoded) <= 8);
+
+    // The same with red as the independent channel takes a rotation
+    for (u32 i = 0; i < 16; i++)
+    {
+        std::swap(texels[i][0], texels[i][3]);
+    }
+    zv_check(round_trip_bc7_block(texels, decoded) != UINT_MAX);
+    zv_check(get_max_block_error(texels, decoded) <= 8);
+}
+
+zv_test(bc7_round_trips_random_blocks)
+{
+    // Noise has no structure to fit, but every mode has to decode to something close to the mean
+    TestRandom random{};
+    u32 num_undecodable_blocks = 0;
+    f64 squared_error = 0.0;
+    for (u32 block = 0; block < 200; block++)
+    {
+        u8 texels[16][4] = {};
+        const u8 base[4] = { static_cast<u8>(random.next_u32() >> 24), static_cast<u8>(random.next_u32() >> 24),
+                             static_cast<u8>(random.next_u32() >> 24), static_cast<u8>(random.next_u32() >> 24) };
+        for (u32 i = 0; i < 16; i++)
+        {
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                texels[i][channel] = static_cast<u8>(ZV::min(base[channel] + (random.next_u32() >> 27), 255u));
+            }
+        }
+
+        u8 decoded[16][4] = {};
+        num_undecodable_blocks += round_trip_bc7_block(texels, decoded) == UINT_MAX ? 1 : 0;
+        for (u32 i = 0; i < 16; i++)
+        {
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                const f64 difference = static_cast<f64>(texels[i][channel]) - static_cast<f64>(decoded[i][channel]);
+                squared_error += difference * difference;
+            }
+        }
+    }
+    zv_check(num_undecodable_blocks == 0);
+    // Texels spread over 32 values, an RMS error of a few steps is what the 16 level ramp allows
+    zv_check(ZV::sqrt(static_cast<f32>(squared_error / (200.0 * 64.0))) < 6.0f);
+}
+
+zv_test(bc1_bc4_bc5_round_trip_random_textures)
+{
+    // 12x12, 6x6 and 3x3 texels, the last two mips end in partial blocks that are padded with their edge texels
+    TestRandom random{};
+    for (TextureCompression compression : { TextureCompression::BC1, TextureCompression::BC4, TextureCompression::BC5 })
+    {
+        const u32 num_channels = compression == TextureCompression::BC1 ? 3 : compression == TextureCompression::BC4 ? 1 : 2;
+        UniquePtr<TextureAsset> texture = make_test_texture(12, 12, num_channels, TextureFormat::Linear, &random, 3);
+        texture->m_usage = TextureUsage::Data;
+
+        u8 base[3] = {};
+        for (u32 channel = 0; channel < 3; channel++)
+        {
+            base[channel] = static_cast<u8>(random.next_u32() >> 24);
+        }
+        u8* data = texture->m_data.get();
+        for (size_t i = 0; i < texture->get_data_size(); i++)
+        {
+            data[i] = static_cast<u8>(ZV::min(base[i % num_channels] + (random.next_u32() >> 27), 255u));
+        }
+
+        s32 max_error = 0;
+        const f32 rms_error = round_trip_bc_texture(texture.get(), compression, &max_error);
+        // 3x3, 2x2 and 1x1 blocks, each mip starts at the next 512 byte placement
+        zv_check(texture->get_data_size() == 1536 + texture->get_bytes_per_block());
+
+        // Texels spread over 32 values, BC4 has an 8 level ramp per channel, BC1 a 4 level ramp along one RGB axis
+        if (compression == TextureCompression::BC1)
+        {
+            zv_check(rms_error < 8.0f);
+            zv_check(max_error <= 24);
+        }
+        else
+        {
+            zv_check(rms_error < 2.0f);
+            zv_check(max_error <= 3);
+        }
+    }
+}
+
+zv_test(bc1_bc4_bc5_keep_solid_blocks_including_partial_edge_blocks)
+{
+    // 12x8, 6x4 and 3x2 texels. The first block of the top mip, the two column edge block of the second mip
+    // and the whole last mip are solid, the rest is noise the clamped edge fetch must not pull in.
+    static constexpr u8 k_solid_color[3] = { 200, 13, 77 };
+    const auto is_solid = [](u32 mip, u32 x, u32 y) { return mip == 2 || (mip == 1 && x >= 4) || (mip == 0 && x < 4 && y < 4); };
+
+    TestRandom random{};
+    for (TextureCompression compression : { TextureCompression::BC1, TextureCompression::BC4, TextureCompression::BC5 })
+    {
+        const u32 num_channels = compression == TextureCompression::BC1 ? 3 : compression == TextureCompression::BC4 ? 1 : 2;
+        UniquePtr<TextureAsset> texture = make_test_texture(12, 8, num_channels, TextureFormat::Linear, &random, 3);
+        texture->m_usage = TextureUsage::Data;
+        for (u32 mip = 0; mip < 3; mip++)
+        {
+            u8* data = texture->m_data.get() + texture->get_mip_offset(mip);
+            for (u32 i = 0; i < texture->get_mip_width(mip) * texture->get_mip_height(mip); i++)
+            {
+                if (is_solid(mip, i % texture->get_mip_width(mip), i / texture->get_mip_width(mip)))
+                {
+                    memcpy(data + i * num_channels, k_solid_color, num_channels);
+                }
+            }
+        }
+
+        compress_texture(texture.get(), compression);
+
+        // 565 rounding moves a solid BC1 color by up to half a 5 bit step, BC4 stores solid values as is
+        const s32 max_allowed_error = compression == TextureCompression::BC1 ? 4 : 0;
+        s32 max_error = 0;
+        u32 num_transparent_texels = 0;
+        for (u32 mip = 0; mip < 3; mip++)
+        {
+            const DynamicArray<u8> decoded = decode_bc_mip(*texture, mip);
+            for (u32 i = 0; i < texture->get_mip_width(mip) * texture->get_mip_height(mip); i++)
+            {
+                if (!is_solid(mip, i % texture->get_mip_width(mip), i / texture->get_mip_width(mip)))
+                {
+                    continue;
+                }
+
+                for (u32 channel = 0; channel < num_channels; channel++)
+                {
+                    max_error = ZV::max(max_error, ZV::abs(static_cast<s32>(k_solid_color[channel]) - static_cast<s32>(decoded[i * 4 + channel])));
+                }
+                num_transparent_texels += compression == TextureCompression::BC1 && decoded[i * 4 + 3] != 255 ? 1 : 0;
+            }
+        }
+        zv_check(max_error <= max_allowed_error);
+        zv_check(num_transparent_texels == 0);
+    }
+}
+
+zv_test(texture_footprints_round_compressed_levels_up_to_whole_blocks)
+{
+    // 10x6, 5x3, 2x1 and 1x1 texels are 3x2, 2x1, 1x1 and 1x1 blocks of 8 bytes
+    const TextureAsset bc1 = make_footprint_texture(10, 6, 4, TextureCompression::BC1, 4);
+    TextureFootprint footprints[4] = {};
+    zv_check(compute_texture_footprints(bc1, footprints) == 1536 + 8);
+    zv_check(is_footprint(footprints[0], 0, 12, 8, 256, 2, 24));
+    zv_check(is_footprint(footprints[1], 512, 8, 4, 256, 1, 16));
+    zv_check(is_footprint(footprints[2], 1024, 4, 4, 256, 1, 8));
+    zv_check(is_footprint(footprints[3], 1536, 4, 4, 256, 1, 8));
+
+    // 16 byte blocks, a 4128 byte row is padded to the next multiple of 256
+    const TextureAsset bc5 = make_footprint_texture(1030, 7, 2, TextureCompression::BC5, 1);
+    zv_check(compute_texture_footprints(bc5, footprints) == 4352 + 4128);
+    zv_check(is_footprint(footprints[0], 0, 1032, 8, 4352, 2, 4128));
+
+    const TextureAsset bc4 = make_footprint_texture(3, 3, 1, TextureCompression::BC4, 1);
+    zv_check(compute_texture_footprints(bc4, footprints) == 8);
+    zv_check(is_footprint(footprints[0], 0, 4, 4, 256, 1, 8));
+}
+
+zv_test(texture_footprints_expand_rgb_to_rgba)
+{
+    TextureFootprint footprint{};
+    const TextureAsset rgb = make_footprint_texture(70, 3, 3, TextureCompression::None, 1);
+    zv_check(compute_texture_footprints(rgb, &footprint) == 2 * 512 + 280);
+    zv_check(is_footprint(footprint, 0, 70, 3, 512, 3, 280));
+
+    // The layout conversion writes the texels there with opaque alpha
+    TestRandom random{};
+    UniquePtr<TextureAsset> texture = make_test_texture(70, 3, 3, TextureFormat::Linear, &random);
+    DynamicArray<u8> source(texture->m_data.get(), texture->m_data.get() + texture->get_data_size());
+    convert_to_upload_layout(texture.get());
+    zv_check(texture->m_upload_size == 2 * 512 + 280);
+
+    u32 num_wrong_texels = 0;
+    for (u32 y = 0; y < 3; y++)
+    {
+        for (u32 x = 0; x < 70; x++)
+        {
+            const u8* expected = source.data() + (y * 70 + x) * 3;
+            const u8* actual = texture->m_data.get() + y * 512 + x * 4;
+            num_wrong_texels += memcmp(expected, actual, 3) != 0 || actual[3] != 255 ? 1 : 0;
+        }
+    }
+    zv_check(num_wrong_texels == 0);
+}
+
+zv_test(texture_footprints_of_odd_mip_chains_and_array_slices)
+{
+    // 7x5, 3x2 and 1x1, every level starts on 512 bytes
+    const TextureAsset odd = make_footprint_texture(7, 5, 4, TextureCompression::None, 3);
+    TextureFootprint footprints[6] = {};
+    zv_check(compute_texture_footprints(odd, footprints) == 2048 + 4);
+    zv_check(is_footprint(footprints[0], 0, 7, 5, 256, 5, 28));
+    zv_check(is_footprint(footprints[1], 1536, 3, 2, 256, 2, 12));
+    zv_check(is_footprint(footprints[2], 2048, 1, 1, 256, 1, 4));
+
+    // Subresource mip + slice * mip_levels, the second slice follows the last level of the first
+    const TextureAsset array = make_footprint_texture(4, 4, 4, TextureCompression::None, 3, 2);
+    zv_check(compute_texture_footprints(array, footprints) == 2048 + 1536 + 4);
+    for (u32 slice = 0; slice < 2; slice++)
+    {
+        zv_check(is_footprint(footprints[slice * 3 + 0], slice * 2048 + 0, 4, 4, 256, 4, 16));
+        zv_check(is_footprint(footprints[slice * 3 + 1], slice * 2048 + 1024, 2, 2, 256, 2, 8));
+        zv_check(is_footprint(footprints[slice * 3 + 2], slice * 2048 + 1536, 1, 1, 256, 1, 4));
+    }
+}
+
+zv_test(texture_footprints_are_aligned_and_disjoint)
+{
+    TestRandom random{};
+    const TextureCompression compressions[] = { TextureCompression::None, TextureCompression::BC1, TextureCompression::BC4, TextureCompression::BC5, TextureCompression::BC7 };
+    u32 num_bad_footprints = 0;
+    for (u32 i = 0; i < 200; i++)
+    {
+        const u32 width = 1 + random.next_u32() % 300;
+        const u32 height = 1 + random.next_u32() % 300;
+        const TextureCompression compression = compressions[random.next_u32() % 5];
+        const u32 num_channels = compression == TextureCompression::None ? 1 + random.next_u32() % 4 : 4;
+        const TextureAsset texture = make_footprint_texture(width, height, num_channels, compression, get_mip_level_count(width, height), 1 + random.next_u32() % 3);
+
+        DynamicArray<TextureFootprint> footprints(texture.get_subresource_count());
+        const u64 total_size = compute_texture_footprints(texture, footprints.data());
+
+        u64 end = 0;
+        for (const TextureFootprint& footprint : footprints)
+        {
+            const bool is_aligned = footprint.m_offset % k_texture_placement_alignment == 0 && footprint.m_row_pitch % k_texture_row_pitch_alignment == 0;
+            const bool is_disjoint = footprint.m_offset >= end && footprint.m_row_pitch >= footprint.m_row_size;
+            num_bad_footprints += is_aligned && is_disjoint ? 0 : 1;
+            end = footprint.m_offset + static_cast<u64>(footprint.m_row_pitch) * (footprint.m_num_rows - 1) + footprint.m_row_size;
+        }
+        num_bad_footprints += end == total_size ? 0 : 1;
+    }
+    zv_check(num_bad_footprints == 0);
+}
+
+zv_test(pack_texture_channels_places_each_source_channel)
+{
+    // 5x3 RGB and single channel sources, a 3x2 one that is point sampled up and a filled channel
+    u8 rgb[5 * 3 * 3] = {};
+    u8 gray[5 * 3] = {};
+    u8 small[3 * 2 * 2] = {};
+    for (u32 i = 0; i < 5 * 3; i++)
+    {
+        rgb[i * 3 + 0] = static_cast<u8>(i);
+        rgb[i * 3 + 1] = static_cast<u8>(100 + i);
+        rgb[i * 3 + 2] = static_cast<u8>(200 + i);
+        gray[i] = static_cast<u8>(50 + i);
+    }
+    for (u32 i = 0; i < 3 * 2; i++)
+    {
+        small[i * 2 + 0] = 0;
+        small[i * 2 + 1] = static_cast<u8>(150 + i);
+    }
+
+    TextureChannelSource sources[4] = {};
+    sources[0] = TextureChannelSource{ rgb, 5, 3, 3, 2 };
+    sources[1] = TextureChannelSource{ gray, 5, 3, 1, 0 };
+    sources[2] = TextureChannelSource{ small, 3, 2, 2, 1 };
+    sources[3].m_fill_value = 77;
+
+    u8 packed[5 * 3 * 4] = {};
+    pack_texture_channels(packed, 5, 3, sources, 4);
+
+    u32 num_wrong_texels = 0;
+    for (u32 y = 0; y < 3; y++)
+    {
+        for (u32 x = 0; x < 5; x++)
+        {
+            const u32 i = y * 5 + x;
+            const u8 expected[4] = { rgb[i * 3 + 2], gray[i], small[((y * 2 / 3) * 3 + x * 3 / 5) * 2 + 1], 77 };
+            num_wrong_texels += memcmp(packed + i * 4, expected, 4) != 0 ? 1 : 0;
+        }
+    }
+    zv_check(num_wrong_texels == 0);
+
+    // Fewer sources give a tighter texel
+    u8 two_channels[5 * 3 * 2] = {};
+    pack_texture_channels(two_channels, 5, 3, sources + 1, 2);
+    zv_check(two_channels[0] == gray[0] && two_channels[1] == small[1]);
+    zv_check(two_channels[28] == gray[14] && two_channels[29] == small[11]);
+}
+
+zv_test(cook_orms_texture_fills_missing_maps)
+{
+    // Roughness and metalness from the G and B of a glTF metallic roughness texture, no occlusion or specular map
+    u8 metal_roughness[4 * 2 * 4] = {};
+    for (u32 i = 0; i < 4 * 2; i++)
+    {
+        metal_roughness[i * 4 + 0] = 0;
+        metal_roughness[i * 4 + 1] = static_cast<u8>(10 + i);
+        metal_roughness[i * 4 + 2] = static_cast<u8>(90 + i);
+        metal_roughness[i * 4 + 3] = 255;
+    }
+
+    TextureChannelSource sources[k_orms_channel_count] = {};
+    sources[1] = TextureChannelSource{ metal_roughness, 4, 2, 4, 1 };
+    sources[2] = TextureChannelSource{ metal_roughness, 4, 2, 4, 2 };
+
+    TextureAsset texture{};
+    zv_check(cook_orms_texture(sources, &texture));
+    zv_check(texture.m_width == 4 && texture.m_height == 2 && texture.m_num_channels == 4);
+    zv_check(texture.m_format == TextureFormat::Linear && texture.m_usage == TextureUsage::Data);
+
+    // Occlusion and specular default to 255, unoccluded for the ao channel and ignored for specular without its flag
+    u32 num_wrong_texels = 0;
+    for (u32 i = 0; i < 4 * 2; i++)
+    {
+        const u8 expected[4] = { 255, static_cast<u8>(10 + i), static_cast<u8>(90 + i), 255 };
+        num_wrong_texels += memcmp(texture.m_data.get() + i * 4, expected, 4) != 0 ? 1 : 0;
+    }
+    zv_check(num_wrong_texels == 0);
+
+    // An occlusion map of a different size comes first and sets the size, the others are resampled to it
+    u8 occlusion[8 * 4] = {};
+    for (u32 i = 0; i < 8 * 4; i++)
+    {
+        occlusion[i] = static_cast<u8>(i);
+    }
+    sources[0] = TextureChannelSource{ occlusion, 8, 4, 1, 0 };
+    zv_check(cook_orms_texture(sources, &texture));
+    zv_check(texture.m_width == 8 && texture.m_height == 4);
+    const u8* last_texel = texture.m_data.get() + (8 * 4 - 1) * 4;
+    zv_check(last_texel[0] == 31 && last_texel[1] == 17 && last_texel[2] == 97 && last_texel[3] == 255);
+
+    const TextureChannelSource no_sources[k_orms_channel_count] = {};
+    zv_check(!cook_orms_texture(no_sources, &texture));
+}
+
+zv_test(atlas_rects_are_packed_inside_without_overlaps)
+{
+    TestRandom random{};
+    for (u32 run = 0; run < 20; run++)
+    {
+        // About a third of the atlas area, in rects of very different shapes
+        DynamicArray<AtlasRect> rects(150);
+        for (AtlasRect& rect : rects)
+        {
+            rect.m_width = 1 + random.next_u32() % 48;
+            rect.m_height = 1 + random.next_u32() % 48;
+        }
+
+        DynamicArray<AtlasPlacement> placements(rects.size());
+        zv_check(pack_atlas_rects(rects.data(), static_cast<u32>(rects.size()), 512, 256, placements.data()));
+        zv_check(count_bad_placements(rects, placements, 512, 256) == 0);
+
+        DynamicArray<AtlasPlacement> repacked(rects.size());
+        pack_atlas_rects(rects.data(), static_cast<u32>(rects.size()), 512, 256, repacked.data());
+        zv_check(memcmp(repacked.data(), placements.data(), placements.size() * sizeof(AtlasPlacement)) == 0);
+    }
+
+    // Four equal squares fill the atlas exactly, bottom left first in input order
+    const DynamicArray<AtlasRect> squares(4, AtlasRect{ 8, 8 });
+    DynamicArray<AtlasPlacement> placements(4);
+    zv_check(pack_atlas_rects(squares.data(), 4, 16, 16, placements.data()));
+    zv_check(placements[0].m_x == 0 && placements[0].m_y == 0);
+    zv_check(placements[1].m_x == 8 && placements[1].m_y == 0);
+    zv_check(placements[2].m_x == 0 && placements[2].m_y == 8);
+    zv_check(placements[3].m_x == 8 && placements[3].m_y == 8);
+
+    zv_check(pack_atlas_rects(nullptr, 0, 16, 16, nullptr));
+}
+
+zv_test(atlas_rects_that_do_not_fit_fail)
+{
+    DynamicArray<AtlasPlacement> placements(5);
+
+    const DynamicArray<AtlasRect> squares(5, AtlasRect{ 8, 8 });
+    zv_check(!pack_atlas_rects(squares.data(), 5, 16, 16, placements.data()));
+
+    const AtlasRect too_wide{ 17, 1 };
+    zv_check(!pack_atlas_rects(&too_wide, 1, 16, 16, placements.data()));
+    const AtlasRect too_tall{ 1, 17 };
+    zv_check(!pack_atlas_rects(&too_tall, 1, 16, 16, placements.data()));
+
+    // Two 10x10 rects stack in 16x32, 16x16 has the area but no room for the second one
+    const DynamicArray<AtlasRect> stacked(2, AtlasRect{ 10, 10 });
+    zv_check(pack_atlas_rects(stacked.data(), 2, 16, 32, placements.data()));
+    zv_check(!pack_atlas_rects(stacked.data(), 2, 16, 16, placements.data()));
+}
+
+zv_benchmark(mip_chain_2048)
+{
+    TestRandom random{};
+    UniquePtr<TextureAsset> source = make_test_texture(2048, 2048, 4, TextureFormat::SRGB, &random);
+
+    for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser })
+    {
+        MipGenerationSettings settings{};
+        settings.m_filter = filter;
+        settings.m_is_srgb = true;
+
+        const f64 milliseconds = measure_best_ms(3, [&]()
+        {
+            UniquePtr<TextureAsset> texture = make_unique_ptr<TextureAsset>();
+            texture->m_width = source->m_width;
+            texture->m_height = source->m_height;
+            texture->m_num_channels = source->m_num_channels;
+            texture->m_dimension = source->m_dimension;
+            texture->m_format = source->m_format;
+            texture->m_data = make_unique_ptr<u8[]>(source->get_data_size());
+            memcpy(texture->m_data.get(), source->m_data.get(), source->get_data_size());
+            generate_mip_chain(texture.get(), settings);
+        });
+        report_timing(filter == MipFilter::Box ? "box, srgb rgba 2048x2048" : "kaiser, srgb rgba 2048x2048", milliseconds);
+    }
+}
+
+zv_benchmark(bc7_compress_1024)
+{
+    TestRandom random{};
+    UniquePtr<TextureAsset> source = make_test_texture(1024, 1024, 4, TextureFormat::Linear, &random);
+
+    const f64 milliseconds = measure_best_ms(3, [&]()
+    {
+        UniquePtr<TextureAsset> texture = make_test_texture(1024, 1024, 4, TextureFormat::Linear, nullptr);
+        memcpy(texture->m_data.get(), source->m_data.get(), source->get_data_size());
+        compress_texture(texture.get(), TextureCompression::BC7);
+    });
+    report_timing("bc7, rgba 1024x1024", milliseconds);
+}
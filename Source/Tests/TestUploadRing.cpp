@@ -0,0 +1,157 @@
+#include <Tests/Test.h>
+
+#include <UploadRing.h>
+
+#include <algorithm>
+
+namespace
+{
+    struct LiveRange
+    {
+        u64 m_fence_value = 0;
+        u64 m_offset = 0;
+        u64 m_size = 0;
+    };
+
+    bool do_ranges_overlap(u64 a_offset, u64 a_size, u64 b_offset, u64 b_size)
+    {
+        return a_offset < b_offset + b_size && b_offset < a_offset + a_size;
+    }
+}
+
+zv_test(upload_ring_aligns_wraps_and_reclaims)
+{
+    UploadRing ring(1000);
+    zv_check(ring.get_capacity() == 1024);
+
+    u64 offset = 0;
+    zv_check(ring.allocate(100, &offset) && offset == 0);
+    zv_check(ring.allocate(256, &offset) && offset == 256);
+    zv_check(ring.allocate(257, &offset) && offset == 512);
+    ring.end_frame(1);
+    zv_check(ring.get_stats().m_frame_bytes == 1024);
+    zv_check(ring.get_stats().m_frame_allocations == 3);
+
+    // Full until the frame's fence completes
+    zv_check(!ring.allocate(1, &offset));
+    ring.reclaim(0);
+    zv_check(!ring.allocate(1, &offset));
+    ring.reclaim(1);
+    zv_check(ring.get_used() == 0);
+
+    // 512 bytes don't fit between 768 and the end, and the start is still in use by frame 2
+    zv_check(ring.allocate(512, &offset) && offset == 0);
+    ring.end_frame(2);
+    zv_check(ring.allocate(256, &offset) && offset == 512);
+    zv_check(!ring.allocate(512, &offset));
+    ring.end_frame(3);
+
+    // Once it completes the allocation skips the last 256 bytes and starts over
+    ring.reclaim(2);
+    zv_check(ring.allocate(512, &offset) && offset == 0);
+    zv_check(ring.get_used() == 256 + 256 + 512);
+    ring.end_frame(4);
+    zv_check(ring.get_stats().m_frame_bytes == 768);
+    ring.reclaim(4);
+    zv_check(ring.get_used() == 0);
+    zv_check(ring.get_stats().m_high_water_mark == 1024);
+}
+
+zv_test(upload_ring_grows_at_least_double)
+{
+    UploadRing ring(1024);
+    u64 offset = 0;
+    zv_check(!ring.allocate(2048, &offset));
+
+    ring.grow(2048);
+    zv_check(ring.get_capacity() == 2048);
+    zv_check(ring.get_stats().m_num_grows == 1);
+    zv_check(ring.allocate(2048, &offset) && offset == 0);
+
+    ring.grow(1);
+    zv_check(ring.get_capacity() == 4096);
+    zv_check(ring.get_used() == 0);
+    zv_check(ring.get_stats().m_num_grows == 2);
+}
+
+zv_test(upload_ring_never_hands_out_live_memory)
+{
+    // Random sizes with two frames in flight, every allocation checked against all that are still in use
+    TestRandom random{};
+    UploadRing ring(1 << 14);
+    DynamicArray<LiveRange> live_ranges{};
+    u64 fence_value = 0;
+    u32 num_overlaps = 0;
+    u32 num_misplaced = 0;
+
+    for (u32 frame = 0; frame < 2000; frame++)
+    {
+        if (fence_value >= 2)
+        {
+            const u64 completed_fence_value = fence_value - 2;
+            ring.reclaim(completed_fence_value);
+            live_ranges.erase(std::remove_if(live_ranges.begin(), live_ranges.end(),
+                                             [&](const LiveRange& range) { return range.m_fence_value <= completed_fence_value; }),
+                              live_ranges.end());
+        }
+
+        for (u32 i = 0; i < 16; i++)
+        {
+            const u64 size = random.next_u32() % 1500 + 1;
+            u64 offset = 0;
+            if (!ring.allocate(size, &offset))
+            {
+                // The old buffer stays alive for the frames in flight, the new one starts out empty
+                ring.grow(size);
+                live_ranges.clear();
+                zv_check(ring.allocate(size, &offset));
+            }
+
+            num_misplaced += offset % k_upload_ring_alignment != 0 || offset + size > ring.get_capacity() ? 1 : 0;
+            for (const LiveRange& range : live_ranges)
+            {
+                num_overlaps += do_ranges_overlap(offset, size, range.m_offset, range.m_size) ? 1 : 0;
+            }
+            live_ranges.push_back({ fence_value + 1, offset, size });
+        }
+        ring.end_frame(++fence_value);
+        zv_check(ring.get_used() <= ring.get_capacity());
+    }
+
+    zv_check(num_overlaps == 0);
+    zv_check(num_misplaced == 0);
+    zv_check(ring.get_stats().m_high_water_mark <= ring.get_capacity());
+}
+
+zv_benchmark(upload_ring_1m_allocations)
+{
+    TestRandom random{};
+    DynamicArray<u64> sizes(1 << 20);
+    for (u64& size : sizes)
+    {
+        size = random.next_u32() % 1024 + 1;
+    }
+
+    // Three frames of the largest sizes always fit, so no allocation fails
+    UploadRing ring(4ull << 20);
+    u64 checksum = 0;
+    const f64 milliseconds = measure_best_ms(5, [&]()
+    {
+        u64 fence_value = 0;
+        for (size_t i = 0; i < sizes.size(); i++)
+        {
+            u64 offset = 0;
+            checksum += ring.allocate(sizes[i], &offset) ? offset : 0;
+            if (i % 1024 == 1023)
+            {
+                ring.end_frame(++fence_value);
+                ring.reclaim(fence_value > 2 ? fence_value - 2 : 0);
+            }
+        }
+        ring.end_frame(++fence_value);
+        ring.reclaim(fence_value);
+    });
+    report_timing("1048576 allocations, 1024 per frame", milliseconds);
+    report_count("high water mark, bytes", ring.get_stats().m_high_water_mark);
+    report_count("checksum", checksum);
+}
@@ -0,0 +1,1792 @@
+#include <TextureProcessing.h>
+
+#include <Platform/Platform.h>
+#include <Platform/PlatformContext.h>
+#include <Utility.h>
+
+#include <cfloat>
+
+#if ZV_ARCH_X64
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    constexpr u32 k_max_filter_taps = 6;
+    constexpr u32 k_linear_to_srgb_table_size = 4096;
+    constexpr u32 k_min_texels_per_batch = 16384;
+#if ZV_DEBUG
+    constexpr u32 k_max_reference_check_texels = 64 * 64;
+#endif
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Float4 helpers, one texel per register
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+#if ZV_ARCH_X64
+    using Float4 = __m128;
+
+    inline Float4 f4_zero() { return _mm_setzero_ps(); }
+    inline Float4 f4_splat(f32 value) { return _mm_set1_ps(value); }
+    inline Float4 f4_load(const f32* src) { return _mm_loadu_ps(src); }
+    inline void f4_store(f32* dst, Float4 value) { _mm_storeu_ps(dst, value); }
+    inline Float4 f4_madd(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#else
+    struct Float4 { f32 v[4]; };
+
+    inline Float4 f4_zero() { return Float4{ { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+    inline Float4 f4_splat(f32 value) { return Float4{ { value, value, value, value } }; }
+    inline Float4 f4_load(const f32* src) { return Float4{ { src[0], src[1], src[2], src[3] } }; }
+    inline void f4_store(f32* dst, Float4 value) { memcpy(dst, value.v, sizeof(value.v)); }
+    inline Float4 f4_madd(Float4 a, Float4 b, Float4 c)
+    {
+        return Float4{ { a.v[0] * b.v[0] + c.v[0], a.v[1] * b.v[1] + c.v[1], a.v[2] * b.v[2] + c.v[2], a.v[3] * b.v[3] + c.v[3] } };
+    }
+#endif
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Filter kernels and color tables
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    struct FilterKernel
+    {
+        s32 m_first_offset = 0;  // Relative to 2 * destination coordinate
+        u32 m_num_taps = 0;
+        f32 m_weights[k_max_filter_taps] = {};
+    };
+
+    f64 bessel_i0(f64 x)
+    {
+        f64 sum = 1.0;
+        f64 term = 1.0;
+        const f64 half_x_squared = 0.25 * x * x;
+
+        for (u32 k = 1; k < 32; k++)
+        {
+            term *= half_x_squared / static_cast<f64>(k * k);
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    FilterKernel make_filter_kernel(MipFilter filter)
+    {
+        FilterKernel kernel{};
+
+        if (filter == MipFilter::Box)
+        {
+            kernel.m_first_offset = 0;
+            kernel.m_num_taps = 2;
+            kernel.m_weights[0] = 0.5f;
+            kernel.m_weights[1] = 0.5f;
+            return kernel;
+        }
+
+        // Kaiser windowed sinc for a 2x reduction, support of 3 source texels on each side
+        constexpr f64 k_alpha = 4.0;
+        constexpr f64 k_radius = 3.0;
+
+        kernel.m_first_offset = -2;
+        kernel.m_num_taps = k_max_filter_taps;
+
+        f64 weights[k_max_filter_taps] = {};
+        f64 weight_sum = 0.0;
+
+        for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+        {
+            // Distance from the source texel center to the destination texel center, in source texels
+            const f64 distance = static_cast<f64>(kernel.m_first_offset + static_cast<s32>(tap)) - 0.5;
+            const f64 t = distance * 0.5;
+            const f64 sinc = t == 0.0 ? 1.0 : ZV::sin(ZV_PI * t) / (ZV_PI * t);
+            const f64 ratio = distance / k_radius;
+            const f64 window = bessel_i0(k_alpha * ZV::sqrt(ZV::max(1.0 - ratio * ratio, 0.0))) / bessel_i0(k_alpha);
+
+            weights[tap] = sinc * window;
+            weight_sum += weights[tap];
+        }
+
+        for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+        {
+            kernel.m_weights[tap] = static_cast<f32>(weights[tap] / weight_sum);
+        }
+
+        return kernel;
+    }
+
+    struct ColorTables
+    {
+        f32 m_srgb_to_linear[256];
+        u8 m_linear_to_srgb[k_linear_to_srgb_table_size];
+
+        ColorTables()
+        {
+            for (u32 i = 0; i < 256; i++)
+            {
+                m_srgb_to_linear[i] = srgb_channel_to_linear(static_cast<f32>(i) / 255.0f);
+            }
+
+            for (u32 i = 0; i < k_linear_to_srgb_table_size; i++)
+            {
+                const f32 linear = static_cast<f32>(i) / static_cast<f32>(k_linear_to_srgb_table_size - 1);
+                m_linear_to_srgb[i] = static_cast<u8>(linear_channel_to_srgb(linear) * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    const ColorTables& get_color_tables()
+    {
+        static const ColorTables s_tables;
+        return s_tables;
+    }
+
+    inline u32 clamp_coordinate(s32 coordinate, u32 size)
+    {
+        return static_cast<u32>(ZV::min(ZV::max(coordinate, 0), static_cast<s32>(size) - 1));
+    }
+
+    inline f32 saturate(f32 value)
+    {
+        return ZV::min(ZV::max(value, 0.0f), 1.0f);
+    }
+
+    inline void renormalize_normal(f32* texel)
+    {
+        const f32 x = texel[0] * 2.0f - 1.0f;
+        const f32 y = texel[1] * 2.0f - 1.0f;
+        const f32 z = texel[2] * 2.0f - 1.0f;
+        const f32 length = ZV::sqrt(x * x + y * y + z * z);
+
+        if (length > ZV_EPSILON)
+        {
+            const f32 scale = 0.5f / length;
+            texel[0] = x * scale + 0.5f;
+            texel[1] = y * scale + 0.5f;
+            texel[2] = z * scale + 0.5f;
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Row based downsampling
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    struct DownsampleContext
+    {
+        const u8* m_src = nullptr;
+        u32 m_src_width = 0;
+        u32 m_src_height = 0;
+        u8* m_dst = nullptr;
+        u32 m_dst_width = 0;
+        u32 m_dst_height = 0;
+        u32 m_num_channels = 0;
+        MipGenerationSettings m_settings{};
+        FilterKernel m_kernel{};
+        const ColorTables* m_tables = nullptr;
+    };
+
+    // Expands one source row to 4 linear floats per texel
+    void decode_row(const DownsampleContext& context, u32 src_y, f32* out)
+    {
+        const u32 num_channels = context.m_num_channels;
+        const u8* row = context.m_src + static_cast<size_t>(src_y) * context.m_src_width * num_channels;
+
+#if ZV_ARCH_X64
+        if (num_channels == 4 && !context.m_settings.m_is_srgb)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+
+            for (u32 x = 0; x < context.m_src_width; x++)
+            {
+                s32 packed;
+                memcpy(&packed, row + x * 4, sizeof(packed));
+
+                __m128i texel = _mm_cvtsi32_si128(packed);
+                texel = _mm_unpacklo_epi8(texel, zero);
+                texel = _mm_unpacklo_epi16(texel, zero);
+                _mm_storeu_ps(out + x * 4, _mm_mul_ps(_mm_cvtepi32_ps(texel), scale));
+            }
+            return;
+        }
+#endif
+
+        const f32* srgb_to_linear_table = context.m_tables->m_srgb_to_linear;
+
+        for (u32 x = 0; x < context.m_src_width; x++)
+        {
+            const u8* src_texel = row + x * num_channels;
+            f32* dst_texel = out + x * 4;
+
+            for (u32 channel = 0; channel < 4; channel++)
+            {
+                if (channel >= num_channels)
+                {
+                    dst_texel[channel] = 0.0f;
+                }
+                else if (context.m_settings.m_is_srgb && channel < 3)
+                {
+                    dst_texel[channel] = srgb_to_linear_table[src_texel[channel]];
+                }
+                else
+                {
+                    dst_texel[channel] = static_cast<f32>(src_texel[channel]) * (1.0f / 255.0f);
+                }
+            }
+        }
+    }
+
+    // Filters a decoded source row horizontally into one destination row
+    void filter_row(const DownsampleContext& context, const f32* decoded_row, f32* out)
+    {
+        const FilterKernel& kernel = context.m_kernel;
+
+        Float4 weights[k_max_filter_taps];
+        for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+        {
+            weights[tap] = f4_splat(kernel.m_weights[tap]);
+        }
+
+        for (u32 x = 0; x < context.m_dst_width; x++)
+        {
+            const s32 first_x = static_cast<s32>(x * 2) + kernel.m_first_offset;
+            Float4 sum = f4_splat(0.0f);
+
+            for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+            {
+                const u32 src_x = clamp_coordinate(first_x + static_cast<s32>(tap), context.m_src_width);
+                sum = f4_madd(f4_load(decoded_row + src_x * 4), weights[tap], sum);
+            }
+
+            f4_store(out + x * 4, sum);
+        }
+    }
+
+    // Weighted sum of horizontally filtered rows, one per vertical tap
+    void filter_column(const DownsampleContext& context, const f32* const* filtered_rows, f32* out)
+    {
+        const FilterKernel& kernel = context.m_kernel;
+
+        Float4 weights[k_max_filter_taps];
+        for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+        {
+            weights[tap] = f4_splat(kernel.m_weights[tap]);
+        }
+
+        for (u32 x = 0; x < context.m_dst_width; x++)
+        {
+            Float4 sum = f4_splat(0.0f);
+            for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+            {
+                sum = f4_madd(f4_load(filtered_rows[tap] + x * 4), weights[tap], sum);
+            }
+            f4_store(out + x * 4, sum);
+        }
+    }
+
+    void encode_row(const DownsampleContext& context, f32* accum, u8* out)
+    {
+        const u32 num_channels = context.m_num_channels;
+        const bool renormalize = context.m_settings.m_is_normal_map && num_channels >= 3;
+
+        for (u32 x = 0; x < context.m_dst_width; x++)
+        {
+            f32* texel = accum + x * 4;
+            u8* dst_texel = out + x * num_channels;
+
+            if (renormalize)
+            {
+                renormalize_normal(texel);
+            }
+
+#if ZV_ARCH_X64
+            if (num_channels == 4 && !context.m_settings.m_is_srgb)
+            {
+                __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(texel), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+                value = _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+
+                __m128i packed = _mm_cvttps_epi32(value);
+                packed = _mm_packs_epi32(packed, packed);
+                packed = _mm_packus_epi16(packed, packed);
+
+                const s32 result = _mm_cvtsi128_si32(packed);
+                memcpy(dst_texel, &result, sizeof(result));
+                continue;
+            }
+#endif
+
+            for (u32 channel = 0; channel < num_channels; channel++)
+            {
+                const f32 value = saturate(texel[channel]);
+
+                if (context.m_settings.m_is_srgb && channel < 3)
+                {
+                    const u32 index = static_cast<u32>(value * static_cast<f32>(k_linear_to_srgb_table_size - 1) + 0.5f);
+                    dst_texel[channel] = context.m_tables->m_linear_to_srgb[index];
+                }
+                else
+                {
+                    dst_texel[channel] = static_cast<u8>(value * 255.0f + 0.5f);
+                }
+            }
+        }
+    }
+
+    PARALLEL_FOR_CALLBACK(downsample_rows_job)
+    {
+        const DownsampleContext& context = *static_cast<const DownsampleContext*>(data);
+        const FilterKernel& kernel = context.m_kernel;
+
+        // Rolling cache of horizontally filtered source rows. Neighbouring destination rows share all but two of their
+        // taps, so every source row of the batch is decoded and filtered once. The taps of one destination row are
+        // consecutive source rows, so placing rows by src_y modulo the tap count never evicts one still in use.
+        DynamicArray<f32> decoded_row(static_cast<size_t>(context.m_src_width) * 4);
+        DynamicArray<f32> accum(static_cast<size_t>(context.m_dst_width) * 4);
+        StaticArray<DynamicArray<f32>, k_max_filter_taps> cached_rows{};
+        StaticArray<u32, k_max_filter_taps> cached_row_ys{};
+        for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+        {
+            cached_rows[tap].resize(static_cast<size_t>(context.m_dst_width) * 4);
+            cached_row_ys[tap] = UINT_MAX;
+        }
+
+        const f32* filtered_rows[k_max_filter_taps] = {};
+        for (u32 y = begin; y < end; y++)
+        {
+            const s32 first_y = static_cast<s32>(y * 2) + kernel.m_first_offset;
+
+            for (u32 tap = 0; tap < kernel.m_num_taps; tap++)
+            {
+                const u32 src_y = clamp_coordinate(first_y + static_cast<s32>(tap), context.m_src_height);
+                const u32 slot = src_y % kernel.m_num_taps;
+                if (cached_row_ys[slot] != src_y)
+                {
+                    decode_row(context, src_y, decoded_row.data());
+                    filter_row(context, decoded_row.data(), cached_rows[slot].data());
+                    cached_row_ys[slot] = src_y;
+                }
+                filtered_rows[tap] = cached_rows[slot].data();
+            }
+
+            filter_column(context, filtered_rows, accum.data());
+
+            u8* dst_row = context.m_dst + static_cast<size_t>(y) * context.m_dst_width * context.m_num_channels;
+            encode_row(context, accum.data(), dst_row);
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Block compression
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    constexpr u32 k_block_texel_count = 16;
+    constexpr u32 k_min_blocks_per_batch = 1024;
+
+    // BC7 interpolation weights for 2, 3 and 4 bit indices
+    constexpr u32 k_bc7_weights2[4] = { 0, 21, 43, 64 };
+    constexpr u32 k_bc7_weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    constexpr u32 k_bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    struct BlockBitWriter
+    {
+        u8* m_data = nullptr;
+        u32 m_bit_offset = 0;
+
+        void write(u32 value, u32 num_bits)
+        {
+            for (u32 bit = 0; bit < num_bits; bit++, m_bit_offset++)
+            {
+                if ((value >> bit) & 1u)
+                {
+                    m_data[m_bit_offset >> 3] |= static_cast<u8>(1u << (m_bit_offset & 7u));
+                }
+            }
+        }
+    };
+
+    // Gathers a 4x4 block as RGBA, edge texels are repeated for mips smaller than a block
+    void fetch_block(const u8* src, u32 width, u32 height, u32 num_channels, u32 block_x, u32 block_y, f32 (*texels)[4])
+    {
+        for (u32 y = 0; y < 4; y++)
+        {
+            const u32 src_y = ZV::min(block_y * 4 + y, height - 1);
+
+            for (u32 x = 0; x < 4; x++)
+            {
+                const u32 src_x = ZV::min(block_x * 4 + x, width - 1);
+                const u8* src_texel = src + (static_cast<size_t>(src_y) * width + src_x) * num_channels;
+                f32* texel = texels[y * 4 + x];
+
+                for (u32 channel = 0; channel < 4; channel++)
+                {
+                    const u8 fallback = channel == 3 ? 255 : 0;
+                    texel[channel] = static_cast<f32>(channel < num_channels ? src_texel[channel] : fallback);
+                }
+            }
+        }
+    }
+
+    // Returns the dominant direction of the block in the first num_dims channels
+    void compute_principal_axis(const f32 (*texels)[4], u32 num_dims, f32* mean, f32* axis)
+    {
+        f32 covariance[4][4] = {};
+        f32 min_value[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+        f32 max_value[4] = {};
+
+        for (u32 dim = 0; dim < num_dims; dim++)
+        {
+            mean[dim] = 0.0f;
+            for (u32 i = 0; i < k_block_texel_count; i++)
+            {
+                mean[dim] += texels[i][dim];
+                min_value[dim] = ZV::min(min_value[dim], texels[i][dim]);
+                max_value[dim] = ZV::max(max_value[dim], texels[i][dim]);
+            }
+            mean[dim] /= static_cast<f32>(k_block_texel_count);
+        }
+
+        for (u32 i = 0; i < k_block_texel_count; i++)
+        {
+            for (u32 row = 0; row < num_dims; row++)
+            {
+                for (u32 column = 0; column < num_dims; column++)
+                {
+                    covariance[row][column] += (texels[i][row] - mean[row]) * (texels[i][column] - mean[column]);
+                }
+            }
+        }
+
+        // Power iteration, seeded with the bounding box diagonal
+        for (u32 dim = 0; dim < num_dims; dim++)
+        {
+            axis[dim] = max_value[dim] - min_value[dim];
+        }
+
+        for (u32 iteration = 0; iteration < 8; iteration++)
+        {
+            f32 next[4] = {};
+            f32 length_squared = 0.0f;
+
+            for (u32 row = 0; row < num_dims; row++)
+            {
+                for (u32 column = 0; column < num_dims; column++)
+                {
+                    next[row] += covariance[row][column] * axis[column];
+                }
+                length_squared += next[row] * next[row];
+            }
+
+            if (length_squared < ZV_EPSILON)
+            {
+                break;
+            }
+
+            const f32 inv_length = 1.0f / ZV::sqrt(length_squared);
+            for (u32 dim = 0; dim < num_dims; dim++)
+            {
+                axis[dim] = next[dim] * inv_length;
+            }
+        }
+    }
+
+    // Projects the block onto its principal axis and returns the extreme points
+    void compute_block_endpoints(const f32 (*texels)[4], u32 num_dims, f32* low, f32* high)
+    {
+        f32 mean[4] = {};
+        f32 axis[4] = {};
+        compute_principal_axis(texels, num_dims, mean, axis);
+
+        f32 min_t = 0.0f;
+        f32 max_t = 0.0f;
+        for (u32 i = 0; i < k_block_texel_count; i++)
+        {
+            f32 t = 0.0f;
+            for (u32 dim = 0; dim < num_dims; dim++)
+            {
+                t += (texels[i][dim] - mean[dim]) * axis[dim];
+            }
+            min_t = ZV::min(min_t, t);
+            max_t = ZV::max(max_t, t);
+        }
+
+        for (u32 dim = 0; dim < num_dims; dim++)
+        {
+            low[dim] = ZV::min(ZV::max(mean[dim] + axis[dim] * min_t, 0.0f), 255.0f);
+            high[dim] = ZV::min(ZV::max(mean[dim] + axis[dim] * max_t, 0.0f), 255.0f);
+        }
+    }
+
+    // Nearest palette entry along the segment low -> high, palette_size entries with the given weights (0..weight_scale)
+    template <u32 N>
+    u32 find_ramp_index(const f32* texel, const f32* low, const f32* high, u32 num_dims, const u32 (&weights)[N], u32 weight_scale)
+    {
+        f32 direction_dot = 0.0f;
+        f32 length_squared = 0.0f;
+        for (u32 dim = 0; dim < num_dims; dim++)
+        {
+            const f32 direction = high[dim] - low[dim];
+            direction_dot += (texel[dim] - low[dim]) * direction;
+            length_squared += direction * direction;
+        }
+
+        const f32 t = length_squared > ZV_EPSILON ? direction_dot / length_squared * static_cast<f32>(weight_scale) : 0.0f;
+
+        u32 best_index = 0;
+        f32 best_distance = FLT_MAX;
+        for (u32 i = 0; i < N; i++)
+        {
+            const f32 distance = ZV::abs(static_cast<f32>(weights[i]) - t);
+            if (distance < best_distance)
+            {
+                best_distance = distance;
+                best_index = i;
+            }
+        }
+
+        return best_index;
+    }
+
+    u16 pack_rgb565(const f32* color)
+    {
+        const u32 r = static_cast<u32>(color[0] * 31.0f / 255.0f + 0.5f);
+        const u32 g = static_cast<u32>(color[1] * 63.0f / 255.0f + 0.5f);
+        const u32 b = static_cast<u32>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<u16>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_rgb565(u16 packed, f32* color)
+    {
+        const u32 r = (packed >> 11) & 31u;
+        const u32 g = (packed >> 5) & 63u;
+        const u32 b = packed & 31u;
+        color[0] = static_cast<f32>((r << 3) | (r >> 2));
+        color[1] = static_cast<f32>((g << 2) | (g >> 4));
+        color[2] = static_cast<f32>((b << 3) | (b >> 2));
+    }
+
+    void encode_bc1_block(const f32 (*texels)[4], u8* out)
+    {
+        f32 low[4] = {};
+        f32 high[4] = {};
+        compute_block_endpoints(texels, 3, low, high);
+
+        // Inset the endpoints a little, the extremes are rarely hit exactly
+        for (u32 dim = 0; dim < 3; dim++)
+        {
+            const f32 inset = (high[dim] - low[dim]) / 16.0f;
+            low[dim] += inset;
+            high[dim] -= inset;
+        }
+
+        u16 color0 = pack_rgb565(high);
+        u16 color1 = pack_rgb565(low);
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+        }
+
+        u32 indices = 0;
+        if (color0 != color1)
+        {
+            f32 endpoint0[3] = {};
+            f32 endpoint1[3] = {};
+            unpack_rgb565(color0, endpoint0);
+            unpack_rgb565(color1, endpoint1);
+
+            // Ramp order is color1, 2/3 color1, 1/3 color1, color0
+            static constexpr u32 k_ramp_weights[4] = { 0, 1, 2, 3 };
+            static constexpr u32 k_ramp_to_index[4] = { 1, 3, 2, 0 };
+
+            for (u32 i = 0; i < k_block_texel_count; i++)
+            {
+                const u32 ramp = find_ramp_index(texels[i], endpoint1, endpoint0, 3, k_ramp_weights, 3);
+                indices |= k_ramp_to_index[ramp] << (i * 2);
+            }
+        }
+
+        memcpy(out + 0, &color0, sizeof(color0));
+        memcpy(out + 2, &color1, sizeof(color1));
+        memcpy(out + 4, &indices, sizeof(indices));
+    }
+
+    void encode_bc4_block(const f32 (*texels)[4], u32 channel, u8* out)
+    {
+        f32 min_value = 255.0f;
+        f32 max_value = 0.0f;
+        for (u32 i = 0; i < k_block_texel_count; i++)
+        {
+            min_value = ZV::min(min_value, texels[i][channel]);
+            max_value = ZV::max(max_value, texels[i][channel]);
+        }
+
+        const u8 value0 = static_cast<u8>(max_value + 0.5f);
+        const u8 value1 = static_cast<u8>(min_value + 0.5f);
+
+        u64 indices = 0;
+        if (value0 > value1)
+        {
+            // 8 value mode, ramp order is value1, 6 interpolated values, value0
+            static constexpr u32 k_ramp_weights[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+            static constexpr u64 k_ramp_to_index[8] = { 1, 7, 6, 5, 4, 3, 2, 0 };
+
+            const f32 low = static_cast<f32>(value1);
+            const f32 high = static_cast<f32>(value0);
+
+            for (u32 i = 0; i < k_block_texel_count; i++)
+            {
+                const u32 ramp = find_ramp_index(&texels[i][channel], &low, &high, 1, k_ramp_weights, 7);
+                indices |= k_ramp_to_index[ramp] << (i * 3);
+            }
+        }
+
+        out[0] = value0;
+        out[1] = value1;
+        for (u32 byte = 0; byte < 6; byte++)
+        {
+            out[2 + byte] = static_cast<u8>(indices >> (byte * 8));
+        }
+    }
+
+    // The first index of an index set is stored with an implicit zero MSB
+    void write_bc7_indices(BlockBitWriter* writer, const u32* indices, u32 index_bits)
+    {
+        writer->write(indices[0], index_bits - 1);
+        for (u32 i = 1; i < k_block_texel_count; i++)
+        {
+            writer->write(indices[i], index_bits);
+        }
+    }
+
+    // Decoders replicate the high bits of an endpoint into the low bits
+    u32 expand_bc7_endpoint(u32 value, u32 num_bits)
+    {
+        return (value << (8 - num_bits)) | (value >> (2 * num_bits - 8));
+    }
+
+    struct Bc7ChannelFit
+    {
+        u32 m_endpoints[2][3] = {};
+        u32 m_indices[k_block_texel_count] = {};
+        f32 m_error = 0.0f;
+    };
+
+    // Quantizes low and high to endpoint_bits and picks the nearest of the N interpolated values for the num_dims channels
+    // starting at first_channel. The endpoints are swapped when the anchor index would not fit.
+    template <u32 N>
+    void fit_bc7_channels(const f32 (*texels)[4], u32 first_channel, u32 num_dims, const f32* low, const f32* high, u32 endpoint_bits,
+                          const u32 (&weights)[N], Bc7ChannelFit* fit)
+    {
+        const f32 max_endpoint = static_cast<f32>((1u << endpoint_bits) - 1);
+        u32 decoded_endpoints[2][3] = {};
+        f32 ramp_endpoints[2][3] = {};
+        for (u32 dim = 0; dim < num_dims; dim++)
+        {
+            const f32 values[2] = { low[dim], high[dim] };
+            for (u32 endpoint = 0; endpoint < 2; endpoint++)
+            {
+                const f32 value = values[endpoint] * max_endpoint / 255.0f + 0.5f;
+                fit->m_endpoints[endpoint][dim] = static_cast<u32>(ZV::min(ZV::max(value, 0.0f), max_endpoint));
+                decoded_endpoints[endpoint][dim] = expand_bc7_endpoint(fit->m_endpoints[endpoint][dim], endpoint_bits);
+                ramp_endpoints[endpoint][dim] = static_cast<f32>(decoded_endpoints[endpoint][dim]);
+            }
+        }
+
+        fit->m_error = 0.0f;
+        for (u32 i = 0; i < k_block_texel_count; i++)
+        {
+            const f32* texel = &texels[i][first_channel];
+            fit->m_indices[i] = find_ramp_index(texel, ramp_endpoints[0], ramp_endpoints[1], num_dims, weights, 64);
+
+            const u32 weight = weights[fit->m_indices[i]];
+            for (u32 dim = 0; dim < num_dims; dim++)
+            {
+                const u32 decoded = ((64 - weight) * decoded_endpoints[0][dim] + weight * decoded_endpoints[1][dim] + 32) >> 6;
+                const f32 difference = static_cast<f32>(decoded) - texel[dim];
+                fit->m_error += difference * difference;
+            }
+        }
+
+        if (fit->m_indices[0] >= N / 2)
+        {
+            for (u32 dim = 0; dim < num_dims; dim++)
+            {
+                std::swap(fit->m_endpoints[0][dim], fit->m_endpoints[1][dim]);
+            }
+
+            for (u32 i = 0; i < k_block_texel_count; i++)
+            {
+                fit->m_indices[i] = N - 1 - fit->m_indices[i];
+            }
+        }
+    }
+
+    struct Bc7SeparateAlphaMode
+    {
+        u32 m_mode = 0;
+        u32 m_index_mode = 0;  // Mode 4 only, 1 gives color the 3 bit indices instead of alpha
+        u32 m_color_bits = 0;
+        u32 m_alpha_bits = 0;
+        u32 m_color_index_bits = 0;
+        u32 m_alpha_index_bits = 0;
+    };
+
+    constexpr Bc7SeparateAlphaMode k_bc7_separate_alpha_modes[3] = {
+        { 4, 0, 5, 6, 2, 3 },
+        { 4, 1, 5, 6, 3, 2 },
+        { 5, 0, 7, 8, 2, 2 },
+    };
+
+    void write_bc7_separate_alpha_block(const Bc7SeparateAlphaMode& mode, u32 rotation, const Bc7ChannelFit& color_fit,
+                                        const Bc7ChannelFit& alpha_fit, u8* out)
+    {
+        memset(out, 0, 16);
+        BlockBitWriter writer{ out };
+        writer.write(1u << mode.m_mode, mode.m_mode + 1);
+        writer.write(rotation, 2);
+        if (mode.m_mode == 4)
+        {
+            writer.write(mode.m_index_mode, 1);
+        }
+
+        for (u32 dim = 0; dim < 3; dim++)
+        {
+            writer.write(color_fit.m_endpoints[0][dim], mode.m_color_bits);
+            writer.write(color_fit.m_endpoints[1][dim], mode.m_color_bits);
+        }
+        writer.write(alpha_fit.m_endpoints[0][0], mode.m_alpha_bits);
+        writer.write(alpha_fit.m_endpoints[1][0], mode.m_alpha_bits);
+
+        // The 2 bit index set always comes first
+        if (mode.m_color_index_bits == 3)
+        {
+            write_bc7_indices(&writer, alpha_fit.m_indices, 2);
+            write_bc7_indices(&writer, color_fit.m_indices, 3);
+        }
+        else
+        {
+            write_bc7_indices(&writer, color_fit.m_indices, 2);
+            write_bc7_indices(&writer, alpha_fit.m_indices, mode.m_alpha_index_bits);
+        }
+    }
+
+    void fit_bc7_channels(const f32 (*texels)[4], u32 first_channel, u32 num_dims, const f32* low, const f32* high, u32 endpoint_bits,
+                          u32 index_bits, Bc7ChannelFit* fit)
+    {
+        if (index_bits == 3)
+        {
+            fit_bc7_channels(texels, first_channel, num_dims, low, high, endpoint_bits, k_bc7_weights3, fit);
+        }
+        else
+        {
+            fit_bc7_channels(texels, first_channel, num_dims, low, high, endpoint_bits, k_bc7_weights2, fit);
+        }
+    }
+
+    // Modes 4 and 5: one subset with color and alpha fitted on their own, so alpha that does not follow the color is kept.
+    // The rotation swaps alpha with one of the color channels first. Returns the squared error of the block.
+    f32 encode_bc7_separate_alpha_block(const f32 (*texels)[4], u8* out)
+    {
+        f32 best_error = FLT_MAX;
+        for (u32 rotation = 0; rotation < 4; rotation++)
+        {
+            f32 rotated[k_block_texel_count][4];
+            memcpy(rotated, texels, sizeof(rotated));
+            if (rotation > 0)
+            {
+                for (u32 i = 0; i < k_block_texel_count; i++)
+                {
+                    std::swap(rotated[i][rotation - 1], rotated[i][3]);
+                }
+            }
+
+            f32 color_low[3] = {};
+            f32 color_high[3] = {};
+            compute_block_endpoints(rotated, 3, color_low, color_high);
+
+            f32 alpha_low = 255.0f;
+            f32 alpha_high = 0.0f;
+            for (u32 i = 0; i < k_block_texel_count; i++)
+            {
+                alpha_low = ZV::min(alpha_low, rotated[i][3]);
+                alpha_high = ZV::max(alpha_high, rotated[i][3]);
+            }
+
+            for (const Bc7SeparateAlphaMode& mode : k_bc7_separate_alpha_modes)
+            {
+                Bc7ChannelFit color_fit{};
+                Bc7ChannelFit alpha_fit{};
+                fit_bc7_channels(rotated, 0, 3, color_low, color_high, mode.m_color_bits, mode.m_color_index_bits, &color_fit);
+                fit_bc7_channels(rotated, 3, 1, &alpha_low, &alpha_high, mode.m_alpha_bits, mode.m_alpha_index_bits, &alpha_fit);
+
+                const f32 error = color_fit.m_error + alpha_fit.m_error;
+                if (error < best_error)
+                {
+                    best_error = error;
+                    write_bc7_separate_alpha_block(mode, rotation, color_fit, alpha_fit, out);
+                }
+            }
+        }
+
+        return best_error;
+    }
+
+    // Mode 6: one subset, RGBA 7.7.7.7 endpoints with unique p-bits and 4 bit indices. Returns the squared error of the block.
+    f32 encode_bc7_mode6_block(const f32 (*texels)[4], u8* out)
+    {
+        f32 low[4] = {};
+        f32 high[4] = {};
+        compute_block_endpoints(texels, 4, low, high);
+
+        u32 best_endpoints[2][4] = {};
+        u32 best_pbits[2] = {};
+        u32 best_indices[k_block_texel_count] = {};
+        f32 best_error = FLT_MAX;
+
+        for (u32 pbit_combination = 0; pbit_combination < 4; pbit_combination++)
+        {
+            const u32 pbits[2] = { pbit_combination & 1u, pbit_combination >> 1 };
+            u32 endpoints[2][4] = {};
+            f32 quantized[2][4] = {};
+
+            for (u32 dim = 0; dim < 4; dim++)
+            {
+                const f32 values[2] = { low[dim], high[dim] };
+                for (u32 endpoint = 0; endpoint < 2; endpoint++)
+                {
+                    const f32 value = (values[endpoint] - static_cast<f32>(pbits[endpoint])) * 0.5f + 0.5f;
+                    endpoints[endpoint][dim] = static_cast<u32>(ZV::min(ZV::max(value, 0.0f), 127.0f));
+                    quantized[endpoint][dim] = static_cast<f32>((endpoints[endpoint][dim] << 1) | pbits[endpoint]);
+                }
+            }
+
+            u32 indices[k_block_texel_count] = {};
+            f32 error = 0.0f;
+
+            for (u32 i = 0; i < k_block_texel_count; i++)
+            {
+                indices[i] = find_ramp_index(texels[i], quantized[0], quantized[1], 4, k_bc7_weights4, 64);
+
+                const u32 weight = k_bc7_weights4[indices[i]];
+                for (u32 dim = 0; dim < 4; dim++)
+                {
+                    const u32 decoded = ((64 - weight) * static_cast<u32>(quantized[0][dim]) + weight * static_cast<u32>(quantized[1][dim]) + 32) >> 6;
+                    const f32 difference = static_cast<f32>(decoded) - texels[i][dim];
+                    error += difference * difference;
+                }
+            }
+
+            if (error < best_error)
+            {
+                best_error = error;
+                memcpy(best_endpoints, endpoints, sizeof(endpoints));
+                memcpy(best_pbits, pbits, sizeof(pbits));
+                memcpy(best_indices, indices, sizeof(indices));
+            }
+        }
+
+        // The anchor index is stored with an implicit zero MSB, swap the endpoints when needed
+        if (best_indices[0] & 8u)
+        {
+            for (u32 dim = 0; dim < 4; dim++)
+            {
+                std::swap(best_endpoints[0][dim], best_endpoints[1][dim]);
+            }
+            std::swap(best_pbits[0], best_pbits[1]);
+
+            for (u32 i = 0; i < k_block_texel_count; i++)
+            {
+                best_indices[i] = 15 - best_indices[i];
+            }
+        }
+
+        memset(out, 0, 16);
+        BlockBitWriter writer{ out };
+        writer.write(1u << 6, 7);
+
+        for (u32 dim = 0; dim < 4; dim++)
+        {
+            writer.write(best_endpoints[0][dim], 7);
+            writer.write(best_endpoints[1][dim], 7);
+        }
+
+        writer.write(best_pbits[0], 1);
+        writer.write(best_pbits[1], 1);
+
+        write_bc7_indices(&writer, best_indices, 4);
+
+        return best_error;
+    }
+
+    // Keeps whichever of modes 4, 5 and 6 encodes the block with the lowest squared error. Blocks mode 6 already
+    // reproduces to within one step on average are kept as they are, the separate alpha modes cost four times as much.
+    void encode_bc7_block(const f32 (*texels)[4], u8* out)
+    {
+        constexpr f32 k_good_enough_error = static_cast<f32>(k_block_texel_count * 4);
+
+        const f32 mode6_error = encode_bc7_mode6_block(texels, out);
+        if (mode6_error <= k_good_enough_error)
+        {
+            return;
+        }
+
+        u8 candidate[16];
+        if (encode_bc7_separate_alpha_block(texels, candidate) < mode6_error)
+        {
+            memcpy(out, candidate, sizeof(candidate));
+        }
+    }
+
+
+    struct CompressContext
+    {
+        const u8* m_src = nullptr;
+        u32 m_width = 0;
+        u32 m_height = 0;
+        u32 m_num_channels = 0;
+        u8* m_dst = nullptr;
+        size_t m_dst_pitch = 0;
+        u32 m_bytes_per_block = 0;
+        TextureCompression m_compression = TextureCompression::None;
+    };
+
+    PARALLEL_FOR_CALLBACK(compress_block_rows_job)
+    {
+        const CompressContext& context = *static_cast<const CompressContext*>(data);
+        const u32 blocks_wide = (context.m_width + 3) / 4;
+
+        f32 texels[k_block_texel_count][4];
+
+        for (u32 block_y = begin; block_y < end; block_y++)
+        {
+            u8* dst_block = context.m_dst + block_y * context.m_dst_pitch;
+
+            for (u32 block_x = 0; block_x < blocks_wide; block_x++, dst_block += context.m_bytes_per_block)
+            {
+                fetch_block(context.m_src, context.m_width, context.m_height, context.m_num_channels, block_x, block_y, texels);
+
+                switch (context.m_compression)
+                {
+                    case TextureCompression::BC1:
+                    {
+                        encode_bc1_block(texels, dst_block);
+                        break;
+                    }
+                    case TextureCompression::BC4:
+                    {
+                        encode_bc4_block(texels, 0, dst_block);
+                        break;
+                    }
+                    case TextureCompression::BC5:
+                    {
+                        encode_bc4_block(texels, 0, dst_block);
+                        encode_bc4_block(texels, 1, dst_block + 8);
+                        break;
+                    }
+                    case TextureCompression::BC7:
+                    {
+                        encode_bc7_block(texels, dst_block);
+                        break;
+                    }
+                    default:
+                    {
+                        zv_assert_msg(false, "Unsupported texture compression");
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Channel packing
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    struct PackContext
+    {
+        const TextureChannelSource* m_sources = nullptr;
+        u32 m_num_sources = 0;
+        u32 m_width = 0;
+        u32 m_height = 0;
+        u8* m_dst = nullptr;
+    };
+
+    PARALLEL_FOR_CALLBACK(pack_channel_rows_job)
+    {
+        const PackContext& context = *static_cast<const PackContext*>(data);
+
+        for (u32 y = begin; y < end; y++)
+        {
+            u8* dst_row = context.m_dst + static_cast<size_t>(y) * context.m_width * context.m_num_sources;
+
+            for (u32 channel = 0; channel < context.m_num_sources; channel++)
+            {
+                const TextureChannelSource& source = context.m_sources[channel];
+                u8* dst = dst_row + channel;
+
+                if (!source.m_data)
+                {
+                    for (u32 x = 0; x < context.m_width; x++, dst += context.m_num_sources)
+                    {
+                        *dst = source.m_fill_value;
+                    }
+                    continue;
+                }
+
+                // Sources of a different size are point sampled
+                const u32 src_y = static_cast<u32>(static_cast<u64>(y) * source.m_height / context.m_height);
+                const u8* src_row = source.m_data + static_cast<size_t>(src_y) * source.m_width * source.m_num_channels + source.m_channel;
+
+                if (source.m_width == context.m_width)
+                {
+                    for (u32 x = 0; x < context.m_width; x++, dst += context.m_num_sources, src_row += source.m_num_channels)
+                    {
+                        *dst = *src_row;
+                    }
+                }
+                else
+                {
+                    for (u32 x = 0; x < context.m_width; x++, dst += context.m_num_sources)
+                    {
+                        const u32 src_x = static_cast<u32>(static_cast<u64>(x) * source.m_width / context.m_width);
+                        *dst = src_row[static_cast<size_t>(src_x) * source.m_num_channels];
+                    }
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Upload layout
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    u64 align_up(u64 value, u64 alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    struct UploadLayoutContext
+    {
+        const u8* m_src = nullptr;
+        size_t m_src_pitch = 0;
+        u32 m_src_texel_size = 0;
+        u32 m_width = 0;  // Texels, or blocks for compressed textures
+        u8* m_dst = nullptr;
+        u32 m_dst_pitch = 0;
+        u32 m_dst_texel_size = 0;
+    };
+
+    PARALLEL_FOR_CALLBACK(write_upload_rows_job)
+    {
+        const UploadLayoutContext& context = *static_cast<const UploadLayoutContext*>(data);
+
+        for (u32 y = begin; y < end; y++)
+        {
+            const u8* src = context.m_src + y * context.m_src_pitch;
+            u8* dst = context.m_dst + static_cast<size_t>(y) * context.m_dst_pitch;
+
+            if (context.m_src_texel_size == context.m_dst_texel_size)
+            {
+                memcpy(dst, src, static_cast<size_t>(context.m_width) * context.m_src_texel_size);
+                continue;
+            }
+
+            // RGB to RGBA
+            for (u32 x = 0; x < context.m_width; x++, src += context.m_src_texel_size, dst += context.m_dst_texel_size)
+            {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 255;
+            }
+        }
+    }
+
+    void set_upload_layout(TextureAsset* texture, UniquePtr<u8[]> data, DynamicArray<TextureFootprint> footprints, u64 upload_size)
+    {
+        texture->m_data = move_ptr(data);
+        texture->m_footprints = move_ptr(footprints);
+        texture->m_upload_size = upload_size;
+    }
+
+    //------------------------------------------------------------------------------------------------------------------------------------
+    // Atlas packing
+    //------------------------------------------------------------------------------------------------------------------------------------
+
+    // Entries are placed on whole 4x4 blocks and on whole texels of every mip level
+    u32 get_atlas_alignment(const MipGenerationSettings& mip_settings)
+    {
+        return ZV::max(4u, 1u << (mip_settings.m_max_mip_levels - 1));
+    }
+
+    struct SkylineNode
+    {
+        u32 m_x = 0;
+        u32 m_y = 0;
+        u32 m_width = 0;
+    };
+
+    // Lowest y at which a rect of the given size can rest on the skyline starting at node_index, UINT32_MAX if it does not fit
+    u32 skyline_fit(const DynamicArray<SkylineNode>& skyline, size_t node_index, u32 width, u32 height, u32 atlas_width, u32 atlas_height)
+    {
+        const u32 x = skyline[node_index].m_x;
+        if (x + width > atlas_width)
+        {
+            return UINT32_MAX;
+        }
+
+        u32 y = 0;
+        u32 width_left = width;
+        for (size_t i = node_index; width_left > 0; i++)
+        {
+            zv_assert_msg(i < skyline.size(), "Skyline does not cover the atlas width");
+
+            y = ZV::max(y, skyline[i].m_y);
+            if (y + height > atlas_height)
+            {
+                return UINT32_MAX;
+            }
+
+            width_left -= ZV::min(width_left, skyline[i].m_width);
+        }
+
+        return y;
+    }
+
+    void skyline_insert(DynamicArray<SkylineNode>& skyline, size_t node_index, u32 x, u32 y, u32 width)
+    {
+        skyline.insert(skyline.begin() + node_index, SkylineNode{ x, y, width });
+
+        // Trim the nodes now covered by the new one
+        for (size_t i = node_index + 1; i < skyline.size();)
+        {
+            const SkylineNode& previous = skyline[i - 1];
+            const u32 previous_end = previous.m_x + previous.m_width;
+
+            if (skyline[i].m_x >= previous_end)
+            {
+                break;
+            }
+
+            const u32 shrink = previous_end - skyline[i].m_x;
+            if (skyline[i].m_width <= shrink)
+            {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+
+            skyline[i].m_x += shrink;
+            skyline[i].m_width -= shrink;
+            break;
+        }
+
+        // Merge neighbours at the same height
+        for (size_t i = 0; i + 1 < skyline.size();)
+        {
+            if (skyline[i].m_y == skyline[i + 1].m_y)
+            {
+                skyline[i].m_width += skyline[i + 1].m_width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+#if ZV_DEBUG
+    void check_atlas_placements(const AtlasRect* rects, u32 num_rects, u32 atlas_width, u32 atlas_height, const AtlasPlacement* placements)
+    {
+        for (u32 i = 0; i < num_rects; i++)
+        {
+            zv_assert_msg(placements[i].m_x + rects[i].m_width <= atlas_width && placements[i].m_y + rects[i].m_height <= atlas_height, "Atlas rect {} is out of bounds", i);
+
+            for (u32 j = i + 1; j < num_rects; j++)
+            {
+                const bool is_separate =
+                    placements[i].m_x + rects[i].m_width <= placements[j].m_x || placements[j].m_x + rects[j].m_width <= placements[i].m_x ||
+                    placements[i].m_y + rects[i].m_height <= placements[j].m_y || placements[j].m_y + rects[j].m_height <= placements[i].m_y;
+                zv_assert_msg(is_separate, "Atlas rects {} and {} overlap", i, j);
+            }
+        }
+    }
+#endif
+
+#if ZV_DEBUG
+    void check_against_reference(const DownsampleContext& context)
+    {
+        const size_t size = static_cast<size_t>(context.m_dst_width) * context.m_dst_height * context.m_num_channels;
+        UniquePtr<u8[]> reference = make_unique_ptr<u8[]>(size);
+
+        downsample_mip_level_reference(
+            context.m_src, context.m_src_width, context.m_src_height,
+            reference.get(), context.m_dst_width, context.m_dst_height,
+            context.m_num_channels, context.m_settings);
+
+        s32 max_error = 0;
+        for (size_t i = 0; i < size; i++)
+        {
+            max_error = ZV::max(max_error, ZV::abs(static_cast<s32>(reference[i]) - static_cast<s32>(context.m_dst[i])));
+        }
+
+        // The linear to sRGB table can be off by one step in the darks
+        zv_assert_msg(max_error <= 2, "Mip level differs from scalar reference by {}", max_error);
+    }
+#endif
+}
+
+u32 get_mip_level_count(u32 width, u32 height)
+{
+    u32 mip_levels = 1;
+    u32 size = ZV::max(width, height);
+
+    while (size > 1)
+    {
+        size >>= 1;
+        mip_levels++;
+    }
+
+    return mip_levels;
+}
+
+MipGenerationSettings get_default_mip_settings(const TextureAsset& texture)
+{
+    MipGenerationSettings settings{};
+    settings.m_filter = texture.m_usage == TextureUsage::Color ? MipFilter::Kaiser : MipFilter::Box;
+    settings.m_is_srgb = texture.m_format == TextureFormat::SRGB;
+    settings.m_is_normal_map = texture.m_usage == TextureUsage::Normal;
+    return settings;
+}
+
+void generate_mip_chain(TextureAsset* texture, const MipGenerationSettings& settings)
+{
+    zv_assert_msg(texture->m_mip_levels == 1, "Texture already has a mip chain");
+    zv_assert_msg(!texture->has_upload_layout(), "Mip generation needs tightly packed data");
+    zv_assert_msg(texture->m_depth == 1 && texture->m_array_size == 1, "Mip generation only supports single 2D textures");
+    zv_assert_msg(texture->m_num_channels >= 1 && texture->m_num_channels <= 4, "Unsupported number of channels");
+
+    u32 mip_levels = ZV::min(get_mip_level_count(texture->m_width, texture->m_height), k_max_texture_subresource_count);
+    if (settings.m_max_mip_levels > 0)
+    {
+        mip_levels = ZV::min(mip_levels, settings.m_max_mip_levels);
+    }
+
+    if (mip_levels <= 1)
+    {
+        return;
+    }
+
+    const size_t base_size = texture->get_mip_size(0);
+    texture->m_mip_levels = static_cast<u16>(mip_levels);
+
+    UniquePtr<u8[]> mip_chain = make_unique_ptr<u8[]>(texture->get_data_size());
+    memcpy(mip_chain.get(), texture->m_data.get(), base_size);
+
+    DownsampleContext context{};
+    context.m_num_channels = texture->m_num_channels;
+    context.m_settings = settings;
+    context.m_kernel = make_filter_kernel(settings.m_filter);
+    context.m_tables = &get_color_tables();
+
+    for (u32 mip = 1; mip < mip_levels; mip++)
+    {
+        context.m_src = mip_chain.get() + texture->get_mip_offset(mip - 1);
+        context.m_src_width = texture->get_mip_width(mip - 1);
+        context.m_src_height = texture->get_mip_height(mip - 1);
+        context.m_dst = mip_chain.get() + texture->get_mip_offset(mip);
+        context.m_dst_width = texture->get_mip_width(mip);
+        context.m_dst_height = texture->get_mip_height(mip);
+
+        const u32 rows_per_batch = ZV::max(k_min_texels_per_batch / context.m_dst_width, 1u);
+        Platform::parallel_for(context.m_dst_height, rows_per_batch, &downsample_rows_job, &context);
+
+#if ZV_DEBUG
+        if (context.m_dst_width * context.m_dst_height <= k_max_reference_check_texels)
+        {
+            check_against_reference(context);
+        }
+#endif
+    }
+
+    texture->m_data = move_ptr(mip_chain);
+}
+
+TextureCompression get_default_texture_compression(const TextureAsset& texture)
+{
+    // D3D12 requires the top level of block compressed textures to be a multiple of the block size
+    if ((texture.m_width % 4) != 0 || (texture.m_height % 4) != 0 || texture.is_block_compressed())
+    {
+        return TextureCompression::None;
+    }
+
+    switch (texture.m_usage)
+    {
+        case TextureUsage::Normal:
+        {
+            return texture.m_num_channels >= 2 ? TextureCompression::BC5 : TextureCompression::BC4;
+        }
+        case TextureUsage::Color:
+        {
+            if (texture.m_num_channels < 4)
+            {
+                return TextureCompression::BC1;
+            }
+
+            // Only spend the extra memory of BC7 on textures that actually use alpha
+            const u8* texels = texture.m_data.get();
+            const size_t num_texels = static_cast<size_t>(texture.m_width) * texture.m_height;
+            for (size_t i = 0; i < num_texels; i++)
+            {
+                if (texels[i * 4 + 3] != 255)
+                {
+                    return TextureCompression::BC7;
+                }
+            }
+            return TextureCompression::BC1;
+        }
+        default:
+        {
+            if (texture.m_num_channels == 1)
+            {
+                return TextureCompression::BC4;
+            }
+            return texture.m_num_channels == 2 ? TextureCompression::BC5 : TextureCompression::BC7;
+        }
+    }
+}
+
+void compress_texture(TextureAsset* texture, TextureCompression compression)
+{
+    if (compression == TextureCompression::None)
+    {
+        return;
+    }
+
+    zv_assert_msg(!texture->is_block_compressed(), "Texture is already block compressed");
+    zv_assert_msg(!texture->has_upload_layout() && texture->m_array_size == 1, "Compression needs a single tightly packed texture");
+    zv_assert_msg((texture->m_width % 4) == 0 && (texture->m_height % 4) == 0, "Block compression requires a block aligned top level");
+
+    StaticArray<size_t, k_max_texture_subresource_count> src_offsets = {};
+    for (u32 mip = 0; mip < texture->m_mip_levels; mip++)
+    {
+        src_offsets[mip] = texture->get_mip_offset(mip);
+    }
+
+    // Blocks are encoded straight into the upload layout, so the renderer can hand the result to the GPU as is
+    texture->m_compression = compression;
+    DynamicArray<TextureFootprint> footprints(texture->get_subresource_count());
+    const u64 upload_size = compute_texture_footprints(*texture, footprints.data());
+    UniquePtr<u8[]> compressed = make_unique_ptr<u8[]>(upload_size);
+
+    CompressContext context{};
+    context.m_num_channels = texture->m_num_channels;
+    context.m_bytes_per_block = texture->get_bytes_per_block();
+    context.m_compression = compression;
+
+    for (u32 mip = 0; mip < texture->m_mip_levels; mip++)
+    {
+        context.m_src = texture->m_data.get() + src_offsets[mip];
+        context.m_width = texture->get_mip_width(mip);
+        context.m_height = texture->get_mip_height(mip);
+        context.m_dst = compressed.get() + footprints[mip].m_offset;
+        context.m_dst_pitch = footprints[mip].m_row_pitch;
+
+        const u32 blocks_wide = (context.m_width + 3) / 4;
+        const u32 rows_per_batch = ZV::max(k_min_blocks_per_batch / blocks_wide, 1u);
+        Platform::parallel_for(footprints[mip].m_num_rows, rows_per_batch, &compress_block_rows_job, &context);
+    }
+
+    set_upload_layout(texture, move_ptr(compressed), move_ptr(footprints), upload_size);
+}
+
+u64 compute_texture_footprints(const TextureAsset& texture, TextureFootprint* out_footprints)
+{
+    const bool is_3d_texture = texture.m_dimension == TextureDimension::Texture3D;
+    const u32 num_slices = is_3d_texture ? 1 : texture.m_array_size;
+    const u32 block_size = texture.is_block_compressed() ? 4 : 1;
+    const u32 bytes_per_block = texture.get_upload_bytes_per_block();
+
+    u64 offset = 0;
+    u64 total_size = 0;
+
+    for (u32 slice = 0; slice < num_slices; slice++)
+    {
+        for (u32 mip = 0; mip < texture.m_mip_levels; mip++)
+        {
+            TextureFootprint& footprint = out_footprints[mip + slice * texture.m_mip_levels];
+
+            const u32 blocks_wide = (texture.get_mip_width(mip) + block_size - 1) / block_size;
+            const u32 blocks_high = (texture.get_mip_height(mip) + block_size - 1) / block_size;
+
+            footprint.m_offset = align_up(offset, k_texture_placement_alignment);
+            footprint.m_width = blocks_wide * block_size;
+            footprint.m_height = blocks_high * block_size;
+            footprint.m_depth = is_3d_texture ? ZV::max(static_cast<u32>(texture.m_depth) >> mip, 1u) : 1;
+            footprint.m_row_size = blocks_wide * bytes_per_block;
+            footprint.m_row_pitch = static_cast<u32>(align_up(footprint.m_row_size, k_texture_row_pitch_alignment));
+            footprint.m_num_rows = blocks_high;
+
+            // Same as GetCopyableFootprints, the padding after the last row is not part of the total
+            const u64 num_rows = static_cast<u64>(footprint.m_num_rows) * footprint.m_depth;
+            total_size = footprint.m_offset + footprint.m_row_pitch * (num_rows - 1) + footprint.m_row_size;
+            offset = footprint.m_offset + footprint.m_row_pitch * num_rows;
+        }
+    }
+
+    return total_size;
+}
+
+void convert_to_upload_layout(TextureAsset* texture)
+{
+    if (texture->has_upload_layout())
+    {
+        return;
+    }
+
+    DynamicArray<TextureFootprint> footprints(texture->get_subresource_count());
+    const u64 upload_size = compute_texture_footprints(*texture, footprints.data());
+    UniquePtr<u8[]> upload_data = make_unique_ptr<u8[]>(upload_size);
+
+    const u32 num_slices = static_cast<u32>(footprints.size()) / texture->m_mip_levels;
+
+    UploadLayoutContext context{};
+    context.m_src_texel_size = texture->get_bytes_per_block();
+    context.m_dst_texel_size = texture->get_upload_bytes_per_block();
+
+    for (u32 slice = 0; slice < num_slices; slice++)
+    {
+        for (u32 mip = 0; mip < texture->m_mip_levels; mip++)
+        {
+            const TextureFootprint& footprint = footprints[mip + slice * texture->m_mip_levels];
+
+            context.m_src = texture->m_data.get() + texture->get_subresource_offset(slice, mip);
+            context.m_src_pitch = texture->get_mip_pitch(mip);
+            context.m_width = footprint.m_row_size / context.m_dst_texel_size;
+            context.m_dst = upload_data.get() + footprint.m_offset;
+            context.m_dst_pitch = footprint.m_row_pitch;
+
+            // Depth slices of a 3D mip follow each other in both layouts
+            const u32 rows_per_batch = ZV::max(k_min_texels_per_batch / context.m_width, 1u);
+            Platform::parallel_for(footprint.m_num_rows * footprint.m_depth, rows_per_batch, &write_upload_rows_job, &context);
+        }
+    }
+
+    set_upload_layout(texture, move_ptr(upload_data), move_ptr(footprints), upload_size);
+}
+
+void pack_texture_channels(u8* dst, u32 width, u32 height, const TextureChannelSource* sources, u32 num_sources)
+{
+    zv_assert_msg(num_sources >= 1 && num_sources <= 4, "Unsupported number of packed channels");
+
+    for (u32 channel = 0; channel < num_sources; channel++)
+    {
+        zv_assert_msg(!sources[channel].m_data || sources[channel].m_channel < sources[channel].m_num_channels, "Source channel out of range");
+    }
+
+    PackContext context{};
+    context.m_sources = sources;
+    context.m_num_sources = num_sources;
+    context.m_width = width;
+    context.m_height = height;
+    context.m_dst = dst;
+
+    const u32 rows_per_batch = ZV::max(k_min_texels_per_batch / width, 1u);
+    Platform::parallel_for(height, rows_per_batch, &pack_channel_rows_job, &context);
+}
+
+bool cook_orms_texture(const TextureChannelSource* sources, TextureAsset* out_texture)
+{
+    const TextureChannelSource* size_source = nullptr;
+    for (u32 channel = 0; channel < k_orms_channel_count && !size_source; channel++)
+    {
+        size_source = sources[channel].m_data ? &sources[channel] : nullptr;
+    }
+
+    if (!size_source)
+    {
+        return false;
+    }
+
+    out_texture->m_width        = size_source->m_width;
+    out_texture->m_height       = size_source->m_height;
+    out_texture->m_num_channels = k_orms_channel_count;
+    out_texture->m_data         = make_unique_ptr<u8[]>(static_cast<size_t>(out_texture->m_width) * out_texture->m_height * k_orms_channel_count);
+    out_texture->m_format       = TextureFormat::Linear;
+    out_texture->m_usage        = TextureUsage::Data;
+
+    pack_texture_channels(out_texture->m_data.get(), out_texture->m_width, out_texture->m_height, sources, k_orms_channel_count);
+    return true;
+}
+
+bool pack_atlas_rects(const AtlasRect* rects, u32 num_rects, u32 atlas_width, u32 atlas_height, AtlasPlacement* out_placements)
+{
+    DynamicArray<u32> order(num_rects);
+    fill_sequential(order.begin(), order.end(), 0u);
+
+    // Tallest first, then widest, ties keep input order so the result is deterministic
+    sort_container(order.begin(), order.end(), [rects](u32 a, u32 b)
+    {
+        if (rects[a].m_height != rects[b].m_height)
+        {
+            return rects[a].m_height > rects[b].m_height;
+        }
+        if (rects[a].m_width != rects[b].m_width)
+        {
+            return rects[a].m_width > rects[b].m_width;
+        }
+        return a < b;
+    });
+
+    DynamicArray<SkylineNode> skyline;
+    skyline.push_back(SkylineNode{ 0, 0, atlas_width });
+
+    for (u32 rect_index : order)
+    {
+        const AtlasRect& rect = rects[rect_index];
+
+        u32 best_y = UINT32_MAX;
+        u32 best_x = UINT32_MAX;
+        size_t best_node = 0;
+
+        for (size_t node = 0; node < skyline.size(); node++)
+        {
+            const u32 y = skyline_fit(skyline, node, rect.m_width, rect.m_height, atlas_width, atlas_height);
+            if (y < best_y || (y == best_y && skyline[node].m_x < best_x))
+            {
+                best_y = y;
+                best_x = skyline[node].m_x;
+                best_node = node;
+            }
+        }
+
+        if (best_y == UINT32_MAX)
+        {
+            return false;
+        }
+
+        out_placements[rect_index] = AtlasPlacement{ best_x, best_y };
+        skyline_insert(skyline, best_node, best_x, best_y + rect.m_height, rect.m_width);
+    }
+
+#if ZV_DEBUG
+    check_atlas_placements(rects, num_rects, atlas_width, atlas_height, out_placements);
+#endif
+
+    return true;
+}
+
+u32 get_atlas_gutter(const MipGenerationSettings& mip_settings)
+{
+    zv_assert_msg(mip_settings.m_max_mip_levels > 0, "Atlas mip chains need a fixed number of levels");
+
+    // Texels a destination texel reads beyond the two it covers, on either side
+    const FilterKernel kernel = make_filter_kernel(mip_settings.m_filter);
+    const u32 reach = static_cast<u32>(ZV::max(-kernel.m_first_offset, kernel.m_first_offset + static_cast<s32>(kernel.m_num_taps) - 2));
+
+    // One clean texel for bilinear filtering at the last level, every level above needs twice that plus the filter reach
+    u32 gutter = 1;
+    for (u32 mip = 1; mip < mip_settings.m_max_mip_levels; mip++)
+    {
+        gutter = gutter * 2 + reach;
+    }
+
+    // Entries have to start on a texel of every level
+    return static_cast<u32>(align_up(gutter, get_atlas_alignment(mip_settings)));
+}
+
+bool build_texture_atlas(const TextureAsset* const* sources, u32 num_sources, const MipGenerationSettings& mip_settings,
+                         TextureAsset* out_atlas, Vector4* out_uv_transforms)
+{
+    zv_assert_msg(num_sources > 0, "Atlas needs at least one source");
+
+    const u32 num_channels = sources[0]->m_num_channels;
+    const u32 gutter = get_atlas_gutter(mip_settings);
+    const u32 alignment = get_atlas_alignment(mip_settings);
+    DynamicArray<AtlasRect> rects(num_sources);
+    u64 total_area = 0;
+
+    for (u32 i = 0; i < num_sources; i++)
+    {
+        const TextureAsset& source = *sources[i];
+        zv_assert_msg(!source.is_block_compressed() && source.m_mip_levels == 1 && !source.has_upload_layout(), "Atlas sources must be tightly packed, uncompressed single mip textures");
+        zv_assert_msg(source.m_num_channels == num_channels && source.m_format == sources[0]->m_format, "Atlas sources must share the same format");
+
+        // Entries stay block aligned so the atlas can be block compressed afterwards
+        rects[i].m_width = static_cast<u32>(align_up(source.m_width + 2 * gutter, alignment));
+        rects[i].m_height = static_cast<u32>(align_up(source.m_height + 2 * gutter, alignment));
+        total_area += static_cast<u64>(rects[i].m_width) * rects[i].m_height;
+    }
+
+    DynamicArray<AtlasPlacement> placements(num_sources);
+    u32 atlas_size = 4;
+    while (static_cast<u64>(atlas_size) * atlas_size < total_area)
+    {
+        atlas_size *= 2;
+    }
+
+    while (!pack_atlas_rects(rects.data(), num_sources, atlas_size, atlas_size, placements.data()))
+    {
+        atlas_size *= 2;
+        if (atlas_size > k_atlas_max_size)
+        {
+            return false;
+        }
+    }
+
+    out_atlas->m_width = atlas_size;
+    out_atlas->m_height = atlas_size;
+    out_atlas->m_num_channels = num_channels;
+    out_atlas->m_dimension = TextureDimension::Texture2D;
+    out_atlas->m_format = sources[0]->m_format;
+    out_atlas->m_usage = sources[0]->m_usage;
+    out_atlas->m_data = make_unique_ptr<u8[]>(out_atlas->get_data_size());
+    memset(out_atlas->m_data.get(), 0, out_atlas->get_data_size());
+
+    const size_t atlas_pitch = static_cast<size_t>(atlas_size) * num_channels;
+    const f32 inv_atlas_size = 1.0f / static_cast<f32>(atlas_size);
+
+    for (u32 i = 0; i < num_sources; i++)
+    {
+        const TextureAsset& source = *sources[i];
+        const u32 padded_width = source.m_width + 2 * gutter;
+        const u32 padded_height = source.m_height + 2 * gutter;
+
+        // The gutter repeats the opposite edge, so bilinear filtering at the border matches wrap addressing
+        for (u32 y = 0; y < padded_height; y++)
+        {
+            const u32 src_y = (y + source.m_height - (gutter % source.m_height)) % source.m_height;
+            const u8* src_row = source.m_data.get() + static_cast<size_t>(src_y) * source.m_width * num_channels;
+            u8* dst_row = out_atlas->m_data.get() + (placements[i].m_y + y) * atlas_pitch + static_cast<size_t>(placements[i].m_x) * num_channels;
+
+            for (u32 x = 0; x < padded_width; x++)
+            {
+                const u32 src_x = (x + source.m_width - (gutter % source.m_width)) % source.m_width;
+                memcpy(dst_row + static_cast<size_t>(x) * num_channels, src_row + static_cast<size_t>(src_x) * num_channels, num_channels);
+            }
+        }
+
+        out_uv_transforms[i] = Vector4(
+            static_cast<f32>(source.m_width) * inv_atlas_size,
+            static_cast<f32>(source.m_height) * inv_atlas_size,
+            static_cast<f32>(placements[i].m_x + gutter) * inv_atlas_size,
+            static_cast<f32>(placements[i].m_y + gutter) * inv_atlas_size);
+    }
+
+    return true;
+}
+
+void build_texture_array(const TextureAsset* const* sources, u32 num_sources, TextureAsset* out_array)
+{
+    zv_assert_msg(num_sources > 0, "Texture array needs at least one source");
+
+    const TextureAsset& first = *sources[0];
+
+    out_array->m_width = first.m_width;
+    out_array->m_height = first.m_height;
+    out_array->m_num_channels = first.m_num_channels;
+    out_array->m_dimension = TextureDimension::Texture2D;
+    out_array->m_format = first.m_format;
+    out_array->m_usage = first.m_usage;
+    out_array->m_compression = first.m_compression;
+    out_array->m_mip_levels = first.m_mip_levels;
+    out_array->m_array_size = static_cast<u16>(num_sources);
+
+    for (u32 i = 0; i < num_sources; i++)
+    {
+        const TextureAsset& source = *sources[i];
+        zv_assert_msg(source.m_width == first.m_width && source.m_height == first.m_height &&
+                      source.m_num_channels == first.m_num_channels && source.m_format == first.m_format &&
+                      source.m_compression == first.m_compression && source.m_mip_levels == first.m_mip_levels &&
+                      source.m_array_size == 1 && source.has_upload_layout() == first.has_upload_layout(), "Texture array slices must match");
+    }
+
+    if (!first.has_upload_layout())
+    {
+        out_array->m_data = make_unique_ptr<u8[]>(out_array->get_data_size());
+
+        const size_t slice_size = out_array->get_slice_size();
+        for (u32 i = 0; i < num_sources; i++)
+        {
+            memcpy(out_array->m_data.get() + out_array->get_subresource_offset(i, 0), sources[i]->m_data.get(), slice_size);
+        }
+        return;
+    }
+
+    // Slices have the same footprints as their sources, only the offsets move
+    DynamicArray<TextureFootprint> footprints(out_array->get_subresource_count());
+    const u64 upload_size = compute_texture_footprints(*out_array, footprints.data());
+    UniquePtr<u8[]> upload_data = make_unique_ptr<u8[]>(upload_size);
+
+    for (u32 i = 0; i < num_sources; i++)
+    {
+        for (u32 mip = 0; mip < first.m_mip_levels; mip++)
+        {
+            const TextureFootprint& src_footprint = sources[i]->m_footprints[mip];
+            const TextureFootprint& dst_footprint = footprints[mip + i * first.m_mip_levels];
+            const size_t size = static_cast<size_t>(src_footprint.m_row_pitch) * (src_footprint.m_num_rows - 1) + src_footprint.m_row_size;
+
+            memcpy(upload_data.get() + dst_footprint.m_offset, sources[i]->m_data.get() + src_footprint.m_offset, size);
+        }
+    }
+
+    set_upload_layout(out_array, move_ptr(upload_data), move_ptr(footprints), upload_size);
+}
+
+void downsample_mip_level_reference(
+    const u8* src, u32 src_width, u32 src_height,
+    u8* dst, u32 dst_width, u32 dst_height,
+    u32 num_channels, const MipGenerationSettings& settings)
+{
+    const FilterKernel kernel = make_filter_kernel(settings.m_filter);
+
+    for (u32 y = 0; y < dst_height; y++)
+    {
+        for (u32 x = 0; x < dst_width; x++)
+        {
+            f64 sum[4] = {};
+
+            for (u32 tap_y = 0; tap_y < kernel.m_num_taps; tap_y++)
+            {
+                const u32 src_y = clamp_coordinate(static_cast<s32>(y * 2 + tap_y) + kernel.m_first_offset, src_height);
+
+                for (u32 tap_x = 0; tap_x < kernel.m_num_taps; tap_x++)
+                {
+                    const u32 src_x = clamp_coordinate(static_cast<s32>(x * 2 + tap_x) + kernel.m_first_offset, src_width);
+                    const u8* src_texel = src + (static_cast<size_t>(src_y) * src_width + src_x) * num_channels;
+                    const f64 weight = static_cast<f64>(kernel.m_weights[tap_x]) * static_cast<f64>(kernel.m_weights[tap_y]);
+
+                    for (u32 channel = 0; channel < num_channels; channel++)
+                    {
+                        f32 value = static_cast<f32>(src_texel[channel]) / 255.0f;
+                        if (settings.m_is_srgb && channel < 3)
+                        {
+                            value = srgb_channel_to_linear(value);
+                        }
+                        sum[channel] += weight * value;
+                    }
+                }
+            }
+
+            f32 texel[4] = {};
+            for (u32 channel = 0; channel < num_channels; channel++)
+            {
+                texel[channel] = static_cast<f32>(sum[channel]);
+            }
+
+            if (settings.m_is_normal_map && num_channels >= 3)
+            {
+                renormalize_normal(texel);
+            }
+
+            u8* dst_texel = dst + (static_cast<size_t>(y) * dst_width + x) * num_channels;
+            for (u32 channel = 0; channel < num_channels; channel++)
+            {
+                f32 value = saturate(texel[channel]);
+                if (settings.m_is_srgb && channel < 3)
+                {
+                    value = linear_channel_to_srgb(value);
+                }
+                dst_texel[channel] = static_cast<u8>(value * 255.0f + 0.5f);
+            }
+        }
+    }
+}
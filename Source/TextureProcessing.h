@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Asset.h>
+#include <CoreDefs.h>
+
+enum class MipFilter : u8
+{
+    Box = 0,     // 2x2 average
+    Kaiser = 1,  // 6 tap Kaiser windowed sinc, sharper for color textures
+};
+
+struct MipGenerationSettings
+{
+    MipFilter m_filter = MipFilter::Box;
+    bool m_is_srgb = false;        // Filter RGB in linear space, alpha always stays linear
+    bool m_is_normal_map = false;  // Renormalize xyz after filtering
+    u32 m_max_mip_levels = 0;      // 0 = full chain down to 1x1
+};
+
+struct TextureChannelSource
+{
+    const u8* m_data = nullptr;  // nullptr fills the channel with m_fill_value
+    u32 m_width = 0;
+    u32 m_height = 0;
+    u32 m_num_channels = 0;
+    u32 m_channel = 0;           // Channel of the source that is copied
+    u8 m_fill_value = 255;
+};
+
+struct AtlasRect
+{
+    u32 m_width = 0;
+    u32 m_height = 0;
+};
+
+struct AtlasPlacement
+{
+    u32 m_x = 0;
+    u32 m_y = 0;
+};
+
+constexpr u32 k_orms_channel_count = 4;  // Occlusion, roughness, metalness and specular in red to alpha
+constexpr u32 k_atlas_max_mip_levels = 3;  // Mips beyond this would need gutters as wide as the entries
+constexpr u32 k_atlas_max_size = 4096;
+
+u32 get_mip_level_count(u32 width, u32 height);
+
+MipGenerationSettings get_default_mip_settings(const TextureAsset& texture);
+
+// Replaces the single level in texture->m_data with the full mip chain and updates m_mip_levels.
+// Rows of each level are filtered in parallel on the job system.
+void generate_mip_chain(TextureAsset* texture, const MipGenerationSettings& settings);
+
+// BC5 for normals, BC4 for single channel data, BC1 for opaque color and BC7 for everything else
+TextureCompression get_default_texture_compression(const TextureAsset& texture);
+
+// Encodes every level of the mip chain, block rows are encoded in parallel on the job system.
+// The result is written in the upload layout.
+void compress_texture(TextureAsset* texture, TextureCompression compression);
+
+// Fills one footprint per subresource (mip + slice * mip_levels) the way GetCopyableFootprints places them:
+// rows padded to k_texture_row_pitch_alignment, subresources aligned to k_texture_placement_alignment.
+// Returns the total size in bytes.
+u64 compute_texture_footprints(const TextureAsset& texture, TextureFootprint* out_footprints);
+
+// Rewrites tightly packed m_data in the upload layout, RGB is expanded to RGBA. Does nothing if the texture already is.
+void convert_to_upload_layout(TextureAsset* texture);
+
+// Writes a width x height image with one channel per source into dst, rows are packed in parallel on the job system
+void pack_texture_channels(u8* dst, u32 width, u32 height, const TextureChannelSource* sources, u32 num_sources);
+
+// Fills out_texture with a linear RGBA data texture of the k_orms_channel_count sources, sized like the first one with data.
+// Missing maps keep their fill value, the ChannelPacking flags of the material decide which channels are read.
+// Returns false if no source has data.
+bool cook_orms_texture(const TextureChannelSource* sources, TextureAsset* out_texture);
+
+// Skyline bottom-left packing, tallest rects first. Placements are written in input order.
+// Returns false if the rects do not fit into atlas_width x atlas_height.
+bool pack_atlas_rects(const AtlasRect* rects, u32 num_rects, u32 atlas_width, u32 atlas_height, AtlasPlacement* out_placements);
+
+// Texels of wrapped border around each atlas entry. Wide enough that filtering the mip chain of the given settings never reaches
+// a neighbour, and that every level up to m_max_mip_levels can be sampled bilinearly at the edges of the entry.
+u32 get_atlas_gutter(const MipGenerationSettings& mip_settings);
+
+// Copies tightly packed, uncompressed single mip textures of the same format into the smallest square power of two atlas that fits them.
+// The gutters are sized for the mip chain the atlas is generated with afterwards, mip_settings.m_max_mip_levels must be set.
+// out_uv_transforms receives the xy scale and zw offset that maps each source's uv range into the atlas.
+bool build_texture_atlas(const TextureAsset* const* sources, u32 num_sources, const MipGenerationSettings& mip_settings,
+                         TextureAsset* out_atlas, Vector4* out_uv_transforms);
+
+// Stacks textures with identical size, format, compression, mip count and layout into the slices of one texture array
+void build_texture_array(const TextureAsset* const* sources, u32 num_sources, TextureAsset* out_array);
+
+// Produces the next level of a tightly packed image. The parallel path is checked against this in debug builds.
+void downsample_mip_level_reference(
+    const u8* src, u32 src_width, u32 src_height,
+    u8* dst, u32 dst_width, u32 dst_height,
+    u32 num_channels, const MipGenerationSettings& settings);
@@ -0,0 +1,86 @@
+#include <UploadRing.h>
+
+#include <Log.h>
+#include <MathLib.h>
+
+namespace
+{
+    inline u64 align_up(u64 value, u64 alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+UploadRing::UploadRing(u64 capacity, u64 alignment)
+    : m_capacity(align_up(ZV::max(capacity, alignment), alignment))
+    , m_alignment(alignment)
+{
+    zv_assert_msg(alignment > 0 && (alignment & (alignment - 1)) == 0, "Upload ring alignment {} is not a power of two", alignment);
+    m_stats.m_capacity = m_capacity;
+}
+
+bool UploadRing::allocate(u64 size, u64* out_offset)
+{
+    const u64 aligned_size = align_up(ZV::max(size, u64{ 1 }), m_alignment);
+    if (aligned_size > m_capacity)
+    {
+        return false;
+    }
+
+    // The rest of the buffer is too short, the allocation starts over at offset 0 and the skipped bytes are retired
+    // with the frame like any other allocation
+    u64 begin = m_head;
+    const u64 offset = begin % m_capacity;
+    if (offset + aligned_size > m_capacity)
+    {
+        begin += m_capacity - offset;
+    }
+
+    const u64 end = begin + aligned_size;
+    if (end - m_tail > m_capacity)
+    {
+        return false;
+    }
+
+    m_head = end;
+    m_frame_allocations++;
+    m_stats.m_high_water_mark = ZV::max(m_stats.m_high_water_mark, get_used());
+
+    *out_offset = begin % m_capacity;
+    return true;
+}
+
+void UploadRing::end_frame(u64 fence_value)
+{
+    m_stats.m_frame_bytes = m_head - m_frame_begin;
+    m_stats.m_frame_allocations = m_frame_allocations;
+
+    if (m_head != m_frame_begin)
+    {
+        m_pending_frames.push(PendingFrame{ fence_value, m_head });
+    }
+
+    m_frame_begin = m_head;
+    m_frame_allocations = 0;
+}
+
+void UploadRing::reclaim(u64 completed_fence_value)
+{
+    while (!m_pending_frames.empty() && m_pending_frames.front().m_fence_value <= completed_fence_value)
+    {
+        m_tail = m_pending_frames.front().m_end;
+        m_pending_frames.pop();
+    }
+}
+
+void UploadRing::grow(u64 min_capacity)
+{
+    m_capacity = align_up(ZV::max(min_capacity, m_capacity * 2), m_alignment);
+    m_head = 0;
+    m_tail = 0;
+    m_frame_begin = 0;
+    m_pending_frames = {};
+
+    m_stats.m_capacity = m_capacity;
+    m_stats.m_num_grows++;
+}
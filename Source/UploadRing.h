@@ -0,0 +1,55 @@
+#pragma once
+
+#include <CoreDefs.h>
+
+constexpr u64 k_upload_ring_alignment = 256;  // Constant buffer views have to start on 256 bytes
+
+struct UploadRingStats
+{
+    u64 m_capacity = 0;
+    u64 m_high_water_mark = 0;   // Most bytes in use at once, frames still in flight included
+    u64 m_frame_bytes = 0;       // Allocated by the last finished frame, alignment and wrap padding included
+    u32 m_frame_allocations = 0;
+    u32 m_num_grows = 0;
+};
+
+// Offsets into a buffer that is written front to back and wraps around. Every frame's allocations are retired together
+// with the fence value the frame was submitted with, and are reused once that fence completes. Only the offsets live here,
+// the owner maps them to memory, so the logic doesn't need a device.
+class UploadRing
+{
+public:
+    // The capacity is rounded up to the alignment
+    explicit UploadRing(u64 capacity, u64 alignment = k_upload_ring_alignment);
+
+    // False when the free space doesn't fit size, the caller decides whether to wait or grow.
+    // An allocation never straddles the end of the buffer, it skips to the start instead.
+    bool allocate(u64 size, u64* out_offset);
+    // Closes the current frame, its allocations stay in use until fence_value completes
+    void end_frame(u64 fence_value);
+    void reclaim(u64 completed_fence_value);
+    // Starts over empty with at least min_capacity and at least double the old capacity. Frames in flight are forgotten,
+    // their memory belongs to the old buffer, which the caller has to keep alive until their fences complete.
+    void grow(u64 min_capacity);
+
+    u64 get_capacity() const { return m_capacity; }
+    u64 get_used() const { return m_head - m_tail; }
+    const UploadRingStats& get_stats() const { return m_stats; }
+
+private:
+    struct PendingFrame
+    {
+        u64 m_fence_value = 0;
+        u64 m_end = 0;
+    };
+
+    // Head and tail only ever grow, the offset in the buffer is the remainder by the capacity
+    u64 m_capacity = 0;
+    u64 m_alignment = 0;
+    u64 m_head = 0;
+    u64 m_tail = 0;
+    u64 m_frame_begin = 0;
+    u32 m_frame_allocations = 0;
+    std::queue<PendingFrame> m_pending_frames{};
+    UploadRingStats m_stats{};
+};
@@ -283,6 +283,15 @@ inline float srgb_channel_to_linear(float c)
     return powf((c + 0.055f) / 1.055f, 2.4f);
 }
 
+// Converts a single linear channel [0,1] to sRGB space [0,1]
+inline float linear_channel_to_srgb(float c)
+{
+  if (c <= 0.0031308f)
+    return c * 12.92f;
+  else
+    return 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+}
+
 // Converts a Vector3 sRGB color to linear space
 inline Vector3 srgb_to_linear(const Vector3& srgb)
 {